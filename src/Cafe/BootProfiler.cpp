@@ -0,0 +1,287 @@
+#include "Cafe/BootProfiler.h"
+#include "util/highresolutiontimer/HighResolutionTimer.h"
+#include "config/ActiveSettings.h"
+#include "Common/FileStream.h"
+#include "util/helpers/helpers.h"
+
+std::atomic_bool g_bootProfilerActive{ false };
+
+#define BOOT_PROFILER_MAX_TRACES_PER_TITLE	(8) // older trace files of the same title are deleted
+
+struct BootProfilerEvent
+{
+	const char* name;
+	std::string detail;
+	uint64 beginTick;
+	uint64 endTick;
+	uint64 selfTicks; // excluding nested scopes on the same thread
+	uint32 threadIndex;
+};
+
+struct
+{
+	std::mutex mutex;
+	std::atomic_uint32_t bootIndex{}; // incremented for every boot so that scopes of an aborted boot are not recorded into the next one. Only modified while holding the mutex
+	uint64 titleId{};
+	uint64 startTick{};
+	std::vector<BootProfilerEvent> events;
+	std::unordered_map<uint32, std::string> threadLabels;
+	std::atomic_uint32_t threadIndexCounter{};
+}s_bootProfiler;
+
+static thread_local BootProfilerScope* t_bootProfilerCurrentScope{};
+static thread_local uint32 t_bootProfilerThreadIndex{};
+
+static uint32 _BootProfiler_GetThreadIndex()
+{
+	if (t_bootProfilerThreadIndex == 0)
+		t_bootProfilerThreadIndex = ++s_bootProfiler.threadIndexCounter;
+	return t_bootProfilerThreadIndex;
+}
+
+void BootProfilerScope::Begin(const char* name, std::string_view detail)
+{
+	m_name = name;
+	m_detail = detail;
+	m_childTicks = 0;
+	m_bootIndex = s_bootProfiler.bootIndex.load(std::memory_order_relaxed);
+	m_parent = t_bootProfilerCurrentScope;
+	t_bootProfilerCurrentScope = this;
+	m_isActive = true;
+	m_startTick = HighResolutionTimer::now().getTick();
+}
+
+void BootProfilerScope::End()
+{
+	const uint64 endTick = HighResolutionTimer::now().getTick();
+	const uint64 totalTicks = endTick - m_startTick;
+	if (m_parent)
+		m_parent->m_childTicks += totalTicks;
+	t_bootProfilerCurrentScope = m_parent;
+	std::unique_lock _l(s_bootProfiler.mutex);
+	if (!g_bootProfilerActive || m_bootIndex != s_bootProfiler.bootIndex)
+		return;
+	s_bootProfiler.events.emplace_back(m_name, std::move(m_detail), m_startTick, endTick, totalTicks - std::min(m_childTicks, totalTicks), _BootProfiler_GetThreadIndex());
+}
+
+void BootProfiler_Begin(uint64 titleId)
+{
+	std::unique_lock _l(s_bootProfiler.mutex);
+	if (g_bootProfilerActive)
+		cemuLog_log(LogType::Force, "Boot profiler: Discarding unfinished trace of title {:016x}", s_bootProfiler.titleId);
+	g_bootProfilerActive = false;
+	s_bootProfiler.bootIndex++;
+	s_bootProfiler.events.clear();
+	if (!ActiveSettings::DumpBootTracesEnabled())
+		return;
+	s_bootProfiler.titleId = titleId;
+	s_bootProfiler.startTick = HighResolutionTimer::now().getTick();
+	g_bootProfilerActive = true;
+}
+
+void BootProfiler_SetTitleId(uint64 titleId)
+{
+	std::unique_lock _l(s_bootProfiler.mutex);
+	s_bootProfiler.titleId = titleId;
+}
+
+void BootProfiler_Abort()
+{
+	std::unique_lock _l(s_bootProfiler.mutex);
+	if (!g_bootProfilerActive)
+		return;
+	g_bootProfilerActive = false;
+	s_bootProfiler.events.clear();
+	cemuLog_log(LogType::Force, "Boot profiler: Title stopped before the first frame, trace discarded");
+}
+
+void BootProfiler_SetThreadLabel(const char* label)
+{
+	uint32 threadIndex = _BootProfiler_GetThreadIndex();
+	std::unique_lock _l(s_bootProfiler.mutex);
+	s_bootProfiler.threadLabels[threadIndex] = label;
+}
+
+static std::string _BootProfiler_EscapeJson(std::string_view str)
+{
+	std::string r;
+	r.reserve(str.size());
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			r.push_back('\\');
+		if ((uint8)c < 0x20)
+			continue;
+		r.push_back(c);
+	}
+	return r;
+}
+
+static void _BootProfiler_WriteTrace(const fs::path& path, uint64 titleId, std::span<const BootProfilerEvent> events, uint64 startTick, uint64 firstFrameTick, uint32 firstFrameThreadIndex, const std::unordered_map<uint32, std::string>& threadLabels)
+{
+	const double ticksPerUs = (double)HighResolutionTimer::getFrequency() / 1000000.0;
+	auto tickToUs = [&](uint64 tick) { return (double)(tick - startTick) / ticksPerUs; };
+	std::set<uint32> threadIndices;
+	for (auto& ev : events)
+		threadIndices.emplace(ev.threadIndex);
+	std::string json;
+	json.reserve(events.size() * 128 + 256);
+	json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	json.append(fmt::format("{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{{\"name\":\"Boot {:016x}\"}}}}", titleId));
+	for (uint32 threadIndex : threadIndices)
+	{
+		auto it = threadLabels.find(threadIndex);
+		std::string label = it != threadLabels.end() ? _BootProfiler_EscapeJson(it->second) : fmt::format("Thread {}", threadIndex);
+		json.append(fmt::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", threadIndex, label));
+	}
+	for (auto& ev : events)
+	{
+		json.append(fmt::format(",\n{{\"name\":\"{}\",\"cat\":\"boot\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"self_ms\":{:.3f}", ev.name, ev.threadIndex, tickToUs(ev.beginTick), (double)(ev.endTick - ev.beginTick) / ticksPerUs, (double)ev.selfTicks / ticksPerUs / 1000.0));
+		if (!ev.detail.empty())
+			json.append(fmt::format(",\"detail\":\"{}\"", _BootProfiler_EscapeJson(ev.detail)));
+		json.append("}}");
+	}
+	json.append(fmt::format(",\n{{\"name\":\"FirstFrame\",\"cat\":\"boot\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}", firstFrameThreadIndex, tickToUs(firstFrameTick)));
+	json.append("\n]}\n");
+
+	std::error_code ec;
+	fs::create_directories(path.parent_path(), ec);
+	FileStream* fs = FileStream::createFile2(path);
+	if (!fs)
+	{
+		cemuLog_log(LogType::Force, "Boot profiler: Unable to create file {}", _pathToUtf8(path));
+		return;
+	}
+	fs->writeData(json.data(), (sint32)json.size());
+	delete fs;
+	cemuLog_log(LogType::Force, "Boot profiler: Wrote {} events to {}", events.size(), _pathToUtf8(path));
+}
+
+// keeps only the newest traces of the title, file names end with the boot timestamp
+static void _BootProfiler_DeleteOldTraces(const fs::path& traceDir, uint64 titleId)
+{
+	const std::string prefix = fmt::format("{:016x}_", titleId);
+	std::vector<fs::path> traceFiles;
+	std::error_code ec;
+	for (auto& it : fs::directory_iterator(traceDir, ec))
+	{
+		std::string fileName = _pathToUtf8(it.path().filename());
+		if (fileName.starts_with(prefix) && fileName.ends_with(".json"))
+			traceFiles.emplace_back(it.path());
+	}
+	if (traceFiles.size() <= BOOT_PROFILER_MAX_TRACES_PER_TITLE)
+		return;
+	std::sort(traceFiles.begin(), traceFiles.end());
+	for (size_t i = 0; i < traceFiles.size() - BOOT_PROFILER_MAX_TRACES_PER_TITLE; i++)
+		fs::remove(traceFiles[i], ec);
+}
+
+// summary of the previous boot, one "<phase>\t<milliseconds>" line per phase
+static std::map<std::string, double> _BootProfiler_LoadSummary(const fs::path& path)
+{
+	std::map<std::string, double> summary;
+	FileStream* fs = FileStream::openFile2(path);
+	if (!fs)
+		return summary;
+	std::string line;
+	while (fs->readLine(line))
+	{
+		size_t separator = line.find('\t');
+		if (separator == std::string::npos)
+			continue;
+		char* end;
+		double ms = strtod(line.c_str() + separator + 1, &end);
+		if (end == line.c_str() + separator + 1)
+			continue;
+		summary.emplace(line.substr(0, separator), ms);
+	}
+	delete fs;
+	return summary;
+}
+
+static void _BootProfiler_StoreSummary(const fs::path& path, const std::map<std::string, double>& summary)
+{
+	FileStream* fs = FileStream::createFile2(path);
+	if (!fs)
+		return;
+	for (auto& it : summary)
+		fs->writeLine(fmt::format("{}\t{:.3f}", it.first, it.second).c_str());
+	delete fs;
+}
+
+// writes the trace and compares against the previous boot, runs on its own thread
+static void _BootProfiler_StoreResults(uint64 titleId, std::vector<BootProfilerEvent> events, uint64 startTick, uint64 firstFrameTick, uint32 firstFrameThreadIndex, std::unordered_map<uint32, std::string> threadLabels)
+{
+	SetThreadName("BootProfiler");
+	static std::mutex s_storeMutex; // boots which end in quick succession share the summary file
+	std::unique_lock _l(s_storeMutex);
+	const double ticksPerMs = (double)HighResolutionTimer::getFrequency() / 1000.0;
+	std::sort(events.begin(), events.end(), [](const BootProfilerEvent& a, const BootProfilerEvent& b) { return a.beginTick < b.beginTick; });
+	const fs::path traceDir = ActiveSettings::GetUserDataPath("dump/boot_traces");
+	_BootProfiler_WriteTrace(traceDir / fmt::format("{:016x}_{}.json", titleId, (uint32)time(nullptr)), titleId, events, startTick, firstFrameTick, firstFrameThreadIndex, threadLabels);
+	_BootProfiler_DeleteOldTraces(traceDir, titleId);
+
+	// total and self time per phase, phases which run multiple times (e.g. one per module) are summed up
+	std::map<std::string, double> phaseTotalMs;
+	std::map<std::string, double> phaseSelfMs;
+	for (auto& ev : events)
+	{
+		phaseTotalMs[ev.name] += (double)(ev.endTick - ev.beginTick) / ticksPerMs;
+		phaseSelfMs[ev.name] += (double)ev.selfTicks / ticksPerMs;
+	}
+	const double timeToFirstFrameMs = (double)(firstFrameTick - startTick) / ticksPerMs;
+	phaseTotalMs["TimeToFirstFrame"] = timeToFirstFrameMs;
+
+	// log the phases which dominate the boot
+	std::vector<std::pair<std::string, double>> dominantPhases(phaseSelfMs.begin(), phaseSelfMs.end());
+	std::sort(dominantPhases.begin(), dominantPhases.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+	if (dominantPhases.size() > 5)
+		dominantPhases.resize(5);
+	std::string dominantPhasesStr;
+	for (auto& it : dominantPhases)
+	{
+		if (!dominantPhasesStr.empty())
+			dominantPhasesStr.append(", ");
+		dominantPhasesStr.append(fmt::format("{} {:.1f}ms", it.first, it.second));
+	}
+
+	// compare with the previous boot of this title
+	const fs::path summaryPath = ActiveSettings::GetUserDataPath("dump/boot_traces/{:016x}_summary.txt", titleId);
+	std::map<std::string, double> previousSummary = _BootProfiler_LoadSummary(summaryPath);
+	auto previousFirstFrame = previousSummary.find("TimeToFirstFrame");
+	if (previousFirstFrame != previousSummary.end())
+		cemuLog_log(LogType::Force, "Boot profiler: Time to first frame {:.1f}ms (previous boot {:.1f}ms)", timeToFirstFrameMs, previousFirstFrame->second);
+	else
+		cemuLog_log(LogType::Force, "Boot profiler: Time to first frame {:.1f}ms", timeToFirstFrameMs);
+	cemuLog_log(LogType::Force, "Boot profiler: Dominant phases (self time): {}", dominantPhasesStr);
+	for (auto& it : phaseTotalMs)
+	{
+		auto previous = previousSummary.find(it.first);
+		if (previous == previousSummary.end() || it.first == "TimeToFirstFrame")
+			continue;
+		// ignore noise, only report phases which got noticeably slower in absolute and relative terms
+		const double deltaMs = it.second - previous->second;
+		if (deltaMs >= 10.0 && it.second >= previous->second * 1.2)
+			cemuLog_log(LogType::Force, "Boot profiler: Regression in {} - {:.1f}ms (previous boot {:.1f}ms, +{:.0f}%)", it.first, it.second, previous->second, deltaMs * 100.0 / std::max(previous->second, 0.001));
+	}
+	_BootProfiler_StoreSummary(summaryPath, phaseTotalMs);
+}
+
+void BootProfiler_NotifyFirstFrame()
+{
+	if (!g_bootProfilerActive.load(std::memory_order_relaxed))
+		return;
+	const uint64 firstFrameTick = HighResolutionTimer::now().getTick();
+	std::unique_lock _l(s_bootProfiler.mutex);
+	if (!g_bootProfilerActive)
+		return;
+	g_bootProfilerActive = false;
+	std::vector<BootProfilerEvent> events = std::move(s_bootProfiler.events);
+	s_bootProfiler.events.clear();
+	const uint64 startTick = s_bootProfiler.startTick;
+	const uint64 titleId = s_bootProfiler.titleId;
+	std::unordered_map<uint32, std::string> threadLabels = s_bootProfiler.threadLabels;
+	_l.unlock();
+	// called from the GPU thread, keep the file IO off it
+	std::thread(_BootProfiler_StoreResults, titleId, std::move(events), startTick, firstFrameTick, _BootProfiler_GetThreadIndex(), std::move(threadLabels)).detach();
+}
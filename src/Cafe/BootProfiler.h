@@ -0,0 +1,64 @@
+#pragma once
+
+// boot profiler
+// records the startup phases of a title from CafeSystem::PrepareForegroundTitle until the first presented frame
+// only active when enabled via Debug -> Dump -> Boot traces. Each boot is written as a Chrome trace event file (chrome://tracing or ui.perfetto.dev)
+// to dump/boot_traces/, keeping the newest few per title, and the phase timings are compared against the previous boot of the same title to report regressions
+// scopes are always compiled in, outside of a boot each scope only costs a single branch
+
+extern std::atomic_bool g_bootProfilerActive;
+
+class BootProfilerScope
+{
+public:
+	BootProfilerScope(const char* name)
+	{
+		if (g_bootProfilerActive.load(std::memory_order_relaxed))
+			Begin(name, {});
+	}
+
+	// detail is shown in the trace as an argument of the event, e.g. the name of a module
+	BootProfilerScope(const char* name, std::string_view detail)
+	{
+		if (g_bootProfilerActive.load(std::memory_order_relaxed))
+			Begin(name, detail);
+	}
+
+	// same as above, but the detail is only generated while a boot is being profiled
+	template<typename TDetailGenerator> requires std::is_invocable_v<TDetailGenerator>
+	BootProfilerScope(const char* name, TDetailGenerator&& generateDetail)
+	{
+		if (g_bootProfilerActive.load(std::memory_order_relaxed))
+			Begin(name, generateDetail());
+	}
+
+	~BootProfilerScope()
+	{
+		if (m_isActive)
+			End();
+	}
+
+	BootProfilerScope(const BootProfilerScope&) = delete;
+	BootProfilerScope& operator=(const BootProfilerScope&) = delete;
+
+private:
+	void Begin(const char* name, std::string_view detail);
+	void End();
+
+	BootProfilerScope* m_parent; // enclosing scope on the same thread
+	const char* m_name;
+	std::string m_detail;
+	uint64 m_startTick;
+	uint64 m_childTicks;
+	uint32 m_bootIndex;
+	bool m_isActive{ false };
+};
+
+#define BOOT_PROFILE_SCOPE(__name) BootProfilerScope _bootProfilerScope(__name)
+#define BOOT_PROFILE_SCOPE_DETAIL(__name, __detail) BootProfilerScope _bootProfilerScope(__name, [&]() { return std::string(__detail); })
+
+void BootProfiler_Begin(uint64 titleId); // starts a new boot trace if enabled, any unfinished trace is discarded
+void BootProfiler_SetTitleId(uint64 titleId); // for boots where the title id is only known after the trace started
+void BootProfiler_NotifyFirstFrame(); // ends the trace, writes it to disk and logs the comparison with the previous boot
+void BootProfiler_Abort(); // title was stopped before the first frame
+void BootProfiler_SetThreadLabel(const char* label); // name of the calling thread in the trace
@@ -17,6 +17,7 @@
 #include "input/InputManager.h"
 #include "input/TAS/TASInput.h"
 #include "Cafe/CafeSystem.h"
+#include "Cafe/BootProfiler.h"
 #include "Cafe/TitleList/TitleList.h"
 #include "Cafe/TitleList/GameInfo.h"
 #include "Cafe/OS/libs/coreinit/coreinit_Alarm.h"
@@ -264,11 +265,22 @@ void InfoLog_PrintActiveSettings()
 			cemuLog_log(LogType::Force, "Accurate barriers are disabled!");
 	}
 #endif
+	if (ActiveSettings::GetGraphicsAPI() == GraphicAPI::kNull)
+		cemuLog_log(LogType::Force, "Null renderer: no graphics output");
 	cemuLog_log(LogType::Force, "Console language: {}", stdx::to_underlying(config.console_language.GetValue()));
 	cemuLog_log(LogType::Force, "TAS deterministic scheduler: {}", TasInput::IsDeterministicSchedulerEnabled() ? "true" : "false");
 	cemuLog_log(LogType::Force, "TAS deterministic time base: {}", TasInput::IsDeterministicTimeEnabled() ? "true" : "false");
 }
 
+void InfoLog_PrintFSTBlockCacheStats()
+{
+	FSTBlockCache::Stats stats = FSTBlockCache::GetStats();
+	uint64 numAccesses = stats.hits + stats.misses;
+	if (numAccesses == 0)
+		return;
+	cemuLog_log(LogType::Force, "FST block cache: {} accesses, hit rate {:.1f}%, {} blocks read ahead, {} evictions, {}/{} MiB used", numAccesses, (double)stats.hits * 100.0 / (double)numAccesses, stats.readAheadBlocks, stats.evictions, stats.bytesUsed / (1024 * 1024), stats.capacity / (1024 * 1024));
+}
+
 struct SharedDataEntry
 {
 	/* +0x00 */ uint32be name;
@@ -400,15 +412,21 @@ void cemu_initForGame()
 	}
 	PPCTimer_start();
 	// coreinit is bootstrapped first and then the main game executable is loaded
-	RPLLoader_LoadCoreinit();
-	LoadMainExecutable();
+	{
+		BOOT_PROFILE_SCOPE("LoadMainExecutable");
+		RPLLoader_LoadCoreinit();
+		LoadMainExecutable();
+	}
 	// log info for launched title
 	InfoLog_TitleLoaded();
 	// link all modules
 	uint32 linkTimeStart = GetTickCount();
-	RPLLoader_UpdateDependencies();
-	RPLLoader_Link();
-	RPLLoader_NotifyControlPassedToApplication();
+	{
+		BOOT_PROFILE_SCOPE("LinkModules");
+		RPLLoader_UpdateDependencies();
+		RPLLoader_Link();
+		RPLLoader_NotifyControlPassedToApplication();
+	}
 	uint32 linkTime = GetTickCount() - linkTimeStart;
 	cemuLog_log(LogType::Force, "RPL link time: {}ms", linkTime);
 	// for HBL ELF: Setup OS-specifics struct
@@ -420,11 +438,15 @@ void cemu_initForGame()
 	else
 	{
 		// replace any known function signatures with our HLE implementations and patch bugs in the games
+		BOOT_PROFILE_SCOPE("GamePatchScan");
 		GamePatch_scan();
 	}
 	LatteGPUState.isDRCPrimary = ActiveSettings::DisplayDRCEnabled();
 	InfoLog_PrintActiveSettings();
-	Latte_Start();
+	{
+		BOOT_PROFILE_SCOPE("LatteStart");
+		Latte_Start();
+	}
 	// check for debugger entrypoint bp
     if (g_gdbstub)
     {
@@ -434,16 +456,25 @@ void cemu_initForGame()
 	debugger_handleEntryBreakpoint(_entryPoint);
 	// load graphic packs
 	cemuLog_log(LogType::Force, "------- Activate graphic packs -------");
-	GraphicPack2::ActivateForCurrentTitle();
+	{
+		BOOT_PROFILE_SCOPE("ActivateGraphicPacks");
+		GraphicPack2::ActivateForCurrentTitle();
+	}
 	// print audio log
 	IAudioAPI::PrintLogging();
 	IAudioInputAPI::PrintLogging();
 	// everything initialized
 	cemuLog_log(LogType::Force, "------- Run title -------");
 	// wait till GPU thread is initialized
-	while (g_isGPUInitFinished == false) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	{
+		BOOT_PROFILE_SCOPE("WaitForGPUInit");
+		while (g_isGPUInitFinished == false) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
 	// run coreinit rpl_entry
-	RPLLoader_CallCoreinitEntrypoint();
+	{
+		BOOT_PROFILE_SCOPE("CoreinitEntrypoint");
+		RPLLoader_CallCoreinitEntrypoint();
+	}
 	// init AX and start AX I/O thread
 	snd_core::AXOut_init();
 }
@@ -582,6 +613,17 @@ namespace CafeSystem
 		iosu::boss::GetModule()
 	};
 
+	// same order as s_iosuModules, used to label the modules in boot traces
+	static const char* s_iosuModuleNames[] =
+	{
+		"kernel",
+		"acp",
+		"fpd",
+		"pdm",
+		"ccr_nfc",
+		"boss"
+	};
+
 	// initialize all subsystems which are persistent and don't depend on a game running
 	void Initialize()
 	{
@@ -667,6 +709,7 @@ namespace CafeSystem
 	PREPARE_STATUS_CODE LoadAndMountForegroundTitle(TitleId titleId)
 	{
         cemuLog_log(LogType::Force, "Mounting title {:016x}", (uint64)titleId);
+		BOOT_PROFILE_SCOPE("MountTitle");
 		sGameInfo_ForegroundTitle = CafeTitleList::GetGameInfo(titleId);
 		if (!sGameInfo_ForegroundTitle.IsValid())
 		{
@@ -677,7 +720,7 @@ namespace CafeSystem
 		TitleInfo& titleBase = sGameInfo_ForegroundTitle.GetBase();
 		if (!titleBase.IsValid())
 			return PREPARE_STATUS_CODE::UNABLE_TO_MOUNT;
-		if(!titleBase.ParseXmlInfo())
+		if(BootProfilerScope _s("ParseTitleInfo", "base"); !titleBase.ParseXmlInfo())
 			return PREPARE_STATUS_CODE::UNABLE_TO_MOUNT;
 		cemuLog_log(LogType::Force, "Base: {}", titleBase.GetPrintPath());
 		// mount base
@@ -690,7 +733,7 @@ namespace CafeSystem
 		TitleInfo& titleUpdate = sGameInfo_ForegroundTitle.GetUpdate();
 		if (titleUpdate.IsValid())
 		{
-			if (!titleUpdate.ParseXmlInfo())
+			if (BootProfilerScope _s("ParseTitleInfo", "update"); !titleUpdate.ParseXmlInfo())
 				return PREPARE_STATUS_CODE::UNABLE_TO_MOUNT;
 			cemuLog_log(LogType::Force, "Update: {}", titleUpdate.GetPrintPath());
 			// mount update
@@ -708,7 +751,7 @@ namespace CafeSystem
 		{
 			// todo - support for multi-title AOC
 			TitleInfo& titleAOC = aocList[0];
-			if (!titleAOC.ParseXmlInfo())
+			if (BootProfilerScope _s("ParseTitleInfo", "aoc"); !titleAOC.ParseXmlInfo())
 				return PREPARE_STATUS_CODE::UNABLE_TO_MOUNT;
 			cemu_assert_debug(titleAOC.IsValid());
 			cemuLog_log(LogType::Force, "DLC: {}", titleAOC.GetPrintPath());
@@ -797,26 +840,52 @@ namespace CafeSystem
 
 	PREPARE_STATUS_CODE PrepareForegroundTitle(TitleId titleId)
 	{
-		CafeTitleList::WaitForMandatoryScan();
+		// the boot trace ends with the first presented frame
+		BootProfiler_Begin(titleId);
+		BootProfiler_SetThreadLabel("Main");
+		stdx::scope_exit bootProfilerAbort([]() { BootProfiler_Abort(); });
+		BOOT_PROFILE_SCOPE("PrepareForegroundTitle");
+		{
+			BOOT_PROFILE_SCOPE("WaitForTitleScan");
+			CafeTitleList::WaitForMandatoryScan();
+		}
 		sLaunchModeIsStandalone = false;
         _pathToExecutable.clear();
 		TitleIdParser tip(titleId);
 		if (tip.GetType() == TitleIdParser::TITLE_TYPE::AOC || tip.GetType() == TitleIdParser::TITLE_TYPE::BASE_TITLE_UPDATE)
 			cemuLog_log(LogType::Force, "Launched titleId is not the base of a title");
         // mount mlc storage
-        MountBaseDirectories();
+		{
+			BOOT_PROFILE_SCOPE("MountBaseDirectories");
+			MountBaseDirectories();
+		}
+		FSTBlockCache::SetCapacity((uint64)GetConfig().fst_block_cache_size.GetValue() * 1024 * 1024);
+		FSTBlockCache::ResetStats();
         // mount title folders
 		PREPARE_STATUS_CODE r = LoadAndMountForegroundTitle(titleId);
 		if (r != PREPARE_STATUS_CODE::SUCCESS)
 			return r;
-		gameProfile_load();
+		{
+			BOOT_PROFILE_SCOPE("LoadGameProfile");
+			gameProfile_load();
+		}
 		// setup memory space and PPC recompiler
-        SetupMemorySpace();
-        PPCRecompiler_init();
+		{
+			BOOT_PROFILE_SCOPE("SetupMemorySpace");
+			SetupMemorySpace();
+		}
+		{
+			BOOT_PROFILE_SCOPE("PPCRecompilerInit");
+			PPCRecompiler_init();
+		}
 		r = PrepareExecutable(); // load RPX
 		if (r != PREPARE_STATUS_CODE::SUCCESS)
 			return r;
-		InitVirtualMlcStorage();
+		{
+			BOOT_PROFILE_SCOPE("MountMlcStorage");
+			InitVirtualMlcStorage();
+		}
+		bootProfilerAbort.release();
 		return PREPARE_STATUS_CODE::SUCCESS;
 	}
 
@@ -824,6 +893,10 @@ namespace CafeSystem
 	{
 		sLaunchModeIsStandalone = true;
 		cemuLog_log(LogType::Force, "Launching executable in standalone mode due to incorrect layout or missing meta files");
+		// the placeholder title id is only known after the executable was read, it is assigned to the trace further below
+		BootProfiler_Begin(0);
+		BootProfiler_SetThreadLabel("Main");
+		stdx::scope_exit bootProfilerAbort([]() { BootProfiler_Abort(); });
 		fs::path executablePath = path;
 		std::string dirName = _pathToUtf8(executablePath.parent_path().filename());
 		if (boost::iequals(dirName, "code"))
@@ -854,19 +927,29 @@ namespace CafeSystem
 		uint32 h = generateHashFromRawRPXData(execData->data(), execData->size());
 		sForegroundTitleId = 0xFFFFFFFF00000000ULL | (uint64)h;
 		cemuLog_log(LogType::Force, "Generated placeholder TitleId: {:016x}", sForegroundTitleId);
+		BootProfiler_SetTitleId(sForegroundTitleId);
 		// setup memory space and ppc recompiler
         SetupMemorySpace();
         PPCRecompiler_init();
         // load executable
         PrepareExecutable();
 		InitVirtualMlcStorage();
+		bootProfilerAbort.release();
 		return PREPARE_STATUS_CODE::SUCCESS;
 	}
 
 	void _LaunchTitleThread()
 	{
-		for(auto& module : s_iosuModules)
-			module->TitleStart();
+		BootProfiler_SetThreadLabel("LaunchTitle");
+		{
+			BOOT_PROFILE_SCOPE("IOSUTitleStart");
+			cemu_assert_debug(s_iosuModules.size() == std::size(s_iosuModuleNames));
+			for (size_t i = 0; i < s_iosuModules.size(); i++)
+			{
+				BOOT_PROFILE_SCOPE_DETAIL("IOSUModuleStart", s_iosuModuleNames[i]);
+				s_iosuModules[i]->TitleStart();
+			}
+		}
 		cemu_initForGame();
 		const bool forceTasDeterministicSingleCore = TasInput::IsDeterministicSchedulerEnabled();
 		const bool strictTasMode = TasInput::IsStrictTasModeEnabled();
@@ -1054,6 +1137,7 @@ namespace CafeSystem
 		shutdownLock.unlock();
 
 		TasInput::SetFrameAdvancePaused(false);
+		BootProfiler_Abort();
 		if(!sSystemRunning)
 		{
 			shutdownLock.lock();
@@ -1076,6 +1160,7 @@ namespace CafeSystem
 	        // reset Cemu subsystems
 	        PPCRecompiler_Shutdown();
 	        GraphicPack2::Reset();
+			InfoLog_PrintFSTBlockCacheStats();
 	        UnmountCurrentTitle();
 	        MlcStorageUnmountAllTitles();
 	        UnmountBaseDirectories();
@@ -3,6 +3,7 @@
 #include "Cemu/ncrypto/ncrypto.h"
 #include "Cafe/Filesystem/WUD/wud.h"
 #include "util/crypto/aes128.h"
+#include "util/ThreadPool/ThreadPool.h"
 #include "openssl/sha.h" /* SHA1 / SHA256 */
 #include "fstUtil.h"
 
@@ -19,8 +20,13 @@ class FSTDataSource
 {
 public:
 	virtual uint64 readData(uint16 clusterIndex, uint64 clusterOffset, uint64 offset, void* data, uint64 size) = 0;
+	// returns a pointer to the data if the source can provide the whole range without copying, otherwise nullptr
+	// unlike readData() this does not need m_readMutex
+	virtual const uint8* getDataPtr(uint16 clusterIndex, uint64 clusterOffset, uint64 offset, uint64 size) { return nullptr; }
 	virtual ~FSTDataSource() {};
 
+	std::mutex m_readMutex; // data sources are seek based, reads from multiple threads need to be serialized
+
 protected:
 	FSTDataSource() {};
 
@@ -57,6 +63,13 @@ public:
 		return wud_readData(m_wudFile, data, (uint32)size, clusterOffset + offset + m_baseOffset);
 	}
 
+	const uint8* getDataPtr(uint16 clusterIndex, uint64 clusterOffset, uint64 offset, uint64 size) override
+	{
+		if (size > 0xFFFFFFFF)
+			return nullptr;
+		return wud_getDataPtr(m_wudFile, clusterOffset + offset + m_baseOffset, (uint32)size);
+	}
+
 	~FSTDataSourceWUD() override
 	{
 		if(m_wudFile)
@@ -867,58 +880,242 @@ struct FSTHashedBlock
 
 static_assert(sizeof(FSTHashedBlock) == BLOCK_SIZE);
 
-struct FSTCachedRawBlock
+struct FSTCachedBlock
 {
-	FSTRawBlock blockData;
-	NCrypto::AesIv ivForNextBlock;
-	uint64 lastAccess;
+	std::vector<uint8> data; // decrypted block. For hashed blocks this includes the hash area
+	NCrypto::AesIv ivForNextBlock; // raw blocks only
+
+	FSTHashedBlock* GetHashedBlock()
+	{
+		cemu_assert_debug(data.size() == BLOCK_SIZE);
+		return (FSTHashedBlock*)data.data();
+	}
 };
 
-struct FSTCachedHashedBlock 
+/* FSTBlockCache */
+
+static constexpr size_t FST_BLOCK_CACHE_SHARD_COUNT = 16;
+static constexpr uint32 FST_READ_AHEAD_SIZE = 512 * 1024; // read ahead this many bytes once a file is read sequentially
+static constexpr uint32 FST_MAX_FETCH_SIZE = 2 * 1024 * 1024; // upper limit for a single read from the data source
+static constexpr uint32 FST_PARALLEL_DECRYPT_MIN_BLOCKS = 4; // smaller batches are decrypted on the calling thread
+
+struct FSTBlockCacheKey
 {
-	FSTHashedBlock blockData;
-	uint64 lastAccess;
+	uint64 volumeId;
+	uint64 blockId; // bit 63 set for hashed blocks, cluster index << 32 | block index
+
+	FSTBlockCacheKey(uint64 volumeId, bool isHashed, uint32 clusterIndex, uint32 blockIndex) : volumeId(volumeId), blockId((isHashed ? (1ull << 63) : 0) | ((uint64)clusterIndex << 32) | (uint64)blockIndex) {}
+
+	bool operator==(const FSTBlockCacheKey& other) const
+	{
+		return volumeId == other.volumeId && blockId == other.blockId;
+	}
+
+	struct HashFunc
+	{
+		size_t operator()(const FSTBlockCacheKey& v) const
+		{
+			uint64 h = v.blockId ^ (v.volumeId * 0x9E3779B97F4A7C15ull);
+			h ^= h >> 29;
+			h *= 0xBF58476D1CE4E5B9ull;
+			return (size_t)(h ^ (h >> 32));
+		}
+	};
 };
 
-// Checks cache fill state and if necessary drops least recently accessed block from the cache. Optionally allows to recycle the released cache entry to cut down cost of memory allocation and clearing
-void FSTVolume::TrimCacheIfRequired(FSTCachedRawBlock** droppedRawBlock, FSTCachedHashedBlock** droppedHashedBlock)
+struct FSTBlockCacheShard
 {
-	// calculate size used by cache
-	size_t cacheSize = 0;
-	for (auto& itr : m_cacheDecryptedRawBlocks)
-		cacheSize += itr.second->blockData.rawData.size();
-	for (auto& itr : m_cacheDecryptedHashedBlocks)
-		cacheSize += sizeof(FSTCachedHashedBlock) + sizeof(FSTHashedBlock);
-	// only trim if cache is full (larger than 2MB)
-	if (cacheSize < 2*1024*1024) // 2MB
-		return;
-	// scan both cache lists to find least recently accessed block to drop
-	auto dropRawItr = std::min_element(m_cacheDecryptedRawBlocks.begin(), m_cacheDecryptedRawBlocks.end(), [](const auto& a, const auto& b) -> bool
-										{ return a.second->lastAccess < b.second->lastAccess; });
-	auto dropHashedItr = std::min_element(m_cacheDecryptedHashedBlocks.begin(), m_cacheDecryptedHashedBlocks.end(), [](const auto& a, const auto& b) -> bool
-										{ return a.second->lastAccess < b.second->lastAccess; });
-	uint64 lastAccess = std::numeric_limits<uint64>::max();
-	if(dropRawItr != m_cacheDecryptedRawBlocks.end())
-		lastAccess = dropRawItr->second->lastAccess;
-	if(dropHashedItr != m_cacheDecryptedHashedBlocks.end())
-		lastAccess = std::min<uint64>(lastAccess, dropHashedItr->second->lastAccess);
-	if(dropRawItr != m_cacheDecryptedRawBlocks.end() && dropRawItr->second->lastAccess == lastAccess)
-	{
-		if (droppedRawBlock)
-			*droppedRawBlock = dropRawItr->second;
-		else
-			delete dropRawItr->second;
-		m_cacheDecryptedRawBlocks.erase(dropRawItr);
-		return;
+	struct Entry
+	{
+		Entry(const FSTBlockCacheKey& key, std::shared_ptr<FSTCachedBlock> block) : key(key), block(std::move(block)) {}
+
+		FSTBlockCacheKey key;
+		std::shared_ptr<FSTCachedBlock> block;
+		Entry* lruPrev{};
+		Entry* lruNext{};
+	};
+
+	std::mutex mutex;
+	std::unordered_map<FSTBlockCacheKey, Entry, FSTBlockCacheKey::HashFunc> entries; // element addresses are stable, the LRU list links them directly
+	Entry* lruHead{}; // most recently used
+	Entry* lruTail{}; // least recently used
+	uint64 bytesUsed{};
+
+	static uint64 GetEntrySize(const Entry& entry)
+	{
+		return entry.block->data.size() + sizeof(FSTCachedBlock) + sizeof(Entry);
 	}
-	else if(dropHashedItr != m_cacheDecryptedHashedBlocks.end() && dropHashedItr->second->lastAccess == lastAccess)
+
+	void Unlink(Entry* entry)
 	{
-		if (droppedHashedBlock)
-			*droppedHashedBlock = dropHashedItr->second;
+		if (entry->lruPrev)
+			entry->lruPrev->lruNext = entry->lruNext;
 		else
-			delete dropHashedItr->second;
-		m_cacheDecryptedHashedBlocks.erase(dropHashedItr);
+			lruHead = entry->lruNext;
+		if (entry->lruNext)
+			entry->lruNext->lruPrev = entry->lruPrev;
+		else
+			lruTail = entry->lruPrev;
+		entry->lruPrev = nullptr;
+		entry->lruNext = nullptr;
+	}
+
+	void PushFront(Entry* entry)
+	{
+		entry->lruPrev = nullptr;
+		entry->lruNext = lruHead;
+		if (lruHead)
+			lruHead->lruPrev = entry;
+		lruHead = entry;
+		if (!lruTail)
+			lruTail = entry;
+	}
+
+	void Erase(Entry* entry)
+	{
+		Unlink(entry);
+		bytesUsed -= GetEntrySize(*entry);
+		FSTBlockCacheKey key = entry->key;
+		entries.erase(key);
+	}
+
+	// drop least recently used blocks until the shard fits into its budget
+	uint32 Trim(uint64 capacity)
+	{
+		uint32 numEvicted = 0;
+		while (bytesUsed > capacity && lruTail)
+		{
+			Erase(lruTail);
+			numEvicted++;
+		}
+		return numEvicted;
+	}
+};
+
+static struct
+{
+	std::array<FSTBlockCacheShard, FST_BLOCK_CACHE_SHARD_COUNT> shards;
+	std::atomic_uint64_t capacity{64 * 1024 * 1024};
+	std::atomic_uint64_t nextVolumeId{1};
+	// statistics
+	std::atomic_uint64_t hits{};
+	std::atomic_uint64_t misses{};
+	std::atomic_uint64_t readAheadBlocks{};
+	std::atomic_uint64_t evictions{};
+}s_fstBlockCache;
+
+static FSTBlockCacheShard& _FSTBlockCache_GetShard(const FSTBlockCacheKey& key)
+{
+	return s_fstBlockCache.shards[FSTBlockCacheKey::HashFunc()(key) % FST_BLOCK_CACHE_SHARD_COUNT];
+}
+
+static std::shared_ptr<FSTCachedBlock> _FSTBlockCache_Lookup(const FSTBlockCacheKey& key, bool updateStats)
+{
+	FSTBlockCacheShard& shard = _FSTBlockCache_GetShard(key);
+	std::unique_lock _l(shard.mutex);
+	auto itr = shard.entries.find(key);
+	if (itr == shard.entries.end())
+	{
+		if (updateStats)
+			s_fstBlockCache.misses++;
+		return nullptr;
+	}
+	shard.Unlink(&itr->second);
+	shard.PushFront(&itr->second);
+	if (updateStats)
+		s_fstBlockCache.hits++;
+	return itr->second.block;
+}
+
+static bool _FSTBlockCache_Contains(const FSTBlockCacheKey& key)
+{
+	FSTBlockCacheShard& shard = _FSTBlockCache_GetShard(key);
+	std::unique_lock _l(shard.mutex);
+	return shard.entries.find(key) != shard.entries.end();
+}
+
+static void _FSTBlockCache_Insert(const FSTBlockCacheKey& key, std::shared_ptr<FSTCachedBlock> block)
+{
+	FSTBlockCacheShard& shard = _FSTBlockCache_GetShard(key);
+	std::unique_lock _l(shard.mutex);
+	auto [itr, inserted] = shard.entries.try_emplace(key, key, std::move(block));
+	if (!inserted)
+		return; // another thread decrypted the same block in the meantime
+	shard.PushFront(&itr->second);
+	shard.bytesUsed += FSTBlockCacheShard::GetEntrySize(itr->second);
+	s_fstBlockCache.evictions += shard.Trim(s_fstBlockCache.capacity / FST_BLOCK_CACHE_SHARD_COUNT);
+}
+
+static void _FSTBlockCache_RemoveVolume(uint64 volumeId)
+{
+	for (auto& shard : s_fstBlockCache.shards)
+	{
+		std::unique_lock _l(shard.mutex);
+		FSTBlockCacheShard::Entry* entry = shard.lruHead;
+		while (entry)
+		{
+			FSTBlockCacheShard::Entry* next = entry->lruNext;
+			if (entry->key.volumeId == volumeId)
+				shard.Erase(entry);
+			entry = next;
+		}
+	}
+}
+
+void FSTBlockCache::SetCapacity(uint64 capacityInBytes)
+{
+	capacityInBytes = std::max<uint64>(capacityInBytes, FST_BLOCK_CACHE_SHARD_COUNT * FST_MAX_FETCH_SIZE);
+	s_fstBlockCache.capacity = capacityInBytes;
+	for (auto& shard : s_fstBlockCache.shards)
+	{
+		std::unique_lock _l(shard.mutex);
+		s_fstBlockCache.evictions += shard.Trim(capacityInBytes / FST_BLOCK_CACHE_SHARD_COUNT);
+	}
+}
+
+FSTBlockCache::Stats FSTBlockCache::GetStats()
+{
+	Stats stats{};
+	stats.hits = s_fstBlockCache.hits;
+	stats.misses = s_fstBlockCache.misses;
+	stats.readAheadBlocks = s_fstBlockCache.readAheadBlocks;
+	stats.evictions = s_fstBlockCache.evictions;
+	stats.capacity = s_fstBlockCache.capacity;
+	for (auto& shard : s_fstBlockCache.shards)
+	{
+		std::unique_lock _l(shard.mutex);
+		stats.bytesUsed += shard.bytesUsed;
 	}
+	return stats;
+}
+
+uint64 FSTBlockCache::AllocateVolumeId()
+{
+	return s_fstBlockCache.nextVolumeId++;
+}
+
+void FSTBlockCache::ResetStats()
+{
+	s_fstBlockCache.hits = 0;
+	s_fstBlockCache.misses = 0;
+	s_fstBlockCache.readAheadBlocks = 0;
+	s_fstBlockCache.evictions = 0;
+}
+
+// Returns how many blocks past the end of the current read should be fetched ahead of time
+// Read-ahead kicks in once consecutive reads continue where the previous one ended
+uint32 FSTVolume::GetReadAheadBlockCount(uint32 clusterIndex, uint32 firstBlockIndex, uint32 lastBlockIndex, uint32 lastFileBlockIndex, uint32 blockSize)
+{
+	uint64 prevLastBlock = m_lastReadBlock.exchange(((uint64)clusterIndex << 32) | (uint64)lastBlockIndex);
+	bool isSequential = (uint32)(prevLastBlock >> 32) == clusterIndex && (uint32)prevLastBlock <= firstBlockIndex && (uint64)(uint32)prevLastBlock + 1 >= firstBlockIndex;
+	if (!isSequential)
+	{
+		m_sequentialReadCount = 0;
+		return 0;
+	}
+	if (++m_sequentialReadCount < 2)
+		return 0;
+	return std::min<uint32>(FST_READ_AHEAD_SIZE / blockSize, lastFileBlockIndex - lastBlockIndex);
 }
 
 void FSTVolume::DetermineUnhashedBlockIV(uint32 clusterIndex, uint32 blockIndex, NCrypto::AesIv& ivOut)
@@ -934,11 +1131,9 @@ void FSTVolume::DetermineUnhashedBlockIV(uint32 clusterIndex, uint32 blockIndex,
 		// the last 16 encrypted bytes of the previous block are the IV (AES CBC)
 		// if the previous block is cached we can grab the IV from there. Otherwise we have to read the 16 bytes from the data source
 		uint32 prevBlockIndex = blockIndex - 1;
-		uint64 cacheBlockId = ((uint64)clusterIndex << (64 - 16)) | (uint64)prevBlockIndex;
-		auto itr = m_cacheDecryptedRawBlocks.find(cacheBlockId);
-		if (itr != m_cacheDecryptedRawBlocks.end())
+		if (auto prevBlock = _FSTBlockCache_Lookup(FSTBlockCacheKey(m_cacheVolumeId, false, clusterIndex, prevBlockIndex), false))
 		{
-			ivOut = itr->second->ivForNextBlock;
+			ivOut = prevBlock->ivForNextBlock;
 		}
 		else
 		{
@@ -956,51 +1151,83 @@ void FSTVolume::DetermineUnhashedBlockIV(uint32 clusterIndex, uint32 blockIndex,
 	}
 }
 
-FSTCachedRawBlock* FSTVolume::GetDecryptedRawBlock(uint32 clusterIndex, uint32 blockIndex)
+uint32 FSTVolume::LimitFetchToUncachedBlocks(bool isHashed, uint32 clusterIndex, uint32 blockIndex, uint32 numBlocksToFetch)
+{
+	// stop at the first block which is already cached
+	for (uint32 i = 1; i < numBlocksToFetch; i++)
+	{
+		if (_FSTBlockCache_Contains(FSTBlockCacheKey(m_cacheVolumeId, isHashed, clusterIndex, blockIndex + i)))
+			return i;
+	}
+	return numBlocksToFetch;
+}
+
+std::shared_ptr<FSTCachedBlock> FSTVolume::GetDecryptedRawBlock(uint32 clusterIndex, uint32 blockIndex, uint32 numBlocksToFetch)
 {
+	if (auto block = _FSTBlockCache_Lookup(FSTBlockCacheKey(m_cacheVolumeId, false, clusterIndex, blockIndex), true))
+		return block;
+	// block not cached, read it together with the following blocks if requested
 	FSTCluster& cluster = m_cluster[clusterIndex];
 	uint64 clusterOffset = (uint64)cluster.offset * m_sectorSize;
-	// generate id for cache
-	uint64 cacheBlockId = ((uint64)clusterIndex << (64 - 16)) | (uint64)blockIndex;
-	// lookup block in cache
-	FSTCachedRawBlock* block = nullptr;
-	auto itr = m_cacheDecryptedRawBlocks.find(cacheBlockId);
-	if (itr != m_cacheDecryptedRawBlocks.end())
-	{
-		block = itr->second;
-		block->lastAccess = ++m_cacheAccessCounter;
-		return block;
+	numBlocksToFetch = LimitFetchToUncachedBlocks(false, clusterIndex, blockIndex, std::clamp<uint32>(numBlocksToFetch, 1, FST_MAX_FETCH_SIZE / m_sectorSize));
+	std::vector<std::shared_ptr<FSTCachedBlock>> decryptedBlocks;
+	std::vector<uint8> encryptedData;
+	// decryption and hashing of raw blocks depends on the previous block, so the whole sequence happens under the data source lock
+	std::unique_lock _l(m_dataSource->m_readMutex);
+	// decrypt straight from the source if it is memory mapped
+	const uint8* encryptedBase = m_dataSource->getDataPtr(clusterIndex, clusterOffset, (uint64)blockIndex * m_sectorSize, (uint64)numBlocksToFetch * m_sectorSize);
+	uint32 numBlocksRead = numBlocksToFetch;
+	if (!encryptedBase)
+	{
+		encryptedData.resize((size_t)numBlocksToFetch * m_sectorSize);
+		uint64 bytesRead = m_dataSource->readData(clusterIndex, clusterOffset, (uint64)blockIndex * m_sectorSize, encryptedData.data(), encryptedData.size());
+		numBlocksRead = (uint32)(bytesRead / m_sectorSize); // fetching past the end of the cluster is not an error as long as the requested block was read
+		encryptedBase = encryptedData.data();
 	}
-	// if cache already full, drop least recently accessed block and recycle FSTCachedRawBlock object if possible
-	TrimCacheIfRequired(&block, nullptr);
-	if (!block)
-		block = new FSTCachedRawBlock();
-	block->blockData.rawData.resize(m_sectorSize);
-	// block not cached, read new
-	block->lastAccess = ++m_cacheAccessCounter;
-	if (m_dataSource->readData(clusterIndex, clusterOffset, blockIndex * m_sectorSize, block->blockData.rawData.data(), m_sectorSize) != m_sectorSize)
+	if (numBlocksRead == 0)
 	{
 		cemuLog_log(LogType::Force, "Failed to read raw FST block");
-		delete block;
 		m_detectedCorruption = true;
 		return nullptr;
 	}
-	// decrypt hash data
 	NCrypto::AesIv iv{};
 	DetermineUnhashedBlockIV(clusterIndex, blockIndex, iv);
-	std::copy(block->blockData.rawData.data() + m_sectorSize - NCrypto::AesIv::SIZE, block->blockData.rawData.data() + m_sectorSize, block->ivForNextBlock.iv);
-	AES128_CBC_decrypt(block->blockData.rawData.data(), block->blockData.rawData.data(), m_sectorSize, m_partitionTitlekey.b, iv.iv);
-	// if this is the next block, then hash it
-	if(cluster.hasContentHash)
+	decryptedBlocks.resize(numBlocksRead);
+	for (uint32 i = 0; i < numBlocksRead; i++)
+	{
+		const uint8* encryptedBlock = encryptedBase + (size_t)(i + 1) * m_sectorSize;
+		auto& block = decryptedBlocks[i];
+		block = std::make_shared<FSTCachedBlock>();
+		block->data.resize(m_sectorSize);
+		std::copy(encryptedBlock - NCrypto::AesIv::SIZE, encryptedBlock, block->ivForNextBlock.iv);
+	}
+	// the IV of each block is the last cipher block of its predecessor, which makes the decryption itself independent per block
+	auto decryptBlock = [&](uint32 i)
+	{
+		uint8* blockIv = i == 0 ? iv.iv : decryptedBlocks[i - 1]->ivForNextBlock.iv;
+		AES128_CBC_decrypt(decryptedBlocks[i]->data.data(), encryptedBase + (size_t)i * m_sectorSize, m_sectorSize, m_partitionTitlekey.b, blockIv);
+	};
+	if (numBlocksRead >= FST_PARALLEL_DECRYPT_MIN_BLOCKS)
+		ThreadPool::ParallelFor(numBlocksRead, decryptBlock);
+	else
+	{
+		for (uint32 i = 0; i < numBlocksRead; i++)
+			decryptBlock(i);
+	}
+	// content hash has to be updated in order
+	for (uint32 i = 0; i < numBlocksRead; i++)
 	{
-		if(cluster.singleHashNumBlocksHashed == blockIndex)
+		uint32 currentBlockIndex = blockIndex + i;
+		auto& block = decryptedBlocks[i];
+		// if this is the next block, then hash it
+		if(cluster.hasContentHash && cluster.singleHashNumBlocksHashed == currentBlockIndex)
 		{
 			cemu_assert_debug(!(cluster.contentSize % m_sectorSize)); // size should be multiple of sector size? Regardless, the hashing code below can handle non-aligned sizes
-			bool isLastBlock = blockIndex == (std::max<uint32>(cluster.contentSize / m_sectorSize, 1) - 1);
+			bool isLastBlock = currentBlockIndex == (std::max<uint32>(cluster.contentSize / m_sectorSize, 1) - 1);
 			uint32 hashSize = m_sectorSize;
 			if(isLastBlock)
-				hashSize = cluster.contentSize - (uint64)blockIndex*m_sectorSize;
-			EVP_DigestUpdate(cluster.singleHashCtx.get(), block->blockData.rawData.data(), hashSize);
+				hashSize = cluster.contentSize - (uint64)currentBlockIndex*m_sectorSize;
+			EVP_DigestUpdate(cluster.singleHashCtx.get(), block->data.data(), hashSize);
 			cluster.singleHashNumBlocksHashed++;
 			if(isLastBlock)
 			{
@@ -1009,65 +1236,106 @@ FSTCachedRawBlock* FSTVolume::GetDecryptedRawBlock(uint32 clusterIndex, uint32 b
 				if(memcmp(hash, cluster.contentHash32, cluster.contentHashIsSHA1 ? 20 : 32) != 0)
 				{
 					cemuLog_log(LogType::Force, "FST: Raw section hash mismatch");
-					delete block;
 					m_detectedCorruption = true;
 					return nullptr;
 				}
 			}
 		}
 	}
+	_l.unlock();
 	// register in cache
-	m_cacheDecryptedRawBlocks.emplace(cacheBlockId, block);
-	return block;
+	for (uint32 i = 0; i < numBlocksRead; i++)
+		_FSTBlockCache_Insert(FSTBlockCacheKey(m_cacheVolumeId, false, clusterIndex, blockIndex + i), decryptedBlocks[i]);
+	s_fstBlockCache.readAheadBlocks += numBlocksRead - 1;
+	return decryptedBlocks[0];
 }
 
-FSTCachedHashedBlock* FSTVolume::GetDecryptedHashedBlock(uint32 clusterIndex, uint32 blockIndex)
+std::shared_ptr<FSTCachedBlock> FSTVolume::GetDecryptedHashedBlock(uint32 clusterIndex, uint32 blockIndex, uint32 numBlocksToFetch)
 {
+	if (auto block = _FSTBlockCache_Lookup(FSTBlockCacheKey(m_cacheVolumeId, true, clusterIndex, blockIndex), true))
+		return block;
+	// block not cached, read it together with the following blocks if requested
 	const FSTCluster& cluster = m_cluster[clusterIndex];
 	uint64 clusterOffset = (uint64)cluster.offset * m_sectorSize;
-	// generate id for cache
-	uint64 cacheBlockId = ((uint64)clusterIndex << (64 - 16)) | (uint64)blockIndex;
-	// lookup block in cache
-	FSTCachedHashedBlock* block = nullptr;
-	auto itr = m_cacheDecryptedHashedBlocks.find(cacheBlockId);
-	if (itr != m_cacheDecryptedHashedBlocks.end())
-	{
-		block = itr->second;
-		block->lastAccess = ++m_cacheAccessCounter;
-		return block;
+	numBlocksToFetch = LimitFetchToUncachedBlocks(true, clusterIndex, blockIndex, std::clamp<uint32>(numBlocksToFetch, 1, FST_MAX_FETCH_SIZE / BLOCK_SIZE));
+	std::vector<std::shared_ptr<FSTCachedBlock>> decryptedBlocks(numBlocksToFetch);
+	for (auto& block : decryptedBlocks)
+	{
+		block = std::make_shared<FSTCachedBlock>();
+		block->data.resize(BLOCK_SIZE);
+	}
+	uint32 numBlocksRead;
+	// if the source is memory mapped the blocks are decrypted straight from it, otherwise they are read first and decrypted in place
+	const uint8* mappedData = m_dataSource->getDataPtr(clusterIndex, clusterOffset, (uint64)blockIndex * BLOCK_SIZE, (uint64)numBlocksToFetch * BLOCK_SIZE);
+	if (mappedData)
+	{
+		numBlocksRead = numBlocksToFetch;
+	}
+	else if (numBlocksToFetch == 1)
+	{
+		std::unique_lock _l(m_dataSource->m_readMutex);
+		numBlocksRead = m_dataSource->readData(clusterIndex, clusterOffset, (uint64)blockIndex * BLOCK_SIZE, decryptedBlocks[0]->data.data(), BLOCK_SIZE) == BLOCK_SIZE ? 1 : 0;
+	}
+	else
+	{
+		std::vector<uint8> encryptedData((size_t)numBlocksToFetch * BLOCK_SIZE);
+		std::unique_lock _l(m_dataSource->m_readMutex);
+		uint64 bytesRead = m_dataSource->readData(clusterIndex, clusterOffset, (uint64)blockIndex * BLOCK_SIZE, encryptedData.data(), encryptedData.size());
+		_l.unlock();
+		numBlocksRead = (uint32)(bytesRead / BLOCK_SIZE); // fetching past the end of the cluster is not an error as long as the requested block was read
+		for (uint32 i = 0; i < numBlocksRead; i++)
+			std::memcpy(decryptedBlocks[i]->data.data(), encryptedData.data() + (size_t)i * BLOCK_SIZE, BLOCK_SIZE);
 	}
-	// if cache already full, drop least recently accessed block and recycle FSTCachedHashedBlock object if possible
-	TrimCacheIfRequired(nullptr, &block);
-	if (!block)
-		block = new FSTCachedHashedBlock();
-	// block not cached, read new
-	block->lastAccess = ++m_cacheAccessCounter;
-	if (m_dataSource->readData(clusterIndex, clusterOffset, blockIndex * BLOCK_SIZE, block->blockData.rawData, BLOCK_SIZE) != BLOCK_SIZE)
+	if (numBlocksRead == 0)
 	{
 		cemuLog_log(LogType::Force, "Failed to read hashed FST block");
-		delete block;
 		m_detectedCorruption = true;
 		return nullptr;
 	}
-	// decrypt hash data
-	uint8 iv[16]{};
-	AES128_CBC_decrypt(block->blockData.getHashData(), block->blockData.getHashData(), BLOCK_HASH_SIZE, m_partitionTitlekey.b, iv);
-	// decrypt file data
-	AES128_CBC_decrypt(block->blockData.getFileData(), block->blockData.getFileData(), BLOCK_FILE_SIZE, m_partitionTitlekey.b, block->blockData.getH0Hash(blockIndex%16));
-	// compare with H0 to verify data integrity
-	NCrypto::CHash160 h0;
-	SHA1(block->blockData.getFileData(), BLOCK_FILE_SIZE, h0.b);
-	uint32 h0Index = (blockIndex % 4096);
-	if (memcmp(h0.b, block->blockData.getH0Hash(h0Index & 0xF), sizeof(h0.b)) != 0)
-	{
-		cemuLog_log(LogType::Force, "FST: Hash H0 mismatch in hashed block (section {} index {})", clusterIndex, blockIndex);
-		delete block;
-		m_detectedCorruption = true;
-		return nullptr;
+	// hashed blocks are independent of each other and can be decrypted outside of the lock
+	std::vector<uint8> isBlockValid(numBlocksRead);
+	auto decryptAndVerifyBlock = [&](uint32 i)
+	{
+		uint32 currentBlockIndex = blockIndex + i;
+		FSTHashedBlock* hashedBlock = decryptedBlocks[i]->GetHashedBlock();
+		const uint8* encryptedBlock = mappedData ? mappedData + (size_t)i * BLOCK_SIZE : hashedBlock->rawData;
+		// decrypt hash data
+		uint8 iv[16]{};
+		AES128_CBC_decrypt(hashedBlock->getHashData(), encryptedBlock, BLOCK_HASH_SIZE, m_partitionTitlekey.b, iv);
+		// decrypt file data
+		AES128_CBC_decrypt(hashedBlock->getFileData(), encryptedBlock + BLOCK_HASH_SIZE, BLOCK_FILE_SIZE, m_partitionTitlekey.b, hashedBlock->getH0Hash(currentBlockIndex%16));
+		// compare with H0 to verify data integrity
+		NCrypto::CHash160 h0;
+		SHA1(hashedBlock->getFileData(), BLOCK_FILE_SIZE, h0.b);
+		uint32 h0Index = (currentBlockIndex % 4096);
+		isBlockValid[i] = memcmp(h0.b, hashedBlock->getH0Hash(h0Index & 0xF), sizeof(h0.b)) == 0;
+	};
+	if (numBlocksRead >= FST_PARALLEL_DECRYPT_MIN_BLOCKS)
+		ThreadPool::ParallelFor(numBlocksRead, decryptAndVerifyBlock);
+	else
+	{
+		for (uint32 i = 0; i < numBlocksRead; i++)
+			decryptAndVerifyBlock(i);
+	}
+	for (uint32 i = 0; i < numBlocksRead; i++)
+	{
+		if (isBlockValid[i])
+			continue;
+		if (i == 0)
+		{
+			cemuLog_log(LogType::Force, "FST: Hash H0 mismatch in hashed block (section {} index {})", clusterIndex, blockIndex);
+			m_detectedCorruption = true;
+			return nullptr;
+		}
+		// don't cache blocks which were only read ahead. If they are actually accessed the error is reported then
+		numBlocksRead = i;
+		break;
 	}
 	// register in cache
-	m_cacheDecryptedHashedBlocks.emplace(cacheBlockId, block);
-	return block;
+	for (uint32 i = 0; i < numBlocksRead; i++)
+		_FSTBlockCache_Insert(FSTBlockCacheKey(m_cacheVolumeId, true, clusterIndex, blockIndex + i), decryptedBlocks[i]);
+	s_fstBlockCache.readAheadBlocks += numBlocksRead - 1;
+	return decryptedBlocks[0];
 }
 
 uint32 FSTVolume::ReadFile_HashModeRaw(uint32 clusterIndex, FSTEntry& entry, uint32 readOffset, uint32 readSize, void* dataOut)
@@ -1077,16 +1345,25 @@ uint32 FSTVolume::ReadFile_HashModeRaw(uint32 clusterIndex, FSTEntry& entry, uin
 		return 0;
 	else if ((readOffset + readSize) >= entry.fileInfo.fileSize)
 		readSize = (entry.fileInfo.fileSize - readOffset);
-	uint64 absFileOffset = entry.fileInfo.fileOffset * m_offsetFactor + readOffset;
+	if (readSize == 0)
+		return 0;
+	uint64 fileStartOffset = entry.fileInfo.fileOffset * m_offsetFactor;
+	uint64 absFileOffset = fileStartOffset + readOffset;
+	// blocks needed by this read and, if the file is read sequentially, the blocks following it
+	uint32 firstBlockIndex = (uint32)(absFileOffset / m_sectorSize);
+	uint32 lastBlockIndex = (uint32)((absFileOffset + readSize - 1) / m_sectorSize);
+	uint32 lastFileBlockIndex = (uint32)((fileStartOffset + entry.fileInfo.fileSize - 1) / m_sectorSize);
+	uint32 fetchEndBlockIndex = lastBlockIndex + GetReadAheadBlockCount(clusterIndex, firstBlockIndex, lastBlockIndex, lastFileBlockIndex, m_sectorSize);
 	uint32 remainingReadSize = readSize;
 	while (remainingReadSize > 0)
 	{
-		const FSTCachedRawBlock* rawBlock = this->GetDecryptedRawBlock(clusterIndex, absFileOffset/m_sectorSize);
+		uint32 blockIndex = (uint32)(absFileOffset / m_sectorSize);
+		auto rawBlock = this->GetDecryptedRawBlock(clusterIndex, blockIndex, fetchEndBlockIndex - blockIndex + 1);
 		if (!rawBlock)
 			break;
 		uint32 blockOffset = (uint32)(absFileOffset % m_sectorSize);
 		uint32 bytesToRead = std::min<uint32>(remainingReadSize, m_sectorSize - blockOffset);
-		std::memcpy(dataOutU8, rawBlock->blockData.rawData.data() + blockOffset, bytesToRead);
+		std::memcpy(dataOutU8, rawBlock->data.data() + blockOffset, bytesToRead);
 		dataOutU8 += bytesToRead;
 		remainingReadSize -= bytesToRead;
 		absFileOffset += bytesToRead;
@@ -1123,18 +1400,24 @@ uint32 FSTVolume::ReadFile_HashModeHashed(uint32 clusterIndex, FSTEntry& entry,
 
 	*/
 
-	const FSTCluster& cluster = m_cluster[clusterIndex];
-	uint64 fileReadOffset = entry.fileInfo.fileOffset * m_offsetFactor + readOffset;
+	if (readSize == 0)
+		return 0;
+	uint64 fileStartOffset = entry.fileInfo.fileOffset * m_offsetFactor;
+	uint64 fileReadOffset = fileStartOffset + readOffset;
 	uint32 blockIndex = (uint32)(fileReadOffset / BLOCK_FILE_SIZE);
 	uint32 bytesRemaining = readSize;
 	uint32 offsetWithinBlock = (uint32)(fileReadOffset % BLOCK_FILE_SIZE);
+	// blocks needed by this read and, if the file is read sequentially, the blocks following it
+	uint32 lastBlockIndex = (uint32)((fileReadOffset + readSize - 1) / BLOCK_FILE_SIZE);
+	uint32 lastFileBlockIndex = (uint32)((fileStartOffset + std::max<uint32>(entry.fileInfo.fileSize, 1) - 1) / BLOCK_FILE_SIZE);
+	uint32 fetchEndBlockIndex = lastBlockIndex + GetReadAheadBlockCount(clusterIndex, blockIndex, lastBlockIndex, std::max(lastFileBlockIndex, lastBlockIndex), BLOCK_SIZE);
 	while (bytesRemaining > 0)
 	{
-		FSTCachedHashedBlock* block = GetDecryptedHashedBlock(clusterIndex, blockIndex);
+		auto block = GetDecryptedHashedBlock(clusterIndex, blockIndex, fetchEndBlockIndex - blockIndex + 1);
 		if (!block)
 			return 0;
 		uint32 bytesToRead = std::min(bytesRemaining, (uint32)BLOCK_FILE_SIZE - offsetWithinBlock);
-		std::memcpy(dataOut, block->blockData.getFileData() + offsetWithinBlock, bytesToRead);
+		std::memcpy(dataOut, block->GetHashedBlock()->getFileData() + offsetWithinBlock, bytesToRead);
 		dataOut = (uint8*)dataOut + bytesToRead;
 		bytesRemaining -= bytesToRead;
 		blockIndex++;
@@ -1176,21 +1459,38 @@ bool FSTVolume::Next(FSTDirectoryIterator& directoryIterator, FSTFileHandle& fil
 
 FSTVolume::~FSTVolume()
 {
-	for (auto& itr : m_cacheDecryptedRawBlocks)
-		delete itr.second;
-	for (auto& itr : m_cacheDecryptedHashedBlocks)
-		delete itr.second;
+	_FSTBlockCache_RemoveVolume(m_cacheVolumeId);
 	if (m_sourceIsOwned)
 		delete m_dataSource;
 }
 
+// decrypt a CBC encrypted buffer in place using multiple threads
+// the buffer is split into slices and the IV of each slice is the last cipher block of the previous slice
+// iv is updated so that consecutive calls continue the CBC chain
+static void _FSTVerifier_DecryptCBCParallel(uint8* data, uint32 size, const uint8* key, uint8* iv)
+{
+	constexpr uint32 SLICE_SIZE = 64 * 1024;
+	cemu_assert_debug((size & 0xF) == 0);
+	uint32 numSlices = (size + SLICE_SIZE - 1) / SLICE_SIZE;
+	std::vector<NCrypto::AesIv> sliceIVs(numSlices);
+	std::memcpy(sliceIVs[0].iv, iv, 16);
+	for (uint32 i = 1; i < numSlices; i++)
+		std::memcpy(sliceIVs[i].iv, data + (size_t)i * SLICE_SIZE - 16, 16);
+	std::memcpy(iv, data + size - 16, 16);
+	ThreadPool::ParallelFor(numSlices, [&](uint32 i)
+	{
+		uint32 sliceSize = std::min<uint32>(SLICE_SIZE, size - i * SLICE_SIZE);
+		AES128_CBC_decrypt(data + (size_t)i * SLICE_SIZE, data + (size_t)i * SLICE_SIZE, sliceSize, key, sliceIVs[i].iv);
+	});
+}
+
 bool FSTVerifier::VerifyContentFile(FileStream* fileContent, const NCrypto::AesKey* key, uint32 contentIndex, uint32 contentSize, uint32 contentSizePadded, bool isSHA1, const uint8* tmdContentHash)
 {
 	cemu_assert_debug(isSHA1); // test this case
 	cemu_assert_debug(((contentSize+0xF)&~0xF) == contentSizePadded);
 
 	std::vector<uint8> buffer;
-	buffer.resize(64 * 1024);
+	buffer.resize(4 * 1024 * 1024);
 	if ((uint32)fileContent->GetSize() != contentSizePadded)
 		return false;
 	fileContent->SetPosition(0);
@@ -1210,8 +1510,12 @@ bool FSTVerifier::VerifyContentFile(FileStream* fileContent, const NCrypto::AesK
 		uint32 bytesToReadPadded = ((bytesToRead + 0xF) & ~0xF);
 		uint32 bytesRead = fileContent->readData(buffer.data(), bytesToReadPadded);
 		if (bytesRead != bytesToReadPadded)
+		{
+			EVP_MD_CTX_free(ctx);
 			return false;
-		AES128_CBC_decrypt_updateIV(buffer.data(), buffer.data(), bytesToReadPadded, key->b, iv);
+		}
+		// decryption is split across threads, the content hash itself is sequential
+		_FSTVerifier_DecryptCBCParallel(buffer.data(), bytesToReadPadded, key->b, iv);
 		EVP_DigestUpdate(ctx, buffer.data(), bytesToRead);
 		remainingBytes -= bytesToRead;
 	}
@@ -1233,40 +1537,53 @@ bool FSTVerifier::VerifyHashedContentFile(FileStream* fileContent, const NCrypto
 
 	std::vector<NCrypto::CHash160> h0List(4096);
 
-	FSTHashedBlock block;
+	// blocks are read in batches. Decryption and H0 verification of each block is independent and runs in parallel
+	constexpr uint32 BLOCKS_PER_BATCH = 64;
+	std::vector<FSTHashedBlock> blocks(BLOCKS_PER_BATCH);
+	std::vector<NCrypto::CHash160> batchH0(BLOCKS_PER_BATCH);
+	std::vector<uint8> isBlockValid(BLOCKS_PER_BATCH);
 	uint32 numBlocks = contentSize / sizeof(FSTHashedBlock);
-	for (uint32 blockIndex = 0; blockIndex < numBlocks; blockIndex++)
+	for (uint32 batchStart = 0; batchStart < numBlocks; batchStart += BLOCKS_PER_BATCH)
 	{
-		if (fileContent->readData(&block, sizeof(FSTHashedBlock)) != sizeof(FSTHashedBlock))
+		uint32 batchSize = std::min<uint32>(BLOCKS_PER_BATCH, numBlocks - batchStart);
+		if (fileContent->readData(blocks.data(), batchSize * sizeof(FSTHashedBlock)) != batchSize * sizeof(FSTHashedBlock))
 			return false;
-		uint32 h0Index = (blockIndex % 4096);
-		// decrypt hash data and file data
-		uint8 iv[16]{};
-		AES128_CBC_decrypt(block.getHashData(), block.getHashData(), BLOCK_HASH_SIZE, key->b, iv);
-		AES128_CBC_decrypt(block.getFileData(), block.getFileData(), BLOCK_FILE_SIZE, key->b, block.getH0Hash(blockIndex % 16));
+		ThreadPool::ParallelFor(batchSize, [&](uint32 i)
+		{
+			uint32 blockIndex = batchStart + i;
+			FSTHashedBlock& block = blocks[i];
+			// decrypt hash data and file data
+			uint8 iv[16]{};
+			AES128_CBC_decrypt(block.getHashData(), block.getHashData(), BLOCK_HASH_SIZE, key->b, iv);
+			AES128_CBC_decrypt(block.getFileData(), block.getFileData(), BLOCK_FILE_SIZE, key->b, block.getH0Hash(blockIndex % 16));
+			// generate H0 hash and compare
+			SHA1(block.getFileData(), BLOCK_FILE_SIZE, batchH0[i].b);
+			isBlockValid[i] = memcmp(batchH0[i].b, block.getH0Hash(blockIndex & 0xF), sizeof(NCrypto::CHash160)) == 0;
+		});
+		for (uint32 i = 0; i < batchSize; i++)
+		{
+			if (!isBlockValid[i])
+				return false;
+			uint32 blockIndex = batchStart + i;
+			uint32 h0Index = (blockIndex % 4096);
+			std::memcpy(h0List[h0Index].b, batchH0[i].b, sizeof(NCrypto::CHash160));
 
-		// generate H0 hash and compare
-		NCrypto::CHash160 h0;
-		SHA1(block.getFileData(), BLOCK_FILE_SIZE, h0.b);
-		if (memcmp(h0.b, block.getH0Hash(h0Index & 0xF), sizeof(h0.b)) != 0)
-			return false;
-		std::memcpy(h0List[h0Index].b, h0.b, sizeof(h0.b));
+			// Sixteen H0 hashes become one H1 hash
+			if (((h0Index + 1) % 16) == 0 && h0Index > 0)
+			{
+				uint32 h1Index = ((h0Index - 15) / 16);
 
-		// Sixteen H0 hashes become one H1 hash
-		if (((h0Index + 1) % 16) == 0 && h0Index > 0)
-		{
-			uint32 h1Index = ((h0Index - 15) / 16);
+				NCrypto::CHash160 h1;
+				SHA1((unsigned char *) (h0List.data() + h1Index * 16), sizeof(NCrypto::CHash160) * 16, h1.b);
+				if (memcmp(h1.b, blocks[i].getH1Hash(h1Index&0xF), sizeof(h1.b)) != 0)
+					return false;
+			}
+			// todo - repeat same for H1 and H2
+			//        At the end all H3 hashes are hashed into a single H4 hash which is then compared with the content hash from the TMD
 
-			NCrypto::CHash160 h1;
-			SHA1((unsigned char *) (h0List.data() + h1Index * 16), sizeof(NCrypto::CHash160) * 16, h1.b);
-			if (memcmp(h1.b, block.getH1Hash(h1Index&0xF), sizeof(h1.b)) != 0)
-				return false;
+			// Checking only H0 and H1 is sufficient enough for verifying if the file data is intact
+			// but if we wanted to be strict and only allow correctly signed data we would have to hash all the way up to H4
 		}
-		// todo - repeat same for H1 and H2
-		//        At the end all H3 hashes are hashed into a single H4 hash which is then compared with the content hash from the TMD
-
-		// Checking only H0 and H1 is sufficient enough for verifying if the file data is intact
-		// but if we wanted to be strict and only allow correctly signed data we would have to hash all the way up to H4
 	}
 	return true;
 }
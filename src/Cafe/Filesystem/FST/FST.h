@@ -24,6 +24,30 @@ private:
 	uint32 currentIndex;
 };
 
+// cache for decrypted FST blocks, shared by all volumes
+// the cache is split into shards with their own lock, hash map and LRU list so lookups and evictions are O(1) and volumes can be read from multiple threads
+class FSTBlockCache
+{
+public:
+	struct Stats
+	{
+		uint64 hits;
+		uint64 misses;
+		uint64 readAheadBlocks; // blocks fetched ahead of time by sequential reads
+		uint64 evictions;
+		uint64 bytesUsed;
+		uint64 capacity;
+	};
+
+	static void SetCapacity(uint64 capacityInBytes);
+	static Stats GetStats();
+	static void ResetStats();
+
+private:
+	friend class FSTVolume;
+	static uint64 AllocateVolumeId();
+};
+
 class FSTVolume
 {
 public:
@@ -46,7 +70,7 @@ public:
 	~FSTVolume();
 
 	uint32 GetFileCount() const;
-	bool HasCorruption() const { return m_detectedCorruption; }
+	bool HasCorruption() const { return m_detectedCorruption.load(); }
 
 	bool OpenFile(std::string_view path, FSTFileHandle& fileHandleOut, bool openOnlyFiles = false);
 
@@ -180,24 +204,26 @@ private:
 	std::vector<FSTEntry> m_entries;
 	std::vector<char> m_nameStringTable;
 	NCrypto::AesKey m_partitionTitlekey;
-	bool m_detectedCorruption{false};
+	std::atomic_bool m_detectedCorruption{false};
 
 	bool HashIsDisabled() const
 	{
 		return m_hashIsDisabled;
 	}
 
-	/* Cache for decrypted raw and hashed blocks */
-	std::unordered_map<uint64, struct FSTCachedRawBlock*> m_cacheDecryptedRawBlocks;
-	std::unordered_map<uint64, struct FSTCachedHashedBlock*> m_cacheDecryptedHashedBlocks;
-	uint64 m_cacheAccessCounter{};
+	/* Decrypted raw and hashed blocks are stored in FSTBlockCache */
+	uint64 m_cacheVolumeId{FSTBlockCache::AllocateVolumeId()}; // unique per volume, part of the cache key
+	// sequential read detection for block read-ahead
+	std::atomic_uint64_t m_lastReadBlock{~0ull}; // cluster index << 32 | block index
+	std::atomic_uint32_t m_sequentialReadCount{0};
 
 	void DetermineUnhashedBlockIV(uint32 clusterIndex, uint32 blockIndex, NCrypto::AesIv& ivOut);
 
-	struct FSTCachedRawBlock* GetDecryptedRawBlock(uint32 clusterIndex, uint32 blockIndex);
-	struct FSTCachedHashedBlock* GetDecryptedHashedBlock(uint32 clusterIndex, uint32 blockIndex);
-
-	void TrimCacheIfRequired(struct FSTCachedRawBlock** droppedRawBlock, struct FSTCachedHashedBlock** droppedHashedBlock);
+	// on a cache miss up to numBlocksToFetch consecutive blocks are read and decrypted in one go
+	std::shared_ptr<struct FSTCachedBlock> GetDecryptedRawBlock(uint32 clusterIndex, uint32 blockIndex, uint32 numBlocksToFetch);
+	std::shared_ptr<struct FSTCachedBlock> GetDecryptedHashedBlock(uint32 clusterIndex, uint32 blockIndex, uint32 numBlocksToFetch);
+	uint32 LimitFetchToUncachedBlocks(bool isHashed, uint32 clusterIndex, uint32 blockIndex, uint32 numBlocksToFetch);
+	uint32 GetReadAheadBlockCount(uint32 clusterIndex, uint32 firstBlockIndex, uint32 lastBlockIndex, uint32 lastFileBlockIndex, uint32 blockSize);
 
 	/* File reading */
 	uint32 ReadFile_HashModeRaw(uint32 clusterIndex, FSTEntry& entry, uint32 readOffset, uint32 readSize, void* dataOut);
@@ -116,6 +116,37 @@ public:
 		auto nodeName = GetNodeName(index);
 		return MatchNodeName(nodeName, name);
 	}
+
+	// hash and compare functors for node names according to FSA case-insensitivity rules
+	// both are transparent so maps keyed by std::string or std::string_view can be queried with any string_view
+	struct NodeNameHash
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view name) const
+		{
+			// FNV-1a over the lower case name
+			uint64 h = 0xcbf29ce484222325;
+			for (char c : name)
+			{
+				if (c >= 'A' && c <= 'Z')
+					c += ('a' - 'A');
+				h ^= (uint8)c;
+				h *= 0x100000001b3;
+			}
+			return (size_t)h;
+		}
+	};
+
+	struct NodeNameEqual
+	{
+		using is_transparent = void;
+
+		bool operator()(std::string_view name1, std::string_view name2) const
+		{
+			return MatchNodeName(name1, name2);
+		}
+	};
 };
 
 template<typename F>
@@ -133,6 +164,7 @@ class FSAFileTree
 	{
 		std::string name;
 		std::vector<node_t*> subnodes;
+		std::unordered_map<std::string_view, node_t*, FSCPath::NodeNameHash, FSCPath::NodeNameEqual> subnodeLookup; // keys reference the name of the subnode
 		size_t fileSize;
 		F* custom;
 		NODETYPE type;
@@ -162,12 +194,10 @@ class FSAFileTree
 
 	node_t* getSubnode(node_t* parentNode, std::string_view name)
 	{
-		for (auto& sn : parentNode->subnodes)
-		{
-			if (FSCPath::MatchNodeName(sn->name, name))
-				return sn;
-		}
-		return nullptr;
+		auto it = parentNode->subnodeLookup.find(name);
+		if (it == parentNode->subnodeLookup.end())
+			return nullptr;
+		return it->second;
 	}
 
 	node_t* newNode(node_t* parentNode, NODETYPE type, std::string_view name)
@@ -177,6 +207,7 @@ class FSAFileTree
 		newNode->type = type;
 		newNode->custom = nullptr;
 		parentNode->subnodes.push_back(newNode);
+		parentNode->subnodeLookup.emplace(newNode->name, newNode);
 		return newNode;
 	}
 
@@ -291,6 +322,7 @@ public:
 			assert(false);
 		}
 		// remove node from parent
+		directoryNode->subnodeLookup.erase(fileNode->name);
 		directoryNode->subnodes.erase(std::remove(directoryNode->subnodes.begin(), directoryNode->subnodes.end(), fileNode), directoryNode->subnodes.end());
 		// delete node
 		delete fileNode;
@@ -4,14 +4,152 @@
 #include "wud.h"
 #include "Common/FileStream.h"
 
+#if !BOOST_OS_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if BOOST_OS_LINUX
+#include <sys/vfs.h>
+#include <sys/sysmacros.h>
+#elif BOOST_OS_MACOS
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+
+#define WUD_READ_AHEAD_SIZE		(4*1024*1024) // once reads are sequential, hint that this many bytes past the current read will be needed
+#define WUD_HINT_ALIGNMENT		(0x10000) // madvise requires page aligned addresses. Covers 4KB and 16KB pages
+
+/*
+ * Reading a mapped file raises SIGBUS or an access violation instead of returning an error when the underlying device fails
+ * Only map files on local, non-removable storage. Images on network shares, optical drives or USB sticks are read through the file stream
+ * where I/O errors turn into short reads and the image is flagged as corrupted
+ */
+static bool wud_isOnFixedLocalStorage(const fs::path& path)
+{
+#if BOOST_OS_WINDOWS
+	wchar_t volumePath[MAX_PATH];
+	if (!GetVolumePathNameW(path.c_str(), volumePath, MAX_PATH))
+		return false;
+	return GetDriveTypeW(volumePath) == DRIVE_FIXED;
+#elif BOOST_OS_LINUX
+	struct statfs fsStat;
+	if (statfs(path.c_str(), &fsStat) != 0)
+		return false;
+	// local disk file systems only, network and FUSE file systems as well as optical media are excluded
+	switch ((unsigned long)fsStat.f_type)
+	{
+	case 0xEF53: // ext2/3/4
+	case 0x58465342: // xfs
+	case 0x9123683E: // btrfs
+	case 0xF2F52010: // f2fs
+	case 0x2FC12FC1: // zfs
+	case 0xCA451A4E: // bcachefs
+	case 0x7366746E: // ntfs3
+	case 0x2011BAB0: // exfat
+	case 0x4D44: // vfat
+		break;
+	default:
+		return false;
+	}
+	// exclude removable block devices, the removable flag is stored on the disk and not on its partitions
+	struct stat fileStat;
+	if (stat(path.c_str(), &fileStat) != 0)
+		return false;
+	std::error_code ec;
+	fs::path sysBlockPath = fs::canonical(fmt::format("/sys/dev/block/{}:{}", major(fileStat.st_dev), minor(fileStat.st_dev)), ec);
+	if (ec)
+		return true; // no block device, e.g. btrfs subvolumes report an anonymous device
+	if (fs::exists(sysBlockPath / "partition", ec))
+		sysBlockPath = sysBlockPath.parent_path();
+	FileStream* removableFile = FileStream::openFile2(sysBlockPath / "removable");
+	if (!removableFile)
+		return true;
+	std::string removable;
+	removableFile->readLine(removable);
+	delete removableFile;
+	return removable != "1";
+#elif BOOST_OS_MACOS
+	struct statfs fsStat;
+	if (statfs(path.c_str(), &fsStat) != 0)
+		return false;
+	return (fsStat.f_flags & MNT_LOCAL) != 0 && (fsStat.f_flags & MNT_REMOVABLE) == 0;
+#else
+	return false;
+#endif
+}
+
+// requiredSize is the file size needed to hold all the image data. Truncated images are not mapped so that reads past the end are reported as short reads
+static void wud_mapFile(wud_t* wud, const fs::path& path, long long requiredSize)
+{
+	// the mapping is optional, if it fails all reads go through the file stream
+	if (!wud_isOnFixedLocalStorage(path))
+		return;
+#if BOOST_OS_WINDOWS
+	HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 || fileSize.QuadPart < requiredSize)
+	{
+		CloseHandle(hFile);
+		return;
+	}
+	HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (!hMapping)
+		return;
+	void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(hMapping);
+		return;
+	}
+	wud->mappingHandle = hMapping;
+	wud->mappedData = (const unsigned char*)view;
+	wud->mappedSize = (long long)fileSize.QuadPart;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0 || fileStat.st_size < requiredSize)
+	{
+		close(fd);
+		return;
+	}
+	void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+		return;
+	wud->mappedData = (const unsigned char*)view;
+	wud->mappedSize = (long long)fileStat.st_size;
+#endif
+}
+
+static void wud_unmapFile(wud_t* wud)
+{
+	if (!wud->mappedData)
+		return;
+#if BOOST_OS_WINDOWS
+	UnmapViewOfFile(wud->mappedData);
+	CloseHandle((HANDLE)wud->mappingHandle);
+	wud->mappingHandle = nullptr;
+#else
+	munmap((void*)wud->mappedData, (size_t)wud->mappedSize);
+#endif
+	wud->mappedData = nullptr;
+	wud->mappedSize = 0;
+}
+
 wud_t* wud_open(const fs::path& path)
 {
 	FileStream* fs = FileStream::openFile2(path);
 	if( !fs )
 		return nullptr;
 	// allocate wud struct
-	wud_t* wud = (wud_t*)malloc(sizeof(wud_t));
-	memset(wud, 0x00, sizeof(wud_t));
+	wud_t* wud = new wud_t();
 	wud->fs = fs;
 	// get size of file
 	long long inputFileSize = wud->fs->GetSize();
@@ -58,15 +196,26 @@ wud_t* wud_open(const fs::path& path)
 		// uncompressed file
 		wud->uncompressedSize = inputFileSize;
 	}
+	// the end of the highest referenced sector for WUX, the whole image otherwise
+	long long requiredFileSize = wud->uncompressedSize;
+	if( wud->isCompressed )
+	{
+		unsigned int maxSectorIndex = 0;
+		for (unsigned int i = 0; i < wud->indexTableEntryCount; i++)
+			maxSectorIndex = std::max(maxSectorIndex, wud->indexTable[i]);
+		requiredFileSize = wud->offsetSectorArray + ((long long)maxSectorIndex + 1) * (long long)wud->sectorSize;
+	}
+	wud_mapFile(wud, path, requiredFileSize);
 	return wud;
 }
 
 void wud_close(wud_t* wud)
 {
+	wud_unmapFile(wud);
 	delete wud->fs;
 	if( wud->indexTable )
 		free(wud->indexTable);
-	free(wud);
+	delete wud;
 }
 
 bool wud_isWUXCompressed(wud_t* wud)
@@ -74,6 +223,83 @@ bool wud_isWUXCompressed(wud_t* wud)
 	return wud->isCompressed;
 }
 
+/*
+ * Translate an offset in the uncompressed image to an offset in the file
+ * For WUX files the range is resolved through the index table and contiguousLength is limited to the sectors which are stored consecutively
+ */
+static long long wud_resolveFileOffset(wud_t* wud, long long offset, unsigned int length, unsigned int* contiguousLength)
+{
+	if( wud->isCompressed == false )
+	{
+		*contiguousLength = length;
+		return offset;
+	}
+	unsigned int sectorOffset = (unsigned int)(offset % (long long)wud->sectorSize);
+	unsigned int firstSectorIndex = (unsigned int)(offset / (long long)wud->sectorSize);
+	unsigned int firstRealSectorIndex = wud->indexTable[firstSectorIndex];
+	unsigned int runLength = std::min(wud->sectorSize - sectorOffset, length);
+	unsigned int sectorIndex = firstSectorIndex + 1;
+	while( runLength < length )
+	{
+		// deduplicated sectors break up the run
+		if( wud->indexTable[sectorIndex] != firstRealSectorIndex + (sectorIndex - firstSectorIndex) )
+			break;
+		runLength += std::min(wud->sectorSize, length - runLength);
+		sectorIndex++;
+	}
+	*contiguousLength = runLength;
+	return wud->offsetSectorArray + (long long)firstRealSectorIndex * (long long)wud->sectorSize + (long long)sectorOffset;
+}
+
+/*
+ * Sequential reads through the mapping only fault in pages once they are touched
+ * Let the OS know early which part of the file is needed next
+ */
+static void wud_updateReadAhead(wud_t* wud, long long offset, unsigned int length)
+{
+	long long readEnd = offset + (long long)length;
+	bool isSequential = wud->lastReadEnd.exchange(readEnd, std::memory_order_relaxed) == offset;
+	if( !isSequential )
+		return;
+	// refresh the hint once half of the previous read-ahead range was consumed
+	if( readEnd + WUD_READ_AHEAD_SIZE / 2 < wud->readAheadEnd.load(std::memory_order_relaxed) )
+		return;
+	long long aheadLength = std::min<long long>(WUD_READ_AHEAD_SIZE, wud->uncompressedSize - readEnd);
+	if( aheadLength <= 0 )
+		return;
+	unsigned int contiguousLength;
+	long long fileOffset = wud_resolveFileOffset(wud, readEnd, (unsigned int)aheadLength, &contiguousLength);
+	wud->readAheadEnd.store(readEnd + contiguousLength, std::memory_order_relaxed);
+	if( fileOffset >= wud->mappedSize )
+		return;
+	long long fileEnd = std::min<long long>(fileOffset + contiguousLength, wud->mappedSize);
+#if BOOST_OS_WINDOWS
+	// not hinted on Windows, the memory manager already reads ahead for sequential page faults on mapped files
+#else
+	long long alignedOffset = fileOffset & ~(long long)(WUD_HINT_ALIGNMENT - 1);
+	madvise((void*)(wud->mappedData + alignedOffset), (size_t)(fileEnd - alignedOffset), MADV_WILLNEED);
+#endif
+}
+
+/*
+ * Get a pointer to the mapped data for the given range of the uncompressed image
+ * Returns nullptr if the file is not mapped or the range is not stored contiguously (deduplicated WUX sectors)
+ * The pointer stays valid until wud_close() is called
+ */
+const unsigned char* wud_getDataPtr(wud_t* wud, long long offset, unsigned int length)
+{
+	if( !wud->mappedData || offset < 0 || offset + (long long)length > wud->uncompressedSize )
+		return nullptr;
+	if( length == 0 )
+		return nullptr;
+	unsigned int contiguousLength;
+	long long fileOffset = wud_resolveFileOffset(wud, offset, length, &contiguousLength);
+	if( contiguousLength != length || fileOffset + (long long)length > wud->mappedSize )
+		return nullptr;
+	wud_updateReadAhead(wud, offset, length);
+	return wud->mappedData + fileOffset;
+}
+
 /*
  * Read data from WUD file
  * Can read up to 4GB at once
@@ -88,7 +314,25 @@ unsigned int wud_readData(wud_t* wud, void* buffer, unsigned int length, long lo
 		length = (unsigned int)fileBytesLeft;
 	// read data
 	unsigned int readBytes = 0;
-	if( wud->isCompressed == false )
+	if( wud->mappedData )
+	{
+		// copy from the mapping, consecutively stored sectors are copied in one go
+		// unlike the file stream path this does not modify any state and can be used from multiple threads
+		wud_updateReadAhead(wud, offset, length);
+		while( length > 0 )
+		{
+			unsigned int bytesToRead;
+			long long fileOffset = wud_resolveFileOffset(wud, offset, length, &bytesToRead);
+			if( fileOffset + (long long)bytesToRead > wud->mappedSize )
+				break; // truncated image
+			memcpy(buffer, wud->mappedData + fileOffset, bytesToRead);
+			readBytes += bytesToRead;
+			buffer = (void*)((char*)buffer + bytesToRead);
+			length -= bytesToRead;
+			offset += bytesToRead;
+		}
+	}
+	else if( wud->isCompressed == false )
 	{
 		// uncompressed read is straight forward
 		wud->fs->SetPosition(offset);
@@ -20,6 +20,13 @@ struct wud_t
 	unsigned int*	indexTable;
 	long long		offsetIndexTable;
 	long long		offsetSectorArray;
+	// memory mapped image. Null if the file could not be mapped, in which case reads go through the file stream
+	const unsigned char* mappedData;
+	long long		mappedSize;
+	void*			mappingHandle;
+	// sequential read detection for read-ahead hints
+	std::atomic<long long> lastReadEnd;
+	std::atomic<long long> readAheadEnd;
 };
 
 #define WUX_MAGIC_0	'0XUW' // "WUX0"
@@ -31,4 +38,5 @@ void wud_close(wud_t* wud);
 
 bool wud_isWUXCompressed(wud_t* wud);
 unsigned int wud_readData(wud_t* wud, void* buffer, unsigned int length, long long offset);
+const unsigned char* wud_getDataPtr(wud_t* wud, long long offset, unsigned int length); // zero-copy access to mapped data, returns nullptr if the range is not contiguous in memory
 long long wud_getWUDSize(wud_t* wud);
\ No newline at end of file
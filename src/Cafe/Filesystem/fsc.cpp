@@ -1,11 +1,14 @@
 #include "Cafe/Filesystem/fsc.h"
 #include "Cafe/Filesystem/FST/fstUtil.h"
+#include <bit>
 
 struct FSCMountPathNode
 {
 	std::string path;
 	std::vector<FSCMountPathNode*> subnodes;
+	std::unordered_map<std::string_view, FSCMountPathNode*, FSCPath::NodeNameHash, FSCPath::NodeNameEqual> subnodeLookup; // keys reference the path of the subnode
 	FSCMountPathNode* parent;
+	uint16 depth{}; // number of path nodes between the root and this node
 	// associated device target and path
 	fscDeviceC* device{ nullptr };
 	void* ctx{ nullptr };
@@ -15,6 +18,8 @@ struct FSCMountPathNode
 
 	FSCMountPathNode(FSCMountPathNode* parent) : parent(parent)
 	{
+		if (parent)
+			depth = parent->depth + 1;
 	}
 
     void AssignDevice(fscDeviceC* device, void* ctx, std::string_view deviceBasePath)
@@ -36,6 +41,30 @@ struct FSCMountPathNode
         return !parent;
     }
 
+	FSCMountPathNode* FindSubnode(std::string_view name) const
+	{
+		auto it = subnodeLookup.find(name);
+		if (it == subnodeLookup.end())
+			return nullptr;
+		return it->second;
+	}
+
+	FSCMountPathNode* AddSubnode(std::string_view name)
+	{
+		FSCMountPathNode* nodeSub = new FSCMountPathNode(this);
+		nodeSub->path = name;
+		nodeSub->priority = priority;
+		subnodes.emplace_back(nodeSub);
+		subnodeLookup.emplace(nodeSub->path, nodeSub);
+		return nodeSub;
+	}
+
+	void RemoveSubnode(FSCMountPathNode* nodeSub)
+	{
+		subnodeLookup.erase(nodeSub->path);
+		std::erase(subnodes, nodeSub);
+	}
+
 	~FSCMountPathNode()
 	{
 		for (auto& itr : subnodes)
@@ -71,10 +100,54 @@ std::recursive_mutex s_fscMutex;
 #define fscEnter() s_fscMutex.lock();
 #define fscLeave() s_fscMutex.unlock();
 
+// result of resolving a virtual path against the mount tree of every priority
+struct FSCPathLookupResult
+{
+	FSCMountPathNode* deviceNode[FSC_PRIORITY_COUNT]; // closest node along the path which has a device assigned
+	FSCMountPathNode* virtualNode[FSC_PRIORITY_COUNT]; // node matching the full path, if any
+};
+
+// games tend to open the same few thousand paths over and over, so resolved paths are remembered until the mount tree changes
+// the key is the normalized path (lower case, single slashes, no '.' nodes). Protected by s_fscMutex
+static struct
+{
+	std::unordered_map<std::string, FSCPathLookupResult> entries;
+	std::string keyBuffer;
+	bool isEnabled{ true };
+	bool useLinearWalk{ false }; // for benchmarking only, compare child nodes one by one like the mount tree walk did before child nodes were hashed
+}s_fscLookupCache;
+
+constexpr size_t FSC_LOOKUP_CACHE_MAX_ENTRIES = 16 * 1024;
+
+static void fsc_invalidateLookupCache()
+{
+	s_fscLookupCache.entries.clear();
+}
+
+// locks the global fsc mutex or, for files which don't share state with other files, only the per-file mutex
+// this allows data transfers on independent files to run in parallel
+class FSCFileAccessLock
+{
+public:
+	FSCFileAccessLock(FSCVirtualFile* fscFile) : m_mutex(fscFile->fscIsThreadSafe() ? fscFile->m_accessMutex : s_fscMutex)
+	{
+		m_mutex.lock();
+	}
+
+	~FSCFileAccessLock()
+	{
+		m_mutex.unlock();
+	}
+
+private:
+	std::recursive_mutex& m_mutex;
+};
+
 FSCMountPathNode* fsc_lookupPathVirtualNode(const char* path, sint32 priority = FSC_PRIORITY_BASE);
 
 void fsc_reset()
 {
+	fsc_invalidateLookupCache();
 	// delete existing nodes
 	for (auto& itr : s_fscRootNodePerPrio)
 	{
@@ -83,7 +156,10 @@ void fsc_reset()
 	}
 	// init root node for each priority
 	for (sint32 i = 0; i < FSC_PRIORITY_COUNT; i++)
+	{
 		s_fscRootNodePerPrio[i] = new FSCMountPathNode(nullptr);
+		s_fscRootNodePerPrio[i]->priority = i;
+	}
 }
 
 /*
@@ -102,16 +178,7 @@ FSCMountPathNode* fsc_createMountPath(const FSCPath& mountPath, sint32 priority)
 	for (size_t i=0; i< mountPath.GetNodeCount(); i++)
 	{
 		// search for subdirectory
-		FSCMountPathNode* nodeSub = nullptr; // set if we found a subnode with a matching name, else this is used to store the new nodes
-		for (auto& nodeItr : nodeParent->subnodes)
-		{
-			if (mountPath.MatchNodeName(i, nodeItr->path))
-			{
-				// subnode found
-				nodeSub = nodeItr;
-				break;
-			}
-		}
+		FSCMountPathNode* nodeSub = nodeParent->FindSubnode(mountPath.GetNodeName(i));
 		if (nodeSub)
 		{
 			// traverse subnode
@@ -119,10 +186,7 @@ FSCMountPathNode* fsc_createMountPath(const FSCPath& mountPath, sint32 priority)
 			continue;
 		}
 		// no matching subnode, add new entry
-		nodeSub = new FSCMountPathNode(nodeParent);
-		nodeSub->path = mountPath.GetNodeName(i);
-		nodeSub->priority = priority;
-		nodeParent->subnodes.emplace_back(nodeSub);
+		nodeSub = nodeParent->AddSubnode(mountPath.GetNodeName(i));
 		if (i == (mountPath.GetNodeCount() - 1))
 		{
 			// last node
@@ -161,6 +225,7 @@ sint32 fsc_mount(std::string_view mountPath, std::string_view targetPath, fscDev
 		return FSC_STATUS_INVALID_PATH;
 	}
     node->AssignDevice(fscDevice, ctx, targetPathWithSlash);
+	fsc_invalidateLookupCache();
 	fscLeave();
 	return FSC_STATUS_OK;
 }
@@ -177,13 +242,14 @@ bool fsc_unmount(std::string_view mountPath, sint32 priority)
 	}
 	cemu_assert(mountPathNode->priority == priority);
 	cemu_assert(mountPathNode->device);
+	fsc_invalidateLookupCache();
     // unassign device
     mountPathNode->UnassignDevice();
 	// prune empty branch
 	while (mountPathNode && !mountPathNode->IsRootNode() && mountPathNode->subnodes.empty() && !mountPathNode->device)
 	{
 		FSCMountPathNode* parent = mountPathNode->parent;
-        std::erase(parent->subnodes, mountPathNode);
+		parent->RemoveSubnode(mountPathNode);
 		delete mountPathNode;
 		mountPathNode = parent;
 	}
@@ -198,87 +264,106 @@ void fsc_unmountAll()
 	fscLeave();
 }
 
-// lookup virtual path and find mounted device and relative device directory
-bool fsc_lookupPath(const char* path, std::string& devicePathOut, fscDeviceC** fscDeviceOut, void** ctxOut, sint32 priority = FSC_PRIORITY_BASE)
+// walk the mount tree of a single priority
+static void fsc_walkMountTree(const FSCPath& parsedPath, sint32 priority, FSCMountPathNode*& deviceNodeOut, FSCMountPathNode*& virtualNodeOut)
 {
-	FSCPath parsedPath(path);
-	FSCMountPathNode* nodeParent = s_fscRootNodePerPrio[priority];
-	size_t i;
-	fscEnter();
-	for (i = 0; i < parsedPath.GetNodeCount(); i++)
+	FSCMountPathNode* nodeCurrent = s_fscRootNodePerPrio[priority];
+	deviceNodeOut = nodeCurrent->device ? nodeCurrent : nullptr;
+	virtualNodeOut = nullptr;
+	for (size_t i = 0; i < parsedPath.GetNodeCount(); i++)
 	{
-		// search for subdirectory
-		FSCMountPathNode* nodeSub = nullptr;
-		for(auto& nodeItr : nodeParent->subnodes)
-		{			
-			if (parsedPath.MatchNodeName(i, nodeItr->path))
-			{
-				nodeSub = nodeItr;
-				break;
-			}
-		}
-		if (nodeSub)
+		if (s_fscLookupCache.useLinearWalk)
 		{
-			nodeParent = nodeSub;
-			continue;
+			auto it = std::find_if(nodeCurrent->subnodes.begin(), nodeCurrent->subnodes.end(), [&](FSCMountPathNode* nodeSub) { return parsedPath.MatchNodeName(i, nodeSub->path); });
+			nodeCurrent = it != nodeCurrent->subnodes.end() ? *it : nullptr;
 		}
-		// no matching subnode
-		break;
+		else
+			nodeCurrent = nodeCurrent->FindSubnode(parsedPath.GetNodeName(i));
+		if (!nodeCurrent)
+			return;
+		if (nodeCurrent->device)
+			deviceNodeOut = nodeCurrent;
+	}
+	virtualNodeOut = nodeCurrent;
+}
+
+// resolve path for all priorities, uses the lookup cache if possible
+// caller has to hold s_fscMutex
+static FSCPathLookupResult fsc_resolvePath(const FSCPath& parsedPath)
+{
+	FSCPathLookupResult result;
+	if (!s_fscLookupCache.isEnabled)
+	{
+		for (sint32 prio = 0; prio < FSC_PRIORITY_COUNT; prio++)
+			fsc_walkMountTree(parsedPath, prio, result.deviceNode[prio], result.virtualNode[prio]);
+		return result;
 	}
-	// if the found node is not a device mount point, then travel back towards the root until we find one
-	while (nodeParent)
+	// build normalized key
+	std::string& key = s_fscLookupCache.keyBuffer;
+	key.clear();
+	for (size_t i = 0; i < parsedPath.GetNodeCount(); i++)
 	{
-		if (nodeParent->device)
+		key.push_back('/');
+		for (char c : parsedPath.GetNodeName(i))
 		{
-			devicePathOut = nodeParent->deviceTargetPath;
-			for (size_t f = i; f < parsedPath.GetNodeCount(); f++)
-			{
-				auto nodeName = parsedPath.GetNodeName(f);
-				devicePathOut.append(nodeName);
-				if (f < (parsedPath.GetNodeCount() - 1))
-					devicePathOut.push_back('/');
-			}
-			*fscDeviceOut = nodeParent->device;
-			*ctxOut = nodeParent->ctx;
-			fscLeave();
-			return true;
+			if (c >= 'A' && c <= 'Z')
+				c += ('a' - 'A');
+			key.push_back(c);
 		}
-		nodeParent = nodeParent->parent;
-		i--;
 	}
+	auto it = s_fscLookupCache.entries.find(key);
+	if (it != s_fscLookupCache.entries.end())
+		return it->second;
+	for (sint32 prio = 0; prio < FSC_PRIORITY_COUNT; prio++)
+		fsc_walkMountTree(parsedPath, prio, result.deviceNode[prio], result.virtualNode[prio]);
+	if (s_fscLookupCache.entries.size() >= FSC_LOOKUP_CACHE_MAX_ENTRIES)
+		s_fscLookupCache.entries.clear();
+	s_fscLookupCache.entries.emplace(key, result);
+	return result;
+}
+
+// translate a resolved path into the device path for the given priority
+static bool fsc_getDevicePath(const FSCPath& parsedPath, const FSCPathLookupResult& lookupResult, sint32 priority, std::string& devicePathOut, fscDeviceC** fscDeviceOut, void** ctxOut)
+{
+	FSCMountPathNode* deviceNode = lookupResult.deviceNode[priority];
+	if (!deviceNode)
+		return false;
+	devicePathOut = deviceNode->deviceTargetPath;
+	for (size_t f = deviceNode->depth; f < parsedPath.GetNodeCount(); f++)
+	{
+		auto nodeName = parsedPath.GetNodeName(f);
+		devicePathOut.append(nodeName);
+		if (f < (parsedPath.GetNodeCount() - 1))
+			devicePathOut.push_back('/');
+	}
+	*fscDeviceOut = deviceNode->device;
+	*ctxOut = deviceNode->ctx;
+	return true;
+}
+
+// lookup virtual path and find mounted device and relative device directory
+bool fsc_lookupPath(const char* path, std::string& devicePathOut, fscDeviceC** fscDeviceOut, void** ctxOut, sint32 priority = FSC_PRIORITY_BASE)
+{
+	FSCPath parsedPath(path);
+	fscEnter();
+	FSCPathLookupResult lookupResult;
+	if (s_fscLookupCache.isEnabled)
+		lookupResult = fsc_resolvePath(parsedPath);
+	else
+		fsc_walkMountTree(parsedPath, priority, lookupResult.deviceNode[priority], lookupResult.virtualNode[priority]);
+	bool r = fsc_getDevicePath(parsedPath, lookupResult, priority, devicePathOut, fscDeviceOut, ctxOut);
 	fscLeave();
-	return false;
+	return r;
 }
 
 // lookup path and find virtual device node
 FSCMountPathNode* fsc_lookupPathVirtualNode(const char* path, sint32 priority)
 {
 	FSCPath parsedPath(path);
-	FSCMountPathNode* nodeCurrentDir = s_fscRootNodePerPrio[priority];
 	fscEnter();
-	for (size_t i = 0; i < parsedPath.GetNodeCount(); i++)
-	{
-		// search for subdirectory
-		FSCMountPathNode* nodeSub = nullptr;
-		for (auto& nodeItr : nodeCurrentDir->subnodes)
-		{
-			if (parsedPath.MatchNodeName(i, nodeItr->path))
-			{
-				nodeSub = nodeItr;
-				break;
-			}
-		}
-		if (nodeSub)
-		{
-			// traverse subdirectory
-			nodeCurrentDir = nodeSub;
-			continue;
-		}
-		fscLeave();
-		return nullptr;
-	}
+	FSCPathLookupResult lookupResult = fsc_resolvePath(parsedPath);
 	fscLeave();
-	return nodeCurrentDir;
+	return lookupResult.virtualNode[priority];
 }
 
 // this wraps multiple iterated directories from different devices into one unified virtual representation
@@ -384,10 +469,12 @@ FSCVirtualFile* fsc_open(const char* path, FSC_ACCESS_FLAG accessFlags, sint32*
 	fscDeviceC* fscDevice = NULL;
 	*fscStatus = FSC_STATUS_UNDEFINED;
 	void* ctx;
+	FSCPath parsedPath(path);
 	fscEnter();
+	FSCPathLookupResult lookupResult = fsc_resolvePath(parsedPath);
 	for (sint32 prio = maxPriority; prio >= 0; prio--)
 	{
-		if (fsc_lookupPath(path, devicePath, &fscDevice, &ctx, prio))
+		if (fsc_getDevicePath(parsedPath, lookupResult, prio, devicePath, &fscDevice, &ctx))
 		{
 			FSCVirtualFile* fscVirtualFile = fscDevice->fscDeviceOpenByPath(devicePath, accessFlags, ctx, fscStatus);
 			if (fscVirtualFile)
@@ -419,7 +506,7 @@ FSCVirtualFile* fsc_open(const char* path, FSC_ACCESS_FLAG accessFlags, sint32*
 		{
 			if (folderExists)
 				break;
-			folderExists |= (fsc_lookupPathVirtualNode(path, prio) != 0);
+			folderExists |= (lookupResult.virtualNode[prio] != nullptr);
 		}
 		if (folderExists)
 		{
@@ -525,6 +612,11 @@ bool fsc_remove(const char* path, sint32* fscStatus)
  */
 void fsc_close(FSCVirtualFile* fscFile)
 {
+	// wait for transfers on this file which only hold the per-file lock to finish
+	// the mutex is owned by the file itself, so it is released again before the file is deleted
+	{
+		FSCFileAccessLock _l(fscFile);
+	}
 	fscEnter();
 	delete fscFile;
 	fscLeave();
@@ -552,18 +644,17 @@ uint32 fsc_getFileSeek(FSCVirtualFile* fscFile)
  */
 void fsc_setFileSeek(FSCVirtualFile* fscFile, uint32 newSeek)
 {
-	fscEnter();
+	FSCFileAccessLock _l(fscFile);
 	uint32 fileSize = fsc_getFileSize(fscFile);
 	if (fsc_isWritable(fscFile) == false)
 		newSeek = std::min(newSeek, fileSize);
 	fscFile->fscSetSeek((uint64)newSeek);
-	fscLeave();
 }
 
 // set file length
 void fsc_setFileLength(FSCVirtualFile* fscFile, uint32 newEndOffset)
 {
-	fscEnter();
+	FSCFileAccessLock _l(fscFile);
 	uint32 fileSize = fsc_getFileSize(fscFile);
 	if (!fsc_isWritable(fscFile))
 	{
@@ -573,7 +664,6 @@ void fsc_setFileLength(FSCVirtualFile* fscFile, uint32 newEndOffset)
 	{
 		fscFile->fscSetFileLength((uint64)newEndOffset);
 	}
-	fscLeave();
 }
 
 /*
@@ -606,10 +696,8 @@ bool fsc_isWritable(FSCVirtualFile* fscFile)
  */
 uint32 fsc_readFile(FSCVirtualFile* fscFile, void* buffer, uint32 size)
 {
-	fscEnter();
-	uint32 fscStatus = fscFile->fscReadData(buffer, size);
-	fscLeave();
-	return fscStatus;
+	FSCFileAccessLock _l(fscFile);
+	return fscFile->fscReadData(buffer, size);
 }
 
 /*
@@ -618,18 +706,18 @@ uint32 fsc_readFile(FSCVirtualFile* fscFile, void* buffer, uint32 size)
  */
 uint32 fsc_writeFile(FSCVirtualFile* fscFile, void* buffer, uint32 size)
 {
-	fscEnter();
+	FSCFileAccessLock _l(fscFile);
 	if (fsc_isWritable(fscFile) == false)
-	{
-		fscLeave();
 		return 0;
-	}
 	if (fscFile->m_isAppend)
 		fsc_setFileSeek(fscFile, fsc_getFileSize(fscFile));
+	return fscFile->fscWriteData(buffer, size);
+}
 
-	uint32 fscStatus = fscFile->fscWriteData(buffer, size);
-	fscLeave();
-	return fscStatus;
+bool fsc_flushFile(FSCVirtualFile* fscFile)
+{
+	FSCFileAccessLock _l(fscFile);
+	return fscFile->fscFlush();
 }
 
 // helper function to load a file into memory
@@ -733,3 +821,93 @@ void fsc_init()
 {
 	fsc_reset();
 }
+
+// device used by the lookup benchmark, all files are reported as missing so every priority is visited
+class fscDeviceTypeLookupBenchmark : public fscDeviceC
+{
+	FSCVirtualFile* fscDeviceOpenByPath(std::string_view path, FSC_ACCESS_FLAG accessFlags, void* ctx, sint32* fscStatus) override
+	{
+		*fscStatus = FSC_STATUS_FILE_NOT_FOUND;
+		return nullptr;
+	}
+};
+
+// resolve paths against a synthetic mount tree resembling a title with update, DLC, save and graphic pack redirection mounts
+bool fsc_RunLookupBenchmark(uint32 numLookups)
+{
+	using clock = std::chrono::steady_clock;
+	fscDeviceTypeLookupBenchmark benchmarkDevice;
+	fscEnter();
+	fsc_reset();
+	fsc_mount("/vol/content", "/base/content", &benchmarkDevice, nullptr, FSC_PRIORITY_BASE);
+	fsc_mount("/vol/code", "/base/code", &benchmarkDevice, nullptr, FSC_PRIORITY_BASE);
+	fsc_mount("/vol/meta", "/base/meta", &benchmarkDevice, nullptr, FSC_PRIORITY_BASE);
+	fsc_mount("/vol/save", "/save", &benchmarkDevice, nullptr, FSC_PRIORITY_BASE);
+	fsc_mount("/vol/storage_mlc01", "/mlc", &benchmarkDevice, nullptr, FSC_PRIORITY_BASE);
+	for (uint32 i = 0; i < 16; i++)
+		fsc_mount(fmt::format("/vol/aoc0005000c1010{:04x}", i), fmt::format("/aoc{}", i), &benchmarkDevice, nullptr, FSC_PRIORITY_AOC);
+	fsc_mount("/vol/content", "/patch/content", &benchmarkDevice, nullptr, FSC_PRIORITY_PATCH);
+	fsc_mount("/vol/code", "/patch/code", &benchmarkDevice, nullptr, FSC_PRIORITY_PATCH);
+	fsc_mount("/vol/meta", "/patch/meta", &benchmarkDevice, nullptr, FSC_PRIORITY_PATCH);
+	for (uint32 i = 0; i < 64; i++)
+		fsc_mount(fmt::format("/vol/content/Data{}/Overrides", i), fmt::format("/hostfs/overrides{}", i), &benchmarkDevice, nullptr, FSC_PRIORITY_PATCH);
+	fsc_mount("/", "/", &benchmarkDevice, nullptr, FSC_PRIORITY_REDIRECT);
+	// generate the working set of paths with mixed case, titles rarely agree with themselves on the case of a path
+	std::vector<std::string> paths;
+	for (uint32 i = 0; i < 4096; i++)
+	{
+		const char* volume = (i % 8) == 0 ? "/vol/code" : ((i % 8) == 1 ? "/vol/aoc0005000c1010000a" : "/VOL/Content");
+		paths.emplace_back(fmt::format("{}/data{}/{}/file{:04}.bfres", volume, i % 64, (i & 1) ? "Overrides" : "models", i));
+	}
+	// the device reports every file as missing, so each open resolves the path and then visits all priorities
+	sint32 fscStatus;
+	auto runOpen = [&]()
+	{
+		auto t0 = clock::now();
+		for (uint32 i = 0; i < numLookups; i++)
+			fsc_open(paths[i % paths.size()].c_str(), FSC_ACCESS_FLAG::OPEN_FILE | FSC_ACCESS_FLAG::READ_PERMISSION, &fscStatus);
+		return clock::now() - t0;
+	};
+	// compare resolved device paths of both variants
+	auto getResultChecksum = [&]()
+	{
+		std::string devicePath;
+		fscDeviceC* fscDevice;
+		void* ctx;
+		uint64 checksum = 0;
+		for (auto& path : paths)
+		{
+			for (sint32 prio = FSC_PRIORITY_MAX; prio >= 0; prio--)
+			{
+				if (fsc_lookupPath(path.c_str(), devicePath, &fscDevice, &ctx, prio))
+					checksum = std::rotl(checksum, 7) ^ std::hash<std::string>{}(devicePath);
+				else
+					checksum = std::rotl(checksum, 7);
+			}
+		}
+		return checksum;
+	};
+	// the linear walk is the baseline, it compares the names of all child nodes at every level
+	s_fscLookupCache.isEnabled = false;
+	s_fscLookupCache.useLinearWalk = true;
+	clock::duration timeLinearWalk = runOpen();
+	uint64 checksumLinearWalk = getResultChecksum();
+	s_fscLookupCache.useLinearWalk = false;
+	clock::duration timeHashedWalk = runOpen();
+	bool resultsMatch = getResultChecksum() == checksumLinearWalk;
+	s_fscLookupCache.isEnabled = true;
+	runOpen(); // warm up the cache
+	clock::duration timeCached = runOpen();
+	resultsMatch = resultsMatch && getResultChecksum() == checksumLinearWalk;
+	fsc_reset();
+	fscLeave();
+
+	auto toNs = [numLookups](clock::duration d) { return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / (double)std::max<uint32>(numLookups, 1); };
+	cemuLog_log(LogType::Force, "FSC lookup benchmark: {} lookups across {} priorities, {} distinct paths", numLookups, FSC_PRIORITY_COUNT, paths.size());
+	cemuLog_log(LogType::Force, "fsc_open with linear mount tree walk: {:.1f}ns per path", toNs(timeLinearWalk));
+	cemuLog_log(LogType::Force, "fsc_open with hashed mount tree walk: {:.1f}ns per path", toNs(timeHashedWalk));
+	cemuLog_log(LogType::Force, "fsc_open with lookup cache:           {:.1f}ns per path", toNs(timeCached));
+	if (!resultsMatch)
+		cemuLog_log(LogType::Force, "Mismatch between lookup results of the linear walk and the hashed walk or lookup cache");
+	return resultsMatch;
+}
@@ -158,9 +158,24 @@ struct FSCVirtualFile
 		return false;
 	}
 
+	// make sure all previous writes reached the underlying storage
+	// returns false if any of them failed
+	virtual bool fscFlush()
+	{
+		return true;
+	}
+
+	// returns true if read/write/seek only touch state owned by this file object
+	// for these files the data operations are serialized per file instead of by the global fsc lock
+	virtual bool fscIsThreadSafe()
+	{
+		return false;
+	}
+
 	FSCDirIteratorState* dirIterator{};
 
 	bool m_isAppend{ false };
+	std::recursive_mutex m_accessMutex; // used instead of the global lock if fscIsThreadSafe() is true
 };
 
 #define FSC_PRIORITY_BASE				(0)
@@ -192,17 +207,22 @@ bool fsc_isFile(FSCVirtualFile* fscFile);
 bool fsc_isWritable(FSCVirtualFile* fscFile);
 uint32 fsc_readFile(FSCVirtualFile* fscFile, void* buffer, uint32 size);
 uint32 fsc_writeFile(FSCVirtualFile* fscFile, void* buffer, uint32 size);
+bool fsc_flushFile(FSCVirtualFile* fscFile);
 
 uint8* fsc_extractFile(const char* path, uint32* fileSize, sint32 maxPriority = FSC_PRIORITY_MAX);
 std::optional<std::vector<uint8>> fsc_extractFile(const char* path, sint32 maxPriority = FSC_PRIORITY_MAX);
 bool fsc_doesFileExist(const char* path, sint32 maxPriority = FSC_PRIORITY_MAX);
 bool fsc_doesDirectoryExist(const char* path, sint32 maxPriority = FSC_PRIORITY_MAX);
 
+// for profiling
+bool fsc_RunLookupBenchmark(uint32 numLookups);
+
 // wud device
 bool FSCDeviceWUD_Mount(std::string_view mountPath, std::string_view destinationBaseDir, class FSTVolume* mountedVolume, sint32 priority);
 
 // wua device
 bool FSCDeviceWUA_Mount(std::string_view mountPath, std::string_view destinationBaseDir, class ZArchiveReader* archive, sint32 priority);
+void FSCDeviceWUA_ReleaseArchive(class ZArchiveReader* archive); // drops cached data and pending prefetches, call before the archive is deleted
 
 // wuhb device
 bool FSCDeviceWUHB_Mount(std::string_view mountPath, std::string_view destinationBaseDir, class WUHBReader* wuhbReader, sint32 priority);
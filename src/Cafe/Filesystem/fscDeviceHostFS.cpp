@@ -9,7 +9,15 @@
 FSCVirtualFile_Host::~FSCVirtualFile_Host()
 {
 	if (m_type == FSC_TYPE_FILE)
+	{
+		if (m_asyncIO)
+		{
+			// WaitForPath() may still hold a reference, make sure nothing uses the stream once it is deleted
+			m_asyncIO->Close();
+			m_asyncIO.reset();
+		}
 		delete m_fs;
+	}
 }
 
 sint32 FSCVirtualFile_Host::fscGetType()
@@ -64,7 +72,11 @@ uint32 FSCVirtualFile_Host::fscWriteData(void* buffer, uint32 size)
 		cemu_assert_suspicious();
 		return 0;
 	}
-	sint32 writtenBytes = m_fs->writeData(buffer, (sint32)size);
+	sint32 writtenBytes;
+	if (m_asyncIO)
+		writtenBytes = (sint32)m_asyncIO->Write(m_seek, buffer, size);
+	else
+		writtenBytes = m_fs->writeData(buffer, (sint32)size);
 	m_seek += (uint64)writtenBytes;
 	m_fileSize = std::max(m_fileSize, m_seek);
 	return (uint32)writtenBytes;
@@ -82,7 +94,11 @@ uint32 FSCVirtualFile_Host::fscReadData(void* buffer, uint32 size)
 	uint32 bytesLeft = (uint32)(m_fileSize - m_seek);
 	bytesLeft = std::min(bytesLeft, 0x7FFFFFFFu);
 	sint32 bytesToRead = std::min(bytesLeft, size);
-	uint32 bytesRead = m_fs->readData(buffer, bytesToRead);
+	uint32 bytesRead;
+	if (m_asyncIO)
+		bytesRead = m_asyncIO->Read(m_seek, buffer, bytesToRead);
+	else
+		bytesRead = m_fs->readData(buffer, bytesToRead);
 	m_seek += bytesRead;
 	return bytesRead;
 }
@@ -93,7 +109,8 @@ void FSCVirtualFile_Host::fscSetSeek(uint64 seek)
 		return;
 	this->m_seek = seek;
 	cemu_assert_debug(seek <= m_fileSize);
-	m_fs->SetPosition(seek);
+	if (!m_asyncIO) // transfers of writable files pass the offset explicitly, the stream may be in use by the IO thread
+		m_fs->SetPosition(seek);
 }
 
 uint64 FSCVirtualFile_Host::fscGetSeek()
@@ -107,15 +124,29 @@ void FSCVirtualFile_Host::fscSetFileLength(uint64 endOffset)
 {
 	if (m_type != FSC_TYPE_FILE)
 		return;
-	m_fs->SetPosition(endOffset);
-	bool r = m_fs->SetEndOfFile();
+	bool r;
+	if (m_asyncIO)
+		r = m_asyncIO->SetLength(endOffset);
+	else
+	{
+		m_fs->SetPosition(endOffset);
+		r = m_fs->SetEndOfFile();
+	}
 	m_seek = std::min(m_seek, endOffset);
 	m_fileSize = m_seek;
-	m_fs->SetPosition(m_seek);
+	if (!m_asyncIO)
+		m_fs->SetPosition(m_seek);
 	if (!r)
 		cemuLog_log(LogType::Force, "fscSetFileLength: Failed to set size to 0x{:x}", endOffset);
 }
 
+bool FSCVirtualFile_Host::fscFlush()
+{
+	if (m_asyncIO)
+		return m_asyncIO->Flush();
+	return true;
+}
+
 bool FSCVirtualFile_Host::fscDirNext(FSCDirEntry* dirEntry)
 {
 	if (m_type != FSC_TYPE_DIRECTORY)
@@ -165,6 +196,8 @@ FSCVirtualFile* FSCVirtualFile_Host::OpenFile(const fs::path& path, FSC_ACCESS_F
 	// attempt to open as file
 	if (HAS_FLAG(accessFlags, FSC_ACCESS_FLAG::OPEN_FILE))
 	{
+		// another handle may still be writing to the file in the background
+		FSCHostFileAsyncIO::WaitForPath(path);
 		FileStream* fs{};
 		bool writeAccessRequested = HAS_FLAG(accessFlags, FSC_ACCESS_FLAG::WRITE_PERMISSION);
 		if (HAS_FLAG(accessFlags, FSC_ACCESS_FLAG::FILE_ALLOW_CREATE))
@@ -194,6 +227,8 @@ FSCVirtualFile* FSCVirtualFile_Host::OpenFile(const fs::path& path, FSC_ACCESS_F
 			vf->m_fs = fs;
 			vf->m_isWritable = writeAccessRequested;
 			vf->m_fileSize = fs->GetSize();
+			if (writeAccessRequested)
+				vf->m_asyncIO = FSCHostFileAsyncIO::Create(fs, path);
 			fscStatus = FSC_STATUS_OK;
 			return vf;
 		}
@@ -251,6 +286,7 @@ public:
 	{
 		*fscStatus = FSC_STATUS_OK;
 		fs::path _path = _utf8ToPath(path);
+		FSCHostFileAsyncIO::WaitForPath(_path);
 		std::error_code ec;
 		if (!fs::exists(_path, ec))
 		{
@@ -270,6 +306,7 @@ public:
 		*fscStatus = FSC_STATUS_OK;
 		fs::path _srcPath = _utf8ToPath(srcPath);
 		fs::path _dstPath = _utf8ToPath(dstPath);
+		FSCHostFileAsyncIO::WaitForPath(_srcPath);
 		std::error_code ec;
 		if (!fs::exists(_srcPath, ec))
 		{
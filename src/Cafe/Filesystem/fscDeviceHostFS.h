@@ -1,4 +1,5 @@
 #include "Cafe/Filesystem/fsc.h"
+#include "Cafe/Filesystem/fscHostFileIO.h"
 
 class FSCVirtualFile_Host : public FSCVirtualFile
 {
@@ -17,6 +18,8 @@ public:
 	uint64 fscGetSeek() override;
 	void fscSetFileLength(uint64 endOffset) override;
 	bool fscDirNext(FSCDirEntry* dirEntry) override;
+	bool fscFlush() override;
+	bool fscIsThreadSafe() override { return m_type == FSC_TYPE_FILE; } // each host file has its own stream
 
 private:
 	FSCVirtualFile_Host(uint32 type) : m_type(type) {};
@@ -28,6 +31,7 @@ private:
 	uint64 m_seek{ 0 };
 	uint64 m_fileSize{ 0 };
 	bool m_isWritable{ false };
+	std::shared_ptr<FSCHostFileAsyncIO> m_asyncIO{}; // set for writable files, all data transfers go through it
 	// directory
 	std::unique_ptr<std::filesystem::path> m_path{};
 	std::unique_ptr<std::filesystem::directory_iterator> m_dirIterator{};
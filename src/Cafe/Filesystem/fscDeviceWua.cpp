@@ -1,14 +1,233 @@
 #include "Cafe/Filesystem/fsc.h"
+#include "util/helpers/helpers.h"
 #include <zarchive/zarchivereader.h>
 
+static constexpr uint32 WUA_CHUNK_SIZE = 64 * 1024; // same as the compressed block size of ZArchive
+static constexpr uint64 WUA_CHUNK_CACHE_CAPACITY = 32 * 1024 * 1024;
+static constexpr uint32 WUA_PREFETCH_MIN_SIZE = 512 * 1024; // prefetch at least this many bytes once a file is read sequentially
+static constexpr uint32 WUA_PREFETCH_MAX_SIZE = 2 * 1024 * 1024;
+static constexpr size_t WUA_PREFETCH_QUEUE_MAX = 128; // in chunks
+
+// mounted archive
+// ZArchiveReader has a single file handle and block cache, all accesses from the device and the prefetch thread go through readerMutex
+struct FSCWuaArchive
+{
+	FSCWuaArchive(ZArchiveReader* reader, uint64 archiveId) : reader(reader), archiveId(archiveId) {}
+
+	ZArchiveReader* reader;
+	uint64 archiveId; // part of the cache key, unlike the reader pointer it is never reused
+	std::mutex readerMutex;
+};
+
+static struct
+{
+	std::mutex mutex;
+	std::unordered_map<ZArchiveReader*, std::unique_ptr<FSCWuaArchive>> archives;
+	uint64 nextArchiveId{1};
+}s_wuaArchives;
+
+/* decompressed chunk cache, shared by all archives */
+
+struct FSCWuaChunkKey
+{
+	uint64 archiveId;
+	ZArchiveNodeHandle nodeHandle;
+	uint32 chunkIndex; // file offset / WUA_CHUNK_SIZE
+
+	bool operator==(const FSCWuaChunkKey& other) const
+	{
+		return archiveId == other.archiveId && nodeHandle == other.nodeHandle && chunkIndex == other.chunkIndex;
+	}
+
+	struct HashFunc
+	{
+		size_t operator()(const FSCWuaChunkKey& v) const
+		{
+			uint64 h = ((uint64)v.nodeHandle << 32 | (uint64)v.chunkIndex) ^ (v.archiveId * 0x9E3779B97F4A7C15ull);
+			h ^= h >> 29;
+			h *= 0xBF58476D1CE4E5B9ull;
+			return (size_t)(h ^ (h >> 32));
+		}
+	};
+};
+
+using FSCWuaChunk = std::shared_ptr<std::vector<uint8>>;
+
+static struct
+{
+	std::mutex mutex;
+	std::list<std::pair<FSCWuaChunkKey, FSCWuaChunk>> lruList; // front is most recently used
+	std::unordered_map<FSCWuaChunkKey, decltype(lruList)::iterator, FSCWuaChunkKey::HashFunc> entries;
+	uint64 bytesUsed{0};
+}s_wuaChunkCache;
+
+static FSCWuaChunk _FSCWuaChunkCache_Lookup(const FSCWuaChunkKey& key)
+{
+	std::unique_lock _l(s_wuaChunkCache.mutex);
+	auto itr = s_wuaChunkCache.entries.find(key);
+	if (itr == s_wuaChunkCache.entries.end())
+		return nullptr;
+	s_wuaChunkCache.lruList.splice(s_wuaChunkCache.lruList.begin(), s_wuaChunkCache.lruList, itr->second);
+	return itr->second->second;
+}
+
+static bool _FSCWuaChunkCache_Contains(const FSCWuaChunkKey& key)
+{
+	std::unique_lock _l(s_wuaChunkCache.mutex);
+	return s_wuaChunkCache.entries.find(key) != s_wuaChunkCache.entries.end();
+}
+
+static void _FSCWuaChunkCache_Insert(const FSCWuaChunkKey& key, FSCWuaChunk chunk)
+{
+	std::unique_lock _l(s_wuaChunkCache.mutex);
+	if (s_wuaChunkCache.entries.find(key) != s_wuaChunkCache.entries.end())
+		return; // the prefetch thread and a reader fetched the same chunk
+	s_wuaChunkCache.bytesUsed += chunk->size();
+	s_wuaChunkCache.lruList.emplace_front(key, std::move(chunk));
+	s_wuaChunkCache.entries.emplace(key, s_wuaChunkCache.lruList.begin());
+	while (s_wuaChunkCache.bytesUsed > WUA_CHUNK_CACHE_CAPACITY)
+	{
+		auto& lruEntry = s_wuaChunkCache.lruList.back();
+		s_wuaChunkCache.bytesUsed -= lruEntry.second->size();
+		s_wuaChunkCache.entries.erase(lruEntry.first);
+		s_wuaChunkCache.lruList.pop_back();
+	}
+}
+
+static void _FSCWuaChunkCache_RemoveArchive(uint64 archiveId)
+{
+	std::unique_lock _l(s_wuaChunkCache.mutex);
+	for (auto itr = s_wuaChunkCache.lruList.begin(); itr != s_wuaChunkCache.lruList.end();)
+	{
+		if (itr->first.archiveId != archiveId)
+		{
+			++itr;
+			continue;
+		}
+		s_wuaChunkCache.bytesUsed -= itr->second->size();
+		s_wuaChunkCache.entries.erase(itr->first);
+		itr = s_wuaChunkCache.lruList.erase(itr);
+	}
+}
+
+// decompress a chunk of a file and add it to the cache. Returns nullptr if the archive could not be read
+static FSCWuaChunk _FSCWua_FetchChunk(FSCWuaArchive* archive, ZArchiveNodeHandle nodeHandle, uint32 chunkIndex, uint64 fileSize)
+{
+	uint64 chunkOffset = (uint64)chunkIndex * WUA_CHUNK_SIZE;
+	cemu_assert_debug(chunkOffset < fileSize);
+	FSCWuaChunk chunk = std::make_shared<std::vector<uint8>>((size_t)std::min<uint64>(WUA_CHUNK_SIZE, fileSize - chunkOffset));
+	uint64 bytesRead;
+	{
+		std::unique_lock _l(archive->readerMutex);
+		bytesRead = archive->reader->ReadFromFile(nodeHandle, chunkOffset, chunk->size(), chunk->data());
+	}
+	if (bytesRead != chunk->size())
+		return nullptr;
+	_FSCWuaChunkCache_Insert({archive->archiveId, nodeHandle, chunkIndex}, chunk);
+	return chunk;
+}
+
+/* prefetch */
+
+// decompresses upcoming chunks of sequentially read files on a background thread
+// created on first use and never destroyed since the thread keeps waiting on it until the process exits
+class FSCWuaPrefetcher
+{
+public:
+	static FSCWuaPrefetcher* Get(bool createIfNeeded)
+	{
+		static std::once_flag s_createFlag;
+		static std::atomic<FSCWuaPrefetcher*> s_instance{nullptr};
+		if (createIfNeeded)
+		{
+			std::call_once(s_createFlag, []()
+			{
+				FSCWuaPrefetcher* prefetcher = new FSCWuaPrefetcher();
+				std::thread(&FSCWuaPrefetcher::ThreadFunc, prefetcher).detach();
+				s_instance = prefetcher;
+			});
+		}
+		return s_instance;
+	}
+
+	// queue the chunks in [firstChunkIndex, endChunkIndex) that are not cached yet
+	void Request(FSCWuaArchive* archive, ZArchiveNodeHandle nodeHandle, uint32 firstChunkIndex, uint32 endChunkIndex, uint64 fileSize)
+	{
+		std::unique_lock _l(m_mutex);
+		bool hasNewRequests = false;
+		for (uint32 chunkIndex = firstChunkIndex; chunkIndex < endChunkIndex; chunkIndex++)
+		{
+			if (m_queue.size() >= WUA_PREFETCH_QUEUE_MAX)
+				break;
+			if (_FSCWuaChunkCache_Contains({archive->archiveId, nodeHandle, chunkIndex}))
+				continue;
+			auto isQueued = std::any_of(m_queue.begin(), m_queue.end(), [&](const Request_t& r) { return r.archive == archive && r.nodeHandle == nodeHandle && r.chunkIndex == chunkIndex; });
+			if (isQueued)
+				continue;
+			m_queue.push_back({archive, nodeHandle, chunkIndex, fileSize});
+			hasNewRequests = true;
+		}
+		if (hasNewRequests)
+			m_requestCV.notify_one();
+	}
+
+	// drop queued requests of an archive and wait until the prefetch thread no longer accesses it
+	void CancelArchive(FSCWuaArchive* archive)
+	{
+		std::unique_lock _l(m_mutex);
+		std::erase_if(m_queue, [archive](const Request_t& r) { return r.archive == archive; });
+		m_idleCV.wait(_l, [this, archive]() { return m_activeArchive != archive; });
+	}
+
+private:
+	struct Request_t
+	{
+		FSCWuaArchive* archive;
+		ZArchiveNodeHandle nodeHandle;
+		uint32 chunkIndex;
+		uint64 fileSize;
+	};
+
+	void ThreadFunc()
+	{
+		SetThreadName("WUAPrefetch");
+		std::unique_lock _l(m_mutex);
+		while (true)
+		{
+			m_requestCV.wait(_l, [this]() { return !m_queue.empty(); });
+			Request_t request = m_queue.front();
+			m_queue.pop_front();
+			m_activeArchive = request.archive;
+			_l.unlock();
+			if (!_FSCWuaChunkCache_Contains({request.archive->archiveId, request.nodeHandle, request.chunkIndex}))
+				_FSCWua_FetchChunk(request.archive, request.nodeHandle, request.chunkIndex, request.fileSize);
+			_l.lock();
+			m_activeArchive = nullptr;
+			m_idleCV.notify_all();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_requestCV;
+	std::condition_variable m_idleCV;
+	std::deque<Request_t> m_queue;
+	FSCWuaArchive* m_activeArchive{nullptr}; // archive of the chunk currently being decompressed
+};
+
 class FSCDeviceWuaFileCtx : public FSCVirtualFile
 {
 	friend class fscDeviceWUAC;
 
 protected:
-	FSCDeviceWuaFileCtx(ZArchiveReader* archive, ZArchiveNodeHandle fstFileHandle, uint32 fscType)
+	FSCDeviceWuaFileCtx(FSCWuaArchive* archive, ZArchiveNodeHandle fstFileHandle, uint32 fscType)
 	{
 		this->m_archive = archive;
+		this->m_fileSize = 0;
+		if (fscType == FSC_TYPE_FILE)
+		{
+			std::unique_lock _l(archive->readerMutex);
+			this->m_fileSize = archive->reader->GetFileSize(fstFileHandle);
+		}
 		this->m_fscType = fscType;
 		this->m_nodeHandle = fstFileHandle;
 		this->m_seek = 0;
@@ -22,7 +241,7 @@ public:
 
 	uint32 fscDeviceWuaFile_getFileSize()
 	{
-		return (uint32)m_archive->GetFileSize(m_nodeHandle);
+		return (uint32)m_fileSize;
 	}
 
 	uint64 fscQueryValueU64(uint32 id) override
@@ -56,8 +275,19 @@ public:
 		cemu_assert(size < (2ULL * 1024 * 1024 * 1024)); // single read operation larger than 2GiB not supported
 		uint32 bytesLeft = fscDeviceWuaFile_getFileSize() - m_seek;
 		uint32 bytesToRead = (std::min)(bytesLeft, (uint32)size);
-		uint32 bytesSuccessfullyRead = (uint32)m_archive->ReadFromFile(m_nodeHandle, m_seek, bytesToRead, buffer);
+		uint32 bytesSuccessfullyRead = ReadChunked(m_seek, bytesToRead, (uint8*)buffer);
+		// once the file is read sequentially, decompress the following chunks in the background
+		if (bytesSuccessfullyRead > 0 && m_seek == m_lastReadEnd)
+		{
+			uint64 readEnd = (uint64)m_seek + bytesSuccessfullyRead;
+			uint32 prefetchSize = std::clamp<uint32>(bytesSuccessfullyRead, WUA_PREFETCH_MIN_SIZE, WUA_PREFETCH_MAX_SIZE);
+			uint32 firstChunkIndex = (uint32)((readEnd + WUA_CHUNK_SIZE - 1) / WUA_CHUNK_SIZE);
+			uint32 endChunkIndex = (uint32)((std::min<uint64>(readEnd + prefetchSize, m_fileSize) + WUA_CHUNK_SIZE - 1) / WUA_CHUNK_SIZE);
+			if (firstChunkIndex < endChunkIndex)
+				FSCWuaPrefetcher::Get(true)->Request(m_archive, m_nodeHandle, firstChunkIndex, endChunkIndex, m_fileSize);
+		}
 		m_seek += bytesSuccessfullyRead;
+		m_lastReadEnd = m_seek;
 		return bytesSuccessfullyRead;
 	}
 
@@ -76,13 +306,19 @@ public:
 		return m_seek;
 	}
 
+	bool fscIsThreadSafe() override
+	{
+		return m_fscType == FSC_TYPE_FILE; // archive accesses are serialized by FSCWuaArchive::readerMutex
+	}
+
 	bool fscDirNext(FSCDirEntry* dirEntry) override
 	{
 		if (m_fscType != FSC_TYPE_DIRECTORY)
 			return false;
 
 		ZArchiveReader::DirEntry zarDirEntry;
-		if (!m_archive->GetDirEntry(m_nodeHandle, m_iteratorIndex, zarDirEntry))
+		std::unique_lock _l(m_archive->readerMutex);
+		if (!m_archive->reader->GetDirEntry(m_nodeHandle, m_iteratorIndex, zarDirEntry))
 			return false;
 		m_iteratorIndex++;
 
@@ -108,11 +344,61 @@ public:
 	}
 
 private:
-	ZArchiveReader* m_archive{nullptr};
+	// reads whole uncached chunks directly into the output buffer, partially read chunks go through the chunk cache
+	uint32 ReadChunked(uint64 offset, uint32 size, uint8* output)
+	{
+		uint64 end = offset + size;
+		uint64 pos = offset;
+		while (pos < end)
+		{
+			uint32 chunkIndex = (uint32)(pos / WUA_CHUNK_SIZE);
+			uint64 chunkOffset = (uint64)chunkIndex * WUA_CHUNK_SIZE;
+			uint64 chunkEnd = std::min<uint64>(chunkOffset + WUA_CHUNK_SIZE, m_fileSize);
+			if (pos == chunkOffset && end >= chunkEnd)
+			{
+				// collect the run of fully read chunks that are not cached
+				uint64 directEnd = pos;
+				uint32 directChunkIndex = chunkIndex;
+				while (true)
+				{
+					uint64 nextChunkEnd = std::min<uint64>(directEnd + WUA_CHUNK_SIZE, m_fileSize);
+					if (directEnd >= end || nextChunkEnd > end || _FSCWuaChunkCache_Contains({m_archive->archiveId, m_nodeHandle, directChunkIndex}))
+						break;
+					directEnd = nextChunkEnd;
+					directChunkIndex++;
+				}
+				if (directEnd > pos)
+				{
+					uint64 bytesRead;
+					{
+						std::unique_lock _l(m_archive->readerMutex);
+						bytesRead = m_archive->reader->ReadFromFile(m_nodeHandle, pos, directEnd - pos, output + (pos - offset));
+					}
+					pos += bytesRead;
+					if (pos != directEnd)
+						break;
+					continue;
+				}
+			}
+			FSCWuaChunk chunk = _FSCWuaChunkCache_Lookup({m_archive->archiveId, m_nodeHandle, chunkIndex});
+			if (!chunk)
+				chunk = _FSCWua_FetchChunk(m_archive, m_nodeHandle, chunkIndex, m_fileSize);
+			if (!chunk)
+				break;
+			uint64 copyEnd = std::min(end, chunkEnd);
+			std::memcpy(output + (pos - offset), chunk->data() + (pos - chunkOffset), (size_t)(copyEnd - pos));
+			pos = copyEnd;
+		}
+		return (uint32)(pos - offset);
+	}
+
+	FSCWuaArchive* m_archive{nullptr};
 	sint32 m_fscType;
 	ZArchiveNodeHandle m_nodeHandle;
 	// file
+	uint64 m_fileSize;
 	uint32 m_seek{0};
+	uint64 m_lastReadEnd{~0ull}; // for sequential read detection
 	// directory
 	uint32 m_iteratorIndex{0};
 };
@@ -121,16 +407,20 @@ class fscDeviceWUAC : public fscDeviceC
 {
 	FSCVirtualFile* fscDeviceOpenByPath(std::string_view path, FSC_ACCESS_FLAG accessFlags, void* ctx, sint32* fscStatus) override
 	{
-		ZArchiveReader* archive = (ZArchiveReader*)ctx;
+		FSCWuaArchive* archive = (FSCWuaArchive*)ctx;
 		cemu_assert_debug(!HAS_FLAG(accessFlags, FSC_ACCESS_FLAG::WRITE_PERMISSION)); // writing to WUA is not supported
 
-		ZArchiveNodeHandle fileHandle = archive->LookUp(path, true, true);
+		std::unique_lock _l(archive->readerMutex);
+		ZArchiveNodeHandle fileHandle = archive->reader->LookUp(path, true, true);
 		if (fileHandle == ZARCHIVE_INVALID_NODE)
 		{
 			*fscStatus = FSC_STATUS_FILE_NOT_FOUND;
 			return nullptr;
 		}
-		if (archive->IsFile(fileHandle))
+		bool isFile = archive->reader->IsFile(fileHandle);
+		bool isDirectory = archive->reader->IsDirectory(fileHandle);
+		_l.unlock();
+		if (isFile)
 		{
 			if (!HAS_FLAG(accessFlags, FSC_ACCESS_FLAG::OPEN_FILE))
 			{
@@ -140,7 +430,7 @@ class fscDeviceWUAC : public fscDeviceC
 			*fscStatus = FSC_STATUS_OK;
 			return new FSCDeviceWuaFileCtx(archive, fileHandle, FSC_TYPE_FILE);
 		}
-		else if (archive->IsDirectory(fileHandle))
+		else if (isDirectory)
 		{
 			if (!HAS_FLAG(accessFlags, FSC_ACCESS_FLAG::OPEN_DIR))
 			{
@@ -169,5 +459,29 @@ public:
 
 bool FSCDeviceWUA_Mount(std::string_view mountPath, std::string_view destinationBaseDir, ZArchiveReader* archive, sint32 priority)
 {
-	return fsc_mount(mountPath, destinationBaseDir, &fscDeviceWUAC::instance(), archive, priority) == FSC_STATUS_OK;
+	FSCWuaArchive* wuaArchive;
+	{
+		std::unique_lock _l(s_wuaArchives.mutex);
+		auto& entry = s_wuaArchives.archives[archive];
+		if (!entry)
+			entry = std::make_unique<FSCWuaArchive>(archive, s_wuaArchives.nextArchiveId++);
+		wuaArchive = entry.get();
+	}
+	return fsc_mount(mountPath, destinationBaseDir, &fscDeviceWUAC::instance(), wuaArchive, priority) == FSC_STATUS_OK;
+}
+
+void FSCDeviceWUA_ReleaseArchive(ZArchiveReader* archive)
+{
+	std::unique_ptr<FSCWuaArchive> wuaArchive;
+	{
+		std::unique_lock _l(s_wuaArchives.mutex);
+		auto itr = s_wuaArchives.archives.find(archive);
+		if (itr == s_wuaArchives.archives.end())
+			return;
+		wuaArchive = std::move(itr->second);
+		s_wuaArchives.archives.erase(itr);
+	}
+	if (FSCWuaPrefetcher* prefetcher = FSCWuaPrefetcher::Get(false))
+		prefetcher->CancelArchive(wuaArchive.get());
+	_FSCWuaChunkCache_RemoveArchive(wuaArchive->archiveId);
 }
\ No newline at end of file
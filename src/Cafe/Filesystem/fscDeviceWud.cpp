@@ -83,6 +83,11 @@ public:
 		return m_seek;
 	}
 
+	bool fscIsThreadSafe() override
+	{
+		return m_fscType == FSC_TYPE_FILE; // FSTVolume reads can happen concurrently
+	}
+
 	bool fscDirNext(FSCDirEntry* dirEntry) override
 	{
 		if (m_fscType != FSC_TYPE_DIRECTORY)
@@ -0,0 +1,497 @@
+#include "Cafe/Filesystem/fscHostFileIO.h"
+#include "Common/FileStream.h"
+#include "util/helpers/helpers.h"
+
+#if !BOOST_OS_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if BOOST_OS_LINUX && defined(HAS_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define FSC_HOSTIO_HAS_URING
+#endif
+
+static constexpr uint32 FSC_HOSTIO_MERGE_MAX_SIZE = 512 * 1024; // merged writes are submitted once they reach this size
+static constexpr uint64 FSC_HOSTIO_MAX_IN_FLIGHT_BYTES = 32 * 1024 * 1024; // per file, further writes block until older ones completed
+
+struct FSCHostFileWriteOp
+{
+	FSCHostFileAsyncIO* file;
+	std::vector<uint8> data;
+	uint64 fileOffset;
+#ifdef FSC_HOSTIO_HAS_URING
+	iovec iov;
+#endif
+};
+
+class FSCHostIOBackend
+{
+public:
+	virtual ~FSCHostIOBackend() = default;
+	virtual void SubmitWrite(FSCHostFileWriteOp* op) = 0;
+};
+
+// fallback, writes are processed in submission order on a dedicated thread
+class FSCHostIOBackendThread : public FSCHostIOBackend
+{
+public:
+	FSCHostIOBackendThread()
+	{
+		std::thread t(&FSCHostIOBackendThread::WorkerThread, this);
+		t.detach();
+	}
+
+	void SubmitWrite(FSCHostFileWriteOp* op) override
+	{
+		std::unique_lock _l(m_mutex);
+		m_queue.emplace_back(op);
+		m_queueCV.notify_one();
+	}
+
+private:
+	void WorkerThread()
+	{
+		SetThreadName("HostFileIO");
+		std::unique_lock _l(m_mutex);
+		while (true)
+		{
+			m_queueCV.wait(_l, [this]() { return !m_queue.empty(); });
+			FSCHostFileWriteOp* op = m_queue.front();
+			m_queue.pop_front();
+			_l.unlock();
+			uint32 size = (uint32)op->data.size();
+			bool success = op->file->WriteSync(op->fileOffset, op->data.data(), size) == size;
+			op->file->CompleteWrite(op, success);
+			_l.lock();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_queueCV;
+	std::deque<FSCHostFileWriteOp*> m_queue;
+};
+
+#ifdef FSC_HOSTIO_HAS_URING
+// uses the raw io_uring syscalls so there is no dependency on liburing
+// submissions are serialized by a mutex, a dedicated thread waits for and reaps completions
+class FSCHostIOBackendUring : public FSCHostIOBackend
+{
+	static constexpr uint32 QUEUE_DEPTH = 64;
+
+public:
+	bool Init()
+	{
+		io_uring_params params{};
+		int ringFd = (int)syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params);
+		if (ringFd < 0)
+			return false; // not supported by the kernel or blocked (e.g. by a seccomp filter)
+		size_t sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+		size_t cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool isSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (isSingleMapping)
+			sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+		void* sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+		if (sqRing == MAP_FAILED)
+		{
+			close(ringFd);
+			return false;
+		}
+		void* cqRing = sqRing;
+		if (!isSingleMapping)
+		{
+			cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+			if (cqRing == MAP_FAILED)
+			{
+				munmap(sqRing, sqRingSize);
+				close(ringFd);
+				return false;
+			}
+		}
+		void* sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+		if (sqes == MAP_FAILED)
+		{
+			if (!isSingleMapping)
+				munmap(cqRing, cqRingSize);
+			munmap(sqRing, sqRingSize);
+			close(ringFd);
+			return false;
+		}
+		m_ringFd = ringFd;
+		m_sqEntries = params.sq_entries;
+		m_sqTail = (uint32*)((uint8*)sqRing + params.sq_off.tail);
+		m_sqMask = *(uint32*)((uint8*)sqRing + params.sq_off.ring_mask);
+		m_sqArray = (uint32*)((uint8*)sqRing + params.sq_off.array);
+		m_sqes = (io_uring_sqe*)sqes;
+		m_cqHead = (uint32*)((uint8*)cqRing + params.cq_off.head);
+		m_cqTail = (uint32*)((uint8*)cqRing + params.cq_off.tail);
+		m_cqMask = *(uint32*)((uint8*)cqRing + params.cq_off.ring_mask);
+		m_cqes = (io_uring_cqe*)((uint8*)cqRing + params.cq_off.cqes);
+		std::thread t(&FSCHostIOBackendUring::CompletionThread, this);
+		t.detach();
+		return true;
+	}
+
+	void SubmitWrite(FSCHostFileWriteOp* op) override
+	{
+		op->iov.iov_base = op->data.data();
+		op->iov.iov_len = op->data.size();
+		std::unique_lock _l(m_mutex);
+		// the completion queue is twice the size of the submission queue, limiting the number of requests in flight to the latter means it can never overflow
+		m_slotCV.wait(_l, [this]() { return m_inFlightCount < m_sqEntries; });
+		uint32 tail = *m_sqTail;
+		uint32 index = tail & m_sqMask;
+		io_uring_sqe* sqe = m_sqes + index;
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		sqe->opcode = IORING_OP_WRITEV; // IORING_OP_WRITE would require Linux 5.6
+		sqe->fd = op->file->GetFileDescriptor();
+		sqe->addr = (uint64)(uintptr_t)&op->iov;
+		sqe->len = 1;
+		sqe->off = op->fileOffset;
+		sqe->user_data = (uint64)(uintptr_t)op;
+		m_sqArray[index] = index;
+		__atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+		m_inFlightCount++;
+		while (true)
+		{
+			int r = (int)syscall(__NR_io_uring_enter, m_ringFd, 1, 0, 0, nullptr, 0);
+			if (r >= 0)
+				return;
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			break;
+		}
+		// the kernel did not consume the entry. Take it back out of the ring, submissions are serialized by m_mutex and no other entry was queued after it
+		cemuLog_log(LogType::Force, "HostFileIO: io_uring_enter failed with errno {}, writing synchronously", errno);
+		__atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+		m_inFlightCount--;
+		m_slotCV.notify_all();
+		_l.unlock();
+		uint32 size = (uint32)op->data.size();
+		bool success = op->file->WriteSync(op->fileOffset, op->data.data(), size) == size;
+		op->file->CompleteWrite(op, success);
+	}
+
+private:
+	void CompletionThread()
+	{
+		SetThreadName("HostFileIO");
+		std::vector<std::pair<FSCHostFileWriteOp*, sint32>> completedOps;
+		while (true)
+		{
+			int r = (int)syscall(__NR_io_uring_enter, m_ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+			if (r < 0 && errno != EINTR)
+			{
+				cemuLog_log(LogType::Force, "HostFileIO: Waiting for io_uring completions failed with errno {}", errno);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			uint32 head = *m_cqHead;
+			uint32 tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+			completedOps.clear();
+			for (; head != tail; head++)
+			{
+				io_uring_cqe* cqe = m_cqes + (head & m_cqMask);
+				completedOps.emplace_back((FSCHostFileWriteOp*)(uintptr_t)cqe->user_data, cqe->res);
+			}
+			__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+			if (completedOps.empty())
+				continue;
+			{
+				std::unique_lock _l(m_mutex);
+				m_inFlightCount -= (uint32)completedOps.size();
+				m_slotCV.notify_all();
+			}
+			for (auto& [op, result] : completedOps)
+			{
+				uint32 size = (uint32)op->data.size();
+				bool success = result >= 0 && (uint32)result == size;
+				if (!success)
+				{
+					// short or interrupted write, the remainder is written synchronously
+					uint32 bytesDone = result > 0 ? (uint32)result : 0;
+					success = op->file->WriteSync(op->fileOffset + bytesDone, op->data.data() + bytesDone, size - bytesDone) == (size - bytesDone);
+				}
+				op->file->CompleteWrite(op, success);
+			}
+		}
+	}
+
+	sint32 m_ringFd{-1};
+	uint32 m_sqEntries{0};
+	uint32* m_sqTail{};
+	uint32 m_sqMask{};
+	uint32* m_sqArray{};
+	io_uring_sqe* m_sqes{};
+	uint32* m_cqHead{};
+	uint32* m_cqTail{};
+	uint32 m_cqMask{};
+	io_uring_cqe* m_cqes{};
+	std::mutex m_mutex;
+	std::condition_variable m_slotCV;
+	uint32 m_inFlightCount{0};
+};
+#endif
+
+// backends are created on first use and intentionally never destroyed, their threads are detached
+static struct
+{
+	std::once_flag initFlag;
+	FSCHostIOBackend* uring{}; // null if unavailable
+	FSCHostIOBackend* thread{};
+}s_hostIOBackends;
+
+static void FSCHostIO_InitBackends()
+{
+	std::call_once(s_hostIOBackends.initFlag, []()
+	{
+#ifdef FSC_HOSTIO_HAS_URING
+		FSCHostIOBackendUring* uring = new FSCHostIOBackendUring();
+		if (uring->Init())
+			s_hostIOBackends.uring = uring;
+		else
+		{
+			delete uring;
+			cemuLog_log(LogType::Force, "HostFileIO: io_uring is unavailable, using background thread for host file writes");
+		}
+#endif
+		s_hostIOBackends.thread = new FSCHostIOBackendThread();
+	});
+}
+
+static FSCHostIOBackend* FSCHostIO_GetBackend(bool hasFileDescriptor)
+{
+	FSCHostIO_InitBackends();
+	if (s_hostIOBackends.uring && hasFileDescriptor)
+		return s_hostIOBackends.uring;
+	return s_hostIOBackends.thread;
+}
+
+// open files with asynchronous writes by lower case path, so other handles to the same file can wait for the writes
+static struct
+{
+	std::mutex mutex;
+	std::unordered_multimap<std::string, std::weak_ptr<FSCHostFileAsyncIO>> files;
+}s_hostFileRegistry;
+
+static std::string FSCHostIO_GetRegistryKey(const fs::path& path)
+{
+	return boost::algorithm::to_lower_copy(_pathToUtf8(path));
+}
+
+FSCHostFileAsyncIO::FSCHostFileAsyncIO(FileStream* fs, const fs::path& path) : m_fs(fs), m_path(path)
+{
+#if !BOOST_OS_WINDOWS
+	// the stream already created or opened the file, open it a second time for positional IO
+	m_fd = open(findPathCI(path).c_str(), O_RDWR | O_CLOEXEC);
+#endif
+}
+
+FSCHostFileAsyncIO::~FSCHostFileAsyncIO()
+{
+	if (m_isRegistered)
+	{
+		std::unique_lock _l(s_hostFileRegistry.mutex);
+		s_hostFileRegistry.files.erase(m_registryIt);
+	}
+	Close();
+#if !BOOST_OS_WINDOWS
+	if (m_fd >= 0)
+		close(m_fd);
+#endif
+}
+
+void FSCHostFileAsyncIO::Close()
+{
+	WaitIdle();
+	// closing a file can't report an error to the game, but the failure shouldn't go unnoticed
+	std::unique_lock _l(m_mutex);
+	if (m_writeFailed)
+		cemuLog_log(LogType::Force, "HostFileIO: Closed file {} with failed writes, the host file may be incomplete", _pathToUtf8(m_path));
+	m_writeFailed = false;
+}
+
+std::shared_ptr<FSCHostFileAsyncIO> FSCHostFileAsyncIO::Create(FileStream* fs, const fs::path& path)
+{
+	auto asyncIO = std::make_shared<FSCHostFileAsyncIO>(fs, path);
+	std::unique_lock _l(s_hostFileRegistry.mutex);
+	asyncIO->m_registryIt = s_hostFileRegistry.files.emplace(FSCHostIO_GetRegistryKey(path), asyncIO);
+	asyncIO->m_isRegistered = true;
+	return asyncIO;
+}
+
+void FSCHostFileAsyncIO::WaitForPath(const fs::path& path)
+{
+	// waiting can take a while, hold references to the files so the registry doesn't need to stay locked
+	std::vector<std::shared_ptr<FSCHostFileAsyncIO>> openFiles;
+	{
+		std::unique_lock _l(s_hostFileRegistry.mutex);
+		if (s_hostFileRegistry.files.empty())
+			return;
+		auto range = s_hostFileRegistry.files.equal_range(FSCHostIO_GetRegistryKey(path));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			// files which are already being destroyed wait for their own writes
+			if (auto file = it->second.lock())
+				openFiles.emplace_back(std::move(file));
+		}
+	}
+	for (auto& file : openFiles)
+		file->WaitIdle();
+}
+
+uint32 FSCHostFileAsyncIO::Write(uint64 fileOffset, const void* data, uint32 size)
+{
+	if (size == 0)
+		return 0;
+	const uint8* dataU8 = (const uint8*)data;
+	std::unique_lock _l(m_mutex);
+	// merge with the pending write if this continues it
+	bool canMerge = !m_pendingData.empty() && fileOffset == m_pendingOffset + m_pendingData.size() && m_pendingData.size() + size <= FSC_HOSTIO_MERGE_MAX_SIZE;
+	if (!canMerge)
+	{
+		SubmitPending(_l);
+		m_pendingOffset = fileOffset;
+	}
+	m_pendingData.insert(m_pendingData.end(), dataU8, dataU8 + size);
+	if (m_pendingData.size() >= FSC_HOSTIO_MERGE_MAX_SIZE)
+		SubmitPending(_l);
+	return size;
+}
+
+// hands the merged write to the backend. The lock is released while submitting
+void FSCHostFileAsyncIO::SubmitPending(std::unique_lock<std::mutex>& lock)
+{
+	if (m_pendingData.empty())
+		return;
+	uint64 begin = m_pendingOffset;
+	uint64 end = m_pendingOffset + m_pendingData.size();
+	// writes in flight may complete in any order, so a write may only be submitted if it doesn't overlap with any of them
+	if (m_inFlightCount > 0 && begin < m_inFlightEnd && end > m_inFlightBegin)
+		m_idleCV.wait(lock, [this]() { return m_inFlightCount == 0; });
+	m_idleCV.wait(lock, [this]() { return m_inFlightCount == 0 || m_inFlightBytes < FSC_HOSTIO_MAX_IN_FLIGHT_BYTES; });
+	if (m_inFlightCount == 0)
+	{
+		m_inFlightBegin = begin;
+		m_inFlightEnd = end;
+	}
+	else
+	{
+		m_inFlightBegin = std::min(m_inFlightBegin, begin);
+		m_inFlightEnd = std::max(m_inFlightEnd, end);
+	}
+	m_inFlightCount++;
+	m_inFlightBytes += m_pendingData.size();
+	FSCHostFileWriteOp* op = new FSCHostFileWriteOp();
+	op->file = this;
+	op->data = std::move(m_pendingData);
+	op->fileOffset = m_pendingOffset;
+	m_pendingData.clear();
+	lock.unlock();
+	FSCHostIO_GetBackend(m_fd >= 0)->SubmitWrite(op);
+	lock.lock();
+}
+
+void FSCHostFileAsyncIO::CompleteWrite(FSCHostFileWriteOp* op, bool success)
+{
+	uint64 size = op->data.size();
+	if (!success)
+		cemuLog_log(LogType::Force, "HostFileIO: Failed to write 0x{:x} bytes at offset 0x{:x}", size, op->fileOffset);
+	delete op;
+	// the file may be destroyed as soon as the lock is released
+	std::unique_lock _l(m_mutex);
+	if (!success)
+		m_writeFailed = true;
+	m_inFlightCount--;
+	m_inFlightBytes -= size;
+	m_idleCV.notify_all();
+}
+
+void FSCHostFileAsyncIO::WaitIdle()
+{
+	std::unique_lock _l(m_mutex);
+	SubmitPending(_l);
+	m_idleCV.wait(_l, [this]() { return m_inFlightCount == 0; });
+}
+
+uint32 FSCHostFileAsyncIO::WriteSync(uint64 fileOffset, const uint8* data, uint32 size)
+{
+#if !BOOST_OS_WINDOWS
+	if (m_fd >= 0)
+	{
+		uint32 bytesWritten = 0;
+		while (bytesWritten < size)
+		{
+			ssize_t r = pwrite(m_fd, data + bytesWritten, size - bytesWritten, (off_t)(fileOffset + bytesWritten));
+			if (r < 0 && errno == EINTR)
+				continue;
+			if (r <= 0)
+				break;
+			bytesWritten += (uint32)r;
+		}
+		return bytesWritten;
+	}
+#endif
+	// the stream is only accessed by one thread at a time, the file waits for all writes before it uses the stream itself
+	m_fs->SetPosition(fileOffset);
+	sint32 r = m_fs->writeData(data, (sint32)size);
+	return r > 0 ? (uint32)r : 0;
+}
+
+uint32 FSCHostFileAsyncIO::Read(uint64 fileOffset, void* data, uint32 size)
+{
+	uint64 end = fileOffset + size;
+	{
+		std::unique_lock _l(m_mutex);
+		bool overlapsPending = !m_pendingData.empty() && fileOffset < m_pendingOffset + m_pendingData.size() && end > m_pendingOffset;
+		if (overlapsPending || m_fd < 0)
+			SubmitPending(_l); // without a file descriptor the stream is shared with the IO thread, wait for all writes
+		if (m_inFlightCount > 0 && (m_fd < 0 || (fileOffset < m_inFlightEnd && end > m_inFlightBegin)))
+			m_idleCV.wait(_l, [this]() { return m_inFlightCount == 0; });
+	}
+#if !BOOST_OS_WINDOWS
+	if (m_fd >= 0)
+	{
+		uint32 bytesRead = 0;
+		while (bytesRead < size)
+		{
+			ssize_t r = pread(m_fd, (uint8*)data + bytesRead, size - bytesRead, (off_t)(fileOffset + bytesRead));
+			if (r < 0 && errno == EINTR)
+				continue;
+			if (r <= 0)
+				break;
+			bytesRead += (uint32)r;
+		}
+		return bytesRead;
+	}
+#endif
+	m_fs->SetPosition(fileOffset);
+	return m_fs->readData(data, size);
+}
+
+bool FSCHostFileAsyncIO::SetLength(uint64 length)
+{
+	WaitIdle();
+#if !BOOST_OS_WINDOWS
+	if (m_fd >= 0)
+		return ftruncate(m_fd, (off_t)length) == 0;
+#endif
+	m_fs->SetPosition(length);
+	return m_fs->SetEndOfFile();
+}
+
+bool FSCHostFileAsyncIO::Flush()
+{
+	WaitIdle();
+	std::unique_lock _l(m_mutex);
+	bool writeFailed = m_writeFailed;
+	if (writeFailed)
+		cemuLog_log(LogType::Force, "HostFileIO: Flushed file had failed writes");
+	m_writeFailed = false;
+	return !writeFailed;
+}
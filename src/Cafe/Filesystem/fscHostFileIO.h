@@ -0,0 +1,50 @@
+#pragma once
+
+// asynchronous write-behind for writable host files
+// writes are copied and handed to io_uring (Linux) or a background IO thread so the FSA worker can reply right away
+// adjacent small writes are merged before submission. Reads, truncation and flushes wait for the writes they depend on
+class FSCHostFileAsyncIO
+{
+public:
+	FSCHostFileAsyncIO(class FileStream* fs, const fs::path& path);
+	~FSCHostFileAsyncIO(); // waits for all writes to finish, failed writes are logged
+
+	// creates the write-behind for a file and registers it so WaitForPath() can find it
+	static std::shared_ptr<FSCHostFileAsyncIO> Create(class FileStream* fs, const fs::path& path);
+
+	uint32 Write(uint64 fileOffset, const void* data, uint32 size);
+	uint32 Read(uint64 fileOffset, void* data, uint32 size);
+	bool SetLength(uint64 length);
+	bool Flush(); // submit merged writes and wait until they reached the host file. Returns false if any write since the last flush failed
+	void Close(); // wait for all writes and log if any of them failed. The stream isn't used anymore afterwards
+
+	// wait for the writes of all open files with the given path
+	static void WaitForPath(const fs::path& path);
+
+	// called by the backends
+	void CompleteWrite(struct FSCHostFileWriteOp* op, bool success);
+	uint32 WriteSync(uint64 fileOffset, const uint8* data, uint32 size);
+
+	sint32 GetFileDescriptor() const { return m_fd; }
+
+private:
+	void SubmitPending(std::unique_lock<std::mutex>& lock);
+	void WaitIdle();
+
+	class FileStream* m_fs;
+	fs::path m_path;
+	sint32 m_fd{-1}; // native file descriptor on Unix, writes use positional IO on it instead of the stream
+	std::unordered_multimap<std::string, std::weak_ptr<FSCHostFileAsyncIO>>::iterator m_registryIt;
+	bool m_isRegistered{false};
+	std::mutex m_mutex;
+	// write that is still being merged
+	std::vector<uint8> m_pendingData;
+	uint64 m_pendingOffset{0};
+	// submitted writes
+	std::condition_variable m_idleCV;
+	uint32 m_inFlightCount{0};
+	uint64 m_inFlightBytes{0};
+	uint64 m_inFlightBegin{0}; // union of the ranges of all writes in flight
+	uint64 m_inFlightEnd{0};
+	bool m_writeFailed{false};
+};
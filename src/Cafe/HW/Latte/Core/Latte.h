@@ -14,6 +14,20 @@ struct gx2GPUSharedArea_t
 	volatile uint32 swapInterval; // vsync swap interval (0 means vsync is deactivated)
 };
 
+namespace Latte
+{
+	// groups of registers which contribute to the pipeline state
+	// register writes flag the affected blocks as dirty so that renderers can reuse state derived from unchanged blocks
+	enum PIPELINE_STATE_BLOCK : uint32
+	{
+		PIPELINE_STATE_PRIMITIVE = (1 << 0), // primitive type, streamout enable, rasterization kill
+		PIPELINE_STATE_RASTERIZER = (1 << 1),
+		PIPELINE_STATE_BLEND = (1 << 2),
+		PIPELINE_STATE_DEPTH_STENCIL = (1 << 3),
+		PIPELINE_STATE_ALL = 0xF,
+	};
+};
+
 struct LatteGPUState_t
 {
 	union
@@ -25,6 +39,8 @@ struct LatteGPUState_t
 	// context control
 	uint32 contextControl0;
 	uint32 contextControl1;
+	// pipeline state tracking, see Latte::PIPELINE_STATE_BLOCK
+	uint32 pipelineStateDirtyMask{ Latte::PIPELINE_STATE_ALL };
 	// optional features
 	bool allowFramebufferSizeOptimization{false}; // allow using scissor box as size hint to determine non-padded rendertarget size
 	// stats
@@ -69,6 +85,8 @@ struct LatteGPUState_t
 };
 
 extern LatteGPUState_t LatteGPUState;
+
+void LatteGPUState_markRegistersDirty(uint32 registerStartIndex, uint32 registerEndIndex);
 extern std::atomic_bool g_lattePauseRequested;
 extern std::atomic_bool g_lattePaused;
 extern std::atomic_uint64_t g_lattePausedPresentRequest;
@@ -132,7 +150,10 @@ void LatteTextureReadback_Initate(LatteTextureView* textureView);
 void LatteTextureReadback_StartTransfer(LatteTextureView* textureView);
 bool LatteTextureReadback_Update(bool forceStart = false);
 void LatteTextureReadback_NotifyTextureDeletion(LatteTexture* texture);
+bool LatteTextureReadback_IsWritePending(LatteTexture* texture);
 void LatteTextureReadback_UpdateFinishedTransfers(bool forceFinish);
+void LatteTextureReadback_WaitForActiveTransfers();
+void LatteTextureReadback_Shutdown();
 
 // query
 
@@ -183,4 +204,5 @@ bool Latte_WaitUntilPaused(uint32 timeoutMs);
 uint64 Latte_RequestPausedPresentOnce();
 bool Latte_WaitForPausedPresent(uint64 requestId, uint32 timeoutMs);
 void LatteThread_Exit();
+bool Latte_RunHeadlessReplay(const fs::path& capturePath, uint32 numLoops);
 
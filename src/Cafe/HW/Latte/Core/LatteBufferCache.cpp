@@ -2,10 +2,17 @@
 #include "util/ChunkedHeap/ChunkedHeap.h"
 #include "util/helpers/fspinlock.h"
 #include "config/ActiveSettings.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
+#include "Cafe/HW/Latte/Core/LatteBufferCache.h"
+#include "util/containers/flat_hash_map.hpp"
+#include <random>
 
 #define CACHE_PAGE_SIZE		0x400
 #define CACHE_PAGE_SIZE_M1	(CACHE_PAGE_SIZE-1)
 
+#define LATTE_BUFFER_CACHE_DEFRAG_MIN_FREE		(4 * 1024 * 1024) // don't bother defragmenting if less than this is free
+#define LATTE_BUFFER_CACHE_DEFRAG_MAX_BYTES		(2 * 1024 * 1024) // per frame
+
 uint32 g_currentCacheChronon = 0;
 
 template<typename TRangeData, typename TNodeObject>
@@ -268,6 +275,8 @@ public:
 std::unique_ptr<VHeap> g_gpuBufferHeap = nullptr;
 std::vector<uint8> s_pageUploadBuffer;
 std::vector<class BufferCacheNode*> s_allCacheNodes;
+uint64 s_defragRelocatedBytes = 0;
+ska::flat_hash_map<uint32, class BufferCacheNode*> s_cacheNodeByOffset; // for finding the nodes next to a free range of the heap
 
 void LatteBufferCache_removeSingleNodeFromTree(BufferCacheNode* node);
 
@@ -283,14 +292,34 @@ public:
 		cemu_assert_debug(m_hasCacheAlloc == false);
 		cemu_assert_debug(m_rangeEnd > m_rangeBegin);
 		m_hasCacheAlloc = g_gpuBufferHeap->allocOffset(m_rangeEnd - m_rangeBegin, CACHE_PAGE_SIZE, m_cacheOffset);
+		if (m_hasCacheAlloc)
+			s_cacheNodeByOffset.emplace(m_cacheOffset, this);
 		return m_hasCacheAlloc;
 	}
 
+	// move the cached data into a free range smaller than maxFreeRangeSize, returns false if there is none
+	// the old memory is only released after the current drawcall, the same as for deleted nodes
+	bool relocateCacheMemory(uint32 maxFreeRangeSize)
+	{
+		cemu_assert_debug(m_hasCacheAlloc);
+		uint32 size = m_rangeEnd - m_rangeBegin;
+		uint32 newCacheOffset;
+		if (!g_gpuBufferHeap->allocOffsetFromSmallerRange(size, CACHE_PAGE_SIZE, maxFreeRangeSize, newCacheOffset))
+			return false;
+		g_renderer->bufferCache_copy(m_cacheOffset, newCacheOffset, size);
+		g_deallocateQueue.emplace_back(m_cacheOffset);
+		s_cacheNodeByOffset.erase(m_cacheOffset);
+		m_cacheOffset = newCacheOffset;
+		s_cacheNodeByOffset.emplace(m_cacheOffset, this);
+		return true;
+	}
+
 	void ReleaseCacheMemoryImmediately()
 	{
 		if (m_hasCacheAlloc)
 		{
 			g_gpuBufferHeap->freeOffset(m_cacheOffset);
+			s_cacheNodeByOffset.erase(m_cacheOffset);
 			m_hasCacheAlloc = false;
 		}
 	}
@@ -549,7 +578,10 @@ private:
 	~BufferCacheNode()
 	{
 		if (m_hasCacheAlloc)
+		{
 			g_deallocateQueue.emplace_back(m_cacheOffset); // release after current drawcall
+			s_cacheNodeByOffset.erase(m_cacheOffset);
+		}
 		// remove from array
 		auto temp = s_allCacheNodes.back();
 		s_allCacheNodes.pop_back();
@@ -803,6 +835,7 @@ public:
             delete it;
         s_allCacheNodes.clear();
         g_deallocateQueue.clear();
+        s_cacheNodeByOffset.clear();
     }
 
 	static void ProcessDeallocations()
@@ -935,8 +968,16 @@ BufferCacheNode* LatteBufferCache_reserveRange(MPTR physAddress, uint32 size)
 }
 
 
+// ranges which are already cached are not read again unless they change, so a starting capture needs their current contents
+void LatteBufferCache_recordCachedRanges()
+{
+	for (auto& node : s_allCacheNodes)
+		LatteCapture_RecordMemory(node->GetRangeBegin(), node->GetRangeEnd() - node->GetRangeBegin());
+}
+
 uint32 LatteBufferCache_retrieveDataInCache(MPTR physAddress, uint32 size)
 {
+	LatteCapture_RecordMemory(physAddress, size);
 	auto range = LatteBufferCache_reserveRange(physAddress, size);
 	range->flagInUse();
 
@@ -1002,6 +1043,12 @@ void LatteBufferCache_getStats(uint32& heapSize, uint32& allocationSize, uint32&
 	g_gpuBufferHeap->getStats(heapSize, allocationSize, allocNum);
 }
 
+void LatteBufferCache_getFragmentationStats(uint32& largestFreeRange, uint32& freeRangeCount, uint64& relocatedBytes)
+{
+	g_gpuBufferHeap->getFragmentationStats(largestFreeRange, freeRangeCount);
+	relocatedBytes = s_defragRelocatedBytes;
+}
+
 FSpinlock g_spinlockDCFlushQueue;
 
 class SparseBitset
@@ -1097,6 +1144,7 @@ void LatteBufferCache_notifySwapTVScanBuffer()
 {
 	if( ActiveSettings::FlushGPUCacheOnSwap() )
 		g_currentCacheChronon++;
+	LatteBufferCache_incrementalDefragment();
 }
 
 void LatteBufferCache_incrementalCleanup()
@@ -1156,3 +1204,186 @@ void LatteBufferCache_incrementalCleanup()
 		}
 	}
 }
+
+// returns true if the free space of the heap is split up enough that it is worth moving ranges around
+bool _LatteBufferCache_isHeapFragmented(VHeap* heap)
+{
+	uint32 heapSize, allocationSize, allocNum;
+	heap->getStats(heapSize, allocationSize, allocNum);
+	uint32 largestFreeRange, freeRangeCount;
+	heap->getFragmentationStats(largestFreeRange, freeRangeCount);
+	uint32 freeSize = heapSize - allocationSize;
+	if (freeSize < LATTE_BUFFER_CACHE_DEFRAG_MIN_FREE || freeRangeCount < 2)
+		return false;
+	return largestFreeRange < freeSize / 2;
+}
+
+// relocates the allocations next to the largest free range of the heap into smaller free ranges, which lets the largest free range grow
+// relocate(offset, maxFreeRangeSize) returns the number of bytes moved or zero if the allocation can't be moved
+template<typename TRelocate>
+uint32 _LatteBufferCache_growLargestFreeRange(VHeap* heap, uint32 maxBytes, TRelocate relocate)
+{
+	uint32 bytesRelocated = 0;
+	while (bytesRelocated < maxBytes)
+	{
+		uint32 freeOffset, freeSize, prevAllocationOffset, nextAllocationOffset;
+		if (!heap->getLargestFreeRange(freeOffset, freeSize, prevAllocationOffset, nextAllocationOffset))
+			break;
+		uint32 movedBytes = 0;
+		if (nextAllocationOffset != 0xFFFFFFFF)
+			movedBytes = relocate(nextAllocationOffset, freeSize - 1);
+		if (movedBytes == 0 && prevAllocationOffset != 0xFFFFFFFF)
+			movedBytes = relocate(prevAllocationOffset, freeSize - 1);
+		if (movedBytes == 0)
+			break;
+		bytesRelocated += movedBytes;
+	}
+	return bytesRelocated;
+}
+
+// called once per frame, in between drawcalls. Over long sessions the buffer cache heap gets fragmented by ranges of different sizes being
+// created and dropped, until larger ranges no longer fit and CleanupCacheAggressive() has to drop everything
+// to counter this, cold ranges bordering the largest free range are moved into holes elsewhere so the largest free range keeps growing
+// the memory of moved ranges is queued for deallocation, so the free range grows by at most one neighbour per side each frame
+void LatteBufferCache_incrementalDefragment()
+{
+	if (s_allCacheNodes.empty() || !_LatteBufferCache_isHeapFragmented(g_gpuBufferHeap.get()))
+		return;
+	BufferCacheNode::ProcessDeallocations(); // queued ranges would block the free range from growing
+	s_defragRelocatedBytes += _LatteBufferCache_growLargestFreeRange(g_gpuBufferHeap.get(), LATTE_BUFFER_CACHE_DEFRAG_MAX_BYTES, [](uint32 offset, uint32 maxFreeRangeSize) -> uint32
+		{
+			auto it = s_cacheNodeByOffset.find(offset);
+			if (it == s_cacheNodeByOffset.end())
+				return 0;
+			BufferCacheNode* node = it->second;
+			if (node->GetFrameAge() < 2)
+				return 0; // only move cold ranges
+			if (!node->relocateCacheMemory(maxFreeRangeSize))
+				return 0;
+			return node->GetRangeEnd() - node->GetRangeBegin();
+		});
+}
+
+// CPU-only simulation of the buffer cache heap usage pattern, used to compare fragmentation with and without defragmentation
+// ranges of random sizes are created and cold ranges are dropped once the heap is mostly filled (like incremental cleanup does)
+// an allocation failure corresponds to the aggressive cleanup which drops the whole cache
+// like relocateCacheMemory(), the old memory of relocated ranges is only freed at the start of the next frame
+void LatteBufferCache_RunHeapSimulation(uint32 numFrames)
+{
+	constexpr uint32 simHeapSize = 256 * 1024 * 1024;
+	for (bool useDefrag : { false, true })
+	{
+		VHeap heap(nullptr, simHeapSize);
+		struct SimRange
+		{
+			uint32 offset;
+			uint32 size;
+			uint32 lastFrame;
+		};
+		std::vector<SimRange> ranges;
+		std::unordered_map<uint32, size_t> rangeIndexByOffset;
+		std::vector<uint32> deallocateQueue; // old offsets of relocated ranges
+		auto processDeallocations = [&]() {
+			for (uint32 offset : deallocateQueue)
+				heap.freeOffset(offset);
+			deallocateQueue.clear();
+		};
+		auto removeRange = [&](size_t index) {
+			heap.freeOffset(ranges[index].offset);
+			rangeIndexByOffset.erase(ranges[index].offset);
+			if (index != ranges.size() - 1)
+			{
+				ranges[index] = ranges.back();
+				rangeIndexByOffset[ranges[index].offset] = index;
+			}
+			ranges.pop_back();
+		};
+		std::mt19937 rng(0x1234);
+		uint32 numFullDrops = 0;
+		uint32 numFragmentationDrops = 0;
+		uint64 relocatedBytes = 0;
+		uint32 peakAllocated = 0;
+		auto beginTime = std::chrono::steady_clock::now();
+		for (uint32 frame = 0; frame < numFrames; frame++)
+		{
+			processDeallocations();
+			// new ranges, mostly small with occasional large ones (streamed area data)
+			uint32 numNewRanges = 20 + (rng() % 40);
+			for (uint32 i = 0; i < numNewRanges; i++)
+			{
+				uint32 sizeClass = rng() % 100;
+				uint32 size;
+				if (sizeClass < 80)
+					size = (1 + rng() % 16) * CACHE_PAGE_SIZE;
+				else if (sizeClass < 98)
+					size = (16 + rng() % 256) * CACHE_PAGE_SIZE;
+				else
+					size = (256 + rng() % 4096) * CACHE_PAGE_SIZE;
+				uint32 offset;
+				bool allocated = heap.allocOffset(size, CACHE_PAGE_SIZE, offset);
+				if (!allocated && !ranges.empty())
+				{
+					// drop everything, this is what happens in CleanupCacheAggressive()
+					uint32 heapSize, allocationSize, allocNum;
+					heap.getStats(heapSize, allocationSize, allocNum);
+					numFullDrops++;
+					if (heapSize - allocationSize >= size)
+						numFragmentationDrops++; // enough space would be available if it wasn't fragmented
+					while (!ranges.empty())
+						removeRange(ranges.size() - 1);
+					processDeallocations();
+					allocated = heap.allocOffset(size, CACHE_PAGE_SIZE, offset);
+				}
+				if (allocated)
+				{
+					rangeIndexByOffset[offset] = ranges.size();
+					ranges.push_back({ offset, size, frame });
+				}
+			}
+			// touch some older ranges to keep them alive
+			for (uint32 i = 0; i < 10 && !ranges.empty(); i++)
+				ranges[rng() % ranges.size()].lastFrame = frame;
+			// drop cold ranges once the heap is 85% full
+			uint32 heapSize, allocationSize, allocNum;
+			heap.getStats(heapSize, allocationSize, allocNum);
+			peakAllocated = std::max(peakAllocated, allocationSize);
+			for (size_t i = 0; i < ranges.size() && allocationSize >= heapSize / 100 * 85;)
+			{
+				if (frame - ranges[i].lastFrame >= 4)
+				{
+					allocationSize -= ranges[i].size;
+					removeRange(i);
+					continue;
+				}
+				i++;
+			}
+			if (useDefrag && _LatteBufferCache_isHeapFragmented(&heap))
+			{
+				relocatedBytes += _LatteBufferCache_growLargestFreeRange(&heap, LATTE_BUFFER_CACHE_DEFRAG_MAX_BYTES, [&](uint32 offset, uint32 maxFreeRangeSize) -> uint32
+					{
+						auto it = rangeIndexByOffset.find(offset);
+						if (it == rangeIndexByOffset.end())
+							return 0;
+						SimRange& range = ranges[it->second];
+						if (frame - range.lastFrame < 2)
+							return 0;
+						uint32 newOffset;
+						if (!heap.allocOffsetFromSmallerRange(range.size, CACHE_PAGE_SIZE, maxFreeRangeSize, newOffset))
+							return 0;
+						deallocateQueue.emplace_back(range.offset);
+						size_t index = it->second;
+						rangeIndexByOffset.erase(it);
+						range.offset = newOffset;
+						rangeIndexByOffset[newOffset] = index;
+						return range.size;
+					});
+			}
+		}
+		double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count();
+		uint32 largestFreeRange, freeRangeCount;
+		heap.getFragmentationStats(largestFreeRange, freeRangeCount);
+		cemuLog_log(LogType::Force, "Buffer heap simulation ({} frames, defragmentation {}): {:.1f}ms", numFrames, useDefrag ? "on" : "off", elapsedMs);
+		cemuLog_log(LogType::Force, "  Full cache drops: {} (caused by fragmentation: {}) Peak allocated: {}MB Free ranges at end: {} Relocated: {}MB",
+			numFullDrops, numFragmentationDrops, peakAllocated / 1024 / 1024, freeRangeCount, relocatedBytes / 1024 / 1024);
+	}
+}
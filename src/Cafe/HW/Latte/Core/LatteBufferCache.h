@@ -12,7 +12,12 @@ void LatteBufferCache_processDCFlushQueue();
 
 void LatteBufferCache_processDeallocations();
 void LatteBufferCache_incrementalCleanup();
+void LatteBufferCache_incrementalDefragment();
 
 void LatteBufferCache_getStats(uint32& heapSize, uint32& allocationSize, uint32& allocNum);
+void LatteBufferCache_getFragmentationStats(uint32& largestFreeRange, uint32& freeRangeCount, uint64& relocatedBytes);
+
+void LatteBufferCache_RunHeapSimulation(uint32 numFrames); // for profiling
+void LatteBufferCache_recordCachedRanges(); // writes the guest memory of all cached ranges to the active GPU capture
 
 void LatteBufferCache_notifySwapTVScanBuffer();
\ No newline at end of file
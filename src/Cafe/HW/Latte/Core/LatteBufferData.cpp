@@ -152,6 +152,7 @@ void LatteBufferCache_syncGPUUniformBuffers(LatteDecompilerShader* shader, const
 // upload vertex and uniform buffers
 bool LatteBufferCache_Sync(uint32 minIndex, uint32 maxIndex, uint32 baseInstance, uint32 instanceCount)
 {
+	LATTE_PROFILE_SCOPE(BufferCache);
 	static uint32 s_syncBufferCounter = 0;
 
 	s_syncBufferCounter++;
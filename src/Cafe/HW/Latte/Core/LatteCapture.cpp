@@ -0,0 +1,440 @@
+#include "Cafe/HW/Latte/Core/Latte.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
+#include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
+#include "Cafe/HW/Latte/Core/LatteTexture.h"
+#include "Cafe/HW/Latte/Core/LatteBufferCache.h"
+#include "Cafe/HW/Latte/Renderer/Null/NullRenderer.h"
+#include "Cafe/HW/MMU/MMU.h"
+#include "util/containers/flat_hash_map.hpp"
+#include "Common/FileStream.h"
+
+sint32 LatteCP_processRingPacket(uint32 itHeader, uint32be* cmd, uint32 nWords);
+
+#define CAPTURE_FILE_MAGIC		0x5041434C // 'LCAP'
+#define CAPTURE_FILE_VERSION	1
+
+enum class CAPTURE_EVENT : uint32
+{
+	END = 0,
+	MEMORY = 1, // physAddr, size, data (padded to 4 byte alignment)
+	RING_PACKET = 2, // itHeader, nWords, data
+	FRAME_END = 3,
+};
+
+struct LatteCaptureFileHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 numFrames;
+	uint32 numRegisters;
+	// followed by contextRegister[numRegisters], contextRegisterShadowAddr[numRegisters], contextControl0 and then the event stream
+};
+
+static_assert(sizeof(LatteCaptureFileHeader) == 16);
+
+bool g_latteCaptureActive = false;
+bool g_latteReplayActive = false;
+
+struct
+{
+	// request from UI thread
+	std::mutex requestMutex;
+	fs::path requestedPath;
+	uint32 requestedFrames{};
+	std::atomic_bool hasRequest{};
+	// active capture, only accessed from GPU thread
+	FileStream* file{};
+	fs::path path;
+	uint32 numFramesTotal{};
+	uint32 numFramesCaptured{};
+	uint64 bytesWritten{};
+	std::vector<uint32be> pendingPacket; // ring packet which is written once all the memory it reads is known
+	ska::flat_hash_map<uint64, size_t> memoryHashes; // last recorded contents per range
+}s_capture;
+
+void LatteCapture_Request(const fs::path& path, uint32 numFrames)
+{
+	std::unique_lock _l(s_capture.requestMutex);
+	s_capture.requestedPath = path;
+	s_capture.requestedFrames = std::max<uint32>(numFrames, 1);
+	s_capture.hasRequest = true;
+}
+
+void _LatteCapture_WriteData(const void* data, uint32 size)
+{
+	s_capture.file->writeData(data, (sint32)size);
+	s_capture.bytesWritten += size;
+}
+
+void _LatteCapture_WriteU32(uint32 v)
+{
+	_LatteCapture_WriteData(&v, sizeof(uint32));
+}
+
+void _LatteCapture_FlushPendingPacket()
+{
+	if (s_capture.pendingPacket.empty())
+		return;
+	_LatteCapture_WriteU32((uint32)CAPTURE_EVENT::RING_PACKET);
+	_LatteCapture_WriteU32(s_capture.pendingPacket[0]);
+	_LatteCapture_WriteU32((uint32)s_capture.pendingPacket.size() - 1);
+	if (s_capture.pendingPacket.size() > 1)
+		_LatteCapture_WriteData(s_capture.pendingPacket.data() + 1, (uint32)(s_capture.pendingPacket.size() - 1) * sizeof(uint32be));
+	s_capture.pendingPacket.clear();
+}
+
+// textures and buffers which are already cached are only read from guest memory again when they change
+// so their current contents are recorded up front, otherwise the replay would see whatever is in memory at that time
+void _LatteCapture_RecordCachedMemory()
+{
+	for (LatteTexture* tex : LatteTexture::GetAllTextures())
+	{
+		if (!tex || !tex->sliceMipInfo)
+			continue;
+		for (sint32 mipIndex = 0; mipIndex < tex->mipLevels; mipIndex++)
+		{
+			// slices of a mip are stored consecutively
+			uint32 addrStart = 0xFFFFFFFF;
+			uint32 addrEnd = 0;
+			for (sint32 sliceIndex = 0; sliceIndex < tex->GetMipDepth(mipIndex); sliceIndex++)
+			{
+				LatteTextureSliceMipInfo* sliceMipInfo = tex->GetSliceMipArrayEntry(sliceIndex, mipIndex);
+				addrStart = std::min(addrStart, sliceMipInfo->addrStart);
+				addrEnd = std::max(addrEnd, sliceMipInfo->addrEnd);
+			}
+			if (addrStart < addrEnd)
+				LatteCapture_RecordMemoryInternal(addrStart, addrEnd - addrStart);
+		}
+	}
+	LatteBufferCache_recordCachedRanges();
+}
+
+void _LatteCapture_Begin()
+{
+	fs::path path;
+	{
+		std::unique_lock _l(s_capture.requestMutex);
+		path = s_capture.requestedPath;
+		s_capture.numFramesTotal = s_capture.requestedFrames;
+		s_capture.hasRequest = false;
+	}
+	std::error_code ec;
+	fs::create_directories(path.parent_path(), ec);
+	s_capture.file = FileStream::createFile2(path);
+	if (!s_capture.file)
+	{
+		cemuLog_log(LogType::Force, "GPU capture: Unable to create file {}", _pathToUtf8(path));
+		return;
+	}
+	s_capture.path = path;
+	s_capture.numFramesCaptured = 0;
+	s_capture.bytesWritten = 0;
+	s_capture.pendingPacket.clear();
+	s_capture.memoryHashes.clear();
+	LatteCaptureFileHeader header{};
+	header.magic = CAPTURE_FILE_MAGIC;
+	header.version = CAPTURE_FILE_VERSION;
+	header.numFrames = 0; // updated when the capture is finished
+	header.numRegisters = LATTE_MAX_REGISTER;
+	_LatteCapture_WriteData(&header, sizeof(header));
+	_LatteCapture_WriteData(LatteGPUState.contextRegister, sizeof(LatteGPUState.contextRegister));
+	_LatteCapture_WriteData(LatteGPUState.contextRegisterShadowAddr, sizeof(LatteGPUState.contextRegisterShadowAddr));
+	_LatteCapture_WriteU32(LatteGPUState.contextControl0);
+	g_latteCaptureActive = true;
+	_LatteCapture_RecordCachedMemory();
+	cemuLog_log(LogType::Force, "GPU capture: Recording {} frames to {}", s_capture.numFramesTotal, _pathToUtf8(path));
+}
+
+void _LatteCapture_End()
+{
+	_LatteCapture_FlushPendingPacket();
+	_LatteCapture_WriteU32((uint32)CAPTURE_EVENT::END);
+	// patch frame count in header
+	s_capture.file->SetPosition(offsetof(LatteCaptureFileHeader, numFrames));
+	s_capture.file->writeU32(s_capture.numFramesCaptured);
+	delete s_capture.file;
+	s_capture.file = nullptr;
+	g_latteCaptureActive = false;
+	s_capture.pendingPacket.clear();
+	s_capture.memoryHashes.clear();
+	cemuLog_log(LogType::Force, "GPU capture: Finished recording {} frames ({} MiB)", s_capture.numFramesCaptured, (s_capture.bytesWritten + 1024 * 1024 - 1) / (1024 * 1024));
+}
+
+// captures always cover whole frames
+void LatteCapture_NotifyFrameEnd()
+{
+	if (g_latteReplayActive)
+		return;
+	if (g_latteCaptureActive)
+	{
+		_LatteCapture_FlushPendingPacket();
+		_LatteCapture_WriteU32((uint32)CAPTURE_EVENT::FRAME_END);
+		s_capture.numFramesCaptured++;
+		if (s_capture.numFramesCaptured >= s_capture.numFramesTotal)
+			_LatteCapture_End();
+		return;
+	}
+	if (s_capture.hasRequest.load(std::memory_order_relaxed))
+		_LatteCapture_Begin();
+}
+
+void LatteCapture_RecordRingPacket(uint32 itHeader, const uint32be* data, uint32 nWords)
+{
+	cemu_assert_debug(g_latteCaptureActive);
+	_LatteCapture_FlushPendingPacket();
+	s_capture.pendingPacket.emplace_back(itHeader);
+	s_capture.pendingPacket.insert(s_capture.pendingPacket.end(), data, data + nWords);
+}
+
+void LatteCapture_RecordMemoryInternal(MPTR physAddr, uint32 size)
+{
+	if (size == 0 || !memory_isAddressRangeAccessible(memory_physicalToVirtual(physAddr), size))
+		return;
+	const uint8* data = memory_getPointerFromPhysicalOffset(physAddr);
+	// only store ranges whose content changed since they were last recorded
+	size_t hash = std::hash<std::string_view>{}(std::string_view((const char*)data, size));
+	uint64 rangeKey = ((uint64)physAddr << 32) | size;
+	auto it = s_capture.memoryHashes.find(rangeKey);
+	if (it != s_capture.memoryHashes.end() && it->second == hash)
+		return;
+	s_capture.memoryHashes[rangeKey] = hash;
+	_LatteCapture_WriteU32((uint32)CAPTURE_EVENT::MEMORY);
+	_LatteCapture_WriteU32(physAddr);
+	_LatteCapture_WriteU32(size);
+	_LatteCapture_WriteData(data, size);
+	static const uint8 s_padding[4]{};
+	if ((size & 3) != 0)
+		_LatteCapture_WriteData(s_padding, 4 - (size & 3));
+}
+
+class LatteCaptureReader
+{
+public:
+	LatteCaptureReader(std::vector<uint8>& data) : m_data(data) {};
+
+	bool ReadU32(uint32& v)
+	{
+		if (m_offset + 4 > m_data.size())
+			return false;
+		v = *(uint32*)(m_data.data() + m_offset);
+		m_offset += 4;
+		return true;
+	}
+
+	uint8* Read(uint32 size)
+	{
+		if (m_offset + size > m_data.size())
+			return nullptr;
+		uint8* p = m_data.data() + m_offset;
+		m_offset += (size + 3) & ~3;
+		return p;
+	}
+
+	void SetOffset(size_t offset)
+	{
+		m_offset = offset;
+	}
+
+	size_t GetOffset() const
+	{
+		return m_offset;
+	}
+
+private:
+	std::vector<uint8>& m_data;
+	size_t m_offset{};
+};
+
+struct LatteReplayPacketStats
+{
+	uint64 count{};
+	uint64 ticks{};
+};
+
+struct LatteReplayCounters
+{
+	uint64 drawCalls{};
+	uint64 fastDrawCalls{};
+	uint64 vertexDataUploaded{};
+	uint64 vertexDataCached{};
+	uint64 uniformBankUploadedData{};
+	uint64 indexDataUploaded{};
+	uint64 indexDataCached{};
+
+	static LatteReplayCounters FromCurrentCycle()
+	{
+		auto& cycle = performanceMonitor.cycle[performanceMonitor.cycleIndex];
+		LatteReplayCounters c;
+		c.drawCalls = cycle.drawCallCounter;
+		c.fastDrawCalls = cycle.fastDrawCallCounter;
+		c.vertexDataUploaded = cycle.vertexDataUploaded;
+		c.vertexDataCached = cycle.vertexDataCached;
+		c.uniformBankUploadedData = cycle.uniformBankUploadedData;
+		c.indexDataUploaded = cycle.indexDataUploaded;
+		c.indexDataCached = cycle.indexDataCached;
+		return c;
+	}
+
+	void AddDelta(const LatteReplayCounters& before, const LatteReplayCounters& after, bool cycleChanged)
+	{
+		// the performance monitor resets its counters once per second
+		const LatteReplayCounters& base = cycleChanged ? LatteReplayCounters{} : before;
+		drawCalls += after.drawCalls - base.drawCalls;
+		fastDrawCalls += after.fastDrawCalls - base.fastDrawCalls;
+		vertexDataUploaded += after.vertexDataUploaded - base.vertexDataUploaded;
+		vertexDataCached += after.vertexDataCached - base.vertexDataCached;
+		uniformBankUploadedData += after.uniformBankUploadedData - base.uniformBankUploadedData;
+		indexDataUploaded += after.indexDataUploaded - base.indexDataUploaded;
+		indexDataCached += after.indexDataCached - base.indexDataCached;
+	}
+};
+
+std::string _LatteCapture_GetPacketName(uint32 packetKey)
+{
+	if (packetKey == 0x100)
+		return "TYPE0";
+	if (packetKey == 0x200)
+		return "FILLER";
+	return fmt::format("IT_{:02x}", packetKey);
+}
+
+bool LatteCapture_Replay(const fs::path& path, uint32 numLoops)
+{
+	auto fileData = FileStream::LoadIntoMemory(path);
+	if (!fileData)
+	{
+		cemuLog_log(LogType::Force, "GPU replay: Unable to open {}", _pathToUtf8(path));
+		return false;
+	}
+	LatteCaptureReader reader(*fileData);
+	LatteCaptureFileHeader* header = (LatteCaptureFileHeader*)reader.Read(sizeof(LatteCaptureFileHeader));
+	if (!header || header->magic != CAPTURE_FILE_MAGIC || header->version != CAPTURE_FILE_VERSION || header->numRegisters != LATTE_MAX_REGISTER)
+	{
+		cemuLog_log(LogType::Force, "GPU replay: {} is not a valid capture file", _pathToUtf8(path));
+		return false;
+	}
+	uint32* initialRegisters = (uint32*)reader.Read(sizeof(LatteGPUState.contextRegister));
+	MPTR* initialShadowAddr = (MPTR*)reader.Read(sizeof(LatteGPUState.contextRegisterShadowAddr));
+	uint32 initialContextControl0;
+	if (!initialRegisters || !initialShadowAddr || !reader.ReadU32(initialContextControl0))
+		return false;
+	const size_t eventStreamOffset = reader.GetOffset();
+
+	cemuLog_log(LogType::Force, "GPU replay: Replaying {} frames from {}", header->numFrames, _pathToUtf8(path));
+	g_latteReplayActive = true;
+	std::map<uint32, LatteReplayPacketStats> packetStats;
+	LatteReplayCounters counters;
+	std::vector<uint64> frameTicks;
+	uint64 memoryBytesRestored = 0;
+	uint32 memoryRangesSkipped = 0;
+	bool isValid = true;
+	for (uint32 loop = 0; loop < numLoops && isValid; loop++)
+	{
+		memcpy(LatteGPUState.contextRegister, initialRegisters, sizeof(LatteGPUState.contextRegister));
+		memcpy(LatteGPUState.contextRegisterShadowAddr, initialShadowAddr, sizeof(LatteGPUState.contextRegisterShadowAddr));
+		LatteGPUState.contextControl0 = initialContextControl0;
+		LatteGPUState.pipelineStateDirtyMask = Latte::PIPELINE_STATE_ALL;
+		reader.SetOffset(eventStreamOffset);
+		uint64 frameStartTick = PPCTimer_getRawTsc();
+		while (true)
+		{
+			uint32 eventType;
+			if (!reader.ReadU32(eventType))
+			{
+				isValid = false;
+				break;
+			}
+			if (eventType == (uint32)CAPTURE_EVENT::END)
+				break;
+			if (eventType == (uint32)CAPTURE_EVENT::MEMORY)
+			{
+				uint32 physAddr, size;
+				uint8* data;
+				if (!reader.ReadU32(physAddr) || !reader.ReadU32(size) || !(data = reader.Read(size)))
+				{
+					isValid = false;
+					break;
+				}
+				if (!memory_isAddressRangeAccessible(memory_physicalToVirtual(physAddr), size))
+				{
+					memoryRangesSkipped++;
+					continue;
+				}
+				memcpy(memory_getPointerFromPhysicalOffset(physAddr), data, size);
+				memoryBytesRestored += size;
+			}
+			else if (eventType == (uint32)CAPTURE_EVENT::RING_PACKET)
+			{
+				uint32 itHeader, nWords;
+				uint8* data;
+				if (!reader.ReadU32(itHeader) || !reader.ReadU32(nWords) || !(data = reader.Read(nWords * sizeof(uint32be))))
+				{
+					isValid = false;
+					break;
+				}
+				uint32 itHeaderType = (itHeader >> 30) & 3;
+				uint32 packetKey = itHeaderType == 3 ? ((itHeader >> 8) & 0xFF) : (itHeaderType << 8);
+				sint32 cycleIndex = performanceMonitor.cycleIndex;
+				LatteReplayCounters countersBefore = LatteReplayCounters::FromCurrentCycle();
+				uint64 packetStartTick = PPCTimer_getRawTsc();
+				LatteCP_processRingPacket(itHeader, (uint32be*)data, nWords);
+				auto& stats = packetStats[packetKey];
+				stats.ticks += PPCTimer_getRawTsc() - packetStartTick;
+				stats.count++;
+				counters.AddDelta(countersBefore, LatteReplayCounters::FromCurrentCycle(), cycleIndex != performanceMonitor.cycleIndex);
+			}
+			else if (eventType == (uint32)CAPTURE_EVENT::FRAME_END)
+			{
+				uint64 frameEndTick = PPCTimer_getRawTsc();
+				frameTicks.emplace_back(frameEndTick - frameStartTick);
+				frameStartTick = frameEndTick;
+			}
+			else
+			{
+				isValid = false;
+				break;
+			}
+		}
+	}
+	g_latteReplayActive = false;
+	if (!isValid)
+	{
+		cemuLog_log(LogType::Force, "GPU replay: Capture file is truncated or corrupted");
+		return false;
+	}
+	// report
+	uint64 totalTicks = 0;
+	for (auto& it : packetStats)
+		totalTicks += it.second.ticks;
+	cemuLog_log(LogType::Force, "GPU replay: {} frames in {} loop(s), total packet time {:.2f}ms", frameTicks.size(), numLoops, (double)PPCTimer_tscToMicroseconds(totalTicks) / 1000.0);
+	if (!frameTicks.empty())
+	{
+		std::vector<uint64> sortedFrameTicks = frameTicks;
+		std::sort(sortedFrameTicks.begin(), sortedFrameTicks.end());
+		uint64 medianUs = PPCTimer_tscToMicroseconds(sortedFrameTicks[sortedFrameTicks.size() / 2]);
+		uint64 worstUs = PPCTimer_tscToMicroseconds(sortedFrameTicks.back());
+		cemuLog_log(LogType::Force, "Frame time: median {:.3f}ms worst {:.3f}ms", (double)medianUs / 1000.0, (double)worstUs / 1000.0);
+	}
+	cemuLog_log(LogType::Force, "Per packet type (count / total / average):");
+	for (auto& it : packetStats)
+	{
+		uint64 us = PPCTimer_tscToMicroseconds(it.second.ticks);
+		cemuLog_log(LogType::Force, "{:<8} {:>8} {:>10.3f}ms {:>8.2f}us", _LatteCapture_GetPacketName(it.first), it.second.count, (double)us / 1000.0, (double)us / (double)it.second.count);
+	}
+	cemuLog_log(LogType::Force, "Draws: {} (fast: {})", counters.drawCalls, counters.fastDrawCalls);
+	cemuLog_log(LogType::Force, "Vertex data: {}KB uploaded, {}KB cached. Uniform data: {}KB uploaded", counters.vertexDataUploaded / 1024, counters.vertexDataCached / 1024, counters.uniformBankUploadedData / 1024);
+	cemuLog_log(LogType::Force, "Index data: {}KB uploaded, {}KB cached", counters.indexDataUploaded / 1024, counters.indexDataCached / 1024);
+	uint32 bufferHeapSize, bufferAllocationSize, bufferAllocNum;
+	LatteBufferCache_getStats(bufferHeapSize, bufferAllocationSize, bufferAllocNum);
+	cemuLog_log(LogType::Force, "Buffer cache: {} allocations, {}KB of {}KB used", bufferAllocNum, bufferAllocationSize / 1024, bufferHeapSize / 1024);
+	cemuLog_log(LogType::Force, "Texture cache: {} textures", LatteTexture_QueryCacheInfo().size());
+	cemuLog_log(LogType::Force, "Guest memory restored: {}KB ({} ranges skipped)", memoryBytesRestored / 1024, memoryRangesSkipped);
+	if (g_renderer->GetType() == RendererAPI::Null)
+	{
+		const NullRendererStats& nullStats = NullRenderer::GetInstance()->GetStats();
+		cemuLog_log(LogType::Force, "Host resources: {} textures ({}MB), {} views, {} shaders, {} pipelines, {} FBOs", nullStats.numTextures, nullStats.textureMemory / 1024 / 1024, nullStats.numTextureViews, nullStats.numShaders, nullStats.numPipelines, nullStats.numCachedFBOs);
+		cemuLog_log(LogType::Force, "Host draws: {} ({} skipped, {} indexed), {} vertices, {} texture copies, {} readbacks", nullStats.numDraws, nullStats.numSkippedDraws, nullStats.numIndexedDraws, nullStats.numVertices, nullStats.numTextureCopies, nullStats.numReadbacks);
+		cemuLog_log(LogType::Force, "Host uploads: {}KB texture data, {}KB buffer data", nullStats.textureDataUploaded / 1024, nullStats.bufferDataUploaded / 1024);
+	}
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// GPU command stream capture
+// Records the ring buffer packets, the initial register state and every range of guest memory the GPU thread reads while processing them
+// Captures start and end at frame boundaries and can be replayed without the CPU side of the emulator
+
+extern bool g_latteCaptureActive;
+extern bool g_latteReplayActive;
+
+inline bool LatteCapture_IsCapturing()
+{
+	return g_latteCaptureActive;
+}
+
+// while replaying there is no CPU side, commands which wait for or notify the CPU are skipped
+inline bool LatteCapture_IsReplaying()
+{
+	return g_latteReplayActive;
+}
+
+void LatteCapture_Request(const fs::path& path, uint32 numFrames);
+void LatteCapture_NotifyFrameEnd();
+void LatteCapture_RecordRingPacket(uint32 itHeader, const uint32be* data, uint32 nWords);
+void LatteCapture_RecordMemoryInternal(MPTR physAddr, uint32 size);
+
+inline void LatteCapture_RecordMemory(MPTR physAddr, uint32 size)
+{
+	if (!g_latteCaptureActive)
+		return;
+	LatteCapture_RecordMemoryInternal(physAddr, size);
+}
+
+// replays a capture on the GPU thread and logs timing and cache statistics
+bool LatteCapture_Replay(const fs::path& path, uint32 numLoops);
@@ -11,6 +11,7 @@
 #include "Cafe/HW/Latte/Core/LatteIndices.h"
 #include "Cafe/HW/Latte/Core/LatteBufferCache.h"
 #include "Cafe/HW/Latte/Core/LattePM4.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
 #include "input/TAS/TASInput.h"
 #include "Cafe/OS/libs/snd_core/ax.h"
 
@@ -112,6 +113,11 @@ public:
 			if (physIndices == MPTR_NULL)
 				return;
 			auto indexType = LatteGPUState.contextNew.VGT_DMA_INDEX_TYPE.get_INDEX_TYPE();
+			if (LatteCapture_IsCapturing())
+			{
+				bool isU32 = indexType == Latte::LATTE_VGT_DMA_INDEX_TYPE::E_INDEX_TYPE::U32_BE || indexType == Latte::LATTE_VGT_DMA_INDEX_TYPE::E_INDEX_TYPE::U32_LE;
+				LatteCapture_RecordMemory(physIndices, count * (isU32 ? 4 : 2));
+			}
 			g_renderer->draw_execute(baseVertex, baseInstance, numInstances, count, physIndices, indexType, m_isFirstDraw);
 		}
 		else
@@ -261,6 +267,7 @@ void LatteCP_itIndirectBufferDepr(LatteCMDPtr cmd, uint32 nWords)
 	if (sizeInU32s > 0)
 	{
 		DrawPassContext drawPassCtx;
+		LatteCapture_RecordMemory(physicalAddress, sizeInU32s * 4);
 		uint32be* buf = MEMPTR<uint32be>(physicalAddress).GetPtr();
 		drawPassCtx.PushCurrentCommandQueuePos(buf, buf, buf + sizeInU32s);
 
@@ -280,6 +287,7 @@ void LatteCP_itIndirectBuffer(LatteCMDPtr cmd, uint32 nWords, DrawPassContext& d
 	if (sizeInDWords > 0)
 	{
 		uint32 displayListSize = sizeInDWords * 4;
+		LatteCapture_RecordMemory(physicalAddress, displayListSize);
 		uint32be* buf = MEMPTR<uint32be>(physicalAddress).GetPtr();
 		drawPassCtx.PushCurrentCommandQueuePos(buf, buf, buf + sizeInDWords);
 	}
@@ -318,9 +326,45 @@ LatteCMDPtr LatteCP_itStreamoutBufferUpdate(LatteCMDPtr cmd, uint32 nWords)
 	return cmd;
 }
 
+struct LattePipelineStateRegisterRange
+{
+	uint32 first;
+	uint32 last;
+	uint32 blockMask;
+};
+
+constexpr LattePipelineStateRegisterRange s_pipelineStateRegisterRanges[] =
+{
+	{ Latte::REGADDR::VGT_PRIMITIVE_TYPE, Latte::REGADDR::VGT_PRIMITIVE_TYPE, Latte::PIPELINE_STATE_PRIMITIVE },
+	{ Latte::REGADDR::CB_TARGET_MASK, Latte::REGADDR::CB_TARGET_MASK, Latte::PIPELINE_STATE_BLEND },
+	{ Latte::REGADDR::DB_STENCILREFMASK, Latte::REGADDR::DB_STENCILREFMASK_BF, Latte::PIPELINE_STATE_DEPTH_STENCIL },
+	{ Latte::REGADDR::CB_BLEND0_CONTROL, Latte::REGADDR::CB_BLEND0_CONTROL + 7, Latte::PIPELINE_STATE_BLEND },
+	{ Latte::REGADDR::DB_DEPTH_CONTROL, Latte::REGADDR::DB_DEPTH_CONTROL, Latte::PIPELINE_STATE_DEPTH_STENCIL },
+	{ Latte::REGADDR::CB_COLOR_CONTROL, Latte::REGADDR::CB_COLOR_CONTROL, Latte::PIPELINE_STATE_BLEND },
+	{ Latte::REGADDR::PA_CL_CLIP_CNTL, Latte::REGADDR::PA_CL_CLIP_CNTL, Latte::PIPELINE_STATE_PRIMITIVE | Latte::PIPELINE_STATE_RASTERIZER },
+	{ Latte::REGADDR::PA_SU_SC_MODE_CNTL, Latte::REGADDR::PA_SU_SC_MODE_CNTL, Latte::PIPELINE_STATE_RASTERIZER },
+	{ mmVGT_STRMOUT_EN, mmVGT_STRMOUT_EN, Latte::PIPELINE_STATE_PRIMITIVE },
+};
+
+// flag pipeline state blocks which are affected by a write to the register range [registerStartIndex, registerEndIndex)
+void LatteGPUState_markRegistersDirty(uint32 registerStartIndex, uint32 registerEndIndex)
+{
+	if (registerStartIndex > mmVGT_STRMOUT_EN || registerEndIndex <= Latte::REGADDR::VGT_PRIMITIVE_TYPE)
+		return;
+	for (auto& range : s_pipelineStateRegisterRanges)
+	{
+		if (registerStartIndex <= range.last && registerEndIndex > range.first)
+			LatteGPUState.pipelineStateDirtyMask |= range.blockMask;
+	}
+}
+
 template<uint32 registerBaseMode>
 void LatteCP_itSetRegistersGeneric_handleSpecialRanges(uint32 registerStartIndex, uint32 registerEndIndex)
 {
+	if constexpr (registerBaseMode == LATTE_REG_BASE_CONFIG || registerBaseMode == LATTE_REG_BASE_CONTEXT)
+	{
+		LatteGPUState_markRegistersDirty(registerStartIndex, registerEndIndex);
+	}
 	if constexpr (registerBaseMode == IT_SET_CONTEXT_REG)
 	{
 		if (registerStartIndex <= mmSQ_VTX_SEMANTIC_CLEAR && registerEndIndex >= mmSQ_VTX_SEMANTIC_CLEAR)
@@ -464,7 +508,11 @@ LatteCMDPtr LatteCP_itWaitRegMem(LatteCMDPtr cmd, uint32 nWords)
 	LatteCP_signalEnterWait();
 
 	bool stalls = false;
-	if ((word0 & 0x10) != 0)
+	if (LatteCapture_IsReplaying())
+	{
+		// the CPU side which would signal the fence doesn't exist
+	}
+	else if ((word0 & 0x10) != 0)
 	{
 		// wait for memory address
 		performanceMonitor.gpuTime_fenceTime.beginMeasuring();
@@ -599,7 +647,8 @@ LatteCMDPtr LatteCP_itEventWriteEOP(LatteCMDPtr cmd, uint32 nWords)
 	{
 		// todo - timestamp interrupt
 	}
-	TCL::TCLGPUNotifyNewRetirementTimestamp();
+	if (!LatteCapture_IsReplaying())
+		TCL::TCLGPUNotifyNewRetirementTimestamp();
 	return cmd;
 }
 
@@ -621,6 +670,8 @@ LatteCMDPtr LatteCP_itMemSemaphore(LatteCMDPtr cmd, uint32 nWords)
 	else if(SEM_SIGNAL == 7)
 	{
 		// wait
+		if (LatteCapture_IsReplaying())
+			return cmd;
 		LatteCP_signalEnterWait();
 		size_t loopCount = 0;
 		while (true)
@@ -671,7 +722,9 @@ LatteCMDPtr LatteCP_itLoadReg(LatteCMDPtr cmd, uint32 nWords, uint32 regBase)
 		uint32 regOffset = LatteReadCMD();
 		uint32 regCount = LatteReadCMD();
 		cemu_assert_debug(regCount != 0);
+		LatteCapture_RecordMemory(regShadowMemAddr, regCount * 4);
 		uint32 regAddr = regBase + regOffset;
+		LatteGPUState_markRegistersDirty(regAddr, regAddr + regCount);
 		for (uint32 f = 0; f < regCount; f++)
 		{
 			LatteGPUState.contextRegisterShadowAddr[regAddr] = regShadowMemAddr;
@@ -845,7 +898,8 @@ LatteCMDPtr LatteCP_itHLEBottomOfPipeCB(LatteCMDPtr cmd, uint32 nWords)
 	*(uint32*)memory_getPointerFromPhysicalOffset(timestampMPTR) = _swapEndianU32((uint32)(timestamp >> 32));
 	*(uint32*)memory_getPointerFromPhysicalOffset(timestampMPTR + 4) = _swapEndianU32((uint32)timestamp);
 	// send event
-	GX2::__GX2NotifyEvent(GX2::GX2CallbackEventType::TIMESTAMP_BOTTOM);
+	if (!LatteCapture_IsReplaying())
+		GX2::__GX2NotifyEvent(GX2::GX2CallbackEventType::TIMESTAMP_BOTTOM);
 	return cmd;
 }
 
@@ -951,6 +1005,8 @@ LatteCMDPtr LatteCP_itHLEWaitForFlip(LatteCMDPtr cmd, uint32 nWords)
 	catchOpenGLError();
 	cemu_assert_debug(nWords == 1);
 	MPTR reserved1 = LatteReadCMD(); // reserved
+	if (LatteCapture_IsReplaying())
+		return cmd;
 	// wait for flip
 	uint32 currentFlipCount = LatteGPUState.flipCounter;
 	while (true)
@@ -1129,6 +1185,8 @@ void LatteCP_processCommandBuffer_continuousDrawPass(DrawPassContext& drawPassCt
 
 void LatteCP_processCommandBuffer(DrawPassContext& drawPassCtx)
 {
+	// paused for commands which wait for the CPU or the next flip, so only the actual command processing is counted
+	LatteProfilerScopeTimer cpScope(LatteProfilerScope::CommandProcessor);
 	while (true)
 	{
 		LatteCMDPtr cmd, cmdStart, cmdEnd;
@@ -1244,9 +1302,11 @@ void LatteCP_processCommandBuffer(DrawPassContext& drawPassCtx)
 				}
 				case IT_WAIT_REG_MEM:
 				{
+					cpScope.Pause();
 					LatteCP_itWaitRegMem(cmdData, nWords);
 					LatteTiming_HandleTimedVsync();
 					LatteAsyncCommands_checkAndExecute();
+					cpScope.Resume();
 					break;
 				}
 				case IT_MEM_WRITE:
@@ -1261,7 +1321,9 @@ void LatteCP_processCommandBuffer(DrawPassContext& drawPassCtx)
 				}
 				case IT_MEM_SEMAPHORE:
 				{
+					cpScope.Pause();
 					LatteCP_itMemSemaphore(cmdData, nWords);
+					cpScope.Resume();
 					break;
 				}
 				case IT_LOAD_CONFIG_REG:
@@ -1306,14 +1368,18 @@ void LatteCP_processCommandBuffer(DrawPassContext& drawPassCtx)
 				}
 				case IT_HLE_TRIGGER_SCANBUFFER_SWAP:
 				{
+					cpScope.Pause();
 					LatteCP_signalEnterWait();
 					LatteCP_itHLESwapScanBuffer(cmdData, nWords);
+					cpScope.Resume();
 					break;
 				}
 				case IT_HLE_WAIT_FOR_FLIP:
 				{
+					cpScope.Pause();
 					LatteCP_signalEnterWait();
 					LatteCP_itHLEWaitForFlip(cmdData, nWords);
+					cpScope.Resume();
 					break;
 				}
 				case IT_HLE_REQUEST_SWAP_BUFFERS:
@@ -1379,7 +1445,8 @@ void LatteCP_processCommandBuffer(DrawPassContext& drawPassCtx)
 				uint32 registerCount = ((itHeader >> 16) & 0x3FFF) + 1;
 				if (registerBase == 0x304A)
 				{
-					GX2::__GX2NotifyEvent(GX2::GX2CallbackEventType::TIMESTAMP_TOP);
+					if (!LatteCapture_IsReplaying())
+						GX2::__GX2NotifyEvent(GX2::GX2CallbackEventType::TIMESTAMP_TOP);
 					LatteSkipCMD(registerCount);
 				}
 				else if (registerBase == 0x304B)
@@ -1403,304 +1470,331 @@ void LatteCP_processCommandBuffer(DrawPassContext& drawPassCtx)
 	}
 }
 
+// executes a single packet read from the ring buffer. Type 3 packets come with nWords data words
+// the register values of type 0 packets are only passed in while capturing or replaying and are not used here
+// returns an estimate of the processing cost, see CP_TIMER_RECHECK
+sint32 LatteCP_processRingPacket(uint32 itHeader, LatteCMDPtr cmd, uint32 nWords)
+{
+	sint32 timerRecheck = 0;
+	uint32 itHeaderType = (itHeader >> 30) & 3;
+	if (itHeaderType == 3)
+	{
+		uint32 itCode = (itHeader >> 8) & 0xFF;
+		switch (itCode)
+		{
+		case IT_SURFACE_SYNC:
+		{
+			LatteCP_itSurfaceSync(cmd);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+		}
+		break;
+		case IT_SET_CONTEXT_REG:
+		{
+			LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_CONTEXT>(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+		}
+		break;
+		case IT_SET_RESOURCE:
+		{
+			LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_RESOURCE>(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+		}
+		break;
+		case IT_SET_ALU_CONST:
+		{
+			LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_ALU_CONST>(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_SET_CTL_CONST:
+		{
+			LatteCP_itSetRegistersGeneric<mmSQ_VTX_BASE_VTX_LOC>(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_SET_SAMPLER:
+		{
+			LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_SAMPLER>(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_SET_CONFIG_REG:
+		{
+			LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_CONFIG>(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_INDIRECT_BUFFER_PRIV:
+		{
+			LatteCP_itIndirectBufferDepr(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_STRMOUT_BUFFER_UPDATE:
+		{
+			LatteCP_itStreamoutBufferUpdate(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_INDEX_TYPE:
+		{
+			LatteCP_itIndexType(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 1024;
+			break;
+		}
+		case IT_NUM_INSTANCES:
+		{
+			LatteCP_itNumInstances(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 1024;
+			break;
+		}
+		case IT_DRAW_INDEX_2:
+		{
+			DrawPassContext drawPassCtx;
+			drawPassCtx.beginDrawPass();
+			LatteCP_itDrawIndex2(cmd, nWords, drawPassCtx);
+			drawPassCtx.endDrawPass();
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_DRAW_INDEX_AUTO:
+		{
+			DrawPassContext drawPassCtx;
+			drawPassCtx.beginDrawPass();
+			LatteCP_itDrawIndexAuto(cmd, nWords, drawPassCtx);
+			drawPassCtx.endDrawPass();
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_DRAW_INDEX_IMMD:
+		{
+			DrawPassContext drawPassCtx;
+			drawPassCtx.beginDrawPass();
+			LatteCP_itDrawImmediate(cmd, nWords, drawPassCtx);
+			drawPassCtx.endDrawPass();
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_WAIT_REG_MEM:
+		{
+			LatteCP_itWaitRegMem(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 16;
+			break;
+		}
+		case IT_MEM_WRITE:
+		{
+			LatteCP_itMemWrite(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 128;
+			break;
+		}
+		case IT_CONTEXT_CONTROL:
+		{
+			LatteCP_itContextControl(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 128;
+			break;
+		}
+		case IT_MEM_SEMAPHORE:
+		{
+			LatteCP_itMemSemaphore(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 128;
+			break;
+		}
+		case IT_LOAD_CONFIG_REG:
+		{
+			LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_CONFIG);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_LOAD_CONTEXT_REG:
+		{
+			LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_CONTEXT);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_LOAD_ALU_CONST:
+		{
+			LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_ALU_CONST);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_LOAD_LOOP_CONST:
+		{
+			LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_LOOP_CONST);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_LOAD_RESOURCE:
+		{
+			LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_RESOURCE);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_LOAD_SAMPLER:
+		{
+			LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_SAMPLER);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_SET_LOOP_CONST:
+		{
+			// todo
+			break;
+		}
+		case IT_SET_PREDICATION:
+		{
+			LatteCP_itSetPredication(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_EVENT_WRITE_EOP:
+		{
+			LatteCP_itEventWriteEOP(cmd, nWords);
+			break;
+		}
+		case IT_HLE_COPY_COLORBUFFER_TO_SCANBUFFER:
+		{
+			LatteCP_itHLECopyColorBufferToScanBuffer(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_HLE_TRIGGER_SCANBUFFER_SWAP:
+		{
+			LatteCP_signalEnterWait();
+			LatteCP_itHLESwapScanBuffer(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 64;
+			break;
+		}
+		case IT_HLE_WAIT_FOR_FLIP:
+		{
+			LatteCP_signalEnterWait();
+			LatteCP_itHLEWaitForFlip(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 1;
+			break;
+		}
+		case IT_HLE_REQUEST_SWAP_BUFFERS:
+		{
+			LatteCP_itHLERequestSwapBuffers(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 32;
+			break;
+		}
+		case IT_HLE_CLEAR_COLOR_DEPTH_STENCIL:
+		{
+			LatteCP_itHLEClearColorDepthStencil(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 128;
+			break;
+		}
+		case IT_HLE_COPY_SURFACE_NEW:
+		{
+			LatteCP_itHLECopySurfaceNew(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 128;
+			break;
+		}
+		case IT_HLE_SAMPLE_TIMER:
+		{
+			LatteCP_itHLESampleTimer(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_HLE_SPECIAL_STATE:
+		{
+			LatteCP_itHLESpecialState(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_HLE_BEGIN_OCCLUSION_QUERY:
+		{
+			LatteCP_itHLEBeginOcclusionQuery(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_HLE_END_OCCLUSION_QUERY:
+		{
+			LatteCP_itHLEEndOcclusionQuery(cmd, nWords);
+			timerRecheck += CP_TIMER_RECHECK / 512;
+			break;
+		}
+		case IT_HLE_BOTTOM_OF_PIPE_CB:
+		{
+			LatteCP_itHLEBottomOfPipeCB(cmd, nWords);
+			break;
+		}
+		case IT_HLE_SYNC_ASYNC_OPERATIONS:
+		{
+			//LatteCP_skipWords<LatteCP_readU32Deprc>(nWords);
+			LatteTextureReadback_UpdateFinishedTransfers(true);
+			LatteQuery_UpdateFinishedQueriesForceFinishAll();
+			break;
+		}
+		default:
+			cemu_assert_debug(false);
+		}
+	}
+	else if (itHeaderType == 2)
+	{
+		// filler packet, skip this
+		cemu_assert_debug(itHeader == 0x80000000);
+	}
+	else if (itHeaderType == 0)
+	{
+		uint32 registerBase = (itHeader & 0xFFFF);
+		if (registerBase == 0x304A)
+		{
+			if (!LatteCapture_IsReplaying())
+				GX2::__GX2NotifyEvent(GX2::GX2CallbackEventType::TIMESTAMP_TOP);
+		}
+		else if (registerBase != 0x304B)
+		{
+			cemu_assert_debug(false);
+		}
+	}
+	else
+	{
+		debug_printf("invalid itHeaderType %08x\n", itHeaderType);
+		cemu_assert_debug(false);
+	}
+	return timerRecheck;
+}
+
 void LatteCP_ProcessRingbuffer()
 {
 	sint32 timerRecheck = 0; // estimates how much CP processing time has elapsed based on the executed commands, if the value exceeds CP_TIMER_RECHECK then _handleTimers() is called
 	uint32be tmpBuffer[128];
+	std::vector<uint32be> type0Payload; // only filled while capturing
 	while (true)
 	{
 		LatteCP_HandlePausePoint();
 
 		uint32 itHeader = LatteCP_readU32Deprc();
 		uint32 itHeaderType = (itHeader >> 30) & 3;
+		uint32 nWords = 0;
+		uint32be* packetData = tmpBuffer;
 		if (itHeaderType == 3)
 		{
-			uint32 itCode = (itHeader >> 8) & 0xFF;
-			uint32 nWords = ((itHeader >> 16) & 0x3FFF) + 1;
+			nWords = ((itHeader >> 16) & 0x3FFF) + 1;
 			cemu_assert(nWords < 128);
 			for (sint32 i=0; i<nWords; i++)
 			{
 				uint32 word = LatteCP_readU32Deprc();
 				tmpBuffer[i] = word;
 			}
-			LatteCMDPtr cmd = (LatteCMDPtr)tmpBuffer;
-			switch (itCode)
-			{
-			case IT_SURFACE_SYNC:
-			{
-				LatteCP_itSurfaceSync(cmd);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-			}
-			break;
-			case IT_SET_CONTEXT_REG:
-			{
-				LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_CONTEXT>(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-			}
-			break;
-			case IT_SET_RESOURCE:
-			{
-				LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_RESOURCE>(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-			}
-			break;
-			case IT_SET_ALU_CONST:
-			{
-				LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_ALU_CONST>(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_SET_CTL_CONST:
-			{
-				LatteCP_itSetRegistersGeneric<mmSQ_VTX_BASE_VTX_LOC>(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_SET_SAMPLER:
-			{
-				LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_SAMPLER>(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_SET_CONFIG_REG:
-			{
-				LatteCP_itSetRegistersGeneric<LATTE_REG_BASE_CONFIG>(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_INDIRECT_BUFFER_PRIV:
-			{
-				LatteCP_itIndirectBufferDepr(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_STRMOUT_BUFFER_UPDATE:
-			{
-				LatteCP_itStreamoutBufferUpdate(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_INDEX_TYPE:
-			{
-				LatteCP_itIndexType(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 1024;
-				break;
-			}
-			case IT_NUM_INSTANCES:
-			{
-				LatteCP_itNumInstances(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 1024;
-				break;
-			}
-			case IT_DRAW_INDEX_2:
-			{
-				DrawPassContext drawPassCtx;
-				drawPassCtx.beginDrawPass();
-				LatteCP_itDrawIndex2(cmd, nWords, drawPassCtx);
-				drawPassCtx.endDrawPass();
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_DRAW_INDEX_AUTO:
-			{
-				DrawPassContext drawPassCtx;
-				drawPassCtx.beginDrawPass();
-				LatteCP_itDrawIndexAuto(cmd, nWords, drawPassCtx);
-				drawPassCtx.endDrawPass();
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_DRAW_INDEX_IMMD:
-			{
-				DrawPassContext drawPassCtx;
-				drawPassCtx.beginDrawPass();
-				LatteCP_itDrawImmediate(cmd, nWords, drawPassCtx);
-				drawPassCtx.endDrawPass();
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_WAIT_REG_MEM:
-			{
-				LatteCP_itWaitRegMem(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 16;
-				break;
-			}
-			case IT_MEM_WRITE:
-			{
-				LatteCP_itMemWrite(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 128;
-				break;
-			}
-			case IT_CONTEXT_CONTROL:
-			{
-				LatteCP_itContextControl(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 128;
-				break;
-			}
-			case IT_MEM_SEMAPHORE:
-			{
-				LatteCP_itMemSemaphore(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 128;
-				break;
-			}
-			case IT_LOAD_CONFIG_REG:
-			{
-				LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_CONFIG);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_LOAD_CONTEXT_REG:
-			{
-				LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_CONTEXT);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_LOAD_ALU_CONST:
-			{
-				LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_ALU_CONST);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_LOAD_LOOP_CONST:
-			{
-				LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_LOOP_CONST);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_LOAD_RESOURCE:
-			{
-				LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_RESOURCE);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_LOAD_SAMPLER:
-			{
-				LatteCP_itLoadReg(cmd, nWords, LATTE_REG_BASE_SAMPLER);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_SET_LOOP_CONST:
-			{
-				// todo
-				break;
-			}
-			case IT_SET_PREDICATION:
-			{
-				LatteCP_itSetPredication(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_EVENT_WRITE_EOP:
-			{
-				LatteCP_itEventWriteEOP(cmd, nWords);
-				break;
-			}
-			case IT_HLE_COPY_COLORBUFFER_TO_SCANBUFFER:
-			{
-				LatteCP_itHLECopyColorBufferToScanBuffer(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_HLE_TRIGGER_SCANBUFFER_SWAP:
-			{
-				LatteCP_signalEnterWait();
-				LatteCP_itHLESwapScanBuffer(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 64;
-				break;
-			}
-			case IT_HLE_WAIT_FOR_FLIP:
-			{
-				LatteCP_signalEnterWait();
-				LatteCP_itHLEWaitForFlip(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 1;
-				break;
-			}
-			case IT_HLE_REQUEST_SWAP_BUFFERS:
-			{
-				LatteCP_itHLERequestSwapBuffers(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 32;
-				break;
-			}
-			case IT_HLE_CLEAR_COLOR_DEPTH_STENCIL:
-			{
-				LatteCP_itHLEClearColorDepthStencil(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 128;
-				break;
-			}
-			case IT_HLE_COPY_SURFACE_NEW:
-			{
-				LatteCP_itHLECopySurfaceNew(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 128;
-				break;
-			}
-			case IT_HLE_SAMPLE_TIMER:
-			{
-				LatteCP_itHLESampleTimer(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_HLE_SPECIAL_STATE:
-			{
-				LatteCP_itHLESpecialState(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_HLE_BEGIN_OCCLUSION_QUERY:
-			{
-				LatteCP_itHLEBeginOcclusionQuery(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_HLE_END_OCCLUSION_QUERY:
-			{
-				LatteCP_itHLEEndOcclusionQuery(cmd, nWords);
-				timerRecheck += CP_TIMER_RECHECK / 512;
-				break;
-			}
-			case IT_HLE_BOTTOM_OF_PIPE_CB:
-			{
-				LatteCP_itHLEBottomOfPipeCB(cmd, nWords);
-				break;
-			}
-			case IT_HLE_SYNC_ASYNC_OPERATIONS:
-			{
-				//LatteCP_skipWords<LatteCP_readU32Deprc>(nWords);
-				LatteTextureReadback_UpdateFinishedTransfers(true);
-				LatteQuery_UpdateFinishedQueriesForceFinishAll();
-				break;
-			}
-			default:
-				cemu_assert_debug(false);
-			}
-		}
-		else if (itHeaderType == 2)
-		{
-			// filler packet, skip this
-			cemu_assert_debug(itHeader == 0x80000000);
 		}
 		else if (itHeaderType == 0)
 		{
-			uint32 registerBase = (itHeader & 0xFFFF);
-			uint32 registerCount = ((itHeader >> 16) & 0x3FFF) + 1;
-			if (registerBase == 0x304A)
+			// the register values of type 0 packets are not used, they can be longer than the packet buffer
+			nWords = ((itHeader >> 16) & 0x3FFF) + 1;
+			if (LatteCapture_IsCapturing())
 			{
-				GX2::__GX2NotifyEvent(GX2::GX2CallbackEventType::TIMESTAMP_TOP);
-				LatteCP_skipWords<LatteCP_readU32Deprc>(registerCount);
-			}
-			else if (registerBase == 0x304B)
-			{
-				LatteCP_skipWords<LatteCP_readU32Deprc>(registerCount);
+				type0Payload.resize(nWords);
+				for (uint32 i = 0; i < nWords; i++)
+					type0Payload[i] = LatteCP_readU32Deprc();
+				packetData = type0Payload.data();
 			}
 			else
-			{
-				cemu_assert_debug(false);
-			}
-		}
-		else
-		{
-			debug_printf("invalid itHeaderType %08x\n", itHeaderType);
-			cemu_assert_debug(false);
+				LatteCP_skipWords<LatteCP_readU32Deprc>(nWords);
 		}
+		if (LatteCapture_IsCapturing())
+			LatteCapture_RecordRingPacket(itHeader, packetData, nWords);
+		timerRecheck += LatteCP_processRingPacket(itHeader, (LatteCMDPtr)packetData, nWords);
 		if (timerRecheck >= CP_TIMER_RECHECK)
 		{
 			LatteTiming_HandleTimedVsync();
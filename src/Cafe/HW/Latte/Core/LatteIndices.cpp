@@ -3,6 +3,9 @@
 #include "Cafe/HW/Latte/ISA/RegDefines.h"
 #include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
 #include "Common/cpu_features.h"
+#include "util/containers/flat_hash_map.hpp"
+
+#include <list>
 
 #if defined(ARCH_X86_64) && defined(__GNUC__)
 #include <immintrin.h>
@@ -10,55 +13,123 @@
 #include <arm_neon.h>
 #endif
 
+struct LatteIndexCacheKey
+{
+	const void* ptr; // nullptr for auto-generated indices
+	uint32 count;
+	LattePrimitiveMode primitiveMode;
+	LatteIndexType indexType;
+	uint32 primitiveRestartIndex; // affects the calculated min/max index
+
+	bool operator==(const LatteIndexCacheKey& other) const = default;
+};
+
+struct LatteIndexCacheKeyHasher
+{
+	size_t operator()(const LatteIndexCacheKey& key) const
+	{
+		uint64 h = (uint64)(uintptr_t)key.ptr;
+		h ^= ((uint64)key.count << 32) ^ ((uint64)key.primitiveRestartIndex << 8) ^ ((uint64)key.primitiveMode << 4) ^ (uint64)key.indexType;
+		h *= 0x9E3779B97F4A7C15ull;
+		return (size_t)(h ^ (h >> 32));
+	}
+};
+
+// Converted index data is kept across draws and frames. Entries are trusted until the GPU enters a wait state (LatteIndices_invalidateAll)
+// after which the source data is rehashed on the next use. Only when the hash differs is the data converted and uploaded again
+// This way static geometry is converted only once. LatteIndices_invalidate() drops entries for memory ranges which are known to have been rewritten
+#define LATTE_INDEX_CACHE_MAX_ENTRIES		(4096)
+#define LATTE_INDEX_CACHE_MAX_SIZE			(48 * 1024 * 1024) // upper limit for the total size of all cached host index buffers
+
 struct
 {
 	struct CacheEntry
 	{
-		// input data
-		const void* lastPtr;
-		uint32 lastCount;
-		LattePrimitiveMode lastPrimitiveMode;
-		LatteIndexType lastIndexType;
-		uint64 lastUsed;
+		LatteIndexCacheKey key;
+		// source data
+		uint32 sourceSize; // zero for auto-generated indices
+		uint64 sourceHash;
+		uint32 validatedEpoch; // entry can be used without rehashing while this matches currentEpoch
 		// output
 		uint32 indexMin;
 		uint32 indexMax;
 		Renderer::INDEX_TYPE renderIndexType;
 		uint32 outputCount;
+		uint32 outputSize;
 		Renderer::IndexAllocation indexAllocation;
 	};
-	std::array<CacheEntry, 8> entry;
-	uint64 currentUsageCounter{0};
+	std::list<CacheEntry> lruList; // front is the most recently used entry
+	ska::flat_hash_map<LatteIndexCacheKey, std::list<CacheEntry>::iterator, LatteIndexCacheKeyHasher> lookup;
+	size_t totalOutputSize{0};
+	uint32 currentEpoch{1};
 }LatteIndexCache{};
 
+void _LatteIndices_releaseEntry(std::list<decltype(LatteIndexCache)::CacheEntry>::iterator it)
+{
+	if (it->outputSize != 0)
+		g_renderer->indexData_releaseIndexMemory(it->indexAllocation);
+	LatteIndexCache.totalOutputSize -= it->outputSize;
+	LatteIndexCache.lookup.erase(it->key);
+	LatteIndexCache.lruList.erase(it);
+}
+
 void LatteIndices_invalidate(const void* memPtr, uint32 size)
 {
-	for(auto& entry : LatteIndexCache.entry)
+	const uint8* rangeBegin = (const uint8*)memPtr;
+	const uint8* rangeEnd = rangeBegin + size;
+	for (auto it = LatteIndexCache.lruList.begin(); it != LatteIndexCache.lruList.end();)
 	{
-		if (entry.lastPtr >= memPtr && (entry.lastPtr < ((uint8*)memPtr + size)) )
+		const uint8* entryBegin = (const uint8*)it->key.ptr;
+		const uint8* entryEnd = entryBegin + it->sourceSize;
+		if (entryBegin != nullptr && entryBegin < rangeEnd && entryEnd > rangeBegin)
 		{
-			if(entry.lastPtr != nullptr)
-				g_renderer->indexData_releaseIndexMemory(entry.indexAllocation);
-			entry.lastPtr = nullptr;
-			entry.lastCount = 0;
+			auto next = std::next(it);
+			_LatteIndices_releaseEntry(it);
+			it = next;
+			continue;
 		}
+		it++;
 	}
 }
 
 void LatteIndices_invalidateAll()
 {
-	for(auto& entry : LatteIndexCache.entry)
-	{
-		if (entry.lastPtr != nullptr)
-			g_renderer->indexData_releaseIndexMemory(entry.indexAllocation);
-		entry.lastPtr = nullptr;
-		entry.lastCount = 0;
-	}
+	// index data may have been modified while the GPU was waiting, all entries have to be revalidated before their next use
+	LatteIndexCache.currentEpoch++;
 }
 
-uint64 LatteIndices_GetNextUsageIndex()
+// release all cached index data, called on shutdown while the renderer is still valid
+void LatteIndices_unloadAll()
 {
-	return LatteIndexCache.currentUsageCounter++;
+	while (!LatteIndexCache.lruList.empty())
+		_LatteIndices_releaseEntry(LatteIndexCache.lruList.begin());
+	cemu_assert_debug(LatteIndexCache.totalOutputSize == 0);
+}
+
+// fast non-cryptographic hash used to detect modifications of the source index data
+uint64 LatteIndices_hashSourceData(const void* data, uint32 size)
+{
+	const uint8* ptr = (const uint8*)data;
+	uint64 h0 = 0x243F6A8885A308D3ull ^ size;
+	uint64 h1 = 0x13198A2E03707344ull;
+	uint64 h2 = 0xA4093822299F31D0ull;
+	uint64 h3 = 0x082EFA98EC4E6C89ull;
+	constexpr uint64 prime = 0x9E3779B185EBCA87ull;
+	while (size >= 32)
+	{
+		uint64 v[4];
+		memcpy(v, ptr, 32);
+		h0 = std::rotl((h0 ^ v[0]) * prime, 31);
+		h1 = std::rotl((h1 ^ v[1]) * prime, 31);
+		h2 = std::rotl((h2 ^ v[2]) * prime, 31);
+		h3 = std::rotl((h3 ^ v[3]) * prime, 31);
+		ptr += 32;
+		size -= 32;
+	}
+	uint64 h = h0 ^ std::rotl(h1, 17) ^ std::rotl(h2, 29) ^ std::rotl(h3, 43);
+	while (size--)
+		h = (h ^ *ptr++) * prime;
+	return h ^ (h >> 29);
 }
 
 uint32 LatteIndices_calculateIndexOutputSize(LattePrimitiveMode primitiveMode, LatteIndexType indexType, uint32 count)
@@ -260,26 +331,6 @@ void LatteIndices_unpackQuadStripAndConvert(const void* indexDataInput, void* in
 	}
 }
 
-template<typename T>
-void LatteIndices_unpackLineLoopAndConvert(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
-{
-	if (count <= 0)
-		return;
-	const betype<T>* src = (betype<T>*)indexDataInput;
-	T firstIndex = *src;
-	T* dst = (T*)indexDataOutput;
-	for (sint32 i = 0; i < (sint32)count; i++)
-	{
-		T idx = *src;
-		indexMin = std::min(indexMin, (uint32)idx);
-		indexMax = std::max(indexMax, (uint32)idx);
-		*dst = idx;
-		src++;
-		dst++;
-	}
-	*dst = firstIndex;
-}
-
 template<typename T>
 void LatteIndices_generateAutoQuadStripIndices(void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
 {
@@ -557,6 +608,223 @@ void LatteIndices_fastConvertU32_AVX2(const void* indexDataInput, void* indexDat
 	indexMax = std::max(indexMax, _maxIndex);
 	indexMin = std::min(indexMin, _minIndex);
 }
+
+ATTRIBUTE_SSE41
+inline void _LatteIndices_foldMinMaxU16_SSE41(__m128i mMin, __m128i mMax, uint32& indexMin, uint32& indexMax)
+{
+	// minpos only exists for min, max is calculated via the inverted values
+	uint32 vMin = (uint32)_mm_extract_epi16(_mm_minpos_epu16(mMin), 0);
+	uint32 vMax = 0xFFFF - (uint32)_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(mMax, _mm_set1_epi32(-1))), 0);
+	indexMin = std::min(indexMin, vMin);
+	indexMax = std::max(indexMax, vMax);
+}
+
+ATTRIBUTE_SSE41
+inline void _LatteIndices_foldMinMaxU32_SSE41(__m128i mMin, __m128i mMax, uint32& indexMin, uint32& indexMax)
+{
+	mMin = _mm_min_epu32(mMin, _mm_shuffle_epi32(mMin, (2 << 0) | (3 << 2) | (0 << 4) | (1 << 6)));
+	mMax = _mm_max_epu32(mMax, _mm_shuffle_epi32(mMax, (2 << 0) | (3 << 2) | (0 << 4) | (1 << 6)));
+	mMin = _mm_min_epu32(mMin, _mm_shuffle_epi32(mMin, (1 << 0) | (0 << 2) | (3 << 4) | (2 << 6)));
+	mMax = _mm_max_epu32(mMax, _mm_shuffle_epi32(mMax, (1 << 0) | (0 << 2) | (3 << 4) | (2 << 6)));
+	indexMin = std::min(indexMin, (uint32)_mm_cvtsi128_si32(mMin));
+	indexMax = std::max(indexMax, (uint32)_mm_cvtsi128_si32(mMax));
+}
+
+// the shuffle masks below combine the big-endian to little-endian swap with the primitive expansion
+// the second output vector of each step repeats its used lanes so that min/max only sees indices which are actually referenced
+
+ATTRIBUTE_SSE41
+void LatteIndices_fastUnpackQuadsU16_SSE41(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	// two quads (8 indices in, 12 indices out) per iteration
+	const uint16* src = (const uint16*)indexDataInput;
+	uint16* dst = (uint16*)indexDataOutput;
+	uint32 numQuadPairs = (count / 4) / 2;
+	if (numQuadPairs)
+	{
+		const __m128i mShufA = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 1, 0, 5, 4, 7, 6, 9, 8, 11, 10); // q0.0 q0.1 q0.2 q0.0 q0.2 q0.3 q1.0 q1.1
+		const __m128i mShufB = _mm_setr_epi8(13, 12, 9, 8, 13, 12, 15, 14, 13, 12, 9, 8, 13, 12, 15, 14); // q1.2 q1.0 q1.2 q1.3
+		__m128i mMin = _mm_set1_epi32(-1);
+		__m128i mMax = _mm_setzero_si128();
+		for (uint32 i = 0; i < numQuadPairs; i++)
+		{
+			__m128i mIndexData = _mm_loadu_si128((const __m128i*)src);
+			__m128i mOutA = _mm_shuffle_epi8(mIndexData, mShufA);
+			__m128i mOutB = _mm_shuffle_epi8(mIndexData, mShufB);
+			_mm_storeu_si128((__m128i*)dst, mOutA);
+			_mm_storel_epi64((__m128i*)(dst + 8), mOutB);
+			mMin = _mm_min_epu16(mMin, _mm_min_epu16(mOutA, mOutB));
+			mMax = _mm_max_epu16(mMax, _mm_max_epu16(mOutA, mOutB));
+			src += 8;
+			dst += 12;
+		}
+		_LatteIndices_foldMinMaxU16_SSE41(mMin, mMax, indexMin, indexMax);
+	}
+	LatteIndices_unpackQuadsAndConvert<uint16>(src, dst, count - numQuadPairs * 8, indexMin, indexMax);
+}
+
+ATTRIBUTE_SSE41
+void LatteIndices_fastUnpackQuadsU32_SSE41(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	// one quad (4 indices in, 6 indices out) per iteration
+	const uint32* src = (const uint32*)indexDataInput;
+	uint32* dst = (uint32*)indexDataOutput;
+	uint32 numQuads = count / 4;
+	if (numQuads)
+	{
+		const __m128i mShufA = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 3, 2, 1, 0); // q.0 q.1 q.2 q.0
+		const __m128i mShufB = _mm_setr_epi8(11, 10, 9, 8, 15, 14, 13, 12, 11, 10, 9, 8, 15, 14, 13, 12); // q.2 q.3
+		__m128i mMin = _mm_set1_epi32(-1);
+		__m128i mMax = _mm_setzero_si128();
+		for (uint32 i = 0; i < numQuads; i++)
+		{
+			__m128i mIndexData = _mm_loadu_si128((const __m128i*)src);
+			__m128i mOutA = _mm_shuffle_epi8(mIndexData, mShufA);
+			__m128i mOutB = _mm_shuffle_epi8(mIndexData, mShufB);
+			_mm_storeu_si128((__m128i*)dst, mOutA);
+			_mm_storel_epi64((__m128i*)(dst + 4), mOutB);
+			mMin = _mm_min_epu32(mMin, _mm_min_epu32(mOutA, mOutB));
+			mMax = _mm_max_epu32(mMax, _mm_max_epu32(mOutA, mOutB));
+			src += 4;
+			dst += 6;
+		}
+		_LatteIndices_foldMinMaxU32_SSE41(mMin, mMax, indexMin, indexMax);
+	}
+}
+
+ATTRIBUTE_SSE41
+void LatteIndices_fastUnpackQuadStripU16_SSE41(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (count <= 3)
+		return;
+	// two quads (6 indices in, 12 indices out) per iteration. Each load reads 8 indices, the loop stops early enough to stay within the input
+	const uint16* src = (const uint16*)indexDataInput;
+	uint16* dst = (uint16*)indexDataOutput;
+	uint32 numQuads = (count - 2) / 2;
+	uint32 quadIndex = 0;
+	if ((quadIndex * 2 + 8) <= count && (quadIndex + 2) <= numQuads)
+	{
+		const __m128i mShufA = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 5, 4, 3, 2, 7, 6, 5, 4, 7, 6); // s0 s1 s2 s2 s1 s3 s2 s3
+		const __m128i mShufB = _mm_setr_epi8(9, 8, 9, 8, 7, 6, 11, 10, 9, 8, 9, 8, 7, 6, 11, 10); // s4 s4 s3 s5
+		__m128i mMin = _mm_set1_epi32(-1);
+		__m128i mMax = _mm_setzero_si128();
+		do
+		{
+			__m128i mIndexData = _mm_loadu_si128((const __m128i*)src);
+			__m128i mOutA = _mm_shuffle_epi8(mIndexData, mShufA);
+			__m128i mOutB = _mm_shuffle_epi8(mIndexData, mShufB);
+			_mm_storeu_si128((__m128i*)dst, mOutA);
+			_mm_storel_epi64((__m128i*)(dst + 8), mOutB);
+			mMin = _mm_min_epu16(mMin, _mm_min_epu16(mOutA, mOutB));
+			mMax = _mm_max_epu16(mMax, _mm_max_epu16(mOutA, mOutB));
+			src += 4;
+			dst += 12;
+			quadIndex += 2;
+		} while ((quadIndex * 2 + 8) <= count && (quadIndex + 2) <= numQuads);
+		_LatteIndices_foldMinMaxU16_SSE41(mMin, mMax, indexMin, indexMax);
+	}
+	uint32 remainingQuads = numQuads - quadIndex;
+	if (remainingQuads)
+		LatteIndices_unpackQuadStripAndConvert<uint16>(src, dst, remainingQuads * 2 + 2, indexMin, indexMax);
+}
+
+ATTRIBUTE_SSE41
+void LatteIndices_fastUnpackQuadStripU32_SSE41(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (count <= 3)
+		return;
+	// one quad (4 indices in, 6 indices out) per iteration
+	const uint32* src = (const uint32*)indexDataInput;
+	uint32* dst = (uint32*)indexDataOutput;
+	uint32 numQuads = (count - 2) / 2;
+	const __m128i mShufA = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 11, 10, 9, 8); // s0 s1 s2 s2
+	const __m128i mShufB = _mm_setr_epi8(7, 6, 5, 4, 15, 14, 13, 12, 7, 6, 5, 4, 15, 14, 13, 12); // s1 s3
+	__m128i mMin = _mm_set1_epi32(-1);
+	__m128i mMax = _mm_setzero_si128();
+	for (uint32 i = 0; i < numQuads; i++)
+	{
+		__m128i mIndexData = _mm_loadu_si128((const __m128i*)src);
+		__m128i mOutA = _mm_shuffle_epi8(mIndexData, mShufA);
+		__m128i mOutB = _mm_shuffle_epi8(mIndexData, mShufB);
+		_mm_storeu_si128((__m128i*)dst, mOutA);
+		_mm_storel_epi64((__m128i*)(dst + 4), mOutB);
+		mMin = _mm_min_epu32(mMin, _mm_min_epu32(mOutA, mOutB));
+		mMax = _mm_max_epu32(mMax, _mm_max_epu32(mOutA, mOutB));
+		src += 2;
+		dst += 6;
+	}
+	_LatteIndices_foldMinMaxU32_SSE41(mMin, mMax, indexMin, indexMax);
+}
+
+ATTRIBUTE_SSE41
+void LatteIndices_fastUnpackTriangleFanU16_SSE41(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	// output alternates between the front and the back of the input: src[0] src[n-1] src[1] src[n-2] ...
+	// four front/back pairs per iteration
+	const uint16* src = (const uint16*)indexDataInput;
+	uint16* dst = (uint16*)indexDataOutput;
+	uint32 numPairs = count / 2;
+	uint32 pairIndex = 0;
+	if (numPairs >= 4)
+	{
+		const __m128i mShuf = _mm_setr_epi8(1, 0, 15, 14, 3, 2, 13, 12, 5, 4, 11, 10, 7, 6, 9, 8);
+		__m128i mMin = _mm_set1_epi32(-1);
+		__m128i mMax = _mm_setzero_si128();
+		for (; (pairIndex + 4) <= numPairs; pairIndex += 4)
+		{
+			__m128i mFront = _mm_loadl_epi64((const __m128i*)(src + pairIndex));
+			__m128i mBack = _mm_loadl_epi64((const __m128i*)(src + count - 4 - pairIndex));
+			__m128i mOut = _mm_shuffle_epi8(_mm_unpacklo_epi64(mFront, mBack), mShuf);
+			_mm_storeu_si128((__m128i*)(dst + pairIndex * 2), mOut);
+			mMin = _mm_min_epu16(mMin, mOut);
+			mMax = _mm_max_epu16(mMax, mOut);
+		}
+		_LatteIndices_foldMinMaxU16_SSE41(mMin, mMax, indexMin, indexMax);
+	}
+	for (uint32 i = pairIndex * 2; i < count; i++)
+	{
+		uint32 i0 = (i % 2 == 0) ? (i / 2) : (count - 1 - i / 2);
+		uint16 idx = _swapEndianU16(src[i0]);
+		indexMin = std::min(indexMin, (uint32)idx);
+		indexMax = std::max(indexMax, (uint32)idx);
+		dst[i] = idx;
+	}
+}
+
+ATTRIBUTE_SSE41
+void LatteIndices_fastUnpackTriangleFanU32_SSE41(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	// two front/back pairs per iteration
+	const uint32* src = (const uint32*)indexDataInput;
+	uint32* dst = (uint32*)indexDataOutput;
+	uint32 numPairs = count / 2;
+	uint32 pairIndex = 0;
+	if (numPairs >= 2)
+	{
+		const __m128i mShuf = _mm_setr_epi8(3, 2, 1, 0, 15, 14, 13, 12, 7, 6, 5, 4, 11, 10, 9, 8);
+		__m128i mMin = _mm_set1_epi32(-1);
+		__m128i mMax = _mm_setzero_si128();
+		for (; (pairIndex + 2) <= numPairs; pairIndex += 2)
+		{
+			__m128i mFront = _mm_loadl_epi64((const __m128i*)(src + pairIndex));
+			__m128i mBack = _mm_loadl_epi64((const __m128i*)(src + count - 2 - pairIndex));
+			__m128i mOut = _mm_shuffle_epi8(_mm_unpacklo_epi64(mFront, mBack), mShuf);
+			_mm_storeu_si128((__m128i*)(dst + pairIndex * 2), mOut);
+			mMin = _mm_min_epu32(mMin, mOut);
+			mMax = _mm_max_epu32(mMax, mOut);
+		}
+		_LatteIndices_foldMinMaxU32_SSE41(mMin, mMax, indexMin, indexMax);
+	}
+	for (uint32 i = pairIndex * 2; i < count; i++)
+	{
+		uint32 i0 = (i % 2 == 0) ? (i / 2) : (count - 1 - i / 2);
+		uint32 idx = _swapEndianU32(src[i0]);
+		indexMin = std::min(indexMin, idx);
+		indexMax = std::max(indexMax, idx);
+		dst[i] = idx;
+	}
+}
+
 #elif defined(__aarch64__)
 
 void LatteIndices_fastConvertU16_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
@@ -665,7 +933,345 @@ void LatteIndices_fastConvertU32_NEON(const void* indexDataInput, void* indexDat
 	indexMin = std::min(indexMin, _minIndex);
 }
 
+
+// see the SSE4.1 variants above for a description of the shuffle masks
+void LatteIndices_fastUnpackQuadsU16_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	static const uint8 shufA[16] = { 1, 0, 3, 2, 5, 4, 1, 0, 5, 4, 7, 6, 9, 8, 11, 10 };
+	static const uint8 shufB[16] = { 13, 12, 9, 8, 13, 12, 15, 14, 13, 12, 9, 8, 13, 12, 15, 14 };
+	const uint16* src = (const uint16*)indexDataInput;
+	uint16* dst = (uint16*)indexDataOutput;
+	uint32 numQuadPairs = (count / 4) / 2;
+	if (numQuadPairs)
+	{
+		uint8x16_t mShufA = vld1q_u8(shufA);
+		uint8x16_t mShufB = vld1q_u8(shufB);
+		uint16x8_t mMin = vdupq_n_u16(0xFFFF);
+		uint16x8_t mMax = vdupq_n_u16(0x0000);
+		for (uint32 i = 0; i < numQuadPairs; i++)
+		{
+			uint8x16_t mIndexData = vld1q_u8((const uint8*)src);
+			uint16x8_t mOutA = vreinterpretq_u16_u8(vqtbl1q_u8(mIndexData, mShufA));
+			uint16x8_t mOutB = vreinterpretq_u16_u8(vqtbl1q_u8(mIndexData, mShufB));
+			vst1q_u16(dst, mOutA);
+			vst1_u16(dst + 8, vget_low_u16(mOutB));
+			mMin = vminq_u16(mMin, vminq_u16(mOutA, mOutB));
+			mMax = vmaxq_u16(mMax, vmaxq_u16(mOutA, mOutB));
+			src += 8;
+			dst += 12;
+		}
+		indexMin = std::min(indexMin, (uint32)vminvq_u16(mMin));
+		indexMax = std::max(indexMax, (uint32)vmaxvq_u16(mMax));
+	}
+	LatteIndices_unpackQuadsAndConvert<uint16>(src, dst, count - numQuadPairs * 8, indexMin, indexMax);
+}
+
+void LatteIndices_fastUnpackQuadsU32_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	static const uint8 shufA[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 3, 2, 1, 0 };
+	static const uint8 shufB[16] = { 11, 10, 9, 8, 15, 14, 13, 12, 11, 10, 9, 8, 15, 14, 13, 12 };
+	const uint32* src = (const uint32*)indexDataInput;
+	uint32* dst = (uint32*)indexDataOutput;
+	uint32 numQuads = count / 4;
+	if (numQuads)
+	{
+		uint8x16_t mShufA = vld1q_u8(shufA);
+		uint8x16_t mShufB = vld1q_u8(shufB);
+		uint32x4_t mMin = vdupq_n_u32(0xFFFFFFFF);
+		uint32x4_t mMax = vdupq_n_u32(0x00000000);
+		for (uint32 i = 0; i < numQuads; i++)
+		{
+			uint8x16_t mIndexData = vld1q_u8((const uint8*)src);
+			uint32x4_t mOutA = vreinterpretq_u32_u8(vqtbl1q_u8(mIndexData, mShufA));
+			uint32x4_t mOutB = vreinterpretq_u32_u8(vqtbl1q_u8(mIndexData, mShufB));
+			vst1q_u32(dst, mOutA);
+			vst1_u32(dst + 4, vget_low_u32(mOutB));
+			mMin = vminq_u32(mMin, vminq_u32(mOutA, mOutB));
+			mMax = vmaxq_u32(mMax, vmaxq_u32(mOutA, mOutB));
+			src += 4;
+			dst += 6;
+		}
+		indexMin = std::min(indexMin, (uint32)vminvq_u32(mMin));
+		indexMax = std::max(indexMax, (uint32)vmaxvq_u32(mMax));
+	}
+}
+
+void LatteIndices_fastUnpackQuadStripU16_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (count <= 3)
+		return;
+	static const uint8 shufA[16] = { 1, 0, 3, 2, 5, 4, 5, 4, 3, 2, 7, 6, 5, 4, 7, 6 };
+	static const uint8 shufB[16] = { 9, 8, 9, 8, 7, 6, 11, 10, 9, 8, 9, 8, 7, 6, 11, 10 };
+	const uint16* src = (const uint16*)indexDataInput;
+	uint16* dst = (uint16*)indexDataOutput;
+	uint32 numQuads = (count - 2) / 2;
+	uint32 quadIndex = 0;
+	if ((quadIndex * 2 + 8) <= count && (quadIndex + 2) <= numQuads)
+	{
+		uint8x16_t mShufA = vld1q_u8(shufA);
+		uint8x16_t mShufB = vld1q_u8(shufB);
+		uint16x8_t mMin = vdupq_n_u16(0xFFFF);
+		uint16x8_t mMax = vdupq_n_u16(0x0000);
+		do
+		{
+			uint8x16_t mIndexData = vld1q_u8((const uint8*)src);
+			uint16x8_t mOutA = vreinterpretq_u16_u8(vqtbl1q_u8(mIndexData, mShufA));
+			uint16x8_t mOutB = vreinterpretq_u16_u8(vqtbl1q_u8(mIndexData, mShufB));
+			vst1q_u16(dst, mOutA);
+			vst1_u16(dst + 8, vget_low_u16(mOutB));
+			mMin = vminq_u16(mMin, vminq_u16(mOutA, mOutB));
+			mMax = vmaxq_u16(mMax, vmaxq_u16(mOutA, mOutB));
+			src += 4;
+			dst += 12;
+			quadIndex += 2;
+		} while ((quadIndex * 2 + 8) <= count && (quadIndex + 2) <= numQuads);
+		indexMin = std::min(indexMin, (uint32)vminvq_u16(mMin));
+		indexMax = std::max(indexMax, (uint32)vmaxvq_u16(mMax));
+	}
+	uint32 remainingQuads = numQuads - quadIndex;
+	if (remainingQuads)
+		LatteIndices_unpackQuadStripAndConvert<uint16>(src, dst, remainingQuads * 2 + 2, indexMin, indexMax);
+}
+
+void LatteIndices_fastUnpackQuadStripU32_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (count <= 3)
+		return;
+	static const uint8 shufA[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 11, 10, 9, 8 };
+	static const uint8 shufB[16] = { 7, 6, 5, 4, 15, 14, 13, 12, 7, 6, 5, 4, 15, 14, 13, 12 };
+	const uint32* src = (const uint32*)indexDataInput;
+	uint32* dst = (uint32*)indexDataOutput;
+	uint32 numQuads = (count - 2) / 2;
+	uint8x16_t mShufA = vld1q_u8(shufA);
+	uint8x16_t mShufB = vld1q_u8(shufB);
+	uint32x4_t mMin = vdupq_n_u32(0xFFFFFFFF);
+	uint32x4_t mMax = vdupq_n_u32(0x00000000);
+	for (uint32 i = 0; i < numQuads; i++)
+	{
+		uint8x16_t mIndexData = vld1q_u8((const uint8*)src);
+		uint32x4_t mOutA = vreinterpretq_u32_u8(vqtbl1q_u8(mIndexData, mShufA));
+		uint32x4_t mOutB = vreinterpretq_u32_u8(vqtbl1q_u8(mIndexData, mShufB));
+		vst1q_u32(dst, mOutA);
+		vst1_u32(dst + 4, vget_low_u32(mOutB));
+		mMin = vminq_u32(mMin, vminq_u32(mOutA, mOutB));
+		mMax = vmaxq_u32(mMax, vmaxq_u32(mOutA, mOutB));
+		src += 2;
+		dst += 6;
+	}
+	indexMin = std::min(indexMin, (uint32)vminvq_u32(mMin));
+	indexMax = std::max(indexMax, (uint32)vmaxvq_u32(mMax));
+}
+
+void LatteIndices_fastUnpackTriangleFanU16_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	static const uint8 shuf[16] = { 1, 0, 15, 14, 3, 2, 13, 12, 5, 4, 11, 10, 7, 6, 9, 8 };
+	const uint16* src = (const uint16*)indexDataInput;
+	uint16* dst = (uint16*)indexDataOutput;
+	uint32 numPairs = count / 2;
+	uint32 pairIndex = 0;
+	if (numPairs >= 4)
+	{
+		uint8x16_t mShuf = vld1q_u8(shuf);
+		uint16x8_t mMin = vdupq_n_u16(0xFFFF);
+		uint16x8_t mMax = vdupq_n_u16(0x0000);
+		for (; (pairIndex + 4) <= numPairs; pairIndex += 4)
+		{
+			uint8x16_t mIndexData = vcombine_u8(vld1_u8((const uint8*)(src + pairIndex)), vld1_u8((const uint8*)(src + count - 4 - pairIndex)));
+			uint16x8_t mOut = vreinterpretq_u16_u8(vqtbl1q_u8(mIndexData, mShuf));
+			vst1q_u16(dst + pairIndex * 2, mOut);
+			mMin = vminq_u16(mMin, mOut);
+			mMax = vmaxq_u16(mMax, mOut);
+		}
+		indexMin = std::min(indexMin, (uint32)vminvq_u16(mMin));
+		indexMax = std::max(indexMax, (uint32)vmaxvq_u16(mMax));
+	}
+	for (uint32 i = pairIndex * 2; i < count; i++)
+	{
+		uint32 i0 = (i % 2 == 0) ? (i / 2) : (count - 1 - i / 2);
+		uint16 idx = _swapEndianU16(src[i0]);
+		indexMin = std::min(indexMin, (uint32)idx);
+		indexMax = std::max(indexMax, (uint32)idx);
+		dst[i] = idx;
+	}
+}
+
+void LatteIndices_fastUnpackTriangleFanU32_NEON(const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	static const uint8 shuf[16] = { 3, 2, 1, 0, 15, 14, 13, 12, 7, 6, 5, 4, 11, 10, 9, 8 };
+	const uint32* src = (const uint32*)indexDataInput;
+	uint32* dst = (uint32*)indexDataOutput;
+	uint32 numPairs = count / 2;
+	uint32 pairIndex = 0;
+	if (numPairs >= 2)
+	{
+		uint8x16_t mShuf = vld1q_u8(shuf);
+		uint32x4_t mMin = vdupq_n_u32(0xFFFFFFFF);
+		uint32x4_t mMax = vdupq_n_u32(0x00000000);
+		for (; (pairIndex + 2) <= numPairs; pairIndex += 2)
+		{
+			uint8x16_t mIndexData = vcombine_u8(vld1_u8((const uint8*)(src + pairIndex)), vld1_u8((const uint8*)(src + count - 2 - pairIndex)));
+			uint32x4_t mOut = vreinterpretq_u32_u8(vqtbl1q_u8(mIndexData, mShuf));
+			vst1q_u32(dst + pairIndex * 2, mOut);
+			mMin = vminq_u32(mMin, mOut);
+			mMax = vmaxq_u32(mMax, mOut);
+		}
+		indexMin = std::min(indexMin, (uint32)vminvq_u32(mMin));
+		indexMax = std::max(indexMax, (uint32)vmaxvq_u32(mMax));
+	}
+	for (uint32 i = pairIndex * 2; i < count; i++)
+	{
+		uint32 i0 = (i % 2 == 0) ? (i / 2) : (count - 1 - i / 2);
+		uint32 idx = _swapEndianU32(src[i0]);
+		indexMin = std::min(indexMin, idx);
+		indexMax = std::max(indexMax, idx);
+		dst[i] = idx;
+	}
+}
+
+#endif
+
+// pick the fastest available implementation for the host CPU
+void LatteIndices_fastConvertBE(LatteIndexType indexType, const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (indexType == LatteIndexType::U16_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.avx2)
+			LatteIndices_fastConvertU16_AVX2(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastConvertU16_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_convertBE<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastConvertU16_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_convertBE<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else if (indexType == LatteIndexType::U32_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.avx2)
+			LatteIndices_fastConvertU32_AVX2(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_convertBE<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastConvertU32_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_convertBE<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else
+		cemu_assert_debug(false);
+}
+
+void LatteIndices_fastUnpackQuadsAndConvert(LatteIndexType indexType, const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (indexType == LatteIndexType::U16_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastUnpackQuadsU16_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_unpackQuadsAndConvert<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastUnpackQuadsU16_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_unpackQuadsAndConvert<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
 #endif
+	}
+	else if (indexType == LatteIndexType::U32_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastUnpackQuadsU32_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_unpackQuadsAndConvert<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastUnpackQuadsU32_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_unpackQuadsAndConvert<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else
+		cemu_assert_debug(false);
+}
+
+void LatteIndices_fastUnpackQuadStripAndConvert(LatteIndexType indexType, const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (indexType == LatteIndexType::U16_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastUnpackQuadStripU16_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_unpackQuadStripAndConvert<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastUnpackQuadStripU16_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_unpackQuadStripAndConvert<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else if (indexType == LatteIndexType::U32_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastUnpackQuadStripU32_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_unpackQuadStripAndConvert<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastUnpackQuadStripU32_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_unpackQuadStripAndConvert<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else
+		cemu_assert_debug(false);
+}
+
+void LatteIndices_fastUnpackLineLoopAndConvert(LatteIndexType indexType, const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (count == 0)
+		return;
+	// a line loop is a plain conversion followed by one extra index to close the loop
+	LatteIndices_fastConvertBE(indexType, indexDataInput, indexDataOutput, count, indexMin, indexMax);
+	if (indexType == LatteIndexType::U16_BE)
+		((uint16*)indexDataOutput)[count] = ((uint16*)indexDataOutput)[0];
+	else if (indexType == LatteIndexType::U32_BE)
+		((uint32*)indexDataOutput)[count] = ((uint32*)indexDataOutput)[0];
+}
+
+void LatteIndices_fastUnpackTriangleFanAndConvert(LatteIndexType indexType, const void* indexDataInput, void* indexDataOutput, uint32 count, uint32& indexMin, uint32& indexMax)
+{
+	if (indexType == LatteIndexType::U16_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastUnpackTriangleFanU16_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_unpackTriangleFanAndConvert<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastUnpackTriangleFanU16_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_unpackTriangleFanAndConvert<uint16>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else if (indexType == LatteIndexType::U32_BE)
+	{
+#if defined(ARCH_X86_64)
+		if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
+			LatteIndices_fastUnpackTriangleFanU32_SSE41(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+		else
+			LatteIndices_unpackTriangleFanAndConvert<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#elif defined(__aarch64__)
+		LatteIndices_fastUnpackTriangleFanU32_NEON(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#else
+		LatteIndices_unpackTriangleFanAndConvert<uint32>(indexDataInput, indexDataOutput, count, indexMin, indexMax);
+#endif
+	}
+	else
+		cemu_assert_debug(false);
+}
 
 template<typename T>
 void _LatteIndices_alternativeCalculateIndexMinMax(const void* indexData, uint32 count, uint32 primitiveRestartIndex, uint32& indexMin, uint32& indexMax)
@@ -719,27 +1325,51 @@ void LatteIndices_alternativeCalculateIndexMinMax(const void* indexData, LatteIn
 
 void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32 count, LattePrimitiveMode primitiveMode, uint32& indexMin, uint32& indexMax, Renderer::INDEX_TYPE& renderIndexType, uint32& outputCount, Renderer::IndexAllocation& indexAllocation)
 {
+	LATTE_PROFILE_SCOPE(IndexDecode);
 	// what this should do:
 	// [x] use fast SIMD-based index decoding
 	// [x] unpack QUAD indices to triangle indices
 	// [x] calculate min and max index, be careful about primitive restart index
 	// [x] decode data directly into coherent memory buffer?
-	// [ ] better cache implementation, allow to cache across frames
+	// [x] better cache implementation, allow to cache across frames
+
+	uint32 primitiveRestartIndex = LatteGPUState.contextNew.VGT_MULTI_PRIM_IB_RESET_INDX.get_RESTART_INDEX();
+	uint32 sourceSize = 0;
+	if (indexType == LatteIndexType::U16_BE || indexType == LatteIndexType::U16_LE)
+		sourceSize = count * sizeof(uint16);
+	else if (indexType == LatteIndexType::U32_BE || indexType == LatteIndexType::U32_LE)
+		sourceSize = count * sizeof(uint32);
+	LatteIndexCacheKey cacheKey{ indexType == LatteIndexType::AUTO ? nullptr : indexData, count, primitiveMode, indexType, primitiveRestartIndex };
+	std::optional<uint64> sourceHash;
 
 	// reuse from cache if data didn't change
-	auto cacheEntry = std::find_if(LatteIndexCache.entry.begin(), LatteIndexCache.entry.end(), [indexData, count, primitiveMode, indexType](const auto& entry)
-	{
-		return entry.lastPtr == indexData && entry.lastCount == count && entry.lastPrimitiveMode == primitiveMode && entry.lastIndexType == indexType;
-	});
-	if (cacheEntry != LatteIndexCache.entry.end())
-	{
-		indexMin = cacheEntry->indexMin;
-		indexMax = cacheEntry->indexMax;
-		renderIndexType = cacheEntry->renderIndexType;
-		outputCount = cacheEntry->outputCount;
-		indexAllocation = cacheEntry->indexAllocation;
-		cacheEntry->lastUsed = LatteIndices_GetNextUsageIndex();
-		return;
+	auto cacheLookupItr = LatteIndexCache.lookup.find(cacheKey);
+	if (cacheLookupItr != LatteIndexCache.lookup.end())
+	{
+		auto cacheEntry = cacheLookupItr->second;
+		bool isValid = true;
+		if (cacheEntry->validatedEpoch != LatteIndexCache.currentEpoch)
+		{
+			if (cacheEntry->sourceSize != 0)
+			{
+				sourceHash = LatteIndices_hashSourceData(indexData, sourceSize);
+				isValid = *sourceHash == cacheEntry->sourceHash;
+			}
+			cacheEntry->validatedEpoch = LatteIndexCache.currentEpoch;
+		}
+		if (isValid)
+		{
+			indexMin = cacheEntry->indexMin;
+			indexMax = cacheEntry->indexMax;
+			renderIndexType = cacheEntry->renderIndexType;
+			outputCount = cacheEntry->outputCount;
+			indexAllocation = cacheEntry->indexAllocation;
+			LatteIndexCache.lruList.splice(LatteIndexCache.lruList.begin(), LatteIndexCache.lruList, cacheEntry);
+			performanceMonitor.cycle[performanceMonitor.cycleIndex].indexDataCached += cacheEntry->outputSize;
+			return;
+		}
+		// source data was modified
+		_LatteIndices_releaseEntry(cacheEntry);
 	}
 
 	outputCount = 0;
@@ -752,8 +1382,6 @@ void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32
 	else
 		cemu_assert_debug(false);
 
-	uint32 primitiveRestartIndex = LatteGPUState.contextNew.VGT_MULTI_PRIM_IB_RESET_INDX.get_RESTART_INDEX();
-
 	// calculate index output size
 	uint32 indexOutputSize = LatteIndices_calculateIndexOutputSize(primitiveMode, indexType, count);
 	if (indexOutputSize == 0)
@@ -788,12 +1416,8 @@ void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32
 				renderIndexType = Renderer::INDEX_TYPE::U32;
 			}
 		}
-		else if (indexType == LatteIndexType::U16_BE)
-			LatteIndices_unpackQuadsAndConvert<uint16>(indexData, indexOutputPtr, count, indexMin, indexMax);
-		else if (indexType == LatteIndexType::U32_BE)
-			LatteIndices_unpackQuadsAndConvert<uint32>(indexData, indexOutputPtr, count, indexMin, indexMax);
 		else
-			cemu_assert_debug(false);
+			LatteIndices_fastUnpackQuadsAndConvert(indexType, indexData, indexOutputPtr, count, indexMin, indexMax);
 		outputCount = count / 4 * 6;
 	}
 	else if (primitiveMode == LattePrimitiveMode::QUAD_STRIP)
@@ -812,12 +1436,8 @@ void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32
 				renderIndexType = Renderer::INDEX_TYPE::U32;
 			}
 		}
-		else if (indexType == LatteIndexType::U16_BE)
-			LatteIndices_unpackQuadStripAndConvert<uint16>(indexData, indexOutputPtr, count, indexMin, indexMax);
-		else if (indexType == LatteIndexType::U32_BE)
-			LatteIndices_unpackQuadStripAndConvert<uint32>(indexData, indexOutputPtr, count, indexMin, indexMax);
 		else
-			cemu_assert_debug(false);
+			LatteIndices_fastUnpackQuadStripAndConvert(indexType, indexData, indexOutputPtr, count, indexMin, indexMax);
 		if (count >= 2)
 			outputCount = (count - 2) / 2 * 6;
 		else
@@ -839,12 +1459,8 @@ void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32
 				renderIndexType = Renderer::INDEX_TYPE::U32;
 			}
 		}
-		else if (indexType == LatteIndexType::U16_BE)
-			LatteIndices_unpackLineLoopAndConvert<uint16>(indexData, indexOutputPtr, count, indexMin, indexMax);
-		else if (indexType == LatteIndexType::U32_BE)
-			LatteIndices_unpackLineLoopAndConvert<uint32>(indexData, indexOutputPtr, count, indexMin, indexMax);
 		else
-			cemu_assert_debug(false);
+			LatteIndices_fastUnpackLineLoopAndConvert(indexType, indexData, indexOutputPtr, count, indexMin, indexMax);
 		outputCount = count + 1;
 	}
 	else if (primitiveMode == LattePrimitiveMode::TRIANGLE_FAN && g_renderer->GetType() == RendererAPI::Metal)
@@ -862,43 +1478,15 @@ void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32
     			renderIndexType = Renderer::INDEX_TYPE::U32;
     		}
     	}
-    	else if (indexType == LatteIndexType::U16_BE)
-    		LatteIndices_unpackTriangleFanAndConvert<uint16>(indexData, indexOutputPtr, count, indexMin, indexMax);
-    	else if (indexType == LatteIndexType::U32_BE)
-    		LatteIndices_unpackTriangleFanAndConvert<uint32>(indexData, indexOutputPtr, count, indexMin, indexMax);
     	else
-    		cemu_assert_debug(false);
+    		LatteIndices_fastUnpackTriangleFanAndConvert(indexType, indexData, indexOutputPtr, count, indexMin, indexMax);
     	outputCount = count;
 	}
 	else
 	{
-		if (indexType == LatteIndexType::U16_BE)
+		if (indexType == LatteIndexType::U16_BE || indexType == LatteIndexType::U32_BE)
 		{
-#if defined(ARCH_X86_64)
-			if (g_CPUFeatures.x86.avx2)
-				LatteIndices_fastConvertU16_AVX2(indexData, indexOutputPtr, count, indexMin, indexMax);
-			else if (g_CPUFeatures.x86.sse4_1 && g_CPUFeatures.x86.ssse3)
-				LatteIndices_fastConvertU16_SSE41(indexData, indexOutputPtr, count, indexMin, indexMax);
-			else
-				LatteIndices_convertBE<uint16>(indexData, indexOutputPtr, count, indexMin, indexMax);
-#elif defined(__aarch64__)
-			LatteIndices_fastConvertU16_NEON(indexData, indexOutputPtr, count, indexMin, indexMax);
-#else
-			LatteIndices_convertBE<uint16>(indexData, indexOutputPtr, count, indexMin, indexMax);            
-#endif
-		}
-		else if (indexType == LatteIndexType::U32_BE)
-		{
-#if defined(ARCH_X86_64)
-			if (g_CPUFeatures.x86.avx2)
-				LatteIndices_fastConvertU32_AVX2(indexData, indexOutputPtr, count, indexMin, indexMax);
-			else
-				LatteIndices_convertBE<uint32>(indexData, indexOutputPtr, count, indexMin, indexMax);
-#elif defined(__aarch64__)
-			LatteIndices_fastConvertU32_NEON(indexData, indexOutputPtr, count, indexMin, indexMax);
-#else
-			LatteIndices_convertBE<uint32>(indexData, indexOutputPtr, count, indexMin, indexMax);            
-#endif
+			LatteIndices_fastConvertBE(indexType, indexData, indexOutputPtr, count, indexMin, indexMax);
 		}
 		else if (indexType == LatteIndexType::U16_LE)
 		{
@@ -921,23 +1509,23 @@ void LatteIndices_decode(const void* indexData, LatteIndexType indexType, uint32
 	}
 	g_renderer->indexData_uploadIndexMemory(indexAllocation);
 	performanceMonitor.cycle[performanceMonitor.cycleIndex].indexDataUploaded += indexOutputSize;
-	// get least recently used cache entry
-	auto lruEntry = std::min_element(LatteIndexCache.entry.begin(), LatteIndexCache.entry.end(), [](const auto& a, const auto& b)
-	{
-		return a.lastUsed < b.lastUsed;
-	});
-	// invalidate previous allocation
-	if(lruEntry->lastPtr != nullptr)
-		g_renderer->indexData_releaseIndexMemory(lruEntry->indexAllocation);
+	// evict least recently used entries
+	while (!LatteIndexCache.lruList.empty() && (LatteIndexCache.lruList.size() >= LATTE_INDEX_CACHE_MAX_ENTRIES || (LatteIndexCache.totalOutputSize + indexOutputSize) > LATTE_INDEX_CACHE_MAX_SIZE))
+		_LatteIndices_releaseEntry(std::prev(LatteIndexCache.lruList.end()));
 	// update cache
-	lruEntry->lastPtr = indexData;
-	lruEntry->lastCount = count;
-	lruEntry->lastPrimitiveMode = primitiveMode;
-	lruEntry->lastIndexType = indexType;
-	lruEntry->indexMin = indexMin;
-	lruEntry->indexMax = indexMax;
-	lruEntry->renderIndexType = renderIndexType;
-	lruEntry->outputCount = outputCount;
-	lruEntry->indexAllocation = indexAllocation;
-	lruEntry->lastUsed = LatteIndices_GetNextUsageIndex();
+	if (sourceSize != 0 && !sourceHash)
+		sourceHash = LatteIndices_hashSourceData(indexData, sourceSize);
+	auto& newEntry = LatteIndexCache.lruList.emplace_front();
+	newEntry.key = cacheKey;
+	newEntry.sourceSize = sourceSize;
+	newEntry.sourceHash = sourceHash.value_or(0);
+	newEntry.validatedEpoch = LatteIndexCache.currentEpoch;
+	newEntry.indexMin = indexMin;
+	newEntry.indexMax = indexMax;
+	newEntry.renderIndexType = renderIndexType;
+	newEntry.outputCount = outputCount;
+	newEntry.outputSize = indexOutputSize;
+	newEntry.indexAllocation = indexAllocation;
+	LatteIndexCache.lookup.emplace(cacheKey, LatteIndexCache.lruList.begin());
+	LatteIndexCache.totalOutputSize += indexOutputSize;
 }
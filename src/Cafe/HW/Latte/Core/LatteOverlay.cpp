@@ -134,6 +134,60 @@ namespace
 		}
 		ImGui::End();
 	}
+
+	void LatteOverlay_renderProfilerOverlay(ImVec2& position, ImVec2& pivot, sint32 direction)
+	{
+		if (!LatteProfiler_IsEnabled())
+			return;
+		LatteProfilerScopeStats stats[(size_t)LatteProfilerScope::COUNT];
+		LatteProfiler_GetStats(stats);
+
+		ImGui::SetNextWindowPos(position, ImGuiCond_Always, pivot);
+		ImGui::SetNextWindowBgAlpha(kBackgroundAlpha);
+		if (ImGui::Begin("GPU thread profiler", nullptr, kPopupFlags))
+		{
+			ImGui::Text("GPU thread CPU time per frame (self time, us)");
+			float totalLast = 0.0f;
+			float totalAverage = 0.0f;
+			for (auto& it : stats)
+			{
+				totalLast += it.lastFrameUs;
+				totalAverage += it.averageUs;
+			}
+			if (ImGui::BeginTable("profilerScopes", 6))
+			{
+				ImGui::TableSetupColumn("Scope");
+				ImGui::TableSetupColumn("Last");
+				ImGui::TableSetupColumn("Avg");
+				ImGui::TableSetupColumn("Max");
+				ImGui::TableSetupColumn("Calls");
+				ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthFixed, 160.0f);
+				ImGui::TableHeadersRow();
+				for (auto& it : stats)
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(it.name);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.0f", it.lastFrameUs);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.0f", it.averageUs);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.0f", it.maxUs);
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", it.lastFrameCalls);
+					ImGui::TableNextColumn();
+					ImGui::PushID(it.name);
+					ImGui::PlotHistogram("##history", it.history, LATTE_PROFILER_HISTORY_FRAMES, (int)it.historyOffset, nullptr, 0.0f, std::max(it.maxUs, 1.0f), ImVec2(160.0f, ImGui::GetTextLineHeight()));
+					ImGui::PopID();
+				}
+				ImGui::EndTable();
+			}
+			ImGui::Text("Total: %.0fus (avg %.0fus)", totalLast, totalAverage);
+			position.y += (ImGui::GetWindowSize().y + 10.0f) * direction;
+		}
+		ImGui::End();
+	}
 }
 
 void LatteOverlay_renderOverlay(ImVec2& position, ImVec2& pivot, sint32 direction, float fontSize, bool pad)
@@ -189,6 +243,7 @@ void LatteOverlay_renderOverlay(ImVec2& position, ImVec2& pivot, sint32 directio
 		ImGui::End();
 	}
 	LatteOverlay_renderTasOverlay(position, pivot, direction);
+	LatteOverlay_renderProfilerOverlay(position, pivot, direction);
 
 	ImGui::PopStyleColor();
 	ImGui::PopFont();
@@ -1,11 +1,213 @@
 #include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
 #include "Cafe/HW/Latte/Core/LatteOverlay.h"
 #include "WindowSystem.h"
+#include "Common/FileStream.h"
 
 performanceMonitor_t performanceMonitor{};
 
+std::atomic_bool g_latteProfilerEnabled{ false };
+
+static const char* s_latteProfilerScopeNames[(size_t)LatteProfilerScope::COUNT] =
+{
+	"CommandProcessor",
+	"ShaderLookup",
+	"PipelineLookup",
+	"TextureCache",
+	"BufferCache",
+	"IndexDecode",
+	"RendererSubmit",
+};
+
+struct LatteProfilerTraceEvent
+{
+	uint64 beginTick;
+	uint64 endTick;
+	LatteProfilerScope scope;
+};
+
+struct
+{
+	std::atomic_bool isEnabled{ false }; // set by the UI thread, applied on the GPU thread at the next frame boundary
+	LatteProfilerScopeTimer* currentScope{};
+	// current frame
+	uint64 frameTicks[(size_t)LatteProfilerScope::COUNT]{};
+	uint32 frameCalls[(size_t)LatteProfilerScope::COUNT]{};
+	// previous frames
+	float history[(size_t)LatteProfilerScope::COUNT][LATTE_PROFILER_HISTORY_FRAMES]{};
+	uint32 historyIndex{};
+	uint32 historyCount{};
+	uint32 lastFrameCalls[(size_t)LatteProfilerScope::COUNT]{};
+	// trace request from UI thread
+	std::mutex requestMutex;
+	fs::path requestedPath;
+	uint32 requestedFrames{};
+	std::atomic_bool hasTraceRequest{};
+	// active trace, only accessed from GPU thread
+	bool isTracing{ false };
+	fs::path tracePath;
+	uint32 traceFramesRemaining{};
+	uint64 traceStartTick{};
+	std::vector<LatteProfilerTraceEvent> traceEvents;
+	std::vector<uint64> traceFrameEndTicks;
+}s_profiler;
+
+void LatteProfilerScopeTimer::Begin()
+{
+	m_childTicks = 0;
+	m_parent = s_profiler.currentScope;
+	s_profiler.currentScope = this;
+	m_isActive = true;
+	m_startTick = PPCTimer_getRawTsc();
+}
+
+void LatteProfilerScopeTimer::End()
+{
+	const uint64 endTick = PPCTimer_getRawTsc();
+	const uint64 totalTicks = endTick - m_startTick;
+	s_profiler.frameTicks[(size_t)m_scope] += totalTicks - std::min(m_childTicks, totalTicks);
+	s_profiler.frameCalls[(size_t)m_scope]++;
+	if (m_parent)
+		m_parent->AddChildTicks(totalTicks);
+	cemu_assert_debug(s_profiler.currentScope == this);
+	s_profiler.currentScope = m_parent;
+	m_isActive = false;
+	// scopes which were already running when the trace started are cut off at the trace start
+	if (s_profiler.isTracing && endTick > s_profiler.traceStartTick)
+		s_profiler.traceEvents.emplace_back(std::max(m_startTick, s_profiler.traceStartTick), endTick, m_scope);
+}
+
+void LatteProfiler_SetEnabled(bool isEnabled)
+{
+	s_profiler.isEnabled = isEnabled;
+	if (isEnabled)
+		g_latteProfilerEnabled = true;
+	// disabling is deferred to the next frame boundary so that an active trace can finish
+}
+
+bool LatteProfiler_IsEnabled()
+{
+	return s_profiler.isEnabled;
+}
+
+void LatteProfiler_RequestTrace(const fs::path& path, uint32 numFrames)
+{
+	std::unique_lock _l(s_profiler.requestMutex);
+	s_profiler.requestedPath = path;
+	s_profiler.requestedFrames = std::max<uint32>(numFrames, 1);
+	s_profiler.hasTraceRequest = true;
+}
+
+void LatteProfiler_GetStats(LatteProfilerScopeStats statsOut[(size_t)LatteProfilerScope::COUNT])
+{
+	const uint32 historyCount = std::max<uint32>(s_profiler.historyCount, 1);
+	const uint32 lastIndex = (s_profiler.historyIndex + LATTE_PROFILER_HISTORY_FRAMES - 1) % LATTE_PROFILER_HISTORY_FRAMES;
+	for (size_t i = 0; i < (size_t)LatteProfilerScope::COUNT; i++)
+	{
+		LatteProfilerScopeStats& stats = statsOut[i];
+		stats.name = s_latteProfilerScopeNames[i];
+		stats.history = s_profiler.history[i];
+		stats.historyOffset = s_profiler.historyIndex;
+		stats.lastFrameUs = s_profiler.history[i][lastIndex];
+		stats.lastFrameCalls = s_profiler.lastFrameCalls[i];
+		float sum = 0.0f;
+		float maxValue = 0.0f;
+		for (uint32 f = 0; f < s_profiler.historyCount; f++)
+		{
+			sum += s_profiler.history[i][f];
+			maxValue = std::max(maxValue, s_profiler.history[i][f]);
+		}
+		stats.averageUs = sum / (float)historyCount;
+		stats.maxUs = maxValue;
+	}
+}
+
+void _LatteProfiler_WriteTrace()
+{
+	const double ticksPerUs = (double)PPCTimer_microsecondsToTsc(1000000) / 1000000.0;
+	auto tickToUs = [&](uint64 tick) { return (double)(tick - s_profiler.traceStartTick) / ticksPerUs; };
+	std::string json;
+	json.reserve(s_profiler.traceEvents.size() * 96 + 256);
+	json.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"GPU thread\"}}");
+	for (auto& ev : s_profiler.traceEvents)
+		json.append(fmt::format(",\n{{\"name\":\"{}\",\"cat\":\"latte\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"dur\":{:.3f}}}", s_latteProfilerScopeNames[(size_t)ev.scope], tickToUs(ev.beginTick), (double)(ev.endTick - ev.beginTick) / ticksPerUs));
+	for (size_t i = 0; i < s_profiler.traceFrameEndTicks.size(); i++)
+		json.append(fmt::format(",\n{{\"name\":\"Frame {}\",\"cat\":\"latte\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":{:.3f}}}", i, tickToUs(s_profiler.traceFrameEndTicks[i])));
+	json.append("\n]}\n");
+
+	std::error_code ec;
+	fs::create_directories(s_profiler.tracePath.parent_path(), ec);
+	FileStream* fs = FileStream::createFile2(s_profiler.tracePath);
+	if (!fs)
+	{
+		cemuLog_log(LogType::Force, "GPU profiler: Unable to create file {}", _pathToUtf8(s_profiler.tracePath));
+		return;
+	}
+	fs->writeData(json.data(), (sint32)json.size());
+	delete fs;
+	cemuLog_log(LogType::Force, "GPU profiler: Wrote {} events over {} frames to {}", s_profiler.traceEvents.size(), s_profiler.traceFrameEndTicks.size(), _pathToUtf8(s_profiler.tracePath));
+}
+
+void _LatteProfiler_FrameEnd()
+{
+	const uint64 frameEndTick = PPCTimer_getRawTsc();
+	// trace
+	if (s_profiler.isTracing)
+	{
+		s_profiler.traceFrameEndTicks.emplace_back(frameEndTick);
+		s_profiler.traceFramesRemaining--;
+		if (s_profiler.traceFramesRemaining == 0)
+		{
+			_LatteProfiler_WriteTrace();
+			s_profiler.isTracing = false;
+			s_profiler.traceEvents.clear();
+			s_profiler.traceEvents.shrink_to_fit();
+			s_profiler.traceFrameEndTicks.clear();
+		}
+	}
+	else if (s_profiler.hasTraceRequest)
+	{
+		std::unique_lock _l(s_profiler.requestMutex);
+		s_profiler.tracePath = s_profiler.requestedPath;
+		s_profiler.traceFramesRemaining = s_profiler.requestedFrames;
+		s_profiler.hasTraceRequest = false;
+		_l.unlock();
+		s_profiler.isTracing = true;
+		s_profiler.traceStartTick = frameEndTick;
+		g_latteProfilerEnabled = true;
+		cemuLog_log(LogType::Force, "GPU profiler: Tracing {} frames to {}", s_profiler.traceFramesRemaining, _pathToUtf8(s_profiler.tracePath));
+	}
+	// per-frame history
+	if (g_latteProfilerEnabled)
+	{
+		const double ticksPerUs = (double)PPCTimer_microsecondsToTsc(1000000) / 1000000.0;
+		for (size_t i = 0; i < (size_t)LatteProfilerScope::COUNT; i++)
+		{
+			s_profiler.history[i][s_profiler.historyIndex] = (float)((double)s_profiler.frameTicks[i] / ticksPerUs);
+			s_profiler.lastFrameCalls[i] = s_profiler.frameCalls[i];
+		}
+		s_profiler.historyIndex = (s_profiler.historyIndex + 1) % LATTE_PROFILER_HISTORY_FRAMES;
+		s_profiler.historyCount = std::min<uint32>(s_profiler.historyCount + 1, LATTE_PROFILER_HISTORY_FRAMES);
+	}
+	std::fill(std::begin(s_profiler.frameTicks), std::end(s_profiler.frameTicks), 0);
+	std::fill(std::begin(s_profiler.frameCalls), std::end(s_profiler.frameCalls), 0);
+	// apply runtime toggle
+	const bool shouldBeEnabled = s_profiler.isEnabled || s_profiler.isTracing;
+	if (g_latteProfilerEnabled != shouldBeEnabled)
+	{
+		g_latteProfilerEnabled = shouldBeEnabled;
+		if (!shouldBeEnabled)
+		{
+			s_profiler.historyCount = 0;
+			s_profiler.historyIndex = 0;
+			memset(s_profiler.history, 0, sizeof(s_profiler.history));
+		}
+	}
+}
+
 void LattePerformanceMonitor_frameEnd()
 {
+	_LatteProfiler_FrameEnd();
 	// per-frame stats
 	performanceMonitor.gpuTime_shaderCreate.frameFinished();
 	performanceMonitor.gpuTime_frameTime.frameFinished();
@@ -5,6 +5,7 @@
 // todo - replace PPCTimer with HighResolutionTimer.h
 uint64 PPCTimer_getRawTsc();
 uint64 PPCTimer_tscToMicroseconds(uint64 us);
+uint64 PPCTimer_microsecondsToTsc(uint64 us);
 
 class LattePerfStatTimer
 {
@@ -145,5 +146,93 @@ extern performanceMonitor_t performanceMonitor;
 void LattePerformanceMonitor_frameEnd();
 void LattePerformanceMonitor_frameBegin();
 
+// GPU thread profiler
+// breaks down the CPU time spent on the GPU thread by subsystem
+// scopes are always compiled in, when the profiler is disabled each scope only costs a single branch
+// scopes can be nested, the time of inner scopes is not counted towards the outer scope (self time)
+// must only be used on the GPU thread
+
+#define LATTE_PROFILER_HISTORY_FRAMES	(128)
+
+enum class LatteProfilerScope : uint8
+{
+	CommandProcessor,
+	ShaderLookup,
+	PipelineLookup,
+	TextureCache,
+	BufferCache,
+	IndexDecode,
+	RendererSubmit,
+	COUNT
+};
+
+extern std::atomic_bool g_latteProfilerEnabled;
+
+class LatteProfilerScopeTimer
+{
+public:
+	LatteProfilerScopeTimer(LatteProfilerScope scope) : m_scope(scope)
+	{
+		if (g_latteProfilerEnabled.load(std::memory_order_relaxed))
+			Begin();
+	}
+
+	~LatteProfilerScopeTimer()
+	{
+		if (m_isActive)
+			End();
+	}
+
+	LatteProfilerScopeTimer(const LatteProfilerScopeTimer&) = delete;
+	LatteProfilerScopeTimer& operator=(const LatteProfilerScopeTimer&) = delete;
+
+	void AddChildTicks(uint64 ticks)
+	{
+		m_childTicks += ticks;
+	}
+
+	// excludes waits from the scope, Pause() must not be called while a nested scope is active
+	void Pause()
+	{
+		if (m_isActive)
+			End();
+	}
+
+	void Resume()
+	{
+		if (!m_isActive && g_latteProfilerEnabled.load(std::memory_order_relaxed))
+			Begin();
+	}
+
+private:
+	void Begin();
+	void End();
+
+	LatteProfilerScopeTimer* m_parent;
+	uint64 m_startTick;
+	uint64 m_childTicks;
+	LatteProfilerScope m_scope;
+	bool m_isActive{ false };
+};
+
+#define LATTE_PROFILE_SCOPE(__scope) LatteProfilerScopeTimer _latteProfilerScope(LatteProfilerScope::__scope)
+
+struct LatteProfilerScopeStats
+{
+	const char* name;
+	float lastFrameUs; // self time in the previous frame
+	float averageUs; // average self time per frame over the history
+	float maxUs;
+	uint32 lastFrameCalls;
+	const float* history; // self time per frame in microseconds, ring buffer of LATTE_PROFILER_HISTORY_FRAMES entries
+	uint32 historyOffset; // index of the oldest entry
+};
+
+void LatteProfiler_SetEnabled(bool isEnabled);
+bool LatteProfiler_IsEnabled();
+void LatteProfiler_GetStats(LatteProfilerScopeStats statsOut[(size_t)LatteProfilerScope::COUNT]);
+// records every scope for the given number of frames and writes it as a Chrome trace event file (chrome://tracing or ui.perfetto.dev)
+void LatteProfiler_RequestTrace(const fs::path& path, uint32 numFrames);
+
 #define beginPerfMonProfiling(__obj) if( THasProfiling ) __obj.beginMeasuring()
 #define endPerfMonProfiling(__obj) if( THasProfiling ) __obj.endMeasuring()
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "Cafe/HW/Latte/Core/LatteCachedFBO.h"
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
 #include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
 #include "Cafe/GraphicPack/GraphicPack2.h"
 #include "config/ActiveSettings.h"
 #include "WindowSystem.h"
@@ -17,6 +18,7 @@
 #include "Cafe/OS/libs/swkbd/swkbd.h"
 #include "Cafe/OS/libs/snd_core/ax.h"
 #include "input/TAS/TASInput.h"
+#include "Cafe/BootProfiler.h"
 
 uint32 prevScissorX = 0;
 uint32 prevScissorY = 0;
@@ -702,6 +704,7 @@ void LatteRenderTarget_itHLESwapScanBuffer()
 		if (LatteGPUState.frameCounter > 5)
 			performanceMonitor.gpuTime_frameTime.endMeasuring();
 		LattePerformanceMonitor_frameEnd();
+		BootProfiler_NotifyFirstFrame();
 		LatteGPUState.frameCounter++;
 		TasInput::OnFramePresented(presentedFrame);
 	}
@@ -718,6 +721,7 @@ void LatteRenderTarget_itHLESwapScanBuffer()
 		LatteQuery_CancelActiveGPU7Queries();
 		LatteBufferCache_notifySwapTVScanBuffer();
 		LattePerformanceMonitor_frameBegin();
+		LatteCapture_NotifyFrameEnd();
 	}
 }
 
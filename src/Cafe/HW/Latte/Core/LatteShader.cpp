@@ -6,6 +6,7 @@
 #include "Cafe/HW/Latte/LegacyShaderDecompiler/LatteDecompiler.h"
 #include "Cafe/HW/Latte/Core/FetchShader.h"
 #include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
 #include "Cafe/HW/Latte/Renderer/Vulkan/VulkanRenderer.h"
 #include "Cafe/OS/libs/gx2/GX2.h" // todo - remove dependency
 #include "Cafe/GraphicPack/GraphicPack2.h"
@@ -44,11 +45,174 @@ LatteDecompilerShader* _activeGeometryShader = nullptr;
 LatteDecompilerShader* _activePixelShader = nullptr;
 
 // runtime shader cache
+// the hash maps and the shader->next chains are only accessed while holding s_shaderRegistryMutex
+// lookups go through the lock-free tables instead, so they can be done from any thread (e.g. pipeline compile threads)
 using SHRC_CACHE_TYPE = ska::flat_hash_map<uint64, LatteDecompilerShader*>;
 
 SHRC_CACHE_TYPE sVertexShaders(512);
 SHRC_CACHE_TYPE sGeometryShaders(512);
 SHRC_CACHE_TYPE sPixelShaders(512);
+std::mutex s_shaderRegistryMutex;
+
+// open addressing hash table mapping a pair of hashes to a shader
+// readers never lock. Writers need to hold s_shaderRegistryMutex
+// a slot is never reused for a different key, removing a shader only clears the shader pointer of the slot
+// once half of the slots are in use the table is rebuilt with only the live entries. The old table is retired but not freed
+// until all shaders are unloaded since readers may still be probing it
+class LatteSHRCLookupTable
+{
+	struct Slot
+	{
+		std::atomic<uint64> baseHash;
+		std::atomic<uint64> auxHash;
+		std::atomic<LatteDecompilerShader*> shader;
+		std::atomic_bool isUsed;
+	};
+
+	struct Table
+	{
+		Table(uint32 capacity) : slots(new Slot[capacity]()), mask(capacity - 1) {};
+
+		std::unique_ptr<Slot[]> slots;
+		uint32 mask;
+		uint32 usedSlots{ 0 };
+		uint32 liveEntries{ 0 };
+	};
+
+public:
+	LatteSHRCLookupTable()
+	{
+		m_table.store(new Table(INITIAL_CAPACITY));
+	}
+
+	~LatteSHRCLookupTable()
+	{
+		Reset();
+		delete m_table.load();
+	}
+
+	LatteDecompilerShader* Find(uint64 baseHash, uint64 auxHash) const
+	{
+		const Table* table = m_table.load(std::memory_order_acquire);
+		uint32 index = _hash(baseHash, auxHash) & table->mask;
+		while (true)
+		{
+			const Slot& slot = table->slots[index];
+			if (!slot.isUsed.load(std::memory_order_acquire))
+				return nullptr;
+			if (slot.baseHash.load(std::memory_order_relaxed) == baseHash && slot.auxHash.load(std::memory_order_relaxed) == auxHash)
+				return slot.shader.load(std::memory_order_acquire);
+			index = (index + 1) & table->mask;
+		}
+	}
+
+	// set shader to nullptr to remove the entry
+	void Set(uint64 baseHash, uint64 auxHash, LatteDecompilerShader* shader)
+	{
+		Table* table = m_table.load(std::memory_order_relaxed);
+		Slot* slot = _findSlot(table, baseHash, auxHash);
+		if (slot->isUsed.load(std::memory_order_relaxed))
+		{
+			LatteDecompilerShader* prevShader = slot->shader.load(std::memory_order_relaxed);
+			if (prevShader && !shader)
+				table->liveEntries--;
+			else if (!prevShader && shader)
+				table->liveEntries++;
+			slot->shader.store(shader, std::memory_order_release);
+			return;
+		}
+		if (!shader)
+			return;
+		if ((table->usedSlots + 1) * 2 > table->mask + 1)
+		{
+			table = _rebuild(table);
+			slot = _findSlot(table, baseHash, auxHash);
+		}
+		_initSlot(table, slot, baseHash, auxHash, shader);
+	}
+
+	// called when all shaders are unloaded, there may not be any concurrent lookups
+	void Reset()
+	{
+		for (auto& it : m_retiredTables)
+			delete it;
+		m_retiredTables.clear();
+		delete m_table.load();
+		m_table.store(new Table(INITIAL_CAPACITY));
+	}
+
+private:
+	static constexpr uint32 INITIAL_CAPACITY = 1024;
+
+	static uint32 _hash(uint64 baseHash, uint64 auxHash)
+	{
+		uint64 h = (baseHash ^ std::rotl<uint64>(auxHash, 29)) * 0x9E3779B97F4A7C15ull;
+		return (uint32)(h >> 32);
+	}
+
+	// returns the slot holding the key or the empty slot where it would be inserted
+	static Slot* _findSlot(Table* table, uint64 baseHash, uint64 auxHash)
+	{
+		uint32 index = _hash(baseHash, auxHash) & table->mask;
+		while (true)
+		{
+			Slot* slot = table->slots.get() + index;
+			if (!slot->isUsed.load(std::memory_order_relaxed))
+				return slot;
+			if (slot->baseHash.load(std::memory_order_relaxed) == baseHash && slot->auxHash.load(std::memory_order_relaxed) == auxHash)
+				return slot;
+			index = (index + 1) & table->mask;
+		}
+	}
+
+	static void _initSlot(Table* table, Slot* slot, uint64 baseHash, uint64 auxHash, LatteDecompilerShader* shader)
+	{
+		slot->baseHash.store(baseHash, std::memory_order_relaxed);
+		slot->auxHash.store(auxHash, std::memory_order_relaxed);
+		slot->shader.store(shader, std::memory_order_relaxed);
+		slot->isUsed.store(true, std::memory_order_release); // publishes the key and shader
+		table->usedSlots++;
+		table->liveEntries++;
+	}
+
+	Table* _rebuild(Table* oldTable)
+	{
+		uint32 capacity = INITIAL_CAPACITY;
+		while (capacity < (oldTable->liveEntries + 1) * 4)
+			capacity *= 2;
+		Table* newTable = new Table(capacity);
+		for (uint32 i = 0; i <= oldTable->mask; i++)
+		{
+			Slot& oldSlot = oldTable->slots[i];
+			if (!oldSlot.isUsed.load(std::memory_order_relaxed))
+				continue;
+			LatteDecompilerShader* shader = oldSlot.shader.load(std::memory_order_relaxed);
+			if (!shader)
+				continue;
+			uint64 baseHash = oldSlot.baseHash.load(std::memory_order_relaxed);
+			uint64 auxHash = oldSlot.auxHash.load(std::memory_order_relaxed);
+			_initSlot(newTable, _findSlot(newTable, baseHash, auxHash), baseHash, auxHash, shader);
+		}
+		m_table.store(newTable, std::memory_order_release);
+		m_retiredTables.emplace_back(oldTable);
+		return newTable;
+	}
+
+	std::atomic<Table*> m_table;
+	std::vector<Table*> m_retiredTables;
+};
+
+// two levels: The first shader registered for a base hash is needed to calculate the aux hash of the current state
+// the second level then maps base hash + aux hash to the shader variant
+struct LatteSHRCLookup
+{
+	LatteSHRCLookupTable baseShaders; // aux hash is always zero
+	LatteSHRCLookupTable shaders;
+};
+
+LatteSHRCLookup sVertexShaderLookup;
+LatteSHRCLookup sGeometryShaderLookup;
+LatteSHRCLookup sPixelShaderLookup;
 
 uint64 _shaderBaseHash_vs;
 uint64 _shaderBaseHash_gs;
@@ -87,6 +251,16 @@ inline ska::flat_hash_map<uint64, LatteDecompilerShader*>& LatteSHRC_GetCacheByT
 	return sPixelShaders;
 }
 
+inline LatteSHRCLookup& LatteSHRC_GetLookupByType(LatteConst::ShaderType shaderType)
+{
+	if (shaderType == LatteConst::ShaderType::Vertex)
+		return sVertexShaderLookup;
+	else if (shaderType == LatteConst::ShaderType::Geometry)
+		return sGeometryShaderLookup;
+	cemu_assert_debug(shaderType == LatteConst::ShaderType::Pixel);
+	return sPixelShaderLookup;
+}
+
 // calculate hash from shader binary
 // this algorithm could be more efficient since we could leverage the fact that the size is always aligned to 8 byte
 // but since this is baked into the shader names used for gfx packs and shader caches we can't really change this
@@ -143,16 +317,26 @@ void LatteSHRC_ResetCachedShaderHash()
 }
 
 LatteShaderPSInputTable _activePSImportTable;
+thread_local LatteShaderPSInputTable* s_threadPSImportTable = nullptr;
 
 LatteShaderPSInputTable* LatteSHRC_GetPSInputTable()
 {
+	if (s_threadPSImportTable)
+		return s_threadPSImportTable;
 	return &_activePSImportTable;
 }
 
+void LatteSHRC_SetThreadPSInputTable(LatteShaderPSInputTable* psInputTable)
+{
+	s_threadPSImportTable = psInputTable;
+}
+
 void LatteSHRC_RemoveFromCache(LatteDecompilerShader* shader)
 {
+	std::unique_lock _lock(s_shaderRegistryMutex);
 	bool removed = false;
 	auto& cache = LatteSHRC_GetCacheByType(shader->shaderType);
+	auto& lookup = LatteSHRC_GetLookupByType(shader->shaderType);
 	// remove from hashtable
 	auto baseIt = cache.find(shader->baseHash);
 	if (baseIt == cache.end())
@@ -168,6 +352,7 @@ void LatteSHRC_RemoveFromCache(LatteDecompilerShader* shader)
             cemu_assert_debug(shader->baseHash == shader->next->baseHash);
             cache.emplace(shader->baseHash, shader->next);
         }
+		lookup.baseShaders.Set(shader->baseHash, 0, shader->next);
         shader->next = 0;
 		removed = true;
 	}
@@ -183,9 +368,21 @@ void LatteSHRC_RemoveFromCache(LatteDecompilerShader* shader)
 				removed = true;
 				break;
 			}
+			shaderChain = shaderChain->next;
 		}
 	}
 	cemu_assert(removed);
+	// another shader with the same hashes may still be registered
+	if (lookup.shaders.Find(shader->baseHash, shader->auxHash) == shader)
+	{
+		LatteDecompilerShader* replacement = nullptr;
+		auto it = cache.find(shader->baseHash);
+		if (it != cache.end())
+			replacement = it->second;
+		while (replacement && replacement->auxHash != shader->auxHash)
+			replacement = replacement->next;
+		lookup.shaders.Set(shader->baseHash, shader->auxHash, replacement);
+	}
 }
 
 void LatteSHRC_RemoveFromCacheByHash(uint64 shader_base_hash, uint64 shader_aux_hash, LatteConst::ShaderType type)
@@ -308,7 +505,7 @@ void LatteShader_CreatePSInputTable(LatteShaderPSInputTable* psInputTable, uint3
 // we prepare the PS import info in advance
 void LatteShader_UpdatePSInputs(uint32* contextRegisters)
 {
-	LatteShader_CreatePSInputTable(&_activePSImportTable, contextRegisters);
+	LatteShader_CreatePSInputTable(LatteSHRC_GetPSInputTable(), contextRegisters);
 }
 
 void LatteShader_CreateRendererShader(LatteDecompilerShader* shader, bool compileAsync)
@@ -382,7 +579,9 @@ void LatteShader_FinishCompilation(LatteDecompilerShader* shader)
 
 void LatteSHRC_RegisterShader(LatteDecompilerShader* shader, uint64 baseHash, uint64 auxHash)
 {
+	std::unique_lock _lock(s_shaderRegistryMutex);
 	auto& cache = LatteSHRC_GetCacheByType(shader->shaderType);
+	auto& lookup = LatteSHRC_GetLookupByType(shader->shaderType);
 	shader->baseHash = baseHash;
 	shader->auxHash = auxHash;
 
@@ -391,47 +590,31 @@ void LatteSHRC_RegisterShader(LatteDecompilerShader* shader, uint64 baseHash, ui
 	{
 		shader->next = nullptr;
 		cache.emplace(shader->baseHash, shader);
+		lookup.baseShaders.Set(baseHash, 0, shader);
 	}
 	else
 	{
 		shader->next = it->second->next;
 		it->second->next = shader;
 	}
-}
-
-LatteDecompilerShader* LatteSHRC_GetFromChain(LatteDecompilerShader* baseShader, uint64 baseHash, uint64 auxHash)
-{
-	while (baseShader && baseShader->auxHash != auxHash)
-		baseShader = baseShader->next;
-	return baseShader;
-}
-
-LatteDecompilerShader* LatteSHRC_Get(SHRC_CACHE_TYPE& cache, uint64 baseHash, uint64 auxHash)
-{
-	auto it = cache.find(baseHash);
-	if (it == cache.end())
-		return nullptr;
-	LatteDecompilerShader* baseShader = it->second;
-	if (!baseShader)
-		return nullptr;
-	while (baseShader && baseShader->auxHash != auxHash)
-		baseShader = baseShader->next;
-	return baseShader;
+	// if multiple shaders are registered with the same hashes the first one is found, same as with the previous chain walk
+	if (!lookup.shaders.Find(baseHash, auxHash))
+		lookup.shaders.Set(baseHash, auxHash, shader);
 }
 
 LatteDecompilerShader* LatteSHRC_FindVertexShader(uint64 baseHash, uint64 auxHash)
 {
-	return LatteSHRC_Get(sVertexShaders, baseHash, auxHash);
+	return sVertexShaderLookup.shaders.Find(baseHash, auxHash);
 }
 
 LatteDecompilerShader* LatteSHRC_FindGeometryShader(uint64 baseHash, uint64 auxHash)
 {
-	return LatteSHRC_Get(sGeometryShaders, baseHash, auxHash);
+	return sGeometryShaderLookup.shaders.Find(baseHash, auxHash);
 }
 
 LatteDecompilerShader* LatteSHRC_FindPixelShader(uint64 baseHash, uint64 auxHash)
 {
-	return LatteSHRC_Get(sPixelShaders, baseHash, auxHash);
+	return sPixelShaderLookup.shaders.Find(baseHash, auxHash);
 }
 
 // update the currently active fetch shader
@@ -691,12 +874,12 @@ LatteDecompilerShader* LatteShader_CreateShaderFromDecompilerOutput(LatteDecompi
 	// HACK
 	if (g_renderer->GetType() == RendererAPI::OpenGL)
 		shader->resourceMapping = decompilerOutput.resourceMappingGL;
-	else if (g_renderer->GetType() == RendererAPI::Vulkan)
-		shader->resourceMapping = decompilerOutput.resourceMappingVK;
 #if ENABLE_METAL
-	else
+	else if (g_renderer->GetType() == RendererAPI::Metal)
 		shader->resourceMapping = decompilerOutput.resourceMappingMTL;
 #endif
+	else
+		shader->resourceMapping = decompilerOutput.resourceMappingVK; // Vulkan and null renderer
 	// copy texture info
 	shader->textureUnitMask2 = decompilerOutput.textureUnitMask;
 	// copy streamout info
@@ -705,7 +888,7 @@ LatteDecompilerShader* LatteShader_CreateShaderFromDecompilerOutput(LatteDecompi
 	// copy uniform offsets
 	// for OpenGL these are retrieved in _prepareSeparableUniforms()
 	// HACK
-	if (g_renderer->GetType() == RendererAPI::Vulkan || g_renderer->GetType() == RendererAPI::Metal)
+	if (g_renderer->GetType() == RendererAPI::Vulkan || g_renderer->GetType() == RendererAPI::Metal || g_renderer->GetType() == RendererAPI::Null)
 	{
 		shader->uniform.loc_remapped = decompilerOutput.uniformOffsetsVK.offset_remapped;
 		shader->uniform.loc_uniformRegister = decompilerOutput.uniformOffsetsVK.offset_uniformRegister;
@@ -919,12 +1102,12 @@ void LatteSHRC_UpdateVertexShader(uint8* vertexShaderPtr, uint32 vertexShaderSiz
 	// todo - should include VTX_SEMANTIC table in state
 	LatteSHRC_UpdateVSBaseHash(vertexShaderPtr, vertexShaderSize, usesGeometryShader);
 	uint64 vsAuxHash = 0;
-	auto itBaseShader = sVertexShaders.find(_shaderBaseHash_vs);
+	LatteDecompilerShader* baseShader = sVertexShaderLookup.baseShaders.Find(_shaderBaseHash_vs, 0);
 	LatteDecompilerShader* vertexShader = nullptr;
-	if (itBaseShader != sVertexShaders.end())
+	if (baseShader)
 	{
-		vsAuxHash = LatteSHRC_CalcVSAuxHash(itBaseShader->second, LatteGPUState.contextRegister);
-		vertexShader = LatteSHRC_GetFromChain(itBaseShader->second, _shaderBaseHash_vs, vsAuxHash);
+		vsAuxHash = LatteSHRC_CalcVSAuxHash(baseShader, LatteGPUState.contextRegister);
+		vertexShader = sVertexShaderLookup.shaders.Find(_shaderBaseHash_vs, vsAuxHash);
 	}
 	if (!vertexShader)
 		vertexShader = LatteShader_CompileSeparableVertexShader(_shaderBaseHash_vs, vsAuxHash, vertexShaderPtr, vertexShaderSize, usesGeometryShader, _activeFetchShader);
@@ -945,12 +1128,10 @@ void LatteSHRC_UpdateGeometryShader(bool usesGeometryShader, uint8* geometryShad
 		return;
 	}
 	LatteSHRC_UpdateGSBaseHash(geometryShaderPtr, geometryShaderSize, geometryCopyShader, geometryCopyShaderSize);
-	auto itBaseShader = sGeometryShaders.find(_shaderBaseHash_gs);
-	LatteDecompilerShader* geometryShader;
-	if (itBaseShader != sGeometryShaders.end())
+	LatteDecompilerShader* geometryShader = sGeometryShaderLookup.baseShaders.Find(_shaderBaseHash_gs, 0);
+	if (geometryShader)
 	{
 		// geometry shader already known
-		geometryShader = itBaseShader->second;
 		cemu_assert_debug(LatteSHRC_CalcGSAuxHash(geometryShader) == 0);
 	}
 	else
@@ -970,12 +1151,12 @@ void LatteSHRC_UpdatePixelShader(uint8* pixelShaderPtr, uint32 pixelShaderSize,
 {
 	LatteSHRC_UpdatePSBaseHash(pixelShaderPtr, pixelShaderSize, usesGeometryShader);
 	uint64 psAuxHash = 0;
-	auto itBaseShader = sPixelShaders.find(_shaderBaseHash_ps);
+	LatteDecompilerShader* baseShader = sPixelShaderLookup.baseShaders.Find(_shaderBaseHash_ps, 0);
 	LatteDecompilerShader* pixelShader = nullptr;
-	if (itBaseShader != sPixelShaders.end())
+	if (baseShader)
 	{
-		psAuxHash = LatteSHRC_CalcPSAuxHash(itBaseShader->second, LatteGPUState.contextRegister);
-		pixelShader = LatteSHRC_GetFromChain(itBaseShader->second, _shaderBaseHash_ps, psAuxHash);
+		psAuxHash = LatteSHRC_CalcPSAuxHash(baseShader, LatteGPUState.contextRegister);
+		pixelShader = sPixelShaderLookup.shaders.Find(_shaderBaseHash_ps, psAuxHash);
 	}
 	if (!pixelShader)
 		pixelShader = LatteShader_CompileSeparablePixelShader(_shaderBaseHash_ps, psAuxHash, pixelShaderPtr, pixelShaderSize, usesGeometryShader);
@@ -987,8 +1168,29 @@ void LatteSHRC_UpdatePixelShader(uint8* pixelShaderPtr, uint32 pixelShaderSize,
 	_activePixelShader = pixelShader;
 }
 
+// shader programs are decompiled straight from guest memory, so GPU captures need a copy of every program range
+static void LatteSHRC_RecordProgramMemoryForCapture(bool geometryShaderUsed)
+{
+	auto recordProgram = [](uint32 regIndex)
+	{
+		uint32 programAddr = (LatteGPUState.contextRegister[regIndex] & 0xFFFFFF) << 8;
+		uint32 programSize = LatteGPUState.contextRegister[regIndex + 1] << 3;
+		if (programAddr != 0)
+			LatteCapture_RecordMemory(programAddr, programSize);
+	};
+	recordProgram(mmSQ_PGM_START_FS);
+	recordProgram(mmSQ_PGM_START_VS);
+	recordProgram(mmSQ_PGM_START_PS);
+	if (geometryShaderUsed)
+	{
+		recordProgram(mmSQ_PGM_START_ES);
+		recordProgram(mmSQ_PGM_START_GS);
+	}
+}
+
 void LatteSHRC_UpdateActiveShaders()
 {
+	LATTE_PROFILE_SCOPE(ShaderLookup);
 	// check if geometry shader is used
 	auto gsMode = LatteGPUState.contextNew.VGT_GS_MODE.get_MODE();
 
@@ -1009,6 +1211,8 @@ void LatteSHRC_UpdateActiveShaders()
 	{
 		cemu_assert_debug(false);
 	}
+	if (LatteCapture_IsCapturing())
+		LatteSHRC_RecordProgramMemoryForCapture(geometryShaderUsed);
 	// get shader programs
 	uint8* psProgramCode = (uint8*)memory_getPointerFromPhysicalOffset((LatteGPUState.contextRegister[mmSQ_PGM_START_PS] & 0xFFFFFF) << 8);
 	uint32 psProgramSize = LatteGPUState.contextRegister[mmSQ_PGM_START_PS + 1] << 3;
@@ -1090,4 +1294,9 @@ void LatteSHRC_UnloadAll()
     while(!sPixelShaders.empty())
         LatteShader_free(sPixelShaders.begin()->second);
     cemu_assert_debug(sPixelShaders.empty());
+	for (LatteSHRCLookup* lookup : { &sVertexShaderLookup, &sGeometryShaderLookup, &sPixelShaderLookup })
+	{
+		lookup->baseShaders.Reset();
+		lookup->shaders.Reset();
+	}
 }
@@ -87,6 +87,7 @@ struct LatteShaderPSInputTable
 void LatteShader_CreatePSInputTable(LatteShaderPSInputTable* psInputTable, uint32* contextRegisters);
 void LatteShader_UpdatePSInputs(uint32* contextRegisters);
 LatteShaderPSInputTable* LatteSHRC_GetPSInputTable();
+void LatteSHRC_SetThreadPSInputTable(LatteShaderPSInputTable* psInputTable); // redirect the PS input table for the calling thread, used when decompiling shaders outside of the GPU thread
 
 void LatteShader_free(LatteDecompilerShader* shader);
 void LatteSHRC_RemoveFromCacheByHash(uint64 shader_base_hash, uint64 shader_aux_hash, LatteConst::ShaderType type);
@@ -1,4 +1,5 @@
 #include "Cafe/CafeSystem.h"
+#include "Cafe/BootProfiler.h"
 #include "Cafe/HW/Latte/Core/LatteConst.h"
 #include "Cafe/HW/Latte/Core/Latte.h"
 #include "Cafe/HW/Latte/Core/LatteShader.h"
@@ -27,16 +28,18 @@
 #include "Cafe/HW/Latte/Common/RegisterSerializer.h"
 #include "Cafe/HW/Latte/Common/ShaderSerializer.h"
 #include "util/helpers/Serializer.h"
+#include "util/helpers/helpers.h"
 
 #include <audio/IAudioAPI.h>
 #include <util/bootSound/BootSoundReader.h>
 #include <thread>
+#include <condition_variable>
 
 #if BOOST_OS_WINDOWS
 #include <psapi.h>
 #endif
 
-#define SHADER_CACHE_COMPILE_QUEUE_SIZE		(32)
+#define SHADER_CACHE_COMPILE_QUEUE_SIZE		(128) // large enough to keep all shader compile threads busy
 
 struct
 {
@@ -67,7 +70,18 @@ FileCache* s_shaderCacheGeneric = nullptr;	// contains hardware and version inde
 #define SHADER_CACHE_TYPE_GEOMETRY				(1)
 #define SHADER_CACHE_TYPE_PIXEL					(2)
 
-bool LatteShaderCache_readSeparableShader(uint8* shaderInfoData, sint32 shaderInfoSize);
+// shader decoded and decompiled from a cache entry but not yet compiled or registered
+struct LatteShaderCacheDecodedShader
+{
+	LatteDecompilerShader* shader{};
+	uint64 shaderBaseHash{};
+	uint64 shaderAuxHash{};
+	uint32 dumpType{};
+	std::vector<uint8> programData; // raw program, only needed for dumping
+};
+
+bool LatteShaderCache_decodeSeparableShader(uint8* shaderInfoData, sint32 shaderInfoSize, LatteShaderCacheDecodedShader& decodedShader);
+void LatteShaderCache_finishSeparableShader(LatteShaderCacheDecodedShader& decodedShader);
 void LatteShaderCache_LoadPipelineCache(uint64 cacheTitleId);
 bool LatteShaderCache_updatePipelineLoadingProgress();
 void LatteShaderCache_ShowProgress(const std::function <bool(void)>& loadUpdateFunc, bool isPipelines);
@@ -336,8 +350,128 @@ void LatteShaderCache_drawBackgroundImage(ImTextureID texture, int width, int he
 	ImGui::PopStyleVar(2);
 }
 
+// decodes and decompiles the entries of the transferable shader cache on all host cores
+// the GPU thread consumes the results strictly in file index order, so compilation and registration into the shader tables happen in the same order as with serial loading
+class LatteShaderCacheParallelLoader
+{
+	static constexpr uint32 kMaxEntriesAhead = 1024; // how far the workers may run ahead of the GPU thread, bounds memory used by decompiled but not yet compiled shaders
+
+public:
+	enum class ENTRY_STATE : uint8
+	{
+		PENDING,
+		EMPTY, // no file at this index
+		INVALID,
+		DECODED,
+	};
+
+	struct Entry
+	{
+		ENTRY_STATE state{ ENTRY_STATE::PENDING };
+		uint64 name1{};
+		uint64 name2{};
+		LatteShaderCacheDecodedShader decodedShader;
+	};
+
+	LatteShaderCacheParallelLoader(FileCache* fileCache, uint32 entryCount) : m_fileCache(fileCache), m_entries(entryCount)
+	{
+		const uint32 threadCount = std::max<uint32>(GetPhysicalCoreCount(), 1);
+		for (uint32 i = 0; i < threadCount; i++)
+			m_threads.emplace_back(&LatteShaderCacheParallelLoader::WorkerThread, this);
+	}
+
+	~LatteShaderCacheParallelLoader()
+	{
+		m_mutex.lock();
+		m_stopRequested = true;
+		m_mutex.unlock();
+		m_workerCondVar.notify_all();
+		for (auto& it : m_threads)
+			it.join();
+		// release shaders which were decompiled but never handed out (loading was cancelled)
+		for (size_t i = m_consumeIndex; i < m_entries.size(); i++)
+		{
+			LatteDecompilerShader* shader = m_entries[i].decodedShader.shader;
+			if (m_entries[i].state != ENTRY_STATE::DECODED || !shader)
+				continue;
+			LatteShader_CleanupAfterCompile(shader);
+			delete shader;
+		}
+	}
+
+	uint32 GetThreadCount() const
+	{
+		return (uint32)m_threads.size();
+	}
+
+	// returns the entry at the current load index or nullptr if the workers haven't finished it within the timeout
+	Entry* GetNext(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock _l(m_mutex);
+		if (!m_readyCondVar.wait_for(_l, timeout, [&]() { return m_entries[m_consumeIndex].state != ENTRY_STATE::PENDING; }))
+			return nullptr;
+		return m_entries.data() + m_consumeIndex;
+	}
+
+	void PopNext()
+	{
+		m_mutex.lock();
+		std::vector<uint8>().swap(m_entries[m_consumeIndex].decodedShader.programData);
+		m_consumeIndex++;
+		m_mutex.unlock();
+		m_workerCondVar.notify_all();
+	}
+
+private:
+	void WorkerThread()
+	{
+		SetThreadName("ShaderCacheLoad");
+		// decompiling a shader updates the PS input table, each worker gets its own
+		LatteShaderPSInputTable psInputTable{};
+		LatteSHRC_SetThreadPSInputTable(&psInputTable);
+		std::span<const uint8> fileView;
+		std::vector<uint8> fileStorage;
+		while (true)
+		{
+			size_t index;
+			{
+				std::unique_lock _l(m_mutex);
+				m_workerCondVar.wait(_l, [&]() { return m_stopRequested || m_nextIndex >= m_entries.size() || m_nextIndex < m_consumeIndex + kMaxEntriesAhead; });
+				if (m_stopRequested || m_nextIndex >= m_entries.size())
+					break;
+				index = m_nextIndex++;
+			}
+			// the entry is only accessed by this thread until its state leaves PENDING
+			Entry& entry = m_entries[index];
+			ENTRY_STATE newState;
+			if (!m_fileCache->GetFileViewByIndex((sint32)index, &entry.name1, &entry.name2, fileView, fileStorage))
+				newState = ENTRY_STATE::EMPTY;
+			else if (LatteShaderCache_decodeSeparableShader((uint8*)fileView.data(), (sint32)fileView.size(), entry.decodedShader))
+				newState = ENTRY_STATE::DECODED;
+			else
+				newState = ENTRY_STATE::INVALID;
+			m_mutex.lock();
+			entry.state = newState;
+			m_mutex.unlock();
+			m_readyCondVar.notify_all();
+		}
+		LatteSHRC_SetThreadPSInputTable(nullptr);
+	}
+
+	FileCache* m_fileCache;
+	std::vector<Entry> m_entries;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_workerCondVar;
+	std::condition_variable m_readyCondVar;
+	size_t m_nextIndex{ 0 }; // next index to be picked up by a worker
+	size_t m_consumeIndex{ 0 }; // next index to be consumed by the GPU thread
+	bool m_stopRequested{ false };
+};
+
 void LatteShaderCache_Load()
 {
+	BOOT_PROFILE_SCOPE("ShaderCacheLoad");
 	shaderCacheScreenStats.compiledShaderCount = 0;
 	shaderCacheScreenStats.vertexShaderCount = 0;
 	shaderCacheScreenStats.geometryShaderCount = 0;
@@ -388,11 +522,13 @@ void LatteShaderCache_Load()
 		return;
 	}
 	s_shaderCacheGeneric->UseCompression(false);
+	s_shaderCacheGeneric->EnableCompactionOnClose(true); // rewritten on application exit if replaced entries left too much unused space
 
 	// load/compile cached shaders
 	sint32 entryCount = s_shaderCacheGeneric->GetMaximumFileIndex();
 	g_shaderCacheLoaderState.shaderFileCount = s_shaderCacheGeneric->GetFileCount();
 	g_shaderCacheLoaderState.loadedShaderFiles = 0;
+	g_shaderCacheLoaderState.loadedPipelines = 0;
 
 	// get game background loading image
 	auto loadBackgroundTexture = [](bool isTV, ImTextureID& out)
@@ -430,35 +566,47 @@ void LatteShaderCache_Load()
 
 	sint32 numLoadedShaders = 0;
 	uint32 loadIndex = 0;
+	const auto timeDecompileStart = now_cached();
+	auto parallelLoader = std::make_unique<LatteShaderCacheParallelLoader>(s_shaderCacheGeneric, (uint32)std::max<sint32>(entryCount, 0));
 
 	auto LoadShadersUpdate = [&]() -> bool
 	{
-		if (loadIndex >= (uint32)s_shaderCacheGeneric->GetMaximumFileIndex())
+		if (loadIndex >= (uint32)entryCount)
 			return false;
 		LatteShaderCache_updateCompileQueue(SHADER_CACHE_COMPILE_QUEUE_SIZE - 2);
-		uint64 name1;
-		uint64 name2;
-		std::vector<uint8> fileData;
-		if (!s_shaderCacheGeneric->GetFileByIndex(loadIndex, &name1, &name2, fileData))
+		// don't block for long so the loading screen keeps updating
+		LatteShaderCacheParallelLoader::Entry* entry = parallelLoader->GetNext(std::chrono::milliseconds(5));
+		if (!entry)
+			return true;
+		if (entry->state == LatteShaderCacheParallelLoader::ENTRY_STATE::EMPTY)
 		{
+			parallelLoader->PopNext();
 			loadIndex++;
 			return true;
 		}
 		g_shaderCacheLoaderState.loadedShaderFiles++;
-		if (LatteShaderCache_readSeparableShader(fileData.data(), fileData.size()) == false)
+		if (entry->state == LatteShaderCacheParallelLoader::ENTRY_STATE::INVALID)
 		{
 			// something is wrong with the stored shader, remove entry from shader cache files
 			cemuLog_log(LogType::Force, "Shader cache entry {} invalid, deleting...", loadIndex);
-			s_shaderCacheGeneric->DeleteFile({name1, name2 });
+			s_shaderCacheGeneric->DeleteFile({entry->name1, entry->name2 });
 		}
+		else
+			LatteShaderCache_finishSeparableShader(entry->decodedShader);
+		parallelLoader->PopNext();
 		numLoadedShaders++;
 		loadIndex++;
 		return true;
 	};
 
 	LatteShaderCache_ShowProgress(LoadShadersUpdate, false);
+	const uint32 loaderThreadCount = parallelLoader->GetThreadCount();
+	parallelLoader.reset();
+	const auto timeDecompileEnd = now_cached();
 
 	LatteShaderCache_updateCompileQueue(0);
+	const auto timeDecompile = std::chrono::duration_cast<std::chrono::milliseconds>(timeDecompileEnd - timeDecompileStart).count();
+	cemuLog_log(LogType::Force, "Shader cache: Decompiled {} shaders on {} threads in {}ms", numLoadedShaders, loaderThreadCount, timeDecompile);
 	// write load time and RAM usage to log file (in dev build)
 #if BOOST_OS_WINDOWS
 	const auto timeLoadEnd = now_cached();
@@ -473,6 +621,9 @@ void LatteShaderCache_Load()
 	// if Vulkan or Metal then also load pipeline cache
 	if (g_renderer->GetType() == RendererAPI::Vulkan || g_renderer->GetType() == RendererAPI::Metal)
         LatteShaderCache_LoadPipelineCache(cacheTitleId);
+	// time from the start of loading until the first frame can be rendered
+	const auto timeWarmUp = std::chrono::duration_cast<std::chrono::milliseconds>(now_cached() - timeLoadStart).count();
+	cemuLog_log(LogType::Force, "Shader cache: Warm-up with {} shaders and {} pipelines took {}ms", numLoadedShaders, g_shaderCacheLoaderState.loadedPipelines, timeWarmUp);
 
 
 	g_renderer->BeginFrame(true);
@@ -634,6 +785,7 @@ void LatteShaderCache_ShowProgress(const std::function <bool(void)>& loadUpdateF
 
 void LatteShaderCache_LoadPipelineCache(uint64 cacheTitleId)
 {
+	BOOT_PROFILE_SCOPE("PipelineCacheLoad");
 	if (g_renderer->GetType() == RendererAPI::Vulkan)
 	    g_shaderCacheLoaderState.pipelineFileCount = VulkanPipelineStableCache::GetInstance().BeginLoading(cacheTitleId);
 #if ENABLE_METAL
@@ -766,7 +918,9 @@ void LatteShaderCache_loadOrCompileSeparableShader(LatteDecompilerShader* shader
 	LatteShaderCache_addToCompileQueue(shader);
 }
 
-bool LatteShaderCache_readSeparableVertexShader(MemStreamReader& streamReader, uint8 version)
+// the decode steps don't access any GPU thread state and are run on the shader cache loader threads
+// the PS input table is redirected to a per-thread copy by the caller
+bool LatteShaderCache_decodeSeparableVertexShader(MemStreamReader& streamReader, uint8 version, LatteShaderCacheDecodedShader& decodedShader)
 {
 	auto lcr = std::make_unique<LatteContextRegister>();
 	if (version != 1)
@@ -804,16 +958,15 @@ bool LatteShaderCache_readSeparableVertexShader(MemStreamReader& streamReader, u
 	// decompile vertex shader
 	LatteDecompilerOutput_t decompilerOutput{};
 	LatteDecompiler_DecompileVertexShader(shaderBaseHash, lcr->GetRawView(), vertexShaderData.data(), vertexShaderData.size(), fetchShader, options, &decompilerOutput);
-	LatteDecompilerShader* vertexShader = LatteShader_CreateShaderFromDecompilerOutput(decompilerOutput, shaderBaseHash, false, shaderAuxHash, lcr->GetRawView());
-	// compile
-	LatteShader_DumpShader(shaderBaseHash, shaderAuxHash, vertexShader);
-	LatteShader_DumpRawShader(shaderBaseHash, shaderAuxHash, SHADER_DUMP_TYPE_VERTEX, vertexShaderData.data(), vertexShaderData.size());
-	LatteShaderCache_loadOrCompileSeparableShader(vertexShader, shaderBaseHash, shaderAuxHash);
-	LatteSHRC_RegisterShader(vertexShader, shaderBaseHash, shaderAuxHash);
+	decodedShader.shader = LatteShader_CreateShaderFromDecompilerOutput(decompilerOutput, shaderBaseHash, false, shaderAuxHash, lcr->GetRawView());
+	decodedShader.shaderBaseHash = shaderBaseHash;
+	decodedShader.shaderAuxHash = shaderAuxHash;
+	decodedShader.dumpType = SHADER_DUMP_TYPE_VERTEX;
+	decodedShader.programData = std::move(vertexShaderData);
 	return true;
 }
 
-bool LatteShaderCache_readSeparableGeometryShader(MemStreamReader& streamReader, uint8 version)
+bool LatteShaderCache_decodeSeparableGeometryShader(MemStreamReader& streamReader, uint8 version, LatteShaderCacheDecodedShader& decodedShader)
 {
 	if (version != 1)
 		return false;
@@ -846,16 +999,15 @@ bool LatteShaderCache_readSeparableGeometryShader(MemStreamReader& streamReader,
 	// decompile geometry shader
 	LatteDecompilerOutput_t decompilerOutput{};
 	LatteDecompiler_DecompileGeometryShader(shaderBaseHash, lcr->GetRawView(), geometryShaderData.data(), geometryShaderData.size(), geometryCopyShaderData.data(), geometryCopyShaderData.size(), vsRingParameterCount, options, &decompilerOutput);
-	LatteDecompilerShader* geometryShader = LatteShader_CreateShaderFromDecompilerOutput(decompilerOutput, shaderBaseHash, false, shaderAuxHash, lcr->GetRawView());
-	// compile
-	LatteShader_DumpShader(shaderBaseHash, shaderAuxHash, geometryShader);
-	LatteShader_DumpRawShader(shaderBaseHash, shaderAuxHash, SHADER_DUMP_TYPE_GEOMETRY, geometryShaderData.data(), geometryShaderData.size());
-	LatteShaderCache_loadOrCompileSeparableShader(geometryShader, shaderBaseHash, shaderAuxHash);
-	LatteSHRC_RegisterShader(geometryShader, shaderBaseHash, shaderAuxHash);
+	decodedShader.shader = LatteShader_CreateShaderFromDecompilerOutput(decompilerOutput, shaderBaseHash, false, shaderAuxHash, lcr->GetRawView());
+	decodedShader.shaderBaseHash = shaderBaseHash;
+	decodedShader.shaderAuxHash = shaderAuxHash;
+	decodedShader.dumpType = SHADER_DUMP_TYPE_GEOMETRY;
+	decodedShader.programData = std::move(geometryShaderData);
 	return true;
 }
 
-bool LatteShaderCache_readSeparablePixelShader(MemStreamReader& streamReader, uint8 version)
+bool LatteShaderCache_decodeSeparablePixelShader(MemStreamReader& streamReader, uint8 version, LatteShaderCacheDecodedShader& decodedShader)
 {
 	if (version != 1)
 		return false;
@@ -884,17 +1036,16 @@ bool LatteShaderCache_readSeparablePixelShader(MemStreamReader& streamReader, ui
 	// decompile pixel shader
 	LatteDecompilerOutput_t decompilerOutput{};
 	LatteDecompiler_DecompilePixelShader(shaderBaseHash, lcr->GetRawView(), pixelShaderData.data(), pixelShaderData.size(), options, &decompilerOutput);
-	LatteDecompilerShader* pixelShader = LatteShader_CreateShaderFromDecompilerOutput(decompilerOutput, shaderBaseHash, false, shaderAuxHash, lcr->GetRawView());
-	// compile
-	LatteShader_DumpShader(shaderBaseHash, shaderAuxHash, pixelShader);
-	LatteShader_DumpRawShader(shaderBaseHash, shaderAuxHash, SHADER_DUMP_TYPE_PIXEL, pixelShaderData.data(), pixelShaderData.size());
-	LatteShaderCache_loadOrCompileSeparableShader(pixelShader, shaderBaseHash, shaderAuxHash);
-	LatteSHRC_RegisterShader(pixelShader, shaderBaseHash, shaderAuxHash);
+	decodedShader.shader = LatteShader_CreateShaderFromDecompilerOutput(decompilerOutput, shaderBaseHash, false, shaderAuxHash, lcr->GetRawView());
+	decodedShader.shaderBaseHash = shaderBaseHash;
+	decodedShader.shaderAuxHash = shaderAuxHash;
+	decodedShader.dumpType = SHADER_DUMP_TYPE_PIXEL;
+	decodedShader.programData = std::move(pixelShaderData);
 	return true;
 }
 
-// read shader info from shader cache
-bool LatteShaderCache_readSeparableShader(uint8* shaderInfoData, sint32 shaderInfoSize)
+// parse and decompile shader info from shader cache
+bool LatteShaderCache_decodeSeparableShader(uint8* shaderInfoData, sint32 shaderInfoSize, LatteShaderCacheDecodedShader& decodedShader)
 {
 	if (shaderInfoSize < 8)
 		return false;
@@ -903,14 +1054,24 @@ bool LatteShaderCache_readSeparableShader(uint8* shaderInfoData, sint32 shaderIn
 	uint8 version = versionAndType & 0xF;
 	uint8 type = (versionAndType >> 4) & 0xF;
 	if (type == SHADER_CACHE_TYPE_VERTEX)
-		return LatteShaderCache_readSeparableVertexShader(streamReader, version);
+		return LatteShaderCache_decodeSeparableVertexShader(streamReader, version, decodedShader);
 	else if (type == SHADER_CACHE_TYPE_GEOMETRY)
-		return LatteShaderCache_readSeparableGeometryShader(streamReader, version);
+		return LatteShaderCache_decodeSeparableGeometryShader(streamReader, version, decodedShader);
 	else if (type == SHADER_CACHE_TYPE_PIXEL)
-		return LatteShaderCache_readSeparablePixelShader(streamReader, version);
+		return LatteShaderCache_decodeSeparablePixelShader(streamReader, version, decodedShader);
 	return false;
 }
 
+// create the renderer shader and register the decoded shader. Runs on the GPU thread
+void LatteShaderCache_finishSeparableShader(LatteShaderCacheDecodedShader& decodedShader)
+{
+	LatteDecompilerShader* shader = decodedShader.shader;
+	LatteShader_DumpShader(decodedShader.shaderBaseHash, decodedShader.shaderAuxHash, shader);
+	LatteShader_DumpRawShader(decodedShader.shaderBaseHash, decodedShader.shaderAuxHash, decodedShader.dumpType, decodedShader.programData.data(), decodedShader.programData.size());
+	LatteShaderCache_loadOrCompileSeparableShader(shader, decodedShader.shaderBaseHash, decodedShader.shaderAuxHash);
+	LatteSHRC_RegisterShader(shader, decodedShader.shaderBaseHash, decodedShader.shaderAuxHash);
+}
+
 void LatteShaderCache_Close()
 {
     if(s_shaderCacheGeneric)
@@ -8,21 +8,12 @@
 
 #include "Cafe/GraphicPack/GraphicPack2.h"
 
-#include <boost/container/small_vector.hpp>
-
-struct TexMemOccupancyEntry
-{
-	uint32 addrStart;
-	uint32 addrEnd;
-	LatteTextureSliceMipInfo* sliceMipInfo;
-};
-
-#define TEX_OCCUPANCY_BUCKET_COUNT		(0x800) // each bucket covers a range of 2MB
-#define TEX_OCCUPANCY_BUCKET_SIZE		(0x100000000/TEX_OCCUPANCY_BUCKET_COUNT)
+#include "util/containers/IntervalTree.h"
 
-#define loopItrMemOccupancyBuckets(__startAddr, __endAddr)		for(sint32 startBucketIndex = ((__startAddr)/TEX_OCCUPANCY_BUCKET_SIZE), bucketIndex=startBucketIndex; bucketIndex<=((__endAddr-1)/TEX_OCCUPANCY_BUCKET_SIZE); bucketIndex++)
+#include <boost/container/small_vector.hpp>
 
-std::vector<TexMemOccupancyEntry> list_texMemOccupancyBucket[TEX_OCCUPANCY_BUCKET_COUNT];
+// index of all slice/mip memory ranges of all textures
+IntervalTree<uint32, LatteTextureSliceMipInfo*> s_texMemOccupancy;
 
 std::atomic_bool s_refreshTextureQueryList;
 std::vector<LatteTextureInformation> s_cacheInfoList;
@@ -107,12 +98,7 @@ void LatteTexture_RefreshInfoCache()
 
 void LatteTexture_AddTexMemOccupancyInterval(LatteTextureSliceMipInfo* sliceMipInfo)
 {
-	TexMemOccupancyEntry entry;
-	entry.addrStart = sliceMipInfo->addrStart;
-	entry.addrEnd = sliceMipInfo->addrEnd;
-	entry.sliceMipInfo = sliceMipInfo;
-	loopItrMemOccupancyBuckets(entry.addrStart, entry.addrEnd)
-		list_texMemOccupancyBucket[bucketIndex].push_back(entry);
+	s_texMemOccupancy.addRange(sliceMipInfo->addrStart, sliceMipInfo->addrEnd, sliceMipInfo);
 }
 
 void LatteTexture_RegisterTextureMemoryOccupancy(LatteTexture* texture)
@@ -136,18 +122,9 @@ void LatteTexture_RegisterTextureMemoryOccupancy(LatteTexture* texture)
 
 void LatteTexture_RemoveTexMemOccupancyInterval(LatteTexture* texture, LatteTextureSliceMipInfo* sliceMipInfo)
 {
-	loopItrMemOccupancyBuckets(sliceMipInfo->addrStart, sliceMipInfo->addrEnd)
-	{
-		for (sint32 i = 0; i < list_texMemOccupancyBucket[bucketIndex].size(); i++)
-		{
-			if (list_texMemOccupancyBucket[bucketIndex][i].sliceMipInfo->texture == texture)
-			{
-				list_texMemOccupancyBucket[bucketIndex].erase(list_texMemOccupancyBucket[bucketIndex].begin() + i);
-				i--;
-				continue;
-			}
-		}
-	}
+	cemu_assert_debug(sliceMipInfo->texture == texture);
+	bool wasRemoved = s_texMemOccupancy.removeRange(sliceMipInfo->addrStart, sliceMipInfo);
+	cemu_assert_debug(wasRemoved);
 }
 
 void LatteTexture_UnregisterTextureMemoryOccupancy(LatteTexture* texture)
@@ -660,32 +637,30 @@ void LatteTexture_TrackTextureRelation(LatteTexture* texture1, LatteTexture* tex
 	}
 }
 
-void LatteTexture_TrackDataOverlap(LatteTexture* texture, LatteTextureSliceMipInfo* sliceMipInfo, TexMemOccupancyEntry& occupancy)
+void LatteTexture_TrackDataOverlap(LatteTexture* texture, LatteTextureSliceMipInfo* sliceMipInfo, LatteTextureSliceMipInfo* occMipSliceInfo)
 {
 	// todo - handle tile thickness and z offset
 
 	// todo - check address range overlap
-	auto& occMipSliceInfo = occupancy.sliceMipInfo;
-
 	if ((sliceMipInfo->addrEnd > occMipSliceInfo->addrStart && sliceMipInfo->addrStart < occMipSliceInfo->addrEnd) == false)
 		return;
 
 	// check if this overlap is already tracked
 	for (auto& it : sliceMipInfo->list_dataOverlap)
 	{
-		if (it.destMipSliceInfo == occupancy.sliceMipInfo)
+		if (it.destMipSliceInfo == occMipSliceInfo)
 			return;
 	}
 	// register texture->dest
 	LatteTextureSliceMipDataOverlap_t overlapEntry;
-	overlapEntry.destMipSliceInfo = occupancy.sliceMipInfo;
-	overlapEntry.destTexture = occupancy.sliceMipInfo->texture;
+	overlapEntry.destMipSliceInfo = occMipSliceInfo;
+	overlapEntry.destTexture = occMipSliceInfo->texture;
 	sliceMipInfo->list_dataOverlap.push_back(overlapEntry);
 	// register dest->texture
 	LatteTextureSliceMipDataOverlap_t overlapEntry2;
 	overlapEntry2.destMipSliceInfo = sliceMipInfo;
 	overlapEntry2.destTexture = sliceMipInfo->texture;
-	occupancy.sliceMipInfo->list_dataOverlap.push_back(overlapEntry2);
+	occMipSliceInfo->list_dataOverlap.push_back(overlapEntry2);
 }
 
 void _LatteTexture_RemoveDataOverlapTracking(LatteTexture* texture, LatteTextureSliceMipInfo* sliceMipInfo, LatteTextureSliceMipDataOverlap_t& dataOverlap)
@@ -742,36 +717,30 @@ void LatteTexture_GatherTextureRelations(LatteTexture* texture)
 		for (sint32 sliceIndex = 0; sliceIndex < mipSliceCount; sliceIndex++)
 		{
 			LatteTextureSliceMipInfo* sliceMipInfo = texture->sliceMipInfo + texture->GetSliceMipArrayIndex(sliceIndex, mipIndex);
-			loopItrMemOccupancyBuckets(sliceMipInfo->addrStart, sliceMipInfo->addrEnd)
-			{
-				for (auto& occupancy : list_texMemOccupancyBucket[bucketIndex])
+			// note: end is inclusive here, ranges which only touch are considered as well
+			s_texMemOccupancy.lookupRangesInclusive(sliceMipInfo->addrStart, sliceMipInfo->addrEnd, [&](LatteTextureSliceMipInfo* occMipSliceInfo) {
+				LatteTexture* itrTexture = occMipSliceInfo->texture;
+				if (itrTexture == texture)
+					return; // ignore self
+				if (sliceMipInfo->addrStart == occMipSliceInfo->addrStart && sliceMipInfo->subIndex == occMipSliceInfo->subIndex)
 				{
-					LatteTexture* itrTexture = occupancy.sliceMipInfo->texture;
-					if (itrTexture == texture)
-						continue; // ignore self
-					if (sliceMipInfo->addrEnd >= occupancy.addrStart && sliceMipInfo->addrStart < occupancy.addrEnd)
+					// overlapping with zero x/y offset
+					if (sliceMipInfo->pitch == occMipSliceInfo->pitch && LatteTexture_IsTexelSizeCompatibleFormat(texture->format, itrTexture->format)
+						&& sliceMipInfo->tileMode == occMipSliceInfo->tileMode &&
+						LatteTexture_IsFormatViewCompatible(texture->format, itrTexture->format))
+					{
+						LatteTexture_TrackTextureRelation(texture, itrTexture);
+					}
+					else
 					{
-						if (sliceMipInfo->addrStart == occupancy.addrStart && sliceMipInfo->subIndex == occupancy.sliceMipInfo->subIndex)
-						{
-							// overlapping with zero x/y offset
-							if (sliceMipInfo->pitch == occupancy.sliceMipInfo->pitch && LatteTexture_IsTexelSizeCompatibleFormat(texture->format, itrTexture->format)
-								&& sliceMipInfo->tileMode == occupancy.sliceMipInfo->tileMode &&
-								LatteTexture_IsFormatViewCompatible(texture->format, itrTexture->format))
-							{
-								LatteTexture_TrackTextureRelation(texture, itrTexture);
-							}
-							else
-							{
-								// pitch not compatible or format not compatible
-							}
-						}
-						else
-						{
-							LatteTexture_TrackDataOverlap(texture, sliceMipInfo, occupancy);
-						}
+						// pitch not compatible or format not compatible
 					}
 				}
-			}
+				else
+				{
+					LatteTexture_TrackDataOverlap(texture, sliceMipInfo, occMipSliceInfo);
+				}
+			});
 		}
 	}
 }
@@ -994,28 +963,21 @@ LatteTextureView* LatteTexture_CreateMapping(MPTR physAddr, MPTR physMipAddr, si
 		LatteAddrLib::CalculateMipAndSliceAddr(physAddr, physMipAddr, format, width, height, depth, dimBase, tileMode, swizzle, 0, mipIndex, sliceIndex, &calcSliceAddrStart, &calcSliceSize, &calcSubSliceIndex);
 		uint32 calcSliceAddrEnd = calcSliceAddrStart + calcSliceSize;
 		// attempt to create view in already existing texture first (we may have to recreate the texture with new specifications)
-		loopItrMemOccupancyBuckets(calcSliceAddrStart, calcSliceAddrEnd)
-		{
-			for (auto& occupancy : list_texMemOccupancyBucket[bucketIndex])
+		s_texMemOccupancy.lookupRangesInclusive(calcSliceAddrStart, calcSliceAddrEnd, [&](LatteTextureSliceMipInfo* occMipSliceInfo) {
+			if (calcSliceAddrStart == occMipSliceInfo->addrStart)
 			{
-				if (calcSliceAddrEnd >= occupancy.addrStart && calcSliceAddrStart < occupancy.addrEnd)
+				// overlapping with zero x/y offset
+				if (std::find(list_overlappingTextures.begin(), list_overlappingTextures.end(), occMipSliceInfo->texture) == list_overlappingTextures.end())
 				{
-					if (calcSliceAddrStart == occupancy.addrStart)
-					{
-						// overlapping with zero x/y offset
-						if (std::find(list_overlappingTextures.begin(), list_overlappingTextures.end(), occupancy.sliceMipInfo->texture) == list_overlappingTextures.end())
-						{
-							list_overlappingTextures.push_back(occupancy.sliceMipInfo->texture);
-						}
-					}
-					else
-					{
-						// overlapping but not matching directly
-						// todo - check if they match with a y offset
-					}
+					list_overlappingTextures.push_back(occMipSliceInfo->texture);
 				}
 			}
-		}
+			else
+			{
+				// overlapping but not matching directly
+				// todo - check if they match with a y offset
+			}
+		});
 	}
 	// try to merge textures if possible
 	for (auto& tex : list_overlappingTextures)
@@ -1092,50 +1054,37 @@ LatteTextureView* LatteTC_LookupTextureByData(MPTR physAddr, sint32 width, sint3
 {
 	cemu_assert_debug(firstMip == 0);
 	sint32 cSearchIndex = 0;
-	loopItrMemOccupancyBuckets(physAddr, physAddr+1)
-	{
-		auto& bucket = list_texMemOccupancyBucket[bucketIndex];
-		for (sint32 i = 0; i < bucket.size(); i++)
+	LatteTextureView* foundView = nullptr;
+	s_texMemOccupancy.lookupRangesByStart(physAddr, [&](LatteTextureSliceMipInfo* occMipSliceInfo) {
+		if (foundView)
+			return;
+		LatteTexture* tex = occMipSliceInfo->texture;
+		if (tex->physAddress == physAddr && tex->pitch == pitch)
 		{
-			if (bucket[i].addrStart == physAddr)
+			if (firstSlice >= 0 && firstSlice < (tex->depth))
 			{
-				LatteTexture* tex = bucket[i].sliceMipInfo->texture;
-				if (tex->physAddress == physAddr && tex->pitch == pitch)
+				if (cSearchIndex >= *searchIndex)
 				{
-					if (firstSlice >= 0 && firstSlice < (tex->depth))
-					{
-						if (cSearchIndex >= *searchIndex)
-						{
-							(*searchIndex)++;
-							return tex->baseView;
-						}
-						cSearchIndex++;
-					}
+					(*searchIndex)++;
+					foundView = tex->baseView;
+					return;
 				}
+				cSearchIndex++;
 			}
 		}
-	}
-
-	return nullptr;
+	});
+	return foundView;
 }
 
 void LatteTC_LookupTexturesByPhysAddr(MPTR physAddr, std::vector<LatteTexture*>& list_textures)
 {
-	sint32 cSearchIndex = 0;
-	loopItrMemOccupancyBuckets(physAddr, physAddr + 1)
-	{
-		for (sint32 i = 0; i < list_texMemOccupancyBucket[bucketIndex].size(); i++)
+	s_texMemOccupancy.lookupRangesByStart(physAddr, [&](LatteTextureSliceMipInfo* occMipSliceInfo) {
+		LatteTexture* tex = occMipSliceInfo->texture;
+		if (tex->physAddress == physAddr)
 		{
-			if (list_texMemOccupancyBucket[bucketIndex][i].addrStart == physAddr)
-			{
-				LatteTexture* tex = list_texMemOccupancyBucket[bucketIndex][i].sliceMipInfo->texture;
-				if (tex->physAddress == physAddr)
-				{
-					vectorAppendUnique(list_textures, tex);
-				}
-			}
+			vectorAppendUnique(list_textures, tex);
 		}
-	}
+	});
 }
 
 LatteTextureView* LatteTC_GetTextureSliceViewOrTryCreate(MPTR srcImagePtr, MPTR srcMipPtr, Latte::E_GX2SURFFMT srcFormat, Latte::E_HWTILEMODE srcTileMode, uint32 srcWidth, uint32 srcHeight, uint32 srcDepth, uint32 srcPitch, uint32 srcSwizzle, uint32 srcSlice, uint32 srcMip, const bool requireExactResolution)
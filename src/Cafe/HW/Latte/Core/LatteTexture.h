@@ -191,6 +191,8 @@ public:
 	// usage
 	uint32 lastAccessTick{};
 	uint32 lastAccessFrameCount{};
+	LatteTexture* lruPrev{}; // more recently used neighbour in texture cache LRU list
+	LatteTexture* lruNext{}; // less recently used neighbour
 	// detection of render feedback loops (see OpenGL 4.5 spec, 9.3)
 	uint32 lastUnflushedRTDrawcallIndex{};
 	// views
@@ -4,21 +4,58 @@
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
 #include "Common/cpu_features.h"
 
-std::unordered_set<LatteTexture*> g_allTextures;
+// all registered textures, ordered by last access. Head is the most recently used texture
+LatteTexture* s_lruHead{};
+LatteTexture* s_lruTail{};
+LatteTexture* s_lruScanCursor{}; // next texture to be checked by the incremental cleanup, walks from tail towards head
+
+void _LatteTC_LRUUnlink(LatteTexture* tex)
+{
+	if (s_lruScanCursor == tex)
+		s_lruScanCursor = tex->lruPrev;
+	if (tex->lruPrev)
+		tex->lruPrev->lruNext = tex->lruNext;
+	else
+		s_lruHead = tex->lruNext;
+	if (tex->lruNext)
+		tex->lruNext->lruPrev = tex->lruPrev;
+	else
+		s_lruTail = tex->lruPrev;
+	tex->lruPrev = nullptr;
+	tex->lruNext = nullptr;
+}
+
+void _LatteTC_LRUPushFront(LatteTexture* tex)
+{
+	tex->lruPrev = nullptr;
+	tex->lruNext = s_lruHead;
+	if (s_lruHead)
+		s_lruHead->lruPrev = tex;
+	else
+		s_lruTail = tex;
+	s_lruHead = tex;
+}
+
+bool _LatteTC_LRUIsLinked(LatteTexture* tex)
+{
+	return tex->lruPrev != nullptr || s_lruHead == tex;
+}
 
 void LatteTC_Init()
 {
-	cemu_assert_debug(g_allTextures.empty());
+	cemu_assert_debug(s_lruHead == nullptr);
 }
 
 void LatteTC_RegisterTexture(LatteTexture* tex)
 {
-	g_allTextures.emplace(tex);
+	cemu_assert_debug(!_LatteTC_LRUIsLinked(tex));
+	_LatteTC_LRUPushFront(tex);
 }
 
 void LatteTC_UnregisterTexture(LatteTexture* tex)
 {
-	g_allTextures.erase(tex);
+	if (_LatteTC_LRUIsLinked(tex))
+		_LatteTC_LRUUnlink(tex);
 }
 
 // sample few uint64s uniformly over memory range
@@ -200,6 +237,9 @@ uint64 _botwLargeTexHax = 0;
 
 bool LatteTC_HasTextureChanged(LatteTexture* hostTexture, bool force)
 {
+	// the retile thread may still be writing readback data to the texture memory, the tracker is reset once the readback is retired
+	if (LatteTextureReadback_IsWritePending(hostTexture))
+		return false;
 	if (hostTexture->forceInvalidate)
 	{
 		force = true;
@@ -260,6 +300,12 @@ void LatteTC_MarkTextureStillInUse(LatteTexture* texture)
 {
 	texture->lastAccessTick = LatteGPUState.currentDrawCallTick;
 	texture->lastAccessFrameCount = LatteGPUState.frameCounter;
+	// move to front of LRU list, this keeps the list sorted by lastAccessTick
+	if (s_lruHead != texture && _LatteTC_LRUIsLinked(texture))
+	{
+		_LatteTC_LRUUnlink(texture);
+		_LatteTC_LRUPushFront(texture);
+	}
 }
 
 // check if a texture has been overwritten by another texture using GPU-writes
@@ -364,32 +410,31 @@ void LatteTexture_RefreshInfoCache();
 
 /*
  * Scans for unused textures and deletes them
+ * Textures are visited in LRU order, starting with the least recently used one. Each call continues where the previous one stopped
  * Called at the end of every frame
  */
 void LatteTC_CleanupUnusedTextures()
 {
-	static size_t currentScanIndex = 0;
 	uint32 currentTick = GetTickCount();
 	sint32 maxDelete = 10;
-	std::vector<LatteTexture*>& allTextures = LatteTexture::GetAllTextures();
-	if (!allTextures.empty())
+	if (!s_lruScanCursor)
+		s_lruScanCursor = s_lruTail;
+	for (sint32 c = 0; c < 25 && s_lruScanCursor; c++)
 	{
-		for (sint32 c = 0; c < 25; c++)
+		LatteTexture* texItr = s_lruScanCursor;
+		if ((currentTick - texItr->lastAccessTick) < 100 && (LatteGPUState.currentDrawCallTick - texItr->lastAccessTick) < 100)
 		{
-			if (currentScanIndex >= allTextures.size())
-				currentScanIndex = 0;
-			LatteTexture* texItr = allTextures[currentScanIndex];
-			currentScanIndex++;
-			if (!texItr)
-				continue;
-			if (LatteTC_CleanupCheckTexture(texItr, currentTick))
-			{
-				maxDelete--;
-				if (maxDelete <= 0)
-					break; // deleting can be an expensive operation, dont delete too many at once to avoid micro stutter
-				if (allTextures.empty())
-					break;
-			}
+			// this and all remaining textures have been used very recently, restart from the tail next time
+			s_lruScanCursor = nullptr;
+			break;
+		}
+		// advance cursor before the check, if the texture gets deleted the cursor is kept valid by _LatteTC_LRUUnlink()
+		s_lruScanCursor = texItr->lruPrev;
+		if (LatteTC_CleanupCheckTexture(texItr, currentTick))
+		{
+			maxDelete--;
+			if (maxDelete <= 0)
+				break; // deleting can be an expensive operation, dont delete too many at once to avoid micro stutter
 		}
 	}
 	LatteTexture_RefreshInfoCache(); // find a better place to call this from?
@@ -400,13 +445,14 @@ std::vector<LatteTexture*> LatteTC_GetDeleteableTextures()
 	std::vector<LatteTexture*> texList;
 	uint32 currentFrameCount = LatteGPUState.frameCounter;
 
-	for (auto& itr : g_allTextures)
+	// walk from the least recently used texture, results are sorted by age
+	for (LatteTexture* itr = s_lruTail; itr; itr = itr->lruPrev)
 	{
 		if(itr->lastAccessFrameCount == 0)
 			continue; // not initialized
 		uint32 framesSinceLastAccess = currentFrameCount - itr->lastAccessFrameCount;
 		if(framesSinceLastAccess < 3)
-			continue;
+			break; // all remaining textures were accessed more recently
 		if (itr->isUpdatedOnGPU)
 		{
 			if (LatteTC_IsTextureDataOverwritten(itr))
@@ -1,6 +1,7 @@
 #include "Cafe/HW/Latte/ISA/RegDefines.h"
 #include "Cafe/HW/Latte/Core/Latte.h"
 #include "Cafe/HW/Latte/Core/LatteShader.h"
+#include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
 
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
 
@@ -288,6 +289,7 @@ void LatteTexture_updateTexturesForStage(LatteDecompilerShader* shaderContext, u
 // also sets LatteGPUState.requiresTextureBarrier to true if texture barrier is required
 void LatteTexture_updateTextures()
 {
+	LATTE_PROFILE_SCOPE(TextureCache);
 	LatteGPUState.textureBindCounter++;
 	// pixel shader
 	LatteDecompilerShader* pixelShader = LatteSHRC_GetActivePixelShader();
@@ -2,6 +2,7 @@
 #include "Cafe/HW/Latte/LatteAddrLib/LatteAddrLib.h"
 #include "config/ActiveSettings.h"
 #include "Cafe/CafeSystem.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
 
 //#define BENCHMARK_TEXTURE_DECODING		// if defined, time it takes to decode textures will be measured and logged to log.txt
 
@@ -595,6 +596,11 @@ void LatteTextureLoader_UpdateTextureSliceData(LatteTexture* tex, uint32 sliceIn
 
 	Latte::E_GX2SURFFMT format = tex->format;
 	LatteTextureLoader_begin(&textureLoader, sliceIndex, mipIndex, physImagePtr, physMipPtr, format, dim, width, height, depth, mipLevels, pitch, tileMode, swizzle);
+	// record from the surface base up to the end of the loaded level, levelOffset is relative to the mip chain base
+	if (mipIndex == 0)
+		LatteCapture_RecordMemory(textureLoader.physAddress, textureLoader.maxOffsetOutdated);
+	else
+		LatteCapture_RecordMemory(textureLoader.physMipAddress, textureLoader.levelOffset + textureLoader.maxOffsetOutdated);
 
 	// enable texture dumping
 	textureLoader.dump = ActiveSettings::DumpTexturesEnabled();
@@ -694,30 +700,22 @@ void LatteTextureLoader_UpdateTextureSliceData(LatteTexture* tex, uint32 sliceIn
 	catchOpenGLError();
 }
 
-template<typename copyType>
+template<uint32 bytesPerPixel>
 void optimizedLinearReadbackWriteLoop(LatteTextureLoaderCtx* textureLoader, uint8* linearPixelData)
 {
-	uint32 pitch = textureLoader->width;
-	// optimized for linear
+	// optimized for linear, each row is contiguous in both the host and the guest layout
+	const uint32 rowSize = textureLoader->width * bytesPerPixel;
+	if (textureLoader->pitch == textureLoader->width)
+	{
+		uint8* blockData = LatteTextureLoader_getInputLinearOptimized_(textureLoader, 0, 0, 1, 1, bytesPerPixel * 8, 0, 1, 0, textureLoader->pitch, textureLoader->height);
+		memcpy(blockData, linearPixelData, rowSize * textureLoader->height);
+		return;
+	}
 	for (sint32 y = 0; y < textureLoader->height; y++)
 	{
-		sint32 yc = y;
-		sint32 pixelOffset = yc * pitch;
-		copyType* rowPixelData = (copyType*)(linearPixelData + pixelOffset * sizeof(copyType));
-		copyType* blockData = (copyType*)LatteTextureLoader_getInputLinearOptimized_(textureLoader, 0, y, 1, 1, sizeof(copyType) * 8, 0, 1, 0, textureLoader->pitch, textureLoader->height);
-		if constexpr (sizeof(copyType) == 4)
-		{
-			memcpy_dwords(blockData, rowPixelData, textureLoader->width);
-		}
-		else
-		{
-			for (sint32 x = 0; x < textureLoader->width; x++)
-			{
-				*blockData = *rowPixelData;
-				rowPixelData++;
-				blockData++;
-			}
-		}
+		uint8* rowPixelData = linearPixelData + y * rowSize;
+		uint8* blockData = LatteTextureLoader_getInputLinearOptimized_(textureLoader, 0, y, 1, 1, bytesPerPixel * 8, 0, 1, 0, textureLoader->pitch, textureLoader->height);
+		memcpy(blockData, rowPixelData, rowSize);
 	}
 }
 
@@ -740,71 +738,25 @@ void LatteTextureLoader_writeReadbackTextureToMemory(LatteTextureDefinition* tex
 
 	if (textureData->tileMode == Latte::E_HWTILEMODE::TM_LINEAR_ALIGNED)
 	{
-		uint32 pitch = textureLoader.width;
 		if (textureData->format == Latte::E_GX2SURFFMT::R8_G8_B8_A8_UNORM ||
-			textureData->format == Latte::E_GX2SURFFMT::R8_G8_B8_A8_SRGB)
+			textureData->format == Latte::E_GX2SURFFMT::R8_G8_B8_A8_SRGB ||
+			textureData->format == Latte::E_GX2SURFFMT::R32_FLOAT)
 		{
-			optimizedLinearReadbackWriteLoop<uint32>(&textureLoader, linearPixelData);
+			optimizedLinearReadbackWriteLoop<4>(&textureLoader, linearPixelData);
 		}
-		else if (textureData->format == Latte::E_GX2SURFFMT::R16_G16_B16_A16_UNORM)
+		else if (textureData->format == Latte::E_GX2SURFFMT::R16_G16_B16_A16_UNORM ||
+			textureData->format == Latte::E_GX2SURFFMT::R16_G16_B16_A16_FLOAT)
 		{
-			optimizedLinearReadbackWriteLoop<uint64>(&textureLoader, linearPixelData);
+			optimizedLinearReadbackWriteLoop<8>(&textureLoader, linearPixelData);
 		}
 		else if (textureData->format == Latte::E_GX2SURFFMT::R32_G32_B32_A32_FLOAT)
 		{
-			for (sint32 y = 0; y < textureLoader.height; y += textureLoader.stepY)
-			{
-				sint32 yc = y;
-				sint32 pixelOffset = (0 + yc * pitch) * 16;
-				for (sint32 x = 0; x < textureLoader.width; x += textureLoader.stepX)
-				{
-					uint8* blockData = LatteTextureLoader_getInputLinearOptimized(&textureLoader, x, y);
-					(*(uint32*)(blockData + 0)) = *(uint32*)(linearPixelData + pixelOffset + 0);
-					(*(uint32*)(blockData + 4)) = *(uint32*)(linearPixelData + pixelOffset + 4);
-					(*(uint32*)(blockData + 8)) = *(uint32*)(linearPixelData + pixelOffset + 8);
-					(*(uint32*)(blockData + 12)) = *(uint32*)(linearPixelData + pixelOffset + 12);
-					pixelOffset += 16;
-				}
-			}
-		}
-		else if (textureData->format == Latte::E_GX2SURFFMT::R32_FLOAT)
-		{
-			for (sint32 y = 0; y < textureLoader.height; y += textureLoader.stepY)
-			{
-				sint32 yc = y;
-				for (sint32 x = 0; x < textureLoader.width; x += textureLoader.stepX)
-				{
-					uint8* blockData = LatteTextureLoader_getInputLinearOptimized(&textureLoader, x, y);
-					sint32 pixelOffset = (x + yc * pitch) * 4;
-					(*(uint32*)(blockData + 0)) = *(uint32*)(linearPixelData + pixelOffset + 0);
-				}
-			}
-		}
-		else if (textureData->format == Latte::E_GX2SURFFMT::R16_G16_B16_A16_FLOAT)
-		{
-			for (sint32 y = 0; y < textureLoader.height; y += textureLoader.stepY)
-			{
-				sint32 yc = y;
-				for (sint32 x = 0; x < textureLoader.width; x += textureLoader.stepX)
-				{
-					uint8* blockData = LatteTextureLoader_getInputLinearOptimized(&textureLoader, x, y);
-					sint32 pixelOffset = (x + yc * pitch) * 8;
-					(*(uint32*)(blockData + 0)) = *(uint32*)(linearPixelData + pixelOffset + 0);
-					(*(uint32*)(blockData + 4)) = *(uint32*)(linearPixelData + pixelOffset + 4);
-				}
-			}
-		}
-		else if (textureData->format == Latte::E_GX2SURFFMT::R8_G8_UNORM)
-		{
-			optimizedLinearReadbackWriteLoop<uint16>(&textureLoader, linearPixelData);
-		}
-		else if (textureData->format == Latte::E_GX2SURFFMT::R16_G16_B16_A16_UNORM)
-		{
-			cemu_assert_unimplemented();
+			optimizedLinearReadbackWriteLoop<16>(&textureLoader, linearPixelData);
 		}
-		else if (textureData->format == Latte::E_GX2SURFFMT::R16_UNORM)
+		else if (textureData->format == Latte::E_GX2SURFFMT::R8_G8_UNORM ||
+			textureData->format == Latte::E_GX2SURFFMT::R16_UNORM)
 		{
-			optimizedLinearReadbackWriteLoop<uint16>(&textureLoader, linearPixelData);
+			optimizedLinearReadbackWriteLoop<2>(&textureLoader, linearPixelData);
 		}
 		else
 		{
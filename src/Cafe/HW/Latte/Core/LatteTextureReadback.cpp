@@ -7,6 +7,8 @@
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
 #include "Cafe/HW/Latte/Core/LatteTexture.h"
 #include "Cafe/HW/Latte/Renderer/OpenGL/LatteTextureViewGL.h"
+#include "input/TAS/TASInput.h"
+#include "util/helpers/helpers.h"
 
 #define LOG_READBACK_TIME
 
@@ -19,6 +21,82 @@ struct LatteTextureReadbackQueueEntry
 
 std::vector<LatteTextureReadbackQueueEntry> sTextureScheduledReadbacks; // readbacks that have been queued but the actual transfer has not yet been started
 std::queue<LatteTextureReadbackInfo*> sTextureActiveReadbackQueue; // readbacks in flight
+std::deque<LatteTextureReadbackInfo*> sTextureRetileQueue; // transfer finished, waiting for the data to be written to guest memory and retired on the GPU thread
+
+/*
+ * Retiling the data and writing it to guest memory is done on a separate thread so the GPU thread doesn't stall on large readbacks
+ * There is only one thread and jobs are processed strictly in queue order, thus guest memory is always updated in the same order in which the transfers were started
+ */
+class LatteTextureReadbackRetileThread
+{
+public:
+	void Queue(LatteTextureReadbackInfo* readbackInfo, uint8* pixelData)
+	{
+		std::unique_lock _l(m_mutex);
+		if (!m_thread.joinable())
+		{
+			m_shutdown = false;
+			m_thread = std::thread(&LatteTextureReadbackRetileThread::ThreadFunc, this);
+		}
+		m_jobs.emplace_back(readbackInfo, pixelData);
+		_l.unlock();
+		m_queueCondVar.notify_one();
+	}
+
+	void WaitForCompletion(LatteTextureReadbackInfo* readbackInfo)
+	{
+		std::unique_lock _l(m_mutex);
+		m_doneCondVar.wait(_l, [&]() { return readbackInfo->isWrittenToMemory.load(std::memory_order_acquire); });
+	}
+
+	// finishes all queued jobs and stops the thread
+	void Shutdown()
+	{
+		std::unique_lock _l(m_mutex);
+		if (!m_thread.joinable())
+			return;
+		m_shutdown = true;
+		_l.unlock();
+		m_queueCondVar.notify_one();
+		m_thread.join();
+	}
+
+private:
+	void ThreadFunc()
+	{
+		SetThreadName("TexReadbackWrite");
+		std::unique_lock _l(m_mutex);
+		while (true)
+		{
+			m_queueCondVar.wait(_l, [&]() { return !m_jobs.empty() || m_shutdown; });
+			if (m_jobs.empty())
+				break;
+			auto [readbackInfo, pixelData] = m_jobs.front();
+			m_jobs.pop_front();
+			_l.unlock();
+			LatteTextureLoader_writeReadbackTextureToMemory(&readbackInfo->hostTextureCopy, 0, 0, pixelData);
+			_l.lock();
+			readbackInfo->isWrittenToMemory.store(true, std::memory_order_release);
+			m_doneCondVar.notify_all();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_queueCondVar;
+	std::condition_variable m_doneCondVar;
+	std::deque<std::pair<LatteTextureReadbackInfo*, uint8*>> m_jobs;
+	std::thread m_thread;
+	bool m_shutdown{ false };
+};
+
+LatteTextureReadbackRetileThread sTextureReadbackRetileThread;
+
+// in TAS mode readback data only becomes visible to the guest at explicit sync points (IT_HLE_SYNC_ASYNC_OPERATIONS or when the staging buffer runs full)
+// otherwise the time at which the guest observes the data would depend on how fast the host GPU completes the transfer
+static bool _LatteTextureReadback_IsDeterministic()
+{
+	return TasInput::IsStrictTasModeEnabled() || TasInput::IsDeterministicSchedulerEnabled();
+}
 
 void LatteTextureReadback_StartTransfer(LatteTextureView* textureView)
 {
@@ -102,14 +180,9 @@ void LatteTextureReadback_Initate(LatteTextureView* textureView)
 	sTextureScheduledReadbacks.emplace_back(queueEntry);
 }
 
-void LatteTextureReadback_UpdateFinishedTransfers(bool forceFinish)
+// hands finished transfers over to the retile thread, in order of submission
+static void _LatteTextureReadback_ProcessActiveTransfers(bool forceFinish)
 {
-	if (forceFinish)
-	{
-		// start any delayed transfers
-		LatteTextureReadback_Update(true);
-	}
-	performanceMonitor.gpuTime_waitForAsync.beginMeasuring();
 	while (!sTextureActiveReadbackQueue.empty())
 	{
 		LatteTextureReadbackInfo* readbackInfo = sTextureActiveReadbackQueue.front();
@@ -147,18 +220,87 @@ void LatteTextureReadback_UpdateFinishedTransfers(bool forceFinish)
 			cemuLog_log(LogType::TextureReadback, "[Texture-Readback] {:08x} Res {}/{} TM {} FMT {:04x} ReadbackLatency: {:6.3}ms WaitTime: {:6.3}ms ForcedWait {}", readbackInfo->hostTextureCopy.physAddress, readbackInfo->hostTextureCopy.width, readbackInfo->hostTextureCopy.height, readbackInfo->hostTextureCopy.tileMode, (uint32)readbackInfo->hostTextureCopy.format, elapsedSecondsTransfer * 1000.0, elapsedSecondsWaiting * 1000.0, readbackInfo->forceFinish ? "yes" : "no");
 		}
 #endif
+		// remove from queue
+		cemu_assert_debug(readbackInfo == sTextureActiveReadbackQueue.front());
+		sTextureActiveReadbackQueue.pop();
+		// GetData() and ReleaseData() may need the renderer context and are always called on the GPU thread
 		uint8* pixelData = readbackInfo->GetData();
-		LatteTextureLoader_writeReadbackTextureToMemory(&readbackInfo->hostTextureCopy, 0, 0, pixelData);
+		sTextureRetileQueue.push_back(readbackInfo);
+		sTextureReadbackRetileThread.Queue(readbackInfo, pixelData);
+	}
+}
+
+// cleans up readbacks for which the data has been written to guest memory
+static void _LatteTextureReadback_RetireWrittenTransfers(bool waitForAll)
+{
+	while (!sTextureRetileQueue.empty())
+	{
+		LatteTextureReadbackInfo* readbackInfo = sTextureRetileQueue.front();
+		if (!readbackInfo->isWrittenToMemory.load(std::memory_order_acquire))
+		{
+			if (!waitForAll)
+				break;
+			sTextureReadbackRetileThread.WaitForCompletion(readbackInfo);
+		}
+		sTextureRetileQueue.pop_front();
 		readbackInfo->ReleaseData();
 		// get the original texture if it still exists and invalidate the current data hash
 		LatteTextureView* origTexView = LatteTextureViewLookupCache::lookupSlice(readbackInfo->hostTextureCopy.physAddress, readbackInfo->hostTextureCopy.width, readbackInfo->hostTextureCopy.height, readbackInfo->hostTextureCopy.pitch, 0, 0, readbackInfo->hostTextureCopy.format);
 		if (origTexView)
 			LatteTC_ResetTextureChangeTracker(origTexView->baseTexture, true);
 		delete readbackInfo;
-		// remove from queue
-		cemu_assert_debug(!sTextureActiveReadbackQueue.empty());
-		cemu_assert_debug(readbackInfo == sTextureActiveReadbackQueue.front());
-		sTextureActiveReadbackQueue.pop();
 	}
+}
+
+/*
+ * Returns true if a readback of the texture is handed to the retile thread but not yet retired
+ * Guest memory of the texture may be written concurrently, change detection has to skip the texture until the readback is retired and the change tracker is reset
+ */
+bool LatteTextureReadback_IsWritePending(LatteTexture* texture)
+{
+	for (LatteTextureReadbackInfo* readbackInfo : sTextureRetileQueue)
+	{
+		if (readbackInfo->hostTextureCopy.physAddress == texture->physAddress)
+			return true;
+	}
+	return false;
+}
+
+void LatteTextureReadback_UpdateFinishedTransfers(bool forceFinish)
+{
+	if (forceFinish)
+	{
+		// start any delayed transfers
+		LatteTextureReadback_Update(true);
+	}
+	performanceMonitor.gpuTime_waitForAsync.beginMeasuring();
+	if (forceFinish || !_LatteTextureReadback_IsDeterministic())
+		_LatteTextureReadback_ProcessActiveTransfers(forceFinish);
+	_LatteTextureReadback_RetireWrittenTransfers(forceFinish);
 	performanceMonitor.gpuTime_waitForAsync.endMeasuring();
 }
+
+/*
+ * Finishes all transfers in flight and writes their data to guest memory, but unlike _UpdateFinishedTransfers(true) does not start any scheduled transfers
+ * Used by the renderer when the readback staging buffer is full
+ */
+void LatteTextureReadback_WaitForActiveTransfers()
+{
+	performanceMonitor.gpuTime_waitForAsync.beginMeasuring();
+	_LatteTextureReadback_ProcessActiveTransfers(true);
+	_LatteTextureReadback_RetireWrittenTransfers(true);
+	performanceMonitor.gpuTime_waitForAsync.endMeasuring();
+}
+
+// called on GPU thread shutdown, readbacks which have not finished yet are dropped
+void LatteTextureReadback_Shutdown()
+{
+	sTextureReadbackRetileThread.Shutdown();
+	_LatteTextureReadback_RetireWrittenTransfers(true);
+	while (!sTextureActiveReadbackQueue.empty())
+	{
+		delete sTextureActiveReadbackQueue.front();
+		sTextureActiveReadbackQueue.pop();
+	}
+	sTextureScheduledReadbacks.clear();
+}
@@ -22,6 +22,7 @@ public:
 	HRTick transferStartTime;
 	HRTick waitStartTime;
 	bool forceFinish{ false }; // set to true if not finished in time for dependent operation
+	std::atomic_bool isWrittenToMemory{ false }; // set by the retile thread once the data has been stored in guest memory
 	// texture info
 	LatteTextureDefinition hostTextureCopy{};
 
@@ -4,6 +4,7 @@
 #include "Cafe/HW/Latte/Core/LatteDraw.h"
 #include "Cafe/HW/Latte/Core/LatteShader.h"
 #include "Cafe/HW/Latte/Core/LatteAsyncCommands.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
 #include "Cafe/GameProfile/GameProfile.h"
 #include "Cafe/GraphicPack/GraphicPack2.h"
 #include "WindowSystem.h"
@@ -11,6 +12,8 @@
 #include "Cafe/HW/Latte/Core/LatteBufferCache.h"
 
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
+#include "Cafe/HW/Latte/Renderer/Null/NullRenderer.h"
+#include "Cafe/HW/Latte/Core/LatteIndices.h"
 #include "Cafe/HW/Latte/Core/LatteTexture.h"
 #include "util/helpers/helpers.h"
 
@@ -18,6 +21,7 @@
 #include "config/ActiveSettings.h"
 
 #include "Cafe/CafeSystem.h"
+#include "Cafe/BootProfiler.h"
 
 LatteGPUState_t LatteGPUState = {};
 
@@ -37,6 +41,7 @@ void Latte_LoadInitialRegisters()
 	LatteGPUState.contextNew.VGT_DMA_NUM_INSTANCES.set_NUM_INSTANCES(1);
 	LatteGPUState.contextRegister[Latte::REGADDR::PA_CL_CLIP_CNTL] = 0;
 	*(float*)&LatteGPUState.contextRegister[mmDB_DEPTH_CLEAR] = 1.0f;
+	LatteGPUState.pipelineStateDirtyMask = Latte::PIPELINE_STATE_ALL;
 }
 
 extern bool gx2WriteGatherInited;
@@ -116,9 +121,9 @@ void LatteThread_HandleOSScreen()
 		g_renderer->SwapBuffers(swapTV, swapDRC);
 }
 
-int Latte_ThreadEntry()
+// initializes the renderer and all GPU side caches, called on the GPU thread
+static void LatteThread_InitRenderer()
 {
-	SetThreadName("LatteThread");
 	sint32 w,h;
 	WindowSystem::GetWindowPhysSize(w,h);
 
@@ -156,6 +161,16 @@ int Latte_ThreadEntry()
 	default:
 		break;
 	}
+}
+
+int Latte_ThreadEntry()
+{
+	SetThreadName("LatteThread");
+	BootProfiler_SetThreadLabel("GPU");
+	{
+		BOOT_PROFILE_SCOPE("InitRenderer");
+		LatteThread_InitRenderer();
+	}
 
 	sLatteThreadFinishedInit = true;
 
@@ -178,7 +193,10 @@ int Latte_ThreadEntry()
 	g_renderer->DrawEmptyFrame(true);
 
 	// before doing anything with game specific shaders, we need to wait for graphic packs to finish loading
-	GraphicPack2::WaitUntilReady();
+	{
+		BOOT_PROFILE_SCOPE("WaitForGraphicPacks");
+		GraphicPack2::WaitUntilReady();
+	}
 	// if legacy packs are enabled we cannot use the colorbuffer resolution optimization
 	LatteGPUState.allowFramebufferSizeOptimization = true;
 	for(auto& pack : GraphicPack2::GetActiveGraphicPacks())
@@ -296,8 +314,12 @@ bool Latte_WaitForPausedPresent(uint64 requestId, uint32 timeoutMs)
 	}
 }
 
-void LatteThread_Exit()
+// releases all GPU side resources and destroys the renderer
+static void LatteThread_Cleanup()
 {
+	LatteTextureReadback_Shutdown();
+	// clean up converted index data, the index allocations are released through the renderer so this has to happen before it shuts down
+	LatteIndices_unloadAll();
 	if (g_renderer)
 		g_renderer->Shutdown();
     // clean up vertex/uniform cache
@@ -320,6 +342,11 @@ void LatteThread_Exit()
 	std::memset(&LatteGPUState, 0, sizeof(LatteGPUState));
 	g_lattePauseRequested = false;
 	g_lattePaused = false;
+}
+
+void LatteThread_Exit()
+{
+	LatteThread_Cleanup();
 	#if BOOST_OS_WINDOWS
 	ExitThread(0);
 	#else
@@ -328,3 +355,25 @@ void LatteThread_Exit()
 	cemu_assert_unimplemented();
 }
 
+// runs a GPU capture on the null renderer without starting the CPU side of the emulator
+// guest memory must be mapped before calling this
+bool Latte_RunHeadlessReplay(const fs::path& capturePath, uint32 numLoops)
+{
+	std::unique_lock _lock(sLatteThreadStateMutex);
+	cemu_assert_debug(!sLatteThreadRunning);
+	cemu_assert_debug(!g_renderer);
+	g_renderer = std::make_unique<NullRenderer>();
+	sLatteThreadRunning = true;
+	bool result = false;
+	std::thread replayThread([&]()
+	{
+		SetThreadName("LatteThread");
+		LatteThread_InitRenderer();
+		Latte_LoadInitialRegisters();
+		result = LatteCapture_Replay(capturePath, numLoops);
+		LatteThread_Cleanup();
+	});
+	replayThread.join();
+	sLatteThreadRunning = false;
+	return result;
+}
@@ -1069,7 +1069,7 @@ void _LatteDecompiler_Process(LatteDecompilerShaderContext* shaderContext, uint8
 	// emit code
 	if (shaderContext->shader->hasError == false)
 	{
-	    if (g_renderer->GetType() == RendererAPI::OpenGL || g_renderer->GetType() == RendererAPI::Vulkan)
+	    if (g_renderer->GetType() == RendererAPI::OpenGL || g_renderer->GetType() == RendererAPI::Vulkan || g_renderer->GetType() == RendererAPI::Null)
 	        LatteDecompiler_emitGLSLShader(shaderContext, shaderContext->shader);
 #if ENABLE_METAL
 		else
@@ -0,0 +1,417 @@
+#include "Cafe/HW/Latte/Renderer/Null/NullRenderer.h"
+#include "Cafe/HW/Latte/Renderer/OpenGL/OpenGLRenderer.h"
+#include "Cafe/HW/Latte/Core/LatteCachedFBO.h"
+#include "Cafe/HW/Latte/Core/LatteQueryObject.h"
+#include "Cafe/HW/Latte/Core/LatteTextureReadbackInfo.h"
+
+#include "Cafe/HW/Latte/Core/Latte.h"
+#include "Cafe/HW/Latte/Core/LatteShader.h"
+#include "Cafe/HW/Latte/Core/LatteIndices.h"
+#include "Cafe/HW/Latte/Core/LatteBufferCache.h"
+#include "Cafe/HW/Latte/LegacyShaderDecompiler/LatteDecompiler.h"
+
+#include "imgui/imgui_extension.h"
+
+extern bool hasValidFramebufferAttached;
+
+// helper objects
+
+class CachedFBONull : public LatteCachedFBO
+{
+public:
+	CachedFBONull(uint64 key) : LatteCachedFBO(key) {}
+};
+
+class RendererShaderNull : public RendererShader
+{
+public:
+	RendererShaderNull(ShaderType type, uint64 baseHash, uint64 auxHash, bool isGameShader, bool isGfxPackShader, size_t sourceSize)
+		: RendererShader(type, baseHash, auxHash, isGameShader, isGfxPackShader), m_sourceSize(sourceSize) {}
+
+	void PreponeCompilation(bool isRenderThread) override {}
+	bool IsCompiled() override { return true; }
+	bool WaitForCompiled() override { return true; }
+
+	size_t GetSourceSize() const { return m_sourceSize; }
+
+private:
+	size_t m_sourceSize;
+};
+
+// there is no rasterization, queries always report zero passed samples
+class LatteQueryObjectNull : public LatteQueryObject
+{
+public:
+	bool getResult(uint64& numSamplesPassed) override
+	{
+		numSamplesPassed = 0;
+		return true;
+	}
+
+	void begin() override {}
+	void end() override {}
+};
+
+// nothing was rendered, readbacks return zeroed pixel data in the size the host texture would have
+class LatteTextureReadbackInfoNull : public LatteTextureReadbackInfo
+{
+public:
+	LatteTextureReadbackInfoNull(LatteTextureView* textureView) : LatteTextureReadbackInfo(textureView)
+	{
+		LatteTexture* baseTexture = textureView->baseTexture;
+		m_image_size = baseTexture->width * baseTexture->height * std::max<uint32>(Latte::GetFormatBits(baseTexture->format) / 8, 1);
+	}
+
+	void StartTransfer() override
+	{
+		m_data.assign(m_image_size, 0);
+	}
+
+	bool IsFinished() override { return true; }
+
+	uint8* GetData() override { return m_data.data(); }
+
+	void ReleaseData() override
+	{
+		m_data.clear();
+		m_data.shrink_to_fit();
+	}
+
+private:
+	std::vector<uint8> m_data;
+};
+
+// textures
+
+static uint64 _NullRenderer_CalculateTextureSize(Latte::E_DIM dim, Latte::E_GX2SURFFMT format, sint32 width, sint32 height, sint32 depth, sint32 mipLevels)
+{
+	const bool isCompressed = Latte::IsCompressedFormat(format);
+	const uint64 bytesPerElement = std::max<uint32>(Latte::GetFormatBits(format) / 8, 1);
+	uint64 size = 0;
+	for (sint32 mip = 0; mip < mipLevels; mip++)
+	{
+		sint32 mipWidth = std::max(width >> mip, 1);
+		sint32 mipHeight = std::max(height >> mip, 1);
+		sint32 mipDepth = dim == Latte::E_DIM::DIM_3D ? std::max(depth >> mip, 1) : depth;
+		uint64 numElements = isCompressed ? (uint64)((mipWidth + 3) / 4) * (uint64)((mipHeight + 3) / 4) : (uint64)mipWidth * (uint64)mipHeight;
+		size += numElements * bytesPerElement * (uint64)mipDepth;
+	}
+	return size;
+}
+
+LatteTextureNull::LatteTextureNull(NullRenderer* nullRenderer, Latte::E_DIM dim, MPTR physAddress, MPTR physMipAddress, Latte::E_GX2SURFFMT format, uint32 width, uint32 height, uint32 depth, uint32 pitch, uint32 mipLevels,
+	uint32 swizzle, Latte::E_HWTILEMODE tileMode, bool isDepth)
+	: LatteTexture(dim, physAddress, physMipAddress, format, width, height, depth, pitch, mipLevels, swizzle, tileMode, isDepth), m_nullRenderer(nullRenderer)
+{
+	sint32 effectiveBaseWidth = width;
+	sint32 effectiveBaseHeight = height;
+	sint32 effectiveBaseDepth = depth;
+	if (overwriteInfo.hasResolutionOverwrite)
+	{
+		effectiveBaseWidth = overwriteInfo.width;
+		effectiveBaseHeight = overwriteInfo.height;
+		effectiveBaseDepth = overwriteInfo.depth;
+	}
+	effectiveBaseWidth = std::max(1, effectiveBaseWidth);
+	effectiveBaseHeight = std::max(1, effectiveBaseHeight);
+	effectiveBaseDepth = std::max(1, effectiveBaseDepth);
+	if (dim == Latte::E_DIM::DIM_1D)
+		effectiveBaseHeight = 1;
+	sint32 effectiveMipLevels = std::clamp<sint32>(mipLevels, 1, maxPossibleMipLevels);
+
+	m_hostSize = _NullRenderer_CalculateTextureSize(dim, format, effectiveBaseWidth, effectiveBaseHeight, effectiveBaseDepth, effectiveMipLevels);
+	auto& stats = m_nullRenderer->GetStatsMutable();
+	stats.numTextures++;
+	stats.textureMemory += m_hostSize;
+}
+
+LatteTextureNull::~LatteTextureNull()
+{
+	auto& stats = m_nullRenderer->GetStatsMutable();
+	cemu_assert_debug(stats.numTextures > 0);
+	stats.numTextures--;
+	stats.textureMemory -= m_hostSize;
+}
+
+void LatteTextureNull::AllocateOnHost()
+{
+}
+
+LatteTextureView* LatteTextureNull::CreateView(Latte::E_DIM dim, Latte::E_GX2SURFFMT format, sint32 firstMip, sint32 mipCount, sint32 firstSlice, sint32 sliceCount)
+{
+	return new LatteTextureViewNull(m_nullRenderer, this, dim, format, firstMip, mipCount, firstSlice, sliceCount);
+}
+
+LatteTextureViewNull::LatteTextureViewNull(NullRenderer* nullRenderer, LatteTextureNull* texture, Latte::E_DIM dim, Latte::E_GX2SURFFMT format, sint32 firstMip, sint32 mipCount, sint32 firstSlice, sint32 sliceCount)
+	: LatteTextureView(texture, firstMip, mipCount, firstSlice, sliceCount, dim, format), m_nullRenderer(nullRenderer)
+{
+	m_nullRenderer->GetStatsMutable().numTextureViews++;
+}
+
+LatteTextureViewNull::~LatteTextureViewNull()
+{
+	m_nullRenderer->GetStatsMutable().numTextureViews--;
+}
+
+// renderer
+
+NullRenderer::NullRenderer()
+{
+	m_vendor = GfxVendor::Generic;
+}
+
+NullRenderer::~NullRenderer()
+{
+}
+
+NullRenderer* NullRenderer::GetInstance()
+{
+	cemu_assert_debug(g_renderer && dynamic_cast<NullRenderer*>(g_renderer.get()));
+	return (NullRenderer*)g_renderer.get();
+}
+
+void NullRenderer::Initialize()
+{
+	Renderer::Initialize();
+	cemuLog_log(LogType::Force, "Using null renderer, no graphics output will be produced");
+}
+
+void NullRenderer::Shutdown()
+{
+	cemuLog_log(LogType::Force, "Null renderer: {} frames, {} draws ({} skipped) in {} sequences, {} pipelines, {} shaders, {} textures ({}MB)",
+		m_stats.numFrames, m_stats.numDraws, m_stats.numSkippedDraws, m_stats.numDrawSequences, m_stats.numPipelines, m_stats.numShaders, m_stats.numTextures, m_stats.textureMemory / 1024 / 1024);
+	Renderer::Shutdown();
+}
+
+void NullRenderer::SwapBuffers(bool swapTV, bool swapDRC)
+{
+	if (swapTV)
+		m_stats.numFrames++;
+}
+
+void NullRenderer::AppendOverlayDebugInfo()
+{
+	ImGui::Text("--- Null renderer ---");
+	ImGui::Text("Textures                   %u (%lluMB)", m_stats.numTextures, (unsigned long long)(m_stats.textureMemory / 1024 / 1024));
+	ImGui::Text("Texture views              %u", m_stats.numTextureViews);
+	ImGui::Text("Shaders                    %u (%lluKB source)", m_stats.numShaders, (unsigned long long)(m_stats.shaderSourceSize / 1024));
+	ImGui::Text("Pipelines                  %u", m_stats.numPipelines);
+	ImGui::Text("Cached FBOs                %u", m_stats.numCachedFBOs);
+	ImGui::Text("Queries                    %u", m_stats.numQueries);
+	ImGui::Text("Draws                      %llu (skipped %llu, indexed %llu)", (unsigned long long)m_stats.numDraws, (unsigned long long)m_stats.numSkippedDraws, (unsigned long long)m_stats.numIndexedDraws);
+	ImGui::Text("Draw sequences             %llu", (unsigned long long)m_stats.numDrawSequences);
+}
+
+LatteCachedFBO* NullRenderer::rendertarget_createCachedFBO(uint64 key)
+{
+	m_stats.numCachedFBOs++;
+	return new CachedFBONull(key);
+}
+
+void NullRenderer::rendertarget_deleteCachedFBO(LatteCachedFBO* fbo)
+{
+	cemu_assert_debug(m_stats.numCachedFBOs > 0);
+	m_stats.numCachedFBOs--;
+	delete fbo;
+}
+
+void* NullRenderer::texture_acquireTextureUploadBuffer(uint32 size)
+{
+	if (m_textureUploadBuffer.size() < size)
+		m_textureUploadBuffer.resize(size);
+	return m_textureUploadBuffer.data();
+}
+
+TextureDecoder* NullRenderer::texture_chooseDecodedFormat(Latte::E_GX2SURFFMT format, bool isDepth, Latte::E_DIM dim, uint32 width, uint32 height)
+{
+	// decoding still runs so that the texture upload path is profiled, the decoded data is discarded
+	return OpenGLRenderer::GetTextureDecoder(format, isDepth, dim);
+}
+
+void NullRenderer::texture_loadSlice(LatteTexture* hostTexture, sint32 width, sint32 height, sint32 depth, void* pixelData, sint32 sliceIndex, sint32 mipIndex, uint32 compressedImageSize)
+{
+	m_stats.textureDataUploaded += compressedImageSize;
+}
+
+LatteTexture* NullRenderer::texture_createTextureEx(Latte::E_DIM dim, MPTR physAddress, MPTR physMipAddress, Latte::E_GX2SURFFMT format, uint32 width, uint32 height, uint32 depth, uint32 pitch, uint32 mipLevels, uint32 swizzle, Latte::E_HWTILEMODE tileMode, bool isDepth)
+{
+	return new LatteTextureNull(this, dim, physAddress, physMipAddress, format, width, height, depth, pitch, mipLevels, swizzle, tileMode, isDepth);
+}
+
+void NullRenderer::texture_copyImageSubData(LatteTexture* src, sint32 srcMip, sint32 effectiveSrcX, sint32 effectiveSrcY, sint32 srcSlice, LatteTexture* dst, sint32 dstMip, sint32 effectiveDstX, sint32 effectiveDstY, sint32 dstSlice, sint32 effectiveCopyWidth, sint32 effectiveCopyHeight, sint32 srcDepth)
+{
+	m_stats.numTextureCopies++;
+}
+
+LatteTextureReadbackInfo* NullRenderer::texture_createReadback(LatteTextureView* textureView)
+{
+	m_stats.numReadbacks++;
+	return new LatteTextureReadbackInfoNull(textureView);
+}
+
+void NullRenderer::surfaceCopy_copySurfaceWithFormatConversion(LatteTexture* sourceTexture, sint32 srcMip, sint32 srcSlice, LatteTexture* destinationTexture, sint32 dstMip, sint32 dstSlice, sint32 width, sint32 height)
+{
+	m_stats.numTextureCopies++;
+}
+
+void NullRenderer::bufferCache_init(const sint32 bufferSize)
+{
+	m_stats.bufferCacheSize = (uint32)bufferSize;
+}
+
+void NullRenderer::bufferCache_upload(uint8* buffer, sint32 size, uint32 bufferOffset)
+{
+	cemu_assert_debug((uint64)bufferOffset + (uint64)size <= m_stats.bufferCacheSize);
+	m_stats.bufferDataUploaded += size;
+}
+
+RendererShader* NullRenderer::shader_create(RendererShader::ShaderType type, uint64 baseHash, uint64 auxHash, const std::string& source, bool compileAsync, bool isGfxPackSource)
+{
+	// shaders are never destroyed via the renderer, so only the total is tracked
+	m_stats.numShaders++;
+	m_stats.shaderSourceSize += source.size();
+	return new RendererShaderNull(type, baseHash, auxHash, true, isGfxPackSource, source.size());
+}
+
+// a real backend would look up or compile a pipeline for every distinct shader combination
+void NullRenderer::TrackActivePipeline()
+{
+	LatteDecompilerShader* vertexShader = LatteSHRC_GetActiveVertexShader();
+	LatteDecompilerShader* geometryShader = LatteSHRC_GetActiveGeometryShader();
+	LatteDecompilerShader* pixelShader = LatteSHRC_GetActivePixelShader();
+	uint64 pipelineKey = 0;
+	for (LatteDecompilerShader* shader : { vertexShader, geometryShader, pixelShader })
+	{
+		pipelineKey = std::rotl<uint64>(pipelineKey, 17);
+		if (shader)
+			pipelineKey += shader->baseHash + std::rotl<uint64>(shader->auxHash, 7);
+	}
+	if (pipelineKey == m_activePipelineKey)
+		return;
+	m_activePipelineKey = pipelineKey;
+	if (m_pipelineKeys.emplace(pipelineKey).second)
+		m_stats.numPipelines = (uint32)m_pipelineKeys.size();
+}
+
+void NullRenderer::draw_beginSequence()
+{
+	m_drawSequenceSkip = false;
+	m_stats.numDrawSequences++;
+
+	bool streamoutEnable = LatteGPUState.contextRegister[mmVGT_STRMOUT_EN] != 0;
+
+	// update shader state
+	LatteSHRC_UpdateActiveShaders();
+	if (LatteGPUState.activeShaderHasError)
+	{
+		cemuLog_logDebugOnce(LogType::Force, "Skipping drawcalls due to shader error");
+		m_drawSequenceSkip = true;
+		return;
+	}
+
+	// update render target and texture state
+	LatteGPUState.requiresTextureBarrier = false;
+	while (true)
+	{
+		LatteGPUState.repeatTextureInitialization = false;
+		if (!LatteMRT::UpdateCurrentFBO())
+		{
+			m_drawSequenceSkip = true;
+			return; // no render target
+		}
+
+		if (!hasValidFramebufferAttached && !streamoutEnable)
+		{
+			m_drawSequenceSkip = true;
+			return; // no render target
+		}
+		LatteTexture_updateTextures();
+		if (!LatteGPUState.repeatTextureInitialization)
+			break;
+	}
+
+	LatteMRT::ApplyCurrentState();
+	LatteRenderTarget_updateViewport();
+	LatteRenderTarget_updateScissorBox();
+
+	// same no-op conditions as the other backends
+	bool rasterizerEnable = LatteGPUState.contextNew.PA_CL_CLIP_CNTL.get_DX_RASTERIZATION_KILL() == false;
+	if (!LatteGPUState.contextNew.PA_CL_VTE_CNTL.get_VPORT_X_OFFSET_ENA())
+		rasterizerEnable = true;
+	if (rasterizerEnable == false && streamoutEnable == false)
+		m_drawSequenceSkip = true;
+}
+
+void NullRenderer::draw_execute(uint32 baseVertex, uint32 baseInstance, uint32 instanceCount, uint32 count, MPTR indexDataMPTR, Latte::LATTE_VGT_DMA_INDEX_TYPE::E_INDEX_TYPE indexType, bool isFirst)
+{
+	m_stats.numDraws++;
+	// special state 5 and 8 are host-side clears/copies which are skipped along with regular draws that turn into no-ops
+	if (m_drawSequenceSkip || LatteGPUState.contextNew.GetSpecialStateValues()[8] != 0 || LatteGPUState.contextNew.GetSpecialStateValues()[5] != 0)
+	{
+		m_stats.numSkippedDraws++;
+		LatteGPUState.drawCallCounter++;
+		return;
+	}
+
+	if (isFirst)
+		TrackActivePipeline();
+
+	LatteStreamout_PrepareDrawcall(count, instanceCount);
+
+	// index data is decoded and vertex/uniform data synced into the buffer cache exactly like on the real backends
+	const LattePrimitiveMode primitiveMode = static_cast<LattePrimitiveMode>(LatteGPUState.contextRegister[mmVGT_PRIMITIVE_TYPE]);
+	Renderer::INDEX_TYPE hostIndexType;
+	uint32 hostIndexCount;
+	uint32 indexMin = 0;
+	uint32 indexMax = 0;
+	Renderer::IndexAllocation indexAllocation;
+	LatteIndices_decode(memory_getPointerFromVirtualOffset(indexDataMPTR), indexType, count, primitiveMode, indexMin, indexMax, hostIndexType, hostIndexCount, indexAllocation);
+	if (hostIndexType != INDEX_TYPE::NONE)
+		m_stats.numIndexedDraws++;
+	m_stats.numVertices += (uint64)(hostIndexType != INDEX_TYPE::NONE ? hostIndexCount : count) * std::max<uint32>(instanceCount, 1);
+
+	LatteBufferCache_Sync(indexMin + baseVertex, indexMax + baseVertex, baseInstance, instanceCount);
+
+	LatteStreamout_FinishDrawcall(false);
+	LatteGPUState.drawCallCounter++;
+}
+
+void NullRenderer::draw_endSequence()
+{
+	LatteDecompilerShader* pixelShader = LatteSHRC_GetActivePixelShader();
+	if (pixelShader)
+		LatteRenderTarget_trackUpdates();
+	LatteTextureReadback_Update();
+}
+
+Renderer::IndexAllocation NullRenderer::indexData_reserveIndexMemory(uint32 size)
+{
+	IndexAllocation allocation;
+	allocation.mem = malloc(size);
+	allocation.rendererInternal = nullptr;
+	return allocation;
+}
+
+void NullRenderer::indexData_releaseIndexMemory(IndexAllocation& allocation)
+{
+	free(allocation.mem);
+	allocation.mem = nullptr;
+}
+
+void NullRenderer::indexData_uploadIndexMemory(IndexAllocation& allocation)
+{
+	m_stats.numIndexUploads++;
+}
+
+LatteQueryObject* NullRenderer::occlusionQuery_create()
+{
+	m_stats.numQueries++;
+	return new LatteQueryObjectNull();
+}
+
+void NullRenderer::occlusionQuery_destroy(LatteQueryObject* queryObj)
+{
+	cemu_assert_debug(m_stats.numQueries > 0);
+	m_stats.numQueries--;
+	delete queryObj;
+}
@@ -858,6 +858,11 @@ void OpenGLRenderer::texture_releaseTextureUploadBuffer(uint8* mem)
 }
 
 TextureDecoder* OpenGLRenderer::texture_chooseDecodedFormat(Latte::E_GX2SURFFMT format, bool isDepth, Latte::E_DIM dim, uint32 width, uint32 height)
+{
+	return GetTextureDecoder(format, isDepth, dim);
+}
+
+TextureDecoder* OpenGLRenderer::GetTextureDecoder(Latte::E_GX2SURFFMT format, bool isDepth, Latte::E_DIM dim)
 {
 	TextureDecoder* texDecoder = nullptr;
 	if (isDepth)
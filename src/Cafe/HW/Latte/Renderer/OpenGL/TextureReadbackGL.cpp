@@ -127,5 +127,7 @@ uint8* LatteTextureReadbackInfoGL::GetData()
 
 void LatteTextureReadbackInfoGL::ReleaseData()
 {
+	// another readback buffer may have been mapped in the meantime
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, texImageBufferGL);
 	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
 }
@@ -34,6 +34,7 @@ enum class RendererAPI
 	OpenGL,
 	Vulkan,
 	Metal,
+	Null, // no graphics output, used for headless runs
 
 	MAX
 };
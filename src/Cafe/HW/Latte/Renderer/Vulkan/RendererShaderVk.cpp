@@ -133,7 +133,9 @@ public:
 		if (m_threadsActive.exchange(true))
 			return;
 		// create thread pool
-		const uint32 threadCount = 2;
+		// one thread per physical core, the GPU thread is mostly waiting for results while the shader cache is loading
+		// the pool stays alive while the game runs alongside the pipeline compile threads, so it is capped the same way they are
+		const uint32 threadCount = std::clamp<uint32>(GetPhysicalCoreCount(), 2, 8);
 		for (uint32 i = 0; i < threadCount; ++i)
 			s_threads.emplace_back(&_ShaderVkThreadPool::CompilerThreadFunc, this);
 	}
@@ -442,6 +444,8 @@ void RendererShaderVk::ShaderCacheLoading_begin(uint64 cacheTitleId)
 	s_spirvCache = FileCache::Open(cachePath, true, spirvCacheMagic);
 	if (s_spirvCache == nullptr)
 		cemuLog_log(LogType::Force, "Unable to open SPIR-V cache {}", cacheFilename);
+	else
+		s_spirvCache->EnableCompactionOnClose(true);
 	s_isLoadingShadersVk = true;
 }
 
@@ -153,3 +153,7 @@ void LatteTextureReadbackInfoVk::ForceFinish()
 	renderer->WaitCommandBufferFinished(m_associatedCommandBufferId);
 }
 
+void LatteTextureReadbackInfoVk::ReleaseData()
+{
+	VulkanRenderer::GetInstance()->texture_releaseReadbackBuffer(m_buffer_offset);
+}
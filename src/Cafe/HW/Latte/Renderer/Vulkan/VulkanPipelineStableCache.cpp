@@ -68,6 +68,7 @@ uint32 VulkanPipelineStableCache::BeginLoading(uint64 cacheTitleId)
 	else
 	{
 		s_cache->UseCompression(false);
+		s_cache->EnableCompactionOnClose(true);
 		g_vkCacheState.pipelineMaxFileIndex = s_cache->GetMaximumFileIndex();
 	}
 	return s_cache->GetFileCount();
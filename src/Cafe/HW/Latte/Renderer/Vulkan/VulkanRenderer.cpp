@@ -1995,6 +1995,7 @@ void VulkanRenderer::WaitForNextFinishedCommandBuffer()
 
 void VulkanRenderer::SubmitCommandBuffer(VkSemaphore signalSemaphore, VkSemaphore waitSemaphore)
 {
+	LATTE_PROFILE_SCOPE(RendererSubmit);
 	draw_endRenderPass();
 
 	occlusionQuery_notifyEndCommandBuffer();
@@ -3534,21 +3535,56 @@ LatteTextureReadbackInfo* VulkanRenderer::texture_createReadback(LatteTextureVie
 	const uint32 linearImageSize = result->GetImageSize();
 	const uint32 uploadSize = (linearImageSize == 0) ? memRequirements.size : linearImageSize;
 	const uint32 uploadAlignment = 256; // todo - use Vk optimalBufferCopyOffsetAlignment
-	m_textureReadbackBufferWriteIndex = (m_textureReadbackBufferWriteIndex + uploadAlignment - 1) & ~(uploadAlignment - 1);
+	cemu_assert(uploadSize + uploadAlignment <= TEXTURE_READBACK_SIZE);
 
-	if ((m_textureReadbackBufferWriteIndex + uploadSize + 256) > TEXTURE_READBACK_SIZE)
-	{
+	// the readback buffer is used as a ring, readbacks are released in the same order as they are allocated
+	// the data is only consumed after the transfer finished so make sure we never overwrite memory of a readback that is still in use
+	if (m_textureReadbackBufferAllocations.empty())
 		m_textureReadbackBufferWriteIndex = 0;
+	uint32 uploadBufferOffset = (m_textureReadbackBufferWriteIndex + uploadAlignment - 1) & ~(uploadAlignment - 1);
+	bool hasSpace = true;
+	if (m_textureReadbackBufferAllocations.empty())
+	{
+		if ((uploadBufferOffset + uploadSize) > TEXTURE_READBACK_SIZE)
+			uploadBufferOffset = 0;
 	}
-
-	const uint32 uploadBufferOffset = m_textureReadbackBufferWriteIndex;
-	m_textureReadbackBufferWriteIndex += uploadSize;
+	else
+	{
+		const uint32 readIndex = m_textureReadbackBufferAllocations.front().first;
+		if (uploadBufferOffset >= readIndex)
+		{
+			// free space is from the write index to the end and from the start to the oldest allocation
+			if ((uploadBufferOffset + uploadSize) > TEXTURE_READBACK_SIZE)
+			{
+				uploadBufferOffset = 0;
+				hasSpace = uploadSize < readIndex;
+			}
+		}
+		else
+			hasSpace = (uploadBufferOffset + uploadSize) < readIndex;
+	}
+	if (!hasSpace)
+	{
+		// buffer is full, wait until all readbacks in flight have been written to guest memory
+		LatteTextureReadback_WaitForActiveTransfers();
+		cemu_assert_debug(m_textureReadbackBufferAllocations.empty());
+		uploadBufferOffset = 0;
+	}
+	m_textureReadbackBufferWriteIndex = uploadBufferOffset + uploadSize;
+	m_textureReadbackBufferAllocations.emplace_back(uploadBufferOffset, uploadSize);
 
 	result->SetBuffer(m_textureReadbackBuffer, m_textureReadbackBufferPtr, uploadBufferOffset);
 
 	return result;
 }
 
+void VulkanRenderer::texture_releaseReadbackBuffer(uint32 bufferOffset)
+{
+	cemu_assert_debug(!m_textureReadbackBufferAllocations.empty() && m_textureReadbackBufferAllocations.front().first == bufferOffset);
+	if (!m_textureReadbackBufferAllocations.empty())
+		m_textureReadbackBufferAllocations.pop_front();
+}
+
 uint32 s_vkCurrentUniqueId = 0;
 
 uint64 VulkanRenderer::GenUniqueId()
@@ -3795,6 +3831,12 @@ void VulkanRenderer::AppendOverlayDebugInfo()
 	ImGui::Text("Buffer");
 	ImGui::SameLine(60.0f);
 	ImGui::Text("%06uKB / %06uKB Allocs: %u", (uint32)(bufferCacheAllocationSize + 1023) / 1024, ((uint32)bufferCacheHeapSize + 1023) / 1024, (uint32)bufferCacheNumAllocations);
+	uint32 bufferCacheLargestFree, bufferCacheFreeRanges;
+	uint64 bufferCacheRelocatedBytes;
+	LatteBufferCache_getFragmentationStats(bufferCacheLargestFree, bufferCacheFreeRanges, bufferCacheRelocatedBytes);
+	ImGui::Text("BufFrag");
+	ImGui::SameLine(60.0f);
+	ImGui::Text("LargestFree: %06uKB FreeRanges: %u Relocated: %uMB", (bufferCacheLargestFree + 1023) / 1024, bufferCacheFreeRanges, (uint32)(bufferCacheRelocatedBytes / 1024 / 1024));
 
 	uint32 numBuffers;
 	size_t totalSize, freeSize;
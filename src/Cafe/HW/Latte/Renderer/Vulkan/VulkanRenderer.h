@@ -268,8 +268,25 @@ public:
 	PipelineInfo* draw_getCachedPipeline();
 
 	// pipeline state hash
+	// the register dependent part is split into sub-hashes per state block (see Latte::PIPELINE_STATE_BLOCK)
+	// the per-draw cost shows up in the PipelineLookup scope of the GPU profiler, there is no standalone benchmark for it
+	struct PipelineStateHashes
+	{
+		uint64 primitive;
+		uint64 rasterizer;
+		uint64 blend;
+		uint64 depthStencil;
+	};
+
+	static void draw_calculatePipelineStateHashes(const LatteContextRegister& lcr, uint32 blockMask, PipelineStateHashes& stateHashes);
 	static uint64 draw_calculateMinimalGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteContextRegister& lcr);
 	static uint64 draw_calculateGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteDecompilerShader* vertexShader, const LatteDecompilerShader* geometryShader, const LatteDecompilerShader* pixelShader, const VKRObjectRenderPass* renderPassObj, const LatteContextRegister& lcr);
+	// same as above but for the current GPU state, only blocks with modified registers are rehashed
+	uint64 draw_calculateCurrentMinimalGraphicsPipelineHash(const LatteFetchShader* fetchShader);
+	uint64 draw_calculateCurrentGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteDecompilerShader* vertexShader, const LatteDecompilerShader* geometryShader, const LatteDecompilerShader* pixelShader, const VKRObjectRenderPass* renderPassObj);
+	const PipelineStateHashes& draw_getCurrentPipelineStateHashes();
+
+	PipelineStateHashes m_currentPipelineStateHashes{};
 
 	// rendertarget
 	void renderTarget_setViewport(float x, float y, float width, float height, float nearZ, float farZ, bool halfZ = false) override;
@@ -297,6 +314,7 @@ public:
 
 	void texture_copyImageSubData(LatteTexture* src, sint32 srcMip, sint32 effectiveSrcX, sint32 effectiveSrcY, sint32 srcSlice, LatteTexture* dst, sint32 dstMip, sint32 effectiveDstX, sint32 effectiveDstY, sint32 dstSlice, sint32 effectiveCopyWidth, sint32 effectiveCopyHeight, sint32 srcDepth) override;
 	LatteTextureReadbackInfo* texture_createReadback(LatteTextureView* textureView) override;
+	void texture_releaseReadbackBuffer(uint32 bufferOffset);
 
 	// surface copy
 	void surfaceCopy_copySurfaceWithFormatConversion(LatteTexture* sourceTexture, sint32 srcMip, sint32 srcSlice, LatteTexture* destinationTexture, sint32 dstMip, sint32 dstSlice, sint32 width, sint32 height) override;
@@ -619,6 +637,7 @@ private:
 	VkDeviceMemory m_textureReadbackBufferMemory = VK_NULL_HANDLE;
 	uint8* m_textureReadbackBufferPtr = nullptr;
 	uint32 m_textureReadbackBufferWriteIndex = 0;
+	std::deque<std::pair<uint32, uint32>> m_textureReadbackBufferAllocations; // offset and size of each readback still using the buffer, in allocation order
 
 	// placeholder objects to simulate NULL buffers and textures
 	struct NullTexture
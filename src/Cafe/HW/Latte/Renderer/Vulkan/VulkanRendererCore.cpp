@@ -15,54 +15,104 @@
 
 extern bool hasValidFramebufferAttached;
 
-// includes only states that may change during minimal drawcalls
-uint64 VulkanRenderer::draw_calculateMinimalGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteContextRegister& lcr)
+// hash of vertex buffer strides and attribute layout
+uint64 _calculateFetchShaderStateHash(const LatteFetchShader* fetchShader, const LatteContextRegister& lcr)
 {
 	uint64 stateHash = 0;
-
-	// fetch shader
 	for (auto& group : fetchShader->bufferGroups)
 	{
 		uint32 bufferStride = group.getCurrentBufferStride(lcr.GetRawView());
 		stateHash = std::rotl<uint64>(stateHash, 7);
 		stateHash += bufferStride * 3;
 	}
-
 	stateHash += fetchShader->getVkPipelineHashFragment();
-	stateHash = std::rotl<uint64>(stateHash, 7);
-
-	stateHash += lcr.GetRawView()[mmVGT_PRIMITIVE_TYPE];
-	stateHash = std::rotl<uint64>(stateHash, 7);
-
-	stateHash += lcr.GetRawView()[mmVGT_STRMOUT_EN];
-	stateHash = std::rotl<uint64>(stateHash, 7);
-
-	if(lcr.PA_CL_CLIP_CNTL.get_DX_RASTERIZATION_KILL())
-		stateHash += 0x333333;
-
 	return stateHash;
 }
 
-uint64 VulkanRenderer::draw_calculateGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteDecompilerShader* vertexShader, const LatteDecompilerShader* geometryShader, const LatteDecompilerShader* pixelShader, const VKRObjectRenderPass* renderPassObj, const LatteContextRegister& lcr)
+void VulkanRenderer::draw_calculatePipelineStateHashes(const LatteContextRegister& lcr, uint32 blockMask, PipelineStateHashes& stateHashes)
 {
-	// note: vertexShader references a fetchShader (vertexShader->fetchShader) but it's not necessarily the one that is currently active
-	// this is because we try to separate dynamic state (mainly attribute offsets) from the actual attribute data layout and mapping (types and slots)
-	// on Vulkan this causes issues because we bake the attribute offsets, which may not match vertexShader->compatibleFetchShader, into the pipeline
-	// To avoid issues always use the active fetch shader. Not the one associated with the vertexShader object
-	// note 2:
-	// there is a secondary issue where we dont store all fetch shaders into the pipeline cache (only a single fetch shader is tied to each stored vertex shader)
-	// but we can probably trust drivers to not require pipeline recompilation if only the offsets differ
-	// An alternative would be to use VK_EXT_vertex_input_dynamic_state but it comes with minor overhead
-	// Regardless, the extension is not well supported as of writing this (July 2021, only 10% of GPUs support it on Windows. Nvidia only)
+	uint32* ctxRegister = lcr.GetRawView();
+	if (blockMask & Latte::PIPELINE_STATE_PRIMITIVE)
+	{
+		uint64 stateHash = ctxRegister[mmVGT_PRIMITIVE_TYPE];
+		stateHash = std::rotl<uint64>(stateHash, 7);
+		stateHash += ctxRegister[mmVGT_STRMOUT_EN];
+		stateHash = std::rotl<uint64>(stateHash, 7);
+		if (lcr.PA_CL_CLIP_CNTL.get_DX_RASTERIZATION_KILL())
+			stateHash += 0x333333;
+		stateHashes.primitive = stateHash;
+	}
+	if (blockMask & Latte::PIPELINE_STATE_RASTERIZER)
+	{
+		uint32 polygonCtrl = lcr.PA_SU_SC_MODE_CNTL.getRawValue();
+		uint64 stateHash = polygonCtrl;
+		stateHash = std::rotl<uint64>(stateHash, 7);
+		stateHash += ctxRegister[Latte::REGADDR::PA_CL_CLIP_CNTL];
+		// polygon offset
+		if (polygonCtrl & (1 << 11))
+		{
+			// front offset enabled
+			stateHash += 0x1111;
+		}
+		stateHashes.rasterizer = stateHash;
+	}
+	if (blockMask & Latte::PIPELINE_STATE_BLEND)
+	{
+		const auto colorControlReg = ctxRegister[Latte::REGADDR::CB_COLOR_CONTROL];
+		uint64 stateHash = colorControlReg;
+		stateHash += ctxRegister[Latte::REGADDR::CB_TARGET_MASK];
+		const uint32 blendEnableMask = (colorControlReg >> 8) & 0xFF;
+		if (blendEnableMask)
+		{
+			for (auto i = 0; i < 8; ++i)
+			{
+				if (((blendEnableMask & (1 << i))) == 0)
+					continue;
+				stateHash = std::rotl<uint64>(stateHash, 7);
+				stateHash += ctxRegister[Latte::REGADDR::CB_BLEND0_CONTROL + i];
+			}
+		}
+		stateHashes.blend = stateHash;
+	}
+	if (blockMask & Latte::PIPELINE_STATE_DEPTH_STENCIL)
+	{
+		uint64 stateHash = 0;
+		uint32 depthControl = ctxRegister[Latte::REGADDR::DB_DEPTH_CONTROL];
+		bool stencilTestEnable = depthControl & 1;
+		if (stencilTestEnable)
+		{
+			stateHash += ctxRegister[mmDB_STENCILREFMASK];
+			stateHash = std::rotl<uint64>(stateHash, 17);
+			if(depthControl & (1<<7)) // back stencil enable
+			{
+				stateHash += ctxRegister[mmDB_STENCILREFMASK_BF];
+				stateHash = std::rotl<uint64>(stateHash, 13);
+			}
+		}
+		else
+		{
+			// zero out stencil related bits (8-31)
+			depthControl &= 0xFF;
+		}
+		stateHash = std::rotl<uint64>(stateHash, 17);
+		stateHash += depthControl;
+		stateHashes.depthStencil = stateHash;
+	}
+}
 
-	cemu_assert_debug(vertexShader->compatibleFetchShader->key == fetchShader->key); // fetch shaders must be layout compatible, but may have different offsets
+// includes only states that may change during minimal drawcalls
+uint64 _combineMinimalGraphicsPipelineHash(uint64 fetchShaderStateHash, const VulkanRenderer::PipelineStateHashes& stateHashes)
+{
+	uint64 stateHash = std::rotl<uint64>(fetchShaderStateHash, 7);
+	stateHash += stateHashes.primitive;
+	return stateHash;
+}
 
-	uint64 stateHash;
-	stateHash = draw_calculateMinimalGraphicsPipelineHash(fetchShader, lcr);
+uint64 _combineGraphicsPipelineHash(uint64 minimalStateHash, const LatteDecompilerShader* vertexShader, const LatteDecompilerShader* geometryShader, const LatteDecompilerShader* pixelShader, const VKRObjectRenderPass* renderPassObj, const VulkanRenderer::PipelineStateHashes& stateHashes)
+{
+	uint64 stateHash = minimalStateHash;
 	stateHash = (stateHash >> 8) + (stateHash * 0x370531ull) % 0x7F980D3BF9B4639Dull;
 
-	uint32* ctxRegister = lcr.GetRawView();
-
 	if (vertexShader)
 		stateHash += vertexShader->baseHash;
 
@@ -78,60 +128,70 @@ uint64 VulkanRenderer::draw_calculateGraphicsPipelineHash(const LatteFetchShader
 
 	stateHash = std::rotl<uint64>(stateHash, 13);
 
-	uint32 polygonCtrl = lcr.PA_SU_SC_MODE_CNTL.getRawValue();
-	stateHash += polygonCtrl;
-	stateHash = std::rotl<uint64>(stateHash, 7);
-
-	stateHash += ctxRegister[Latte::REGADDR::PA_CL_CLIP_CNTL];
+	stateHash += stateHashes.rasterizer;
 	stateHash = std::rotl<uint64>(stateHash, 7);
+	stateHash += stateHashes.blend;
+	stateHash += renderPassObj->m_hashForPipeline;
+	stateHash = std::rotl<uint64>(stateHash, 17);
+	stateHash += stateHashes.depthStencil;
+	return stateHash;
+}
 
-	const auto colorControlReg = ctxRegister[Latte::REGADDR::CB_COLOR_CONTROL];
-	stateHash += colorControlReg;
+uint64 VulkanRenderer::draw_calculateMinimalGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteContextRegister& lcr)
+{
+	PipelineStateHashes stateHashes;
+	draw_calculatePipelineStateHashes(lcr, Latte::PIPELINE_STATE_PRIMITIVE, stateHashes);
+	return _combineMinimalGraphicsPipelineHash(_calculateFetchShaderStateHash(fetchShader, lcr), stateHashes);
+}
 
-	stateHash += ctxRegister[Latte::REGADDR::CB_TARGET_MASK];
+uint64 VulkanRenderer::draw_calculateGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteDecompilerShader* vertexShader, const LatteDecompilerShader* geometryShader, const LatteDecompilerShader* pixelShader, const VKRObjectRenderPass* renderPassObj, const LatteContextRegister& lcr)
+{
+	// note: vertexShader references a fetchShader (vertexShader->fetchShader) but it's not necessarily the one that is currently active
+	// this is because we try to separate dynamic state (mainly attribute offsets) from the actual attribute data layout and mapping (types and slots)
+	// on Vulkan this causes issues because we bake the attribute offsets, which may not match vertexShader->compatibleFetchShader, into the pipeline
+	// To avoid issues always use the active fetch shader. Not the one associated with the vertexShader object
+	// note 2:
+	// there is a secondary issue where we dont store all fetch shaders into the pipeline cache (only a single fetch shader is tied to each stored vertex shader)
+	// but we can probably trust drivers to not require pipeline recompilation if only the offsets differ
+	// An alternative would be to use VK_EXT_vertex_input_dynamic_state but it comes with minor overhead
+	// Regardless, the extension is not well supported as of writing this (July 2021, only 10% of GPUs support it on Windows. Nvidia only)
 
-	const uint32 blendEnableMask = (colorControlReg >> 8) & 0xFF;
-	if (blendEnableMask)
-	{
-		for (auto i = 0; i < 8; ++i)
-		{
-			if (((blendEnableMask & (1 << i))) == 0)
-				continue;
-			stateHash = std::rotl<uint64>(stateHash, 7);
-			stateHash += ctxRegister[Latte::REGADDR::CB_BLEND0_CONTROL + i];
-		}
-	}
+	cemu_assert_debug(vertexShader->compatibleFetchShader->key == fetchShader->key); // fetch shaders must be layout compatible, but may have different offsets
 
-	stateHash += renderPassObj->m_hashForPipeline;
+	PipelineStateHashes stateHashes;
+	draw_calculatePipelineStateHashes(lcr, Latte::PIPELINE_STATE_ALL, stateHashes);
+	uint64 minimalStateHash = _combineMinimalGraphicsPipelineHash(_calculateFetchShaderStateHash(fetchShader, lcr), stateHashes);
+	return _combineGraphicsPipelineHash(minimalStateHash, vertexShader, geometryShader, pixelShader, renderPassObj, stateHashes);
+}
 
-	uint32 depthControl = ctxRegister[Latte::REGADDR::DB_DEPTH_CONTROL];
-	bool stencilTestEnable = depthControl & 1;
-	if (stencilTestEnable)
-	{
-		stateHash += ctxRegister[mmDB_STENCILREFMASK];
-		stateHash = std::rotl<uint64>(stateHash, 17);
-		if(depthControl & (1<<7)) // back stencil enable
-		{
-			stateHash += ctxRegister[mmDB_STENCILREFMASK_BF];
-			stateHash = std::rotl<uint64>(stateHash, 13);
-		}
-	}
-	else
+const VulkanRenderer::PipelineStateHashes& VulkanRenderer::draw_getCurrentPipelineStateHashes()
+{
+	uint32 dirtyMask = LatteGPUState.pipelineStateDirtyMask;
+	if (dirtyMask)
 	{
-		// zero out stencil related bits (8-31)
-		depthControl &= 0xFF;
+		draw_calculatePipelineStateHashes(LatteGPUState.contextNew, dirtyMask, m_currentPipelineStateHashes);
+		LatteGPUState.pipelineStateDirtyMask = 0;
 	}
+	return m_currentPipelineStateHashes;
+}
 
-	stateHash = std::rotl<uint64>(stateHash, 17);
-	stateHash += depthControl;
-
-	// polygon offset
-	if (polygonCtrl & (1 << 11))
-	{
-		// front offset enabled
-		stateHash += 0x1111;
-	}
+uint64 VulkanRenderer::draw_calculateCurrentMinimalGraphicsPipelineHash(const LatteFetchShader* fetchShader)
+{
+	uint64 stateHash = _combineMinimalGraphicsPipelineHash(_calculateFetchShaderStateHash(fetchShader, LatteGPUState.contextNew), draw_getCurrentPipelineStateHashes());
+#ifdef CEMU_DEBUG_ASSERT
+	cemu_assert_debug(stateHash == draw_calculateMinimalGraphicsPipelineHash(fetchShader, LatteGPUState.contextNew));
+#endif
+	return stateHash;
+}
 
+uint64 VulkanRenderer::draw_calculateCurrentGraphicsPipelineHash(const LatteFetchShader* fetchShader, const LatteDecompilerShader* vertexShader, const LatteDecompilerShader* geometryShader, const LatteDecompilerShader* pixelShader, const VKRObjectRenderPass* renderPassObj)
+{
+	const PipelineStateHashes& stateHashes = draw_getCurrentPipelineStateHashes();
+	uint64 minimalStateHash = _combineMinimalGraphicsPipelineHash(_calculateFetchShaderStateHash(fetchShader, LatteGPUState.contextNew), stateHashes);
+	uint64 stateHash = _combineGraphicsPipelineHash(minimalStateHash, vertexShader, geometryShader, pixelShader, renderPassObj, stateHashes);
+#ifdef CEMU_DEBUG_ASSERT
+	cemu_assert_debug(stateHash == draw_calculateGraphicsPipelineHash(fetchShader, vertexShader, geometryShader, pixelShader, renderPassObj, LatteGPUState.contextNew));
+#endif
 	return stateHash;
 }
 
@@ -153,7 +213,7 @@ PipelineInfo* VulkanRenderer::draw_getCachedPipeline()
 	const auto pixelShader = LatteSHRC_GetActivePixelShader();
 	auto cachedFboVk = (CachedFBOVk*)m_state.activeFBO;
 
-	const uint64 stateHash = draw_calculateGraphicsPipelineHash(fetchShader, vertexShader, geometryShader, pixelShader, cachedFboVk->GetRenderPassObj(), LatteGPUState.contextNew);
+	const uint64 stateHash = draw_calculateCurrentGraphicsPipelineHash(fetchShader, vertexShader, geometryShader, pixelShader, cachedFboVk->GetRenderPassObj());
 
 	const auto innerit = it->second.find(stateHash);
 	if (innerit == it->second.cend())
@@ -219,8 +279,8 @@ PipelineInfo* VulkanRenderer::draw_createGraphicsPipeline(uint32 indexCount)
 	const auto pixelShader = LatteSHRC_GetActivePixelShader();
 	auto cachedFboVk = (CachedFBOVk*)m_state.activeFBO;
 
-	uint64 minimalStateHash = draw_calculateMinimalGraphicsPipelineHash(fetchShader, LatteGPUState.contextNew);
-	uint64 pipelineHash = draw_calculateGraphicsPipelineHash(fetchShader, vertexShader, geometryShader, pixelShader, cachedFboVk->GetRenderPassObj(), LatteGPUState.contextNew);
+	uint64 minimalStateHash = draw_calculateCurrentMinimalGraphicsPipelineHash(fetchShader);
+	uint64 pipelineHash = draw_calculateCurrentGraphicsPipelineHash(fetchShader, vertexShader, geometryShader, pixelShader, cachedFboVk->GetRenderPassObj());
 
 	// create PipelineInfo
 	auto vkFBO = (CachedFBOVk*)(VulkanRenderer::GetInstance()->m_state.activeFBO);
@@ -269,6 +329,7 @@ PipelineInfo* VulkanRenderer::draw_createGraphicsPipeline(uint32 indexCount)
 
 PipelineInfo* VulkanRenderer::draw_getOrCreateGraphicsPipeline(uint32 indexCount)
 {
+	LATTE_PROFILE_SCOPE(PipelineLookup);
 	auto cache_object = draw_getCachedPipeline();
 	if (cache_object != nullptr)
 	{
@@ -1397,7 +1458,7 @@ void VulkanRenderer::draw_execute(uint32 baseVertex, uint32 baseInstance, uint32
 
 	if (!isFirst)
 	{
-		if (m_state.activePipelineInfo->minimalStateHash != draw_calculateMinimalGraphicsPipelineHash(vertexShader->compatibleFetchShader, LatteGPUState.contextNew))
+		if (m_state.activePipelineInfo->minimalStateHash != draw_calculateCurrentMinimalGraphicsPipelineHash(vertexShader->compatibleFetchShader))
 		{
 			// pipeline changed
 			pipeline_info = draw_getOrCreateGraphicsPipeline(count);
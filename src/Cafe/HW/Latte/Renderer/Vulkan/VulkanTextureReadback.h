@@ -19,6 +19,8 @@ public:
 		return m_buffer_ptr + m_buffer_offset;
 	}
 
+	void ReleaseData() override;
+
 	uint32 GetImageSize() const
 	{
 		return m_image_size;
@@ -198,3 +198,6 @@ private:
 		const uint32* vtxSemanticTable{};
 	}m_vertexShaderCtx{};
 };
+
+// compares the ZpIR->GLSL->glslang path against the direct ZpIR->SPIR-V emitter, results are logged
+bool LatteTC_RunEmitterBenchmark(uint32 shaderCount);
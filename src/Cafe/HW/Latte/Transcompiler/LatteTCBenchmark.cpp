@@ -0,0 +1,250 @@
+#include "Cafe/HW/Latte/Transcompiler/LatteTC.h"
+
+#include "util/Zir/Core/IR.h"
+#include "util/Zir/Core/ZpIRBuilder.h"
+#include "util/Zir/Core/ZpIRPasses.h"
+#include "util/Zir/EmitterGLSL/ZpIREmitGLSL.h"
+#include "util/Zir/EmitterSPIRV/ZpIREmitSPIRV.h"
+#include "util/helpers/StringBuf.h"
+
+#include <glslang/Public/ShaderLang.h>
+#include <glslang/SPIRV/GlslangToSpv.h>
+
+// Headless comparison of the two ZpIR backends:
+// - ZpIR -> GLSL -> glslang -> SPIR-V (path used by the Vulkan renderer for decompiled shaders)
+// - ZpIR -> SPIR-V (direct emitter)
+// LatteTCGenIR only translates a small subset of the Latte ISA so the input are synthetic vertex shaders built from the same IR
+// instructions it generates (attribute fetch with endian swap, uniform reads and float ALU math)
+
+struct LatteTCBenchmarkShader
+{
+	ZpIR::ZpIRFunction* irFunction;
+	uint32 uniformVec4Count;
+	uint32 attributeCount;
+	uint32 outputCount;
+};
+
+static ZpIR::IRReg LatteTCBenchmark_importUniform(ZpIR::BasicBlockBuilder& builder, uint32 index, uint32& uniformCount)
+{
+	ZpIR::IRReg r = builder.createReg(ZpIR::DataType::F32);
+	builder.emit_IMPORT(ZpIR::ShaderSubset::ShaderImportLocation().SetUniformRegister(index), r);
+	uniformCount = std::max<uint32>(uniformCount, index / 4 + 1);
+	return r;
+}
+
+static ZpIR::IRReg LatteTCBenchmark_importAttribute(ZpIR::BasicBlockBuilder& builder, uint32 attributeIndex, uint32 channel, bool asInteger)
+{
+	ZpIR::IRReg raw = builder.createReg(ZpIR::DataType::U32);
+	builder.emit_IMPORT(ZpIR::ShaderSubset::ShaderImportLocation().SetVertexAttribute(attributeIndex, channel), raw);
+	ZpIR::IRReg swapped = builder.emit_RR(ZpIR::IR::OpCode::SWAP_ENDIAN, ZpIR::DataType::U32, raw);
+	if (asInteger)
+		return builder.emit_RR(ZpIR::IR::OpCode::CONVERT_INT_TO_FLOAT, ZpIR::DataType::F32, swapped);
+	return builder.emit_RR(ZpIR::IR::OpCode::BITCAST, ZpIR::DataType::F32, swapped);
+}
+
+// generate a vertex shader, complexity depends on the seed
+static LatteTCBenchmarkShader LatteTCBenchmark_generateShader(uint32 seed)
+{
+	LatteTCBenchmarkShader shader{};
+	shader.irFunction = new ZpIR::ZpIRFunction();
+	ZpIR::ZpIRBasicBlock* basicBlock = new ZpIR::ZpIRBasicBlock();
+	shader.irFunction->m_basicBlocks.emplace_back(basicBlock);
+	shader.irFunction->m_entryBlocks.emplace_back(basicBlock);
+	shader.irFunction->m_exitBlocks.emplace_back(basicBlock);
+	ZpIR::BasicBlockBuilder builder(basicBlock);
+
+	shader.attributeCount = 1 + (seed % 4);
+	shader.outputCount = shader.attributeCount - 1 + (seed % 3);
+	const uint32 extraAluOps = (seed % 16) * 4;
+
+	// position = matrix * attribute0
+	ZpIR::IRReg pos[4];
+	for (uint32 c = 0; c < 4; c++)
+		pos[c] = LatteTCBenchmark_importAttribute(builder, 0, c, false);
+	ZpIR::IRReg transformed[4];
+	for (uint32 r = 0; r < 4; r++)
+	{
+		ZpIR::IRReg sum = builder.emit_RRR(ZpIR::IR::OpCode::MUL, ZpIR::DataType::F32, pos[0], LatteTCBenchmark_importUniform(builder, r * 4 + 0, shader.uniformVec4Count));
+		for (uint32 c = 1; c < 4; c++)
+		{
+			ZpIR::IRReg product = builder.emit_RRR(ZpIR::IR::OpCode::MUL, ZpIR::DataType::F32, pos[c], LatteTCBenchmark_importUniform(builder, r * 4 + c, shader.uniformVec4Count));
+			sum = builder.emit_RRR(ZpIR::IR::OpCode::ADD, ZpIR::DataType::F32, sum, product);
+		}
+		transformed[r] = sum;
+	}
+	// additional ALU work on x/y
+	for (uint32 i = 0; i < extraAluOps; i++)
+	{
+		ZpIR::IRReg& target = transformed[i & 1];
+		ZpIR::IRReg uniformValue = LatteTCBenchmark_importUniform(builder, 16 + (i % 32), shader.uniformVec4Count);
+		if ((i % 3) == 0)
+			target = builder.emit_RRR(ZpIR::IR::OpCode::MUL, ZpIR::DataType::F32, target, builder.createConstF32(1.0f + (f32)(i % 5) * 0.25f));
+		else if ((i % 3) == 1)
+			target = builder.emit_RRR(ZpIR::IR::OpCode::ADD, ZpIR::DataType::F32, target, uniformValue);
+		else
+			target = builder.emit_RRR(ZpIR::IR::OpCode::DIV, ZpIR::DataType::F32, target, builder.createConstF32(2.0f));
+	}
+	builder.emit(new ZpIR::IR::InsEXPORT(ZpIR::ShaderSubset::ShaderExportLocation().SetPosition(), transformed[0], transformed[1], transformed[2], transformed[3]));
+
+	// pass through remaining attributes
+	for (uint32 i = 0; i < shader.outputCount; i++)
+	{
+		uint32 attributeIndex = 1 + (i % std::max<uint32>(shader.attributeCount - 1, 1));
+		ZpIR::IRReg v[4];
+		if (attributeIndex >= shader.attributeCount)
+		{
+			for (uint32 c = 0; c < 4; c++)
+				v[c] = builder.emit_RRR(ZpIR::IR::OpCode::MUL, ZpIR::DataType::F32, transformed[c], LatteTCBenchmark_importUniform(builder, 48 + c, shader.uniformVec4Count));
+		}
+		else
+		{
+			const bool asInteger = (attributeIndex & 1) != 0;
+			for (uint32 c = 0; c < 4; c++)
+				v[c] = LatteTCBenchmark_importAttribute(builder, attributeIndex, c, asInteger);
+			if (asInteger)
+			{
+				// normalize and round trip through integer conversion
+				ZpIR::IRReg truncated = builder.emit_RR(ZpIR::IR::OpCode::CONVERT_FLOAT_TO_INT, ZpIR::DataType::S32, v[3]);
+				v[3] = builder.emit_RR(ZpIR::IR::OpCode::CONVERT_INT_TO_FLOAT, ZpIR::DataType::F32, truncated);
+				for (uint32 c = 0; c < 4; c++)
+					v[c] = builder.emit_RRR(ZpIR::IR::OpCode::DIV, ZpIR::DataType::F32, v[c], builder.createConstF32(255.0f));
+			}
+		}
+		builder.emit(new ZpIR::IR::InsEXPORT(ZpIR::ShaderSubset::ShaderExportLocation().SetOutputAttribute(i), v[0], v[1], v[2], v[3]));
+	}
+	return shader;
+}
+
+static void LatteTCBenchmark_freeShader(LatteTCBenchmarkShader& shader)
+{
+	for (auto& itr : shader.irFunction->m_basicBlocks)
+	{
+		ZpIR::IR::__InsBase* instruction = itr->m_instructionFirst;
+		while (instruction)
+		{
+			ZpIR::IR::__InsBase* next = instruction->next;
+			if (auto ins = ZpIR::IR::InsRR::getIfForm(instruction))
+				delete ins;
+			else if (auto ins = ZpIR::IR::InsRRR::getIfForm(instruction))
+				delete ins;
+			else if (auto ins = ZpIR::IR::InsIMPORT::getIfForm(instruction))
+				delete ins;
+			else if (auto ins = ZpIR::IR::InsEXPORT::getIfForm(instruction))
+				delete ins;
+			instruction = next;
+		}
+		delete itr;
+	}
+	delete shader.irFunction;
+	shader.irFunction = nullptr;
+}
+
+static bool LatteTCBenchmark_compileGLSL(const LatteTCBenchmarkShader& shader, std::vector<uint32>& spirvOut)
+{
+	StringBuf glslSource(64 * 1024);
+	glslSource.add("#version 450\r\n");
+	glslSource.addFmt("layout(set = 0, binding = 0) uniform ufBlock {{ vec4 uf_remappedVS[{}]; }};\r\n", shader.uniformVec4Count);
+	for (uint32 i = 0; i < shader.attributeCount; i++)
+		glslSource.addFmt("layout(location = {}) in uvec4 attrDataSem{};\r\n", i, i);
+	for (uint32 i = 0; i < shader.outputCount; i++)
+		glslSource.addFmt("layout(location = {}) out vec4 passParameterSem{};\r\n", i, i);
+	glslSource.add("#define SET_POSITION(_v) gl_Position = _v; gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0\r\n");
+	ZirPass::RegisterAllocatorForGLSL ra(shader.irFunction);
+	ra.applyPass();
+	ZirEmitter::GLSL emitter;
+	emitter.Emit(shader.irFunction, &glslSource);
+
+	// same glslang configuration as RendererShaderVk
+	TBuiltInResource resources = {};
+	resources.maxVertexAttribs = 64;
+	resources.maxVertexUniformComponents = 4096;
+	resources.maxVertexUniformVectors = 128;
+	resources.maxVertexOutputComponents = 64;
+	resources.maxVaryingComponents = 60;
+	resources.maxDrawBuffers = 32;
+	resources.maxClipDistances = 8;
+
+	std::string glslCode(glslSource.c_str(), glslSource.getLen());
+	const char* cstr = glslCode.c_str();
+	glslang::TShader glslShader(EShLangVertex);
+	glslShader.setStrings(&cstr, 1);
+	glslShader.setEnvInput(glslang::EShSourceGlsl, EShLangVertex, glslang::EShClientVulkan, 100);
+	glslShader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetClientVersion::EShTargetVulkan_1_1);
+	glslShader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetLanguageVersion::EShTargetSpv_1_3);
+	EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
+	if (!glslShader.parse(&resources, 100, false, messages))
+	{
+		cemuLog_log(LogType::Force, "Emitter benchmark: GLSL parsing failed: \"{}\"", glslShader.getInfoLog());
+		cemuLog_log(LogType::Force, "GLSL source:\n{}", glslCode);
+		return false;
+	}
+	glslang::TProgram program;
+	program.addShader(&glslShader);
+	if (!program.link(messages) || !program.mapIO())
+	{
+		cemuLog_log(LogType::Force, "Emitter benchmark: GLSL linking failed: \"{}\"", program.getInfoLog());
+		return false;
+	}
+	spv::SpvBuildLogger logger;
+	glslang::SpvOptions spvOptions;
+	spvOptions.disableOptimizer = false;
+	spvOptions.validate = false;
+	spvOptions.optimizeSize = true;
+	spirvOut.clear();
+	glslang::GlslangToSpv(*program.getIntermediate(EShLangVertex), spirvOut, &logger, &spvOptions);
+	return !spirvOut.empty();
+}
+
+bool LatteTC_RunEmitterBenchmark(uint32 shaderCount)
+{
+	using clock = std::chrono::steady_clock;
+	glslang::InitializeProcess();
+
+	clock::duration timeGLSL{}, timeSPIRV{}, timeValidate{};
+	size_t sizeGLSL = 0, sizeSPIRV = 0;
+	uint32 failedGLSL = 0, failedSPIRV = 0;
+	std::vector<uint32> spirv;
+	std::string validationError;
+	for (uint32 i = 0; i < shaderCount; i++)
+	{
+		// the GLSL path assigns physical registers, so each backend gets a separately generated function
+		LatteTCBenchmarkShader shaderA = LatteTCBenchmark_generateShader(i);
+		auto t0 = clock::now();
+		bool success = LatteTCBenchmark_compileGLSL(shaderA, spirv);
+		timeGLSL += clock::now() - t0;
+		if (success)
+			sizeGLSL += spirv.size() * sizeof(uint32);
+		else
+			failedGLSL++;
+		LatteTCBenchmark_freeShader(shaderA);
+
+		LatteTCBenchmarkShader shaderB = LatteTCBenchmark_generateShader(i);
+		t0 = clock::now();
+		ZirEmitter::SPIRV::Options options;
+		options.remapPositionZ = true;
+		ZirEmitter::SPIRV emitter;
+		emitter.Emit(shaderB.irFunction, options, spirv);
+		auto t1 = clock::now();
+		success = ZirEmitter::SPIRV::Validate(spirv, &validationError);
+		timeSPIRV += t1 - t0;
+		timeValidate += clock::now() - t1;
+		if (success)
+			sizeSPIRV += spirv.size() * sizeof(uint32);
+		else
+		{
+			if (failedSPIRV == 0)
+				cemuLog_log(LogType::Force, "Emitter benchmark: SPIR-V validation failed for shader {}: {}", i, validationError);
+			failedSPIRV++;
+		}
+		LatteTCBenchmark_freeShader(shaderB);
+	}
+	glslang::FinalizeProcess();
+
+	auto toMs = [](clock::duration d) { return (double)std::chrono::duration_cast<std::chrono::microseconds>(d).count() / 1000.0; };
+	cemuLog_log(LogType::Force, "Emitter benchmark: {} vertex shaders", shaderCount);
+	cemuLog_log(LogType::Force, "GLSL + glslang: {:.2f}ms total, {:.4f}ms per shader, {} bytes SPIR-V, {} failed", toMs(timeGLSL), toMs(timeGLSL) / std::max<uint32>(shaderCount, 1), sizeGLSL, failedGLSL);
+	cemuLog_log(LogType::Force, "Direct SPIR-V:  {:.2f}ms total, {:.4f}ms per shader, {} bytes SPIR-V, {} failed (validation {:.2f}ms)", toMs(timeSPIRV), toMs(timeSPIRV) / std::max<uint32>(shaderCount, 1), sizeSPIRV, failedSPIRV, toMs(timeValidate));
+	if (timeSPIRV.count() > 0)
+		cemuLog_log(LogType::Force, "Speedup: {:.1f}x", toMs(timeGLSL) / toMs(timeSPIRV));
+	return failedGLSL == 0 && failedSPIRV == 0;
+}
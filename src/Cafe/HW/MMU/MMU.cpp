@@ -197,6 +197,18 @@ void memory_mapForCurrentTitle()
 	}
 }
 
+// used by the GPU capture replay tool. No title is loaded so graphic pack RAM mappings do not apply and only the ranges the GPU can read from are needed
+void memory_mapForGPUReplay()
+{
+	for (MMURange* range : { &mmuRange_MEM2, &mmuRange_FGBUCKET, &mmuRange_TILINGAPERTURE, &mmuRange_MEM1 })
+	{
+		if (range->isMapped())
+			continue;
+		range->resetConfig();
+		range->mapMem();
+	}
+}
+
 void memory_unmapForCurrentTitle()
 {
     for (auto& itr : g_mmuRanges)
@@ -8,6 +8,7 @@
 #include "Cafe/HW/Latte/Core/LatteBufferCache.h" // also remove this dependency
 
 #include "Cafe/HW/MMU/MMU.h"
+#include "input/TAS/TASInput.h"
 
 using namespace iosu::kernel;
 
@@ -23,6 +24,9 @@ namespace iosu
 		{
 			std::string workingDirectory;
 			bool isAllocated{false};
+			// commands of a client are processed in order and never concurrently. Protected by sFSAWorkerPool.mutex
+			std::deque<IPCCommandBody*> pendingCommands;
+			bool isScheduled{false}; // queued in the ready list or currently processed by a worker
 
 			void AllocateAndInitialize()
 			{
@@ -38,6 +42,30 @@ namespace iosu
 
 		std::array<FSAClient, 624> sFSAClientArray;
 
+		// commands are dispatched to a small pool of workers so a long running request (e.g. a large read) does not block other clients
+		// each client has its own FIFO and only one of its commands is processed at a time, which keeps replies ordered per client and per handle
+		static constexpr sint32 FSA_WORKER_COUNT = 4;
+
+		struct FSAReadAhead;
+
+		struct
+		{
+			std::mutex mutex;
+			std::condition_variable workCV;
+			std::condition_variable idleCV;
+			std::vector<std::thread> threads;
+			std::deque<FSAClient*> readyClients;
+			std::deque<std::shared_ptr<FSAReadAhead>> prefetchQueue; // processed only when no client has pending commands
+			uint32 numPendingCommands{0};
+			bool shutdown{false};
+		}sFSAWorkerPool;
+
+		// in TAS mode commands are processed one by one in the order they arrived so that completion order is reproducible
+		bool FSAIsDeterministic()
+		{
+			return TasInput::IsStrictTasModeEnabled() || TasInput::IsDeterministicSchedulerEnabled();
+		}
+
 		IOS_ERROR FSAAllocateClient(sint32& indexOut)
 		{
 			for (size_t i = 0; i < sFSAClientArray.size(); i++)
@@ -168,17 +196,52 @@ namespace iosu
 			return fsc_open(translatedPath.c_str(), accessFlags, &fscStatus);
 		}
 
+		// sequential read detection and prefetching for read-only files
+		// once a handle was read sequentially a few times the following range of the file is read ahead of time on an FSA worker
+		struct FSAReadAhead
+		{
+			static constexpr uint32 SEQUENTIAL_READS_REQUIRED = 2;
+			static constexpr uint32 MIN_CHUNK_SIZE = 128 * 1024;
+			static constexpr uint32 MAX_CHUNK_SIZE = 1024 * 1024;
+			static constexpr uint32 MAX_TOTAL_MEMORY = 64 * 1024 * 1024; // summed over all handles
+
+			FSAReadAhead(FSCVirtualFile* fscFile) : fscFile(fscFile) {}
+			~FSAReadAhead()
+			{
+				s_totalMemory -= (uint32)buffer.capacity();
+			}
+
+			std::mutex mutex; // held for the duration of any operation on fscFile
+			FSCVirtualFile* fscFile;
+			bool isClosed{false};
+			bool prefetchQueued{false};
+			uint32 prefetchSize{0};
+			// sequential read detection
+			uint32 nextExpectedPos{0};
+			uint32 sequentialCount{0};
+			// prefetched data
+			std::vector<uint8> buffer;
+			uint32 bufferFilePos{0};
+			uint32 bufferSize{0};
+			uint32 bufferWriteGeneration{0};
+
+			static inline std::atomic_uint32_t s_totalMemory{0};
+			static inline std::atomic_uint32_t s_writeGeneration{0}; // incremented before and after any write so prefetched data can't go stale
+		};
+
 		class _FSAHandleTable {
 			struct _FSAHandleResource
 			{
 				bool isAllocated{false};
 				FSCVirtualFile* fscFile;
 				uint16 handleCheckValue;
+				std::shared_ptr<FSAReadAhead> readAhead;
 			};
 
 		public:
-			FSA_RESULT AllocateHandle(FSResHandle& handleOut, FSCVirtualFile* fscFile)
+			FSA_RESULT AllocateHandle(FSResHandle& handleOut, FSCVirtualFile* fscFile, bool allowReadAhead = false)
 			{
+				std::unique_lock _l(m_mutex);
 				for (size_t i = 0; i < m_handleTable.size(); i++)
 				{
 					auto& it = m_handleTable.at(i);
@@ -189,6 +252,8 @@ namespace iosu
 					it.handleCheckValue = checkValue;
 					it.fscFile = fscFile;
 					it.isAllocated = true;
+					if (allowReadAhead)
+						it.readAhead = std::make_shared<FSAReadAhead>(fscFile);
 					uint32 handleVal = ((uint32)i << 16) | (uint32)checkValue;
 					handleOut = (FSResHandle)handleVal;
 					return FSA_RESULT::OK;
@@ -201,20 +266,33 @@ namespace iosu
 			{
 				uint16 index = (uint16)((uint32)handle >> 16);
 				uint16 checkValue = (uint16)(handle & 0xFFFF);
-				if (index >= m_handleTable.size())
-					return FSA_RESULT::INVALID_FILE_HANDLE;
-				auto& it = m_handleTable.at(index);
-				if (!it.isAllocated)
-					return FSA_RESULT::INVALID_FILE_HANDLE;
-				if (it.handleCheckValue != checkValue)
-					return FSA_RESULT::INVALID_FILE_HANDLE;
-				it.fscFile = nullptr;
-				it.isAllocated = false;
+				std::shared_ptr<FSAReadAhead> readAhead;
+				{
+					std::unique_lock _l(m_mutex);
+					if (index >= m_handleTable.size())
+						return FSA_RESULT::INVALID_FILE_HANDLE;
+					auto& it = m_handleTable.at(index);
+					if (!it.isAllocated)
+						return FSA_RESULT::INVALID_FILE_HANDLE;
+					if (it.handleCheckValue != checkValue)
+						return FSA_RESULT::INVALID_FILE_HANDLE;
+					it.fscFile = nullptr;
+					it.isAllocated = false;
+					readAhead = std::move(it.readAhead);
+				}
+				if (readAhead)
+				{
+					// wait for an active prefetch to finish and prevent queued ones from accessing the file
+					std::unique_lock _l(readAhead->mutex);
+					readAhead->isClosed = true;
+					readAhead->fscFile = nullptr;
+				}
 				return FSA_RESULT::OK;
 			}
 
-			FSCVirtualFile* GetByHandle(FSResHandle handle)
+			FSCVirtualFile* GetByHandle(FSResHandle handle, std::shared_ptr<FSAReadAhead>* readAheadOut = nullptr)
 			{
+				std::unique_lock _l(m_mutex);
 				uint16 index = (uint16)((uint32)handle >> 16);
 				uint16 checkValue = (uint16)(handle & 0xFFFF);
 				if (index >= m_handleTable.size())
@@ -224,10 +302,13 @@ namespace iosu
 					return nullptr;
 				if (it.handleCheckValue != checkValue)
 					return nullptr;
+				if (readAheadOut)
+					*readAheadOut = it.readAhead;
 				return it.fscFile;
 			}
 
 		private:
+			std::mutex m_mutex;
 			uint32 m_currentCounter = 1;
 			std::array<_FSAHandleResource, 0x3C0> m_handleTable;
 		};
@@ -235,6 +316,107 @@ namespace iosu
 		_FSAHandleTable sFileHandleTable;
 		_FSAHandleTable sDirHandleTable;
 
+		// resolves a file handle and, for handles with read-ahead, blocks prefetching for the lifetime of the object
+		// a prefetch temporarily moves the file seek so any operation on the handle needs to hold the lock
+		class FSAFileAccess
+		{
+		public:
+			FSAFileAccess(FSResHandle fileHandle)
+			{
+				m_fscFile = sFileHandleTable.GetByHandle(fileHandle, &m_readAhead);
+				if (m_readAhead)
+				{
+					m_lock = std::unique_lock(m_readAhead->mutex);
+					if (m_readAhead->isClosed)
+						m_fscFile = nullptr; // closed by another client in the meantime
+				}
+			}
+
+			FSCVirtualFile* GetFile() const { return m_fscFile; }
+			const std::shared_ptr<FSAReadAhead>& GetReadAhead() const { return m_readAhead; }
+
+		private:
+			FSCVirtualFile* m_fscFile;
+			std::shared_ptr<FSAReadAhead> m_readAhead;
+			std::unique_lock<std::mutex> m_lock;
+		};
+
+		void FSAQueuePrefetch(std::shared_ptr<FSAReadAhead> readAhead)
+		{
+			std::unique_lock _l(sFSAWorkerPool.mutex);
+			sFSAWorkerPool.prefetchQueue.emplace_back(std::move(readAhead));
+			sFSAWorkerPool.workCV.notify_one();
+		}
+
+		// reads from the current file position, serving the request from prefetched data if possible
+		uint32 __FSAReadFileWithReadAhead(FSAFileAccess& fileAccess, uint8* dataOut, uint32 size)
+		{
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
+			FSAReadAhead& readAhead = *fileAccess.GetReadAhead();
+			uint32 filePos = fsc_getFileSeek(fscFile);
+			bool bufferIsValid = readAhead.bufferSize > 0 && readAhead.bufferWriteGeneration == FSAReadAhead::s_writeGeneration;
+			uint32 bytesRead;
+			if (bufferIsValid && filePos >= readAhead.bufferFilePos && (uint64)filePos + size <= (uint64)readAhead.bufferFilePos + readAhead.bufferSize)
+			{
+				memcpy(dataOut, readAhead.buffer.data() + (filePos - readAhead.bufferFilePos), size);
+				fsc_setFileSeek(fscFile, filePos + size);
+				bytesRead = size;
+			}
+			else
+				bytesRead = fsc_readFile(fscFile, dataOut, size);
+			// sequential read detection
+			if (filePos == readAhead.nextExpectedPos)
+				readAhead.sequentialCount++;
+			else
+				readAhead.sequentialCount = 0;
+			readAhead.nextExpectedPos = filePos + bytesRead;
+			if (bytesRead < size || readAhead.sequentialCount < FSAReadAhead::SEQUENTIAL_READS_REQUIRED || readAhead.prefetchQueued)
+				return bytesRead;
+			if (size > FSAReadAhead::MAX_CHUNK_SIZE / 2 || FSAIsDeterministic())
+				return bytesRead; // large reads gain little from prefetching
+			uint32 chunkSize = std::clamp(size * 4, FSAReadAhead::MIN_CHUNK_SIZE, FSAReadAhead::MAX_CHUNK_SIZE);
+			// keep at least half a chunk buffered ahead of the read position
+			uint64 bufferEnd = (uint64)readAhead.bufferFilePos + readAhead.bufferSize;
+			if (bufferIsValid && readAhead.nextExpectedPos >= readAhead.bufferFilePos && bufferEnd >= (uint64)readAhead.nextExpectedPos + chunkSize / 2)
+				return bytesRead;
+			if (readAhead.nextExpectedPos >= fsc_getFileSize(fscFile))
+				return bytesRead;
+			readAhead.prefetchSize = chunkSize;
+			readAhead.prefetchQueued = true;
+			FSAQueuePrefetch(fileAccess.GetReadAhead());
+			return bytesRead;
+		}
+
+		void FSAProcessPrefetch(FSAReadAhead& readAhead)
+		{
+			std::unique_lock _l(readAhead.mutex);
+			readAhead.prefetchQueued = false;
+			if (readAhead.isClosed)
+				return;
+			FSCVirtualFile* fscFile = readAhead.fscFile;
+			uint32 fileSize = fsc_getFileSize(fscFile);
+			uint32 prefetchPos = readAhead.nextExpectedPos;
+			if (prefetchPos >= fileSize)
+				return;
+			uint32 prefetchSize = std::min(readAhead.prefetchSize, fileSize - prefetchPos);
+			if (readAhead.buffer.capacity() < prefetchSize)
+			{
+				uint32 prevCapacity = (uint32)readAhead.buffer.capacity();
+				if (FSAReadAhead::s_totalMemory + (prefetchSize - prevCapacity) > FSAReadAhead::MAX_TOTAL_MEMORY)
+					return;
+				readAhead.buffer.reserve(prefetchSize);
+				FSAReadAhead::s_totalMemory += (uint32)readAhead.buffer.capacity() - prevCapacity;
+			}
+			readAhead.buffer.resize(prefetchSize);
+			uint32 writeGeneration = FSAReadAhead::s_writeGeneration;
+			uint32 savedSeek = fsc_getFileSeek(fscFile);
+			fsc_setFileSeek(fscFile, prefetchPos);
+			readAhead.bufferSize = fsc_readFile(fscFile, readAhead.buffer.data(), prefetchSize);
+			readAhead.bufferFilePos = prefetchPos;
+			readAhead.bufferWriteGeneration = writeGeneration;
+			fsc_setFileSeek(fscFile, savedSeek);
+		}
+
 		FSA_RESULT __FSAOpenFile(FSAClient* client, const char* path, const char* accessModifierStr, sint32* fileHandle)
 		{
 			*fileHandle = FS_INVALID_HANDLE_VALUE;
@@ -291,7 +473,7 @@ namespace iosu
 			if (isAppend)
 				fsc_setFileSeek(fscFile, fsc_getFileSize(fscFile));
 			FSResHandle fsFileHandle;
-			FSA_RESULT r = sFileHandleTable.AllocateHandle(fsFileHandle, fscFile);
+			FSA_RESULT r = sFileHandleTable.AllocateHandle(fsFileHandle, fscFile, !fsc_isWritable(fscFile));
 			if (r != FSA_RESULT::OK)
 			{
 				cemuLog_log(LogType::Force, "Exceeded maximum number of FSA file handles");
@@ -445,7 +627,8 @@ namespace iosu
 		{
 			FSFileHandle2 fileHandle = shimBuffer->request.cmdGetStatFile.fileHandle;
 			FSStat_t* statOut = &shimBuffer->response.cmdStatFile.statOut;
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::NOT_FOUND;
 			cemu_assert_debug(fsc_isFile(fscFile));
@@ -460,7 +643,8 @@ namespace iosu
 			uint32 fileHandle = shimBuffer->request.cmdReadFile.fileHandle;
 			uint32 flags = shimBuffer->request.cmdReadFile.flag;
 
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 
@@ -469,7 +653,11 @@ namespace iosu
 			if ((flags & FSA_CMD_FLAG_SET_POS) != 0)
 				fsc_setFileSeek(fscFile, filePos);
 			// todo: File permissions
-			uint32 bytesSuccessfullyRead = fsc_readFile(fscFile, destPtr, bytesToRead);
+			uint32 bytesSuccessfullyRead;
+			if (fileAccess.GetReadAhead())
+				bytesSuccessfullyRead = __FSAReadFileWithReadAhead(fileAccess, (uint8*)destPtr.GetPtr(), bytesToRead);
+			else
+				bytesSuccessfullyRead = fsc_readFile(fscFile, destPtr, bytesToRead);
 			if (transferElementSize == 0)
 				return FSA_RESULT::OK;
 
@@ -485,7 +673,8 @@ namespace iosu
 			uint32 fileHandle = shimBuffer->request.cmdWriteFile.fileHandle;
 			uint32 flags = shimBuffer->request.cmdWriteFile.flag;
 
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 			cemu_assert_debug((transferSize % transferElementSize) == 0);
@@ -499,7 +688,10 @@ namespace iosu
 			// update file position if flag is set
 			if ((flags & FSA_CMD_FLAG_SET_POS) != 0)
 				fsc_setFileSeek(fscFile, filePos);
+			// bumped again once the write is done, a prefetch running concurrently may have read the old data under the new generation
+			FSAReadAhead::s_writeGeneration++;
 			uint32 bytesSuccessfullyWritten = fsc_writeFile(fscFile, destPtr, bytesToWrite);
+			FSAReadAhead::s_writeGeneration++;
 			debug_printf("FSAProcessCmd_write(): Writing 0x%08x bytes (bytes actually written: 0x%08x)\n", bytesToWrite, bytesSuccessfullyWritten);
 			return (FSA_RESULT)(bytesSuccessfullyWritten / transferElementSize); // return number of elements read
 		}
@@ -508,7 +700,8 @@ namespace iosu
 		{
 			uint32 fileHandle = shimBuffer->request.cmdSetPosFile.fileHandle;
 			uint32 filePos = shimBuffer->request.cmdSetPosFile.filePos;
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 			fsc_setFileSeek(fscFile, filePos);
@@ -518,7 +711,8 @@ namespace iosu
 		FSA_RESULT FSAProcessCmd_getPos(FSAClient* client, FSAShimBuffer* shimBuffer)
 		{
 			uint32 fileHandle = shimBuffer->request.cmdGetPosFile.fileHandle;
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 			uint32 filePos = fsc_getFileSeek(fscFile);
@@ -607,12 +801,20 @@ namespace iosu
 
 		FSA_RESULT FSAProcessCmd_flushFile(FSAClient* client, FSAShimBuffer* shimBuffer)
 		{
+			// writes to host files are submitted asynchronously, wait for them to complete
+			FSAFileAccess fileAccess(shimBuffer->request.cmdFlushFile.fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
+			if (!fscFile)
+				return FSA_RESULT::INVALID_FILE_HANDLE;
+			if (!fsc_flushFile(fscFile))
+				return FSA_RESULT::FATAL_ERROR; // a write which was already acknowledged to the title did not reach the host file
 			return FSA_RESULT::OK;
 		}
 
 		FSA_RESULT FSAProcessCmd_appendFile(FSAClient* client, FSAShimBuffer* shimBuffer)
 		{
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(shimBuffer->request.cmdAppendFile.fileHandle);
+			FSAFileAccess fileAccess(shimBuffer->request.cmdAppendFile.fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 #ifdef CEMU_DEBUG_ASSERT
@@ -624,17 +826,21 @@ namespace iosu
 		FSA_RESULT FSAProcessCmd_truncateFile(FSAClient* client, FSAShimBuffer* shimBuffer)
 		{
 			FSFileHandle2 fileHandle = shimBuffer->request.cmdTruncateFile.fileHandle;
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
+			FSAReadAhead::s_writeGeneration++;
 			fsc_setFileLength(fscFile, fsc_getFileSeek(fscFile));
+			FSAReadAhead::s_writeGeneration++;
 			return FSA_RESULT::OK;
 		}
 
 		FSA_RESULT FSAProcessCmd_isEof(FSAClient* client, FSAShimBuffer* shimBuffer)
 		{
 			uint32 fileHandle = shimBuffer->request.cmdIsEof.fileHandle;
-			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAFileAccess fileAccess(fileHandle);
+			FSCVirtualFile* fscFile = fileAccess.GetFile();
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 			uint32 filePos = fsc_getFileSeek(fscFile);
@@ -830,6 +1036,93 @@ namespace iosu
 			IOS_ResourceReply(cmd, (IOS_ERROR)fsaResult);
 		}
 
+		// handles IOCTL and IOCTLV requests. Called from a worker thread or, in TAS mode, from the dispatcher
+		void FSAProcessCommand(FSAClient* client, IPCCommandBody* cmd)
+		{
+			cemu_assert(client->isAllocated);
+			if (cmd->cmdId == IPCCommandId::IOS_IOCTL)
+			{
+				FSAHandleCommandIoctl(client, cmd, (FSA_CMD_OPERATION_TYPE)cmd->args[0].value(), MEMPTR<void>(cmd->args[1]), MEMPTR<void>(cmd->args[3]));
+			}
+			else if (cmd->cmdId == IPCCommandId::IOS_IOCTLV)
+			{
+				FSA_CMD_OPERATION_TYPE requestId = (FSA_CMD_OPERATION_TYPE)cmd->args[0].value();
+				uint32 numIn = cmd->args[1];
+				uint32 numOut = cmd->args[2];
+				IPCIoctlVector* vec = MEMPTR<IPCIoctlVector>{cmd->args[3]}.GetPtr();
+				FSAHandleCommandIoctlv(client, cmd, requestId, numIn, numOut, vec);
+			}
+			else
+			{
+				cemuLog_log(LogType::Force, "/dev/fsa: Unsupported IPC cmdId");
+				cemu_assert_suspicious();
+				IOS_ResourceReply(cmd, IOS_ERROR_INVALID);
+			}
+		}
+
+		void FSAQueueCommand(FSAClient* client, IPCCommandBody* cmd)
+		{
+			std::unique_lock _l(sFSAWorkerPool.mutex);
+			client->pendingCommands.emplace_back(cmd);
+			sFSAWorkerPool.numPendingCommands++;
+			if (!client->isScheduled)
+			{
+				client->isScheduled = true;
+				sFSAWorkerPool.readyClients.emplace_back(client);
+				sFSAWorkerPool.workCV.notify_one();
+			}
+		}
+
+		// wait until all queued commands of the client have been replied to
+		void FSAWaitForClientIdle(FSAClient* client)
+		{
+			std::unique_lock _l(sFSAWorkerPool.mutex);
+			sFSAWorkerPool.idleCV.wait(_l, [client]() { return !client->isScheduled; });
+		}
+
+		void FSAWaitForAllIdle()
+		{
+			std::unique_lock _l(sFSAWorkerPool.mutex);
+			sFSAWorkerPool.idleCV.wait(_l, []() { return sFSAWorkerPool.numPendingCommands == 0; });
+		}
+
+		void FSAWorkerThread(sint32 workerIndex)
+		{
+			SetThreadName(fmt::format("IOSU-FSA-W{}", workerIndex).c_str());
+			std::unique_lock _l(sFSAWorkerPool.mutex);
+			while (true)
+			{
+				sFSAWorkerPool.workCV.wait(_l, []() { return sFSAWorkerPool.shutdown || !sFSAWorkerPool.readyClients.empty() || !sFSAWorkerPool.prefetchQueue.empty(); });
+				if (!sFSAWorkerPool.readyClients.empty())
+				{
+					FSAClient* client = sFSAWorkerPool.readyClients.front();
+					sFSAWorkerPool.readyClients.pop_front();
+					IPCCommandBody* cmd = client->pendingCommands.front();
+					client->pendingCommands.pop_front();
+					_l.unlock();
+					FSAProcessCommand(client, cmd);
+					_l.lock();
+					sFSAWorkerPool.numPendingCommands--;
+					// round robin between clients so a client issuing many requests can't starve others
+					if (!client->pendingCommands.empty())
+						sFSAWorkerPool.readyClients.emplace_back(client);
+					else
+						client->isScheduled = false;
+					sFSAWorkerPool.idleCV.notify_all();
+					continue;
+				}
+				if (sFSAWorkerPool.shutdown)
+					return;
+				std::shared_ptr<FSAReadAhead> readAhead = std::move(sFSAWorkerPool.prefetchQueue.front());
+				sFSAWorkerPool.prefetchQueue.pop_front();
+				_l.unlock();
+				FSAProcessPrefetch(*readAhead);
+				readAhead.reset();
+				_l.lock();
+			}
+		}
+
+		// receives all requests and distributes them to the workers
 		void FSAIoThread()
 		{
 			SetThreadName("IOSU-FSA");
@@ -854,35 +1147,22 @@ namespace iosu
 					IOS_ResourceReply(cmd, (IOS_ERROR)clientIndex);
 					continue;
 				}
-				else if (cmd->cmdId == IPCCommandId::IOS_CLOSE)
+				cemu_assert(clientHandle < sFSAClientArray.size());
+				FSAClient* client = sFSAClientArray.data() + clientHandle;
+				if (cmd->cmdId == IPCCommandId::IOS_CLOSE)
 				{
-					cemu_assert(clientHandle < sFSAClientArray.size());
-					sFSAClientArray[clientHandle].ReleaseAndCleanup();
+					FSAWaitForClientIdle(client);
+					client->ReleaseAndCleanup();
 					IOS_ResourceReply(cmd, IOS_ERROR_OK);
-					continue;
 				}
-				else if (cmd->cmdId == IPCCommandId::IOS_IOCTL)
+				else if (FSAIsDeterministic())
 				{
-					cemu_assert(clientHandle < sFSAClientArray.size());
-					cemu_assert(sFSAClientArray[clientHandle].isAllocated);
-					FSAHandleCommandIoctl(sFSAClientArray.data() + clientHandle, cmd, (FSA_CMD_OPERATION_TYPE)cmd->args[0].value(), MEMPTR<void>(cmd->args[1]), MEMPTR<void>(cmd->args[3]));
-				}
-				else if (cmd->cmdId == IPCCommandId::IOS_IOCTLV)
-				{
-					cemu_assert(clientHandle < sFSAClientArray.size());
-					cemu_assert(sFSAClientArray[clientHandle].isAllocated);
-					FSA_CMD_OPERATION_TYPE requestId = (FSA_CMD_OPERATION_TYPE)cmd->args[0].value();
-					uint32 numIn = cmd->args[1];
-					uint32 numOut = cmd->args[2];
-					IPCIoctlVector* vec = MEMPTR<IPCIoctlVector>{cmd->args[3]}.GetPtr();
-					FSAHandleCommandIoctlv(sFSAClientArray.data() + clientHandle, cmd, requestId, numIn, numOut, vec);
+					// completion order must only depend on the order of requests, so drain the workers and process the command right here
+					FSAWaitForAllIdle();
+					FSAProcessCommand(client, cmd);
 				}
 				else
-				{
-					cemuLog_log(LogType::Force, "/dev/fsa: Unsupported IPC cmdId");
-					cemu_assert_suspicious();
-					IOS_ResourceReply(cmd, IOS_ERROR_INVALID);
-				}
+					FSAQueueCommand(client, cmd);
 			}
 		}
 
@@ -894,6 +1174,9 @@ namespace iosu
 			IOS_ERROR r = IOS_RegisterResourceManager("/dev/fsa", sFSAIoMsgQueue);
 			IOS_DeviceAssociateId("/dev/fsa", 11);
 			cemu_assert(!IOS_ResultIsError(r));
+			sFSAWorkerPool.shutdown = false;
+			for (sint32 i = 0; i < FSA_WORKER_COUNT; i++)
+				sFSAWorkerPool.threads.emplace_back(FSAWorkerThread, i);
 			sFSAIoThread = std::thread(FSAIoThread);
 		}
 
@@ -901,6 +1184,15 @@ namespace iosu
 		{
 			IOS_SendMessage(sFSAIoMsgQueue, 0, 0);
 			sFSAIoThread.join();
+			{
+				std::unique_lock _l(sFSAWorkerPool.mutex);
+				sFSAWorkerPool.shutdown = true;
+				sFSAWorkerPool.workCV.notify_all();
+			}
+			for (auto& it : sFSAWorkerPool.threads)
+				it.join();
+			sFSAWorkerPool.threads.clear();
+			sFSAWorkerPool.prefetchQueue.clear();
 		}
 	} // namespace fsa
 } // namespace iosu
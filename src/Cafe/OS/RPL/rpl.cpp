@@ -12,6 +12,9 @@
 #include "util/ChunkedHeap/ChunkedHeap.h"
 
 #include "util/crypto/crc32.h"
+#include "util/ThreadPool/ThreadPool.h"
+#include "util/highresolutiontimer/HighResolutionTimer.h"
+#include "Cafe/BootProfiler.h"
 #include "config/ActiveSettings.h"
 #include "Cafe/OS/libs/coreinit/coreinit_DynLoad.h"
 #include "COSModule.h"
@@ -366,6 +369,14 @@ RPLUncompressedSection* RPLLoader_LoadUncompressedSection(RPLModule* rplLoaderCo
 	uint32 sectionFlags = section->flags;
 	if ((sectionFlags & SHF_RPL_COMPRESSED) != 0)
 	{
+		// use data decompressed by RPLLoader_DecompressSections
+		auto itr = rplLoaderContext->decompressedSectionData.find(sectionIndex);
+		if (itr != rplLoaderContext->decompressedSectionData.end())
+		{
+			uSection->sectionData = std::move(itr->second);
+			rplLoaderContext->decompressedSectionData.erase(itr);
+			return uSection;
+		}
 		// decompress
 		if (!RPLLoader_CheckBounds(rplLoaderContext, section->fileOffset, sizeof(uint32be)) )
 		{
@@ -416,6 +427,72 @@ RPLUncompressedSection* RPLLoader_LoadUncompressedSection(RPLModule* rplLoaderCo
 	return uSection;
 }
 
+// inflate all compressed sections up front, spread across the thread pool
+// the patch CRC, section loading and relocation then use the decompressed data instead of inflating each section again
+// sections which fail to decompress are skipped here and reported by the regular load path
+void RPLLoader_DecompressSections(RPLModule* rplLoaderContext)
+{
+	BenchmarkTimer bt;
+	bt.Start();
+	std::vector<uint32> sectionIndices;
+	for (uint32 i = 0; i < (uint32)rplLoaderContext->rplHeader.sectionTableEntryCount; i++)
+	{
+		const rplSectionEntryNew_t* section = rplLoaderContext->sectionTablePtr + i;
+		if ((uint32)section->type == SHT_NOBITS || ((uint32)section->flags & SHF_RPL_COMPRESSED) == 0)
+			continue;
+		if ((uint32)section->sectionSize < sizeof(uint32be) || !RPLLoader_CheckBounds(rplLoaderContext, section->fileOffset, section->sectionSize))
+			continue;
+		if (*(uint32be*)(rplLoaderContext->RPLRawData.data() + (uint32)section->fileOffset) >= 1 * 1024 * 1024 * 1024)
+			continue;
+		sectionIndices.emplace_back(i);
+	}
+	std::vector<std::vector<uint8>> sectionData(sectionIndices.size());
+	std::vector<uint8> isDecompressed(sectionIndices.size());
+	ThreadPool::ParallelFor((uint32)sectionIndices.size(), [&](uint32 i)
+	{
+		const rplSectionEntryNew_t* section = rplLoaderContext->sectionTablePtr + sectionIndices[i];
+		const uint8* rawData = rplLoaderContext->RPLRawData.data() + (uint32)section->fileOffset;
+		uint32 uncompressedSize = *(uint32be*)rawData;
+		sectionData[i].resize(uncompressedSize);
+		z_stream strm;
+		strm.zalloc = Z_NULL;
+		strm.zfree = Z_NULL;
+		strm.opaque = Z_NULL;
+		if (inflateInit(&strm) != Z_OK)
+			return;
+		strm.avail_in = (uint32)section->sectionSize - 4;
+		strm.next_in = (Bytef*)rawData + 4;
+		strm.avail_out = uncompressedSize;
+		strm.next_out = sectionData[i].data();
+		int ret = inflate(&strm, Z_FULL_FLUSH);
+		inflateEnd(&strm);
+		isDecompressed[i] = (ret == Z_OK || ret == Z_STREAM_END) && strm.avail_in == 0 && strm.avail_out == 0;
+	});
+	for (size_t i = 0; i < sectionIndices.size(); i++)
+	{
+		if (isDecompressed[i])
+			rplLoaderContext->decompressedSectionData.emplace(sectionIndices[i], std::move(sectionData[i]));
+	}
+	bt.Stop();
+	rplLoaderContext->metrics.decompressMs = bt.GetElapsedMilliseconds();
+}
+
+void RPLLoader_BuildExportLookup(RPLModule* rplLoaderContext)
+{
+	auto buildLookup = [](std::unordered_map<std::string_view, uint32>& lookup, rplExportTableEntry_t* exportDataPtr, uint32 exportCount)
+	{
+		lookup.clear();
+		if (!exportDataPtr)
+			return;
+		lookup.reserve(exportCount);
+		char* exportNameData = (char*)((uint8*)exportDataPtr - 8);
+		for (uint32 f = 0; f < exportCount; f++)
+			lookup.try_emplace(exportNameData + (uint32)exportDataPtr[f].nameOffset, f); // keep the first entry on duplicate names, same as the linear search did
+	};
+	buildLookup(rplLoaderContext->exportFLookup, rplLoaderContext->exportFDataPtr, rplLoaderContext->exportFCount);
+	buildLookup(rplLoaderContext->exportDLookup, rplLoaderContext->exportDDataPtr, rplLoaderContext->exportDCount);
+}
+
 bool RPLLoader_LoadSingleSection(RPLModule* rplLoaderContext, sint32 sectionIndex, RPLMappingRegion* regionMappingInfo, MPTR mappedAddress)
 {
 	rplSectionEntryNew_t* section = RPLLoader_GetSection(rplLoaderContext, sectionIndex);
@@ -586,6 +663,7 @@ bool RPLLoader_LoadSections(sint32 aProcId, RPLModule* rplLoaderContext)
 			}
 		}
 	}
+	RPLLoader_BuildExportLookup(rplLoaderContext);
 	// load text sections
 	uint32 textSectionMappedBase = rplLoaderContext->regionMappingBase_text.GetMPTR() + (uint32)rplLoaderContext->fileInfo.trampolineAdjustment; // leave some space for trampolines before the code section begins
 	for (sint32 i = 0; i < (sint32)rplLoaderContext->rplHeader.sectionTableEntryCount; i++)
@@ -644,6 +722,9 @@ bool RPLLoader_LoadSections(sint32 aProcId, RPLModule* rplLoaderContext)
 	}
 	// todo: Verify calcEndAddress<=endAddress for each region
 
+	// only relocation data is still needed for linking
+	std::erase_if(rplLoaderContext->decompressedSectionData, [rplLoaderContext](const auto& entry) { return (uint32)rplLoaderContext->sectionTablePtr[entry.first].type != SHT_RELA; });
+
 	// dump loaded sections
 	/*
 	for (sint32 i = 0; i < (sint32)rplLoaderContext->rplHeader.sectionTableEntryCount; i++)
@@ -682,14 +763,15 @@ struct RPLSharedImportTracking
 
 static_assert(sizeof(RPLFileSymtabEntry) == 0x10, "rplSymtabEntry_t has invalid size");
 
-typedef struct
+struct MappedImportNameHash
 {
-	uint64 hash1;
-	uint64 hash2;
-	uint32 address;
-}mappedFunctionImport_t;
+	size_t operator()(const std::pair<uint64, uint64>& v) const
+	{
+		return (size_t)(v.first ^ (v.second * 0x9E3779B97F4A7C15ull));
+	}
+};
 
-std::vector<mappedFunctionImport_t> list_mappedFunctionImports = std::vector<mappedFunctionImport_t>();
+std::unordered_map<std::pair<uint64, uint64>, uint32, MappedImportNameHash> map_mappedFunctionImports; // import name hash -> address
 
 void _calculateMappedImportNameHash(const char* rplName, const char* funcName, uint64* h1Out, uint64* h2Out)
 {
@@ -740,13 +822,9 @@ uint32 rpl_mapHLEImport(RPLModule* rplLoaderContext, const char* rplName, const
 	uint64 mappedImportHash2;
 	_calculateMappedImportNameHash(rplName, funcName, &mappedImportHash1, &mappedImportHash2);
 	// find already mapped name
-	for (auto& importItr : list_mappedFunctionImports)
-	{
-		if (importItr.hash1 == mappedImportHash1 && importItr.hash2 == mappedImportHash2)
-		{
-			return importItr.address;
-		}
-	}
+	auto importItr = map_mappedFunctionImports.find({mappedImportHash1, mappedImportHash2});
+	if (importItr != map_mappedFunctionImports.end())
+		return importItr->second;
 	// copy lib file name and cut off .rpl from libName if present
 	char libName[512];
 	strcpy_s(libName, rplName);
@@ -768,11 +846,7 @@ uint32 rpl_mapHLEImport(RPLModule* rplLoaderContext, const char* rplName, const
 		uint32 opcode = (1 << 26) | functionIndex;
 		memory_write<uint32>(codeAddr, opcode);
 		// register mapped import
-		mappedFunctionImport_t newImport;
-		newImport.hash1 = mappedImportHash1;
-		newImport.hash2 = mappedImportHash2;
-		newImport.address = codeAddr;
-		list_mappedFunctionImports.push_back(newImport);
+		map_mappedFunctionImports.emplace(std::make_pair(mappedImportHash1, mappedImportHash2), codeAddr);
 		// remember in symbol storage for debugger
 		rplSymbolStorage_store(libName, funcName, codeAddr);
 		return codeAddr;
@@ -803,17 +877,25 @@ uint32 rpl_mapHLEImport(RPLModule* rplLoaderContext, const char* rplName, const
 	// align address to 4 byte boundary
 	currentAddress = (currentAddress + 3)&~3;
 	// register mapped import
-	mappedFunctionImport_t newImport;
-	newImport.hash1 = mappedImportHash1;
-	newImport.hash2 = mappedImportHash2;
-	newImport.address = codeStart;
-	list_mappedFunctionImports.push_back(newImport);
+	map_mappedFunctionImports.emplace(std::make_pair(mappedImportHash1, mappedImportHash2), codeStart);
 	// remember in symbol storage for debugger
 	rplSymbolStorage_store(libName, funcName, codeStart);
 	// return address of code start
 	return codeStart;
 }
 
+// returns false if the module has no export with the given name
+bool RPLLoader_LookupExport(RPLModule* rplLoaderContext, bool isData, std::string_view exportName, uint32& exportAddressOut)
+{
+	auto& lookup = isData ? rplLoaderContext->exportDLookup : rplLoaderContext->exportFLookup;
+	auto itr = lookup.find(exportName);
+	if (itr == lookup.end())
+		return false;
+	rplExportTableEntry_t* exportDataPtr = isData ? rplLoaderContext->exportDDataPtr : rplLoaderContext->exportFDataPtr;
+	exportAddressOut = exportDataPtr[itr->second].virtualOffset; // addresses are read on each lookup since relocations can still modify them
+	return true;
+}
+
 MPTR RPLLoader_FindRPLExport(RPLModule* rplLoaderContext, const char* symbolName, bool isData)
 {
 	if (isData)
@@ -821,18 +903,9 @@ MPTR RPLLoader_FindRPLExport(RPLModule* rplLoaderContext, const char* symbolName
 		cemu_assert_debug(false);
 		// todo - look in DDataPtr
 	}
-	if (rplLoaderContext->exportFDataPtr)
-	{
-		char* exportNameData = (char*)((uint8*)rplLoaderContext->exportFDataPtr - 8);
-		for (uint32 f = 0; f < rplLoaderContext->exportFCount; f++)
-		{
-			char* name = exportNameData + (uint32)rplLoaderContext->exportFDataPtr[f].nameOffset;
-			if (strcmp(name, symbolName) == 0)
-			{
-				return (uint32)rplLoaderContext->exportFDataPtr[f].virtualOffset;
-			}
-		}
-	}
+	uint32 exportAddress;
+	if (RPLLoader_LookupExport(rplLoaderContext, false, symbolName, exportAddress))
+		return exportAddress;
 	return MPTR_NULL;
 }
 
@@ -859,34 +932,9 @@ MPTR _findHLEExport(RPLModule* rplLoaderContext, RPLSharedImportTracking* shared
 
 uint32 RPLLoader_FindModuleExport(RPLModule* rplLoaderContext, bool isData, const char* exportName)
 {
-	if (isData == false)
-	{
-		// find function export
-		char* exportNameData = (char*)((uint8*)rplLoaderContext->exportFDataPtr - 8);
-		for (uint32 f = 0; f < rplLoaderContext->exportFCount; f++)
-		{
-			char* name = exportNameData + (uint32)rplLoaderContext->exportFDataPtr[f].nameOffset;
-			if (strcmp(name, exportName) == 0)
-			{
-				uint32 exportAddress = rplLoaderContext->exportFDataPtr[f].virtualOffset;
-				return exportAddress;
-			}
-		}
-	}
-	else
-	{
-		// find data export
-		char* exportNameData = (char*)((uint8*)rplLoaderContext->exportDDataPtr - 8);
-		for (uint32 f = 0; f < rplLoaderContext->exportDCount; f++)
-		{
-			char* name = exportNameData + (uint32)rplLoaderContext->exportDDataPtr[f].nameOffset;
-			if (strcmp(name, exportName) == 0)
-			{
-				uint32 exportAddress = rplLoaderContext->exportDDataPtr[f].virtualOffset;
-				return exportAddress;
-			}
-		}
-	}
+	uint32 exportAddress;
+	if (RPLLoader_LookupExport(rplLoaderContext, isData, exportName, exportAddress))
+		return exportAddress;
 	return 0;
 }
 
@@ -974,39 +1022,11 @@ bool RPLLoader_FixImportSymbols(RPLModule* rplLoaderContext, sint32 symtabSectio
 				uint32 nameOffset = sym->ukn00;
 				char* symbolName = (char*)strtabData + nameOffset;
 
-				bool foundExport = false;
-				if ((rplLoaderContext->sectionTablePtr[symSectionIndex].flags & 0x4) != 0)
-				{
-					// find function export
-					char* exportNameData = (char*)((uint8*)ctxExportModule->exportFDataPtr - 8);
-					for (uint32 f = 0; f < ctxExportModule->exportFCount; f++)
-					{
-						char* name = exportNameData + (uint32)ctxExportModule->exportFDataPtr[f].nameOffset;
-						if (strcmp(name, symbolName) == 0)
-						{
-							uint32 exportAddress = ctxExportModule->exportFDataPtr[f].virtualOffset;
-							sym->symbolAddress = exportAddress;
-							foundExport = true;
-							break;
-						}
-					}
-				}
-				else
-				{
-					// find data export
-					char* exportNameData = (char*)((uint8*)ctxExportModule->exportDDataPtr - 8);
-					for (uint32 f = 0; f < ctxExportModule->exportDCount; f++)
-					{
-						char* name = exportNameData + (uint32)ctxExportModule->exportDDataPtr[f].nameOffset;
-						if (strcmp(name, symbolName) == 0)
-						{
-							uint32 exportAddress = ctxExportModule->exportDDataPtr[f].virtualOffset;
-							sym->symbolAddress = exportAddress;
-							foundExport = true;
-							break;
-						}
-					}
-				}
+				bool isFunctionImport = (rplLoaderContext->sectionTablePtr[symSectionIndex].flags & 0x4) != 0;
+				uint32 exportAddress;
+				bool foundExport = RPLLoader_LookupExport(ctxExportModule, !isFunctionImport, symbolName, exportAddress);
+				if (foundExport)
+					sym->symbolAddress = exportAddress;
 				if (foundExport == false)
 				{
 #ifdef CEMU_DEBUG_ASSERT
@@ -1014,17 +1034,10 @@ bool RPLLoader_FixImportSymbols(RPLModule* rplLoaderContext, sint32 symtabSectio
 					{
 						cemuLog_logDebug(LogType::Force, "export not found - force lookup in function exports");
 						// workaround - force look up export in function exports
-						char* exportNameData = (char*)((uint8*)ctxExportModule->exportFDataPtr - 8);
-						for (uint32 f = 0; f < ctxExportModule->exportFCount; f++)
+						if (RPLLoader_LookupExport(ctxExportModule, false, symbolName, exportAddress))
 						{
-							char* name = exportNameData + (uint32)ctxExportModule->exportFDataPtr[f].nameOffset;
-							if (strcmp(name, symbolName) == 0)
-							{
-								uint32 exportAddress = ctxExportModule->exportFDataPtr[f].virtualOffset;
-								sym->symbolAddress = exportAddress;
-								foundExport = true;
-								break;
-							}
+							sym->symbolAddress = exportAddress;
+							foundExport = true;
 						}
 					}
 #endif
@@ -1052,7 +1065,39 @@ bool RPLLoader_FixImportSymbols(RPLModule* rplLoaderContext, sint32 symtabSectio
 	return true;
 }
 
-bool RPLLoader_ApplySingleReloc(RPLModule* rplLoaderContext, uint32 uknR3, uint8* relocTargetSectionAddress, uint32 relocType, bool isSymbolBinding2, uint32 relocOffset, uint32 relocAddend, uint32 symbolAddress, sint16 tlsModuleIndex)
+// REL24 relocation which can't reach its destination and needs a trampoline
+struct RPLDeferredFarBranch
+{
+	sint32 relaSectionIndex;
+	MPTR relocAddr;
+	MPTR destAddr;
+};
+
+// relocations of all RELA sections which target the same section
+// tasks are processed in parallel. Trampolines are allocated from shared heaps, so far branches are only collected
+// and patched afterwards in module and section order, which keeps the trampoline layout identical to sequential linking
+struct RPLRelocTask
+{
+	RPLModule* rplLoaderContext;
+	uint32 linkMode;
+	uint32 relocTargetSectionIndex;
+	std::vector<sint32> relaSectionIndices;
+	std::vector<RPLDeferredFarBranch> deferredFarBranches;
+	uint32 relocCount{0};
+	double elapsedMs{0.0};
+};
+
+void _RPLLoader_PatchFarBranch(MPTR relocAddr, MPTR trampolineAddr)
+{
+	uint32 opc = memory_readU32(relocAddr);
+	cemu_assert_debug((opc >> 26) == 18); // should be B/BL instruction
+	opc &= ~0x03fffffc;
+	opc |= (trampolineAddr & 0x3FFFFFC);
+	opc |= (1 << 1); // absolute jump
+	memory_writeU32(relocAddr, opc);
+}
+
+bool RPLLoader_ApplySingleReloc(RPLModule* rplLoaderContext, uint32 uknR3, uint8* relocTargetSectionAddress, uint32 relocType, bool isSymbolBinding2, uint32 relocOffset, uint32 relocAddend, uint32 symbolAddress, sint16 tlsModuleIndex, std::vector<RPLDeferredFarBranch>* deferredFarBranches, sint32 relaSectionIndex)
 {
 	MPTR relocTargetSectionMPTR = memory_getVirtualOffsetFromPointer(relocTargetSectionAddress);
 	MPTR relocAddrMPTR = relocTargetSectionMPTR + relocOffset;
@@ -1086,13 +1131,13 @@ bool RPLLoader_ApplySingleReloc(RPLModule* rplLoaderContext, uint32 uknR3, uint8
 		if ((jumpDistance>>25) != 0 && (jumpDistance >> 25) != 0x7F)
 		{
 			// can't reach with 24bit jump, use trampoline + absolute branch
+			if (deferredFarBranches)
+			{
+				deferredFarBranches->push_back({relaSectionIndex, relocAddrMPTR, relocDestAddr});
+				return true;
+			}
 			MPTR trampolineAddr = _generateTrampolineFarJump(rplLoaderContext, relocDestAddr);
-			// make absolute branch
-			cemu_assert_debug((opc >> 26) == 18); // should be B/BL instruction
-			opc &= ~0x03fffffc;
-			opc |= (trampolineAddr & 0x3FFFFFC);
-			opc |= (1 << 1); // absolute jump
-			*(uint32be*)relocAddr = opc;
+			_RPLLoader_PatchFarBranch(relocAddrMPTR, trampolineAddr);
 		}
 		else
 		{
@@ -1224,7 +1269,7 @@ bool RPLLoader_ApplySingleReloc(RPLModule* rplLoaderContext, uint32 uknR3, uint8
 	return true;
 }
 
-bool RPLLoader_ApplyRelocs(RPLModule* rplLoaderContext, sint32 relaSectionIndex, rplSectionEntryNew_t* section, uint32 linkMode)
+bool RPLLoader_ApplyRelocs(RPLModule* rplLoaderContext, sint32 relaSectionIndex, rplSectionEntryNew_t* section, uint32 linkMode, RPLRelocTask& relocTask)
 {
 	uint32 relocTargetSectionIndex = section->relocTargetSectionIndex;
 	if (relocTargetSectionIndex >= (uint32)rplLoaderContext->rplHeader.sectionTableEntryCount)
@@ -1246,12 +1291,20 @@ bool RPLLoader_ApplyRelocs(RPLModule* rplLoaderContext, sint32 relaSectionIndex,
 	// decompress reloc section if needed
 	uint8* relocData;
 	uint32 relocSize;
-	if ((uint32)(section->flags) & SHF_RPL_COMPRESSED)
+	bool relocDataAllocated = false;
+	auto decompressedItr = rplLoaderContext->decompressedSectionData.find(relaSectionIndex);
+	if (decompressedItr != rplLoaderContext->decompressedSectionData.end())
+	{
+		relocData = decompressedItr->second.data();
+		relocSize = (uint32)decompressedItr->second.size();
+	}
+	else if ((uint32)(section->flags) & SHF_RPL_COMPRESSED)
 	{
 		uint8* relocRawData = (uint8*)rplLoaderContext->sectionAddressTable2[relaSectionIndex].ptr;
 		uint32 relocUncompressedSize = *(uint32be*)relocRawData;
 		relocData = (uint8*)malloc(relocUncompressedSize);
 		relocSize = relocUncompressedSize;
+		relocDataAllocated = true;
 		// decompress
 		int ret;
 		z_stream strm;
@@ -1344,20 +1397,57 @@ bool RPLLoader_ApplyRelocs(RPLModule* rplLoaderContext, sint32 relaSectionIndex,
 			tlsModuleIndex = rplLoaderContext->fileInfo.tlsModuleIndex;
 		}
 		uint32 relocOffset = (uint32)reloc->relocOffset - (uint32)rplLoaderContext->sectionTablePtr[relocTargetSectionIndex].virtualAddress;
-		RPLLoader_ApplySingleReloc(rplLoaderContext, 0, relocTargetSectionAddress, relocType, symbolBinding == 2, relocOffset, reloc->relocAddend, symbolAddress, tlsModuleIndex);
+		RPLLoader_ApplySingleReloc(rplLoaderContext, 0, relocTargetSectionAddress, relocType, symbolBinding == 2, relocOffset, reloc->relocAddend, symbolAddress, tlsModuleIndex, &relocTask.deferredFarBranches, relaSectionIndex);
+		relocTask.relocCount++;
 
 		// next reloc
 		reloc++;
 	}
 
-	if ((uint32)(section->flags) & SHF_RPL_COMPRESSED)
+	if (relocDataAllocated)
 		free(relocData);
 	return true;
 }
 
-bool RPLLoader_HandleRelocs(RPLModule* rplLoaderContext, std::span<RPLSharedImportTracking> sharedImportTracking, uint32 linkMode)
+void RPLLoader_RunRelocTasks(std::span<RPLRelocTask> relocTasks)
+{
+	ThreadPool::ParallelFor((uint32)relocTasks.size(), [&](uint32 i)
+	{
+		RPLRelocTask& relocTask = relocTasks[i];
+		BenchmarkTimer bt;
+		bt.Start();
+		for (sint32 relaSectionIndex : relocTask.relaSectionIndices)
+			RPLLoader_ApplyRelocs(relocTask.rplLoaderContext, relaSectionIndex, relocTask.rplLoaderContext->sectionTablePtr + relaSectionIndex, relocTask.linkMode, relocTask);
+		bt.Stop();
+		relocTask.elapsedMs = bt.GetElapsedMilliseconds();
+	});
+	// tasks of a module are stored consecutively
+	std::vector<RPLDeferredFarBranch> farBranches;
+	for (size_t taskIndex = 0; taskIndex < relocTasks.size();)
+	{
+		RPLModule* rplLoaderContext = relocTasks[taskIndex].rplLoaderContext;
+		farBranches.clear();
+		for (; taskIndex < relocTasks.size() && relocTasks[taskIndex].rplLoaderContext == rplLoaderContext; taskIndex++)
+		{
+			RPLRelocTask& relocTask = relocTasks[taskIndex];
+			farBranches.insert(farBranches.end(), relocTask.deferredFarBranches.begin(), relocTask.deferredFarBranches.end());
+			rplLoaderContext->metrics.linkMs += relocTask.elapsedMs;
+			if (relocTask.linkMode == 2)
+				rplLoaderContext->metrics.relocCount += relocTask.relocCount;
+		}
+		// within a RELA section the branches are already in relocation order
+		std::stable_sort(farBranches.begin(), farBranches.end(), [](const RPLDeferredFarBranch& a, const RPLDeferredFarBranch& b) { return a.relaSectionIndex < b.relaSectionIndex; });
+		for (auto& farBranch : farBranches)
+			_RPLLoader_PatchFarBranch(farBranch.relocAddr, _generateTrampolineFarJump(rplLoaderContext, farBranch.destAddr));
+	}
+}
+
+// resolves the symbols and queues the relocations of a module, the relocations are applied by RPLLoader_RunRelocTasks
+bool RPLLoader_HandleRelocs(RPLModule* rplLoaderContext, std::span<RPLSharedImportTracking> sharedImportTracking, uint32 linkMode, std::vector<RPLRelocTask>& relocTasks)
 {
 	// resolve relocs
+	BenchmarkTimer bt;
+	bt.Start();
 	for (sint32 i = 0; i < (sint32)rplLoaderContext->rplHeader.sectionTableEntryCount; i++)
 	{
 		rplSectionEntryNew_t* section = rplLoaderContext->sectionTablePtr + i;
@@ -1366,15 +1456,30 @@ bool RPLLoader_HandleRelocs(RPLModule* rplLoaderContext, std::span<RPLSharedImpo
 			continue;
 		RPLLoader_FixImportSymbols(rplLoaderContext, i, section, sharedImportTracking, linkMode);
 	}
+	bt.Stop();
+	rplLoaderContext->metrics.linkMs += bt.GetElapsedMilliseconds();
 
 	// apply relocs again after we have fixed the import section
+	// RELA sections with the same target section are grouped into one task so they are still applied in order
+	size_t firstTaskIndex = relocTasks.size();
 	for (sint32 i = 0; i < (sint32)rplLoaderContext->rplHeader.sectionTableEntryCount; i++)
 	{
 		rplSectionEntryNew_t* section = rplLoaderContext->sectionTablePtr + i;
 		uint32 sectionType = section->type;
 		if (sectionType != SHT_RELA)
 			continue;
-		RPLLoader_ApplyRelocs(rplLoaderContext, i, section, linkMode);
+		uint32 relocTargetSectionIndex = section->relocTargetSectionIndex;
+		auto itr = std::find_if(relocTasks.begin() + firstTaskIndex, relocTasks.end(), [&](const RPLRelocTask& t) { return t.relocTargetSectionIndex == relocTargetSectionIndex; });
+		if (itr == relocTasks.end())
+		{
+			RPLRelocTask& relocTask = relocTasks.emplace_back();
+			relocTask.rplLoaderContext = rplLoaderContext;
+			relocTask.linkMode = linkMode;
+			relocTask.relocTargetSectionIndex = relocTargetSectionIndex;
+			relocTask.relaSectionIndices.emplace_back(i);
+		}
+		else
+			itr->relaSectionIndices.emplace_back(i);
 	}
 	return true;
 }
@@ -1464,6 +1569,12 @@ void RPLLoader_BeginCemuhookCRC(RPLModule* rpl)
 			rawData = NULL;
 			rawSize = sectionCompressedSize;
 		}
+		else if ((flags&SHF_RPL_COMPRESSED) != 0 && rpl->decompressedSectionData.contains(i))
+		{
+			std::vector<uint8>& decompressedData = rpl->decompressedSectionData[i];
+			rawSize = (uint32)decompressedData.size();
+			rawData = decompressedData.data();
+		}
 		else if ((flags&SHF_RPL_COMPRESSED) != 0)
 		{
 			uint32 decompressedSize = _swapEndianU32(*(uint32*)(rpl->RPLRawData.data() + sectionFileOffset));
@@ -1581,6 +1692,9 @@ void RPLLoader_InitModuleAllocator(RPLModule* rpl)
 // map rpl into memory, but do not resolve relocs and imports yet
 RPLModule* RPLLoader_LoadFromMemory(uint8* rplData, sint32 size, std::string_view name)
 {
+	BOOT_PROFILE_SCOPE_DETAIL("LoadRPL", name);
+	BenchmarkTimer loadTimer;
+	loadTimer.Start();
 	char moduleName[RPL_MODULE_NAME_LENGTH];
 	_RPLLoader_ExtractModuleNameFromPath(moduleName, name);
 	RPLModule* rpl = nullptr;
@@ -1590,6 +1704,7 @@ RPLModule* RPLLoader_LoadFromMemory(uint8* rplData, sint32 size, std::string_vie
 		return nullptr;
 	}
 	RPLLoader_InitModuleAllocator(rpl);
+	RPLLoader_DecompressSections(rpl);
 	RPLLoader_BeginCemuhookCRC(rpl);
 	if (RPLLoader_LoadSections(0, rpl) == false)
 	{
@@ -1665,6 +1780,8 @@ RPLModule* RPLLoader_LoadFromMemory(uint8* rplData, sint32 size, std::string_vie
 
 	// update entrypoint
 	RPLLoader_UpdateEntrypoint(rpl);
+	loadTimer.Stop();
+	rpl->metrics.loadMs = loadTimer.GetElapsedMilliseconds();
 	return rpl;
 }
 
@@ -1679,8 +1796,8 @@ void RPLLoader_FlushMemory(RPLModule* rpl)
 	});
 }
 
-// resolve relocs and imports of all modules. Or resolve exports
-void RPLLoader_LinkSingleModule(RPLModule* rplLoaderContext, bool resolveOnlyExports)
+// resolve imports of a module and queue its relocations. Or resolve exports
+void RPLLoader_PrepareLinkSingleModule(RPLModule* rplLoaderContext, bool resolveOnlyExports, std::vector<RPLRelocTask>& relocTasks)
 {
 	// setup shared import tracking
 	std::vector<RPLSharedImportTracking> sharedImportTracking;
@@ -1720,10 +1837,17 @@ void RPLLoader_LinkSingleModule(RPLModule* rplLoaderContext, bool resolveOnlyExp
 	}
 
 	if (resolveOnlyExports)
-		RPLLoader_HandleRelocs(rplLoaderContext, sharedImportTracking, 2);
+		RPLLoader_HandleRelocs(rplLoaderContext, sharedImportTracking, 2, relocTasks);
 	else
-		RPLLoader_HandleRelocs(rplLoaderContext, sharedImportTracking, 0);
+		RPLLoader_HandleRelocs(rplLoaderContext, sharedImportTracking, 0, relocTasks);
+}
 
+// resolve relocs and imports of all modules. Or resolve exports
+void RPLLoader_LinkSingleModule(RPLModule* rplLoaderContext, bool resolveOnlyExports)
+{
+	std::vector<RPLRelocTask> relocTasks;
+	RPLLoader_PrepareLinkSingleModule(rplLoaderContext, resolveOnlyExports, relocTasks);
+	RPLLoader_RunRelocTasks(relocTasks);
 	RPLLoader_FlushMemory(rplLoaderContext);
 }
 
@@ -1880,11 +2004,20 @@ void RPLLoader_Link()
 		RPLLoader_FixModuleTLSIndex(rplModuleList[i]);
 	}
 	// resolve relocs
+	// this pass only touches memory of the module itself, so the relocations of all modules are applied in parallel
+	std::vector<RPLRelocTask> relocTasks;
 	for (sint32 i = 0; i < rplModuleCount; i++)
 	{
 		if(rplModuleList[i]->isLinked)
 			continue;
-		RPLLoader_LinkSingleModule(rplModuleList[i], false);
+		RPLLoader_PrepareLinkSingleModule(rplModuleList[i], false, relocTasks);
+	}
+	RPLLoader_RunRelocTasks(relocTasks);
+	for (sint32 i = 0; i < rplModuleCount; i++)
+	{
+		if (rplModuleList[i]->isLinked)
+			continue;
+		RPLLoader_FlushMemory(rplModuleList[i]);
 	}
 	// resolve imports and load debug symbols
 	for (sint32 i = 0; i < rplModuleCount; i++)
@@ -1894,6 +2027,9 @@ void RPLLoader_Link()
 		RPLLoader_LinkSingleModule(rplModuleList[i], true);
 		RPLLoader_LoadDebugSymbols(rplModuleList[i]);
 		rplModuleList[i]->isLinked = true; // mark as linked
+		rplModuleList[i]->decompressedSectionData.clear();
+		auto& metrics = rplModuleList[i]->metrics;
+		cemuLog_logDebug(LogType::Force, "RPLLoader: {} loaded in {:.2f}ms (decompression {:.2f}ms), linked in {:.2f}ms ({} relocations)", rplModuleList[i]->moduleName2, metrics.loadMs, metrics.decompressMs, metrics.linkMs, metrics.relocCount);
 		GraphicPack2::NotifyModuleLoaded(rplModuleList[i]);
 		g_debuggerDispatcher.NotifyModuleLoaded(rplModuleList[i]);
 	}
@@ -2493,7 +2629,7 @@ void RPLLoader_UnloadAll()
 	rplSymbolStorage_unloadAll();
 	// free all code imports
 	g_heapTrampolineArea.releaseAll();
-	list_mappedFunctionImports.clear();
+	map_mappedFunctionImports.clear();
 	g_map_callableExports.clear();
 	rplLoader_applicationHasMemoryControl = false;
 	rplLoader_maxCodeAddress = 0;
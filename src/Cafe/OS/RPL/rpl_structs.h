@@ -163,6 +163,9 @@ struct RPLModule
 	rplExportTableEntry_t* exportDDataPtr;
 	uint32 exportFCount;
 	rplExportTableEntry_t* exportFDataPtr;
+	// hashed export tables, maps export name to index in exportFDataPtr/exportDDataPtr
+	std::unordered_map<std::string_view, uint32> exportFLookup;
+	std::unordered_map<std::string_view, uint32> exportDLookup;
 
 	std::string moduleName2;
 	
@@ -203,6 +206,8 @@ struct RPLModule
 	}fileInfo;
 	// parsed CRC
 	std::vector<uint32> crcTable;
+	// compressed sections inflated ahead of time, only kept until the module is linked
+	std::unordered_map<uint32, std::vector<uint8>> decompressedSectionData;
 
 	uint32 GetSectionCRC(size_t sectionIndex) const
 	{
@@ -230,6 +235,15 @@ struct RPLModule
 	bool debugSectionLoadMask[128] = { false };
 	bool hasError{ false };
 
+	// boot time metrics
+	struct
+	{
+		double loadMs; // headers, section decompression and mapping
+		double decompressMs; // part of loadMs
+		double linkMs; // import resolution and relocations, summed over all threads
+		uint32 relocCount;
+	}metrics{};
+
 };
 
 struct RPLDependency
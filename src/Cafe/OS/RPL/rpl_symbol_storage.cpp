@@ -1,22 +1,16 @@
 #include "Cafe/OS/RPL/rpl.h"
 #include "Cafe/OS/RPL/rpl_symbol_storage.h"
 
-struct rplSymbolLib_t
-{
-	char* libName;
-	rplSymbolLib_t* next;
-};
-
 struct  
 {
-	rplSymbolLib_t* libs;
 	std::mutex m_symbolStorageMutex;
+	std::unordered_map<std::string, char*> map_libByLowercaseName; // library names are compared case-insensitive
 	std::unordered_map<uint32, RPLStoredSymbol*> map_symbolByAddress;
 	// allocator for strings
 	char* strAllocatorBlock;
 	sint32 strAllocatorOffset;
 	std::vector<void*> list_strAllocatedBlocks;
-}rplSymbolStorage = { 0 };
+}rplSymbolStorage{};
 
 #define STR_ALLOC_BLOCK_SIZE	(128*1024) // allocate 128KB blocks at once
 
@@ -39,28 +33,13 @@ char* rplSymbolStorage_allocDupString(const char* str)
 
 char* rplSymbolStorage_storeLibname(const char* libName)
 {
-	if (rplSymbolStorage.libs == NULL)
-	{
-		rplSymbolLib_t* libEntry = new rplSymbolLib_t();
-		libEntry->libName = rplSymbolStorage_allocDupString(libName);
-		libEntry->next = NULL;
-		rplSymbolStorage.libs = libEntry;
-		return libEntry->libName;
-	}
-	rplSymbolLib_t* libItr = rplSymbolStorage.libs;
-	while (libItr)
-	{
-		if (boost::iequals(libItr->libName, libName))
-			return libItr->libName;
-		// next
-		libItr = libItr->next;
-	}
-	// create new entry
-	rplSymbolLib_t* libEntry = new rplSymbolLib_t();
-	libEntry->libName = rplSymbolStorage_allocDupString(libName);
-	libEntry->next = rplSymbolStorage.libs;
-	rplSymbolStorage.libs = libEntry;
-	return libEntry->libName;
+	std::string lowercaseName = boost::to_lower_copy(std::string(libName));
+	auto it = rplSymbolStorage.map_libByLowercaseName.find(lowercaseName);
+	if (it != rplSymbolStorage.map_libByLowercaseName.end())
+		return it->second;
+	char* libNameStorage = rplSymbolStorage_allocDupString(libName);
+	rplSymbolStorage.map_libByLowercaseName.emplace(std::move(lowercaseName), libNameStorage);
+	return libNameStorage;
 }
 
 RPLStoredSymbol* rplSymbolStorage_store(const char* libName, const char* symbolName, MPTR address)
@@ -80,7 +59,10 @@ RPLStoredSymbol* rplSymbolStorage_store(const char* libName, const char* symbolN
 RPLStoredSymbol* rplSymbolStorage_getByAddress(MPTR address)
 {
 	std::unique_lock<std::mutex> lck(rplSymbolStorage.m_symbolStorageMutex);
-	return rplSymbolStorage.map_symbolByAddress[address];
+	auto it = rplSymbolStorage.map_symbolByAddress.find(address);
+	if (it == rplSymbolStorage.map_symbolByAddress.end())
+		return nullptr;
+	return it->second;
 }
 
 RPLStoredSymbol* rplSymbolStorage_getByClosestAddress(MPTR address)
@@ -89,9 +71,9 @@ RPLStoredSymbol* rplSymbolStorage_getByClosestAddress(MPTR address)
     std::unique_lock<std::mutex> lck(rplSymbolStorage.m_symbolStorageMutex);
     for(uint32 i=0; i<4096; i++)
     {
-        RPLStoredSymbol* symbol = rplSymbolStorage.map_symbolByAddress[address];
-        if(symbol)
-            return symbol;
+        auto it = rplSymbolStorage.map_symbolByAddress.find(address);
+        if(it != rplSymbolStorage.map_symbolByAddress.end() && it->second)
+            return it->second;
         address -= 4;
     }
     return nullptr;
@@ -148,14 +130,7 @@ void rplSymbolStorage_unloadAll()
 		delete it.second;
 	rplSymbolStorage.map_symbolByAddress.clear();
 	// free libs
-	rplSymbolLib_t* lib = rplSymbolStorage.libs;
-	while (lib)
-	{
-		rplSymbolLib_t* next = lib->next;
-		delete lib;
-		lib = next;
-	}
-	rplSymbolStorage.libs = nullptr;
+	rplSymbolStorage.map_libByLowercaseName.clear();
 	// free strings
 	for (auto it : rplSymbolStorage.list_strAllocatedBlocks)
 		free(it);
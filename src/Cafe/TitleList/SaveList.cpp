@@ -1,6 +1,7 @@
 #include "SaveList.h"
 #include <charconv>
 #include <util/helpers/helpers.h>
+#include "util/ThreadPool/ThreadPool.h"
 
 std::mutex sSLMutex;
 fs::path sSLMLCPath;
@@ -64,6 +65,7 @@ void CafeSaveList::RefreshThreadWorker()
 	fs::path mlcPath = sSLMLCPath;
 	sSLMutex.unlock();
 	std::error_code ec;
+	std::vector<TitleId> saveTitleIds;
 	for (auto it_titleHigh : fs::directory_iterator(mlcPath / "usr/save", ec))
 	{
 		if(!it_titleHigh.is_directory(ec))
@@ -88,14 +90,18 @@ void CafeSaveList::RefreshThreadWorker()
 			if (r.ec != std::errc())
 				continue;
 			// found save
-			TitleId titleId = (uint64)titleIdHigh << 32 | (uint64)titleIdLow;
-			SaveInfo* saveInfo = new SaveInfo(titleId);
-			if (saveInfo->IsValid())
-				DiscoveredSave(saveInfo);
-			else
-				delete saveInfo;
+			saveTitleIds.emplace_back((uint64)titleIdHigh << 32 | (uint64)titleIdLow);
 		}
 	}
+	// reading the meta data of each save is independent, spread it across the thread pool
+	ThreadPool::ParallelFor((uint32)saveTitleIds.size(), [&](uint32 i)
+	{
+		SaveInfo* saveInfo = new SaveInfo(saveTitleIds[i]);
+		if (saveInfo->IsValid())
+			DiscoveredSave(saveInfo);
+		else
+			delete saveInfo;
+	});
 	sSLMutex.lock();
 	sSLWorkerThreadActive = false;
 	sSLMutex.unlock();
@@ -96,6 +96,7 @@ TitleInfo::TitleInfo(const TitleInfo::CachedInfo& cachedInfo)
 	m_fullPath = cachedInfo.path;
 	m_subPath = cachedInfo.subPath;
 	m_titleFormat = cachedInfo.titleDataFormat;
+	m_sourceStamp = cachedInfo.sourceStamp;
 	// verify some parameters
 	m_isValid = false;
 	if (cachedInfo.titleDataFormat != TitleDataFormat::HOST_FS &&
@@ -136,9 +137,40 @@ TitleInfo::CachedInfo TitleInfo::MakeCacheEntry()
 	e.region = GetMetaRegion();
 	e.group_id = GetAppGroup();
 	e.app_type = GetAppType();
+	e.sourceStamp = m_sourceStamp;
 	return e;
 }
 
+TitleInfo::SourceStamp TitleInfo::DetermineSourceStamp(const fs::path& path)
+{
+	SourceStamp stamp;
+	std::error_code ec;
+	auto addFile = [&](const fs::path& filePath) -> bool
+	{
+		uint64 fileSize = fs::file_size(filePath, ec);
+		if (ec)
+			return false;
+		auto modTime = fs::last_write_time(filePath, ec);
+		if (ec)
+			return false;
+		stamp.size += fileSize;
+		stamp.modTime = std::max<sint64>(stamp.modTime, (sint64)modTime.time_since_epoch().count());
+		return true;
+	};
+	if (fs::is_regular_file(path, ec))
+	{
+		if (!addFile(path))
+			return {};
+	}
+	else
+	{
+		// title folder. The app.xml holds the title id and version, meta.xml the names
+		if (!addFile(path / "code/app.xml") || !addFile(path / "meta/meta.xml"))
+			return {};
+	}
+	return stamp;
+}
+
 // WUA can contain multiple titles. Root directory contains one directory for each title. The name must match: <titleId>_v<version>
 bool TitleInfo::ParseWuaTitleFolderName(std::string_view name, TitleId& titleIdOut, uint16& titleVersionOut)
 {
@@ -383,6 +415,7 @@ void _ZArchivePool_ReleaseInstance(const fs::path& path, ZArchiveReader* zar)
 	it->second.first--; // decrement ref count
 	if (it->second.first == 0)
 	{
+		FSCDeviceWUA_ReleaseArchive(it->second.second);
 		delete it->second.second;
 		sZArchivePool.erase(it);
 	}
@@ -142,6 +142,17 @@ public:
 		MISSING_XML_FILES = 4,
 	};
 
+	// size and modification time of the title source when it was parsed, used to skip unchanged titles when rescanning
+	// for files this is the file itself, for title folders the meta and code xml files
+	struct SourceStamp
+	{
+		uint64 size{};
+		sint64 modTime{};
+
+		bool IsValid() const { return modTime != 0; }
+		bool operator==(const SourceStamp& other) const { return size == other.size && modTime == other.modTime; }
+	};
+
 	struct CachedInfo
 	{
 		TitleDataFormat titleDataFormat;
@@ -154,6 +165,7 @@ public:
 		CafeConsoleRegion region;
 		uint32 group_id;
 		uint32 app_type;
+		SourceStamp sourceStamp;
 	};
 
 	TitleInfo() : m_isValid(false) {};
@@ -175,6 +187,10 @@ public:
 
 	bool IsCached() { return m_cachedInfo; }; // returns true if this TitleInfo was loaded from cache and has not yet been parsed
 
+	static SourceStamp DetermineSourceStamp(const fs::path& path); // path as passed to the constructor
+	void SetSourceStamp(const SourceStamp& stamp) { m_sourceStamp = stamp; }
+	const SourceStamp& GetSourceStamp() const { return m_sourceStamp; }
+
 	CachedInfo MakeCacheEntry();
 
 	bool IsValid() const;
@@ -246,6 +262,7 @@ private:
 		m_fullPath = other.m_fullPath;
 		m_subPath = other.m_subPath;
 		m_hasParsedXmlFiles = other.m_hasParsedXmlFiles;
+		m_sourceStamp = other.m_sourceStamp;
 		m_parsedMetaXml = nullptr;
 		m_parsedAppXml = nullptr;
 
@@ -275,6 +292,7 @@ private:
 	std::string m_subPath; // used for formats where fullPath isn't unique on its own (like WUA)
 	uint64 m_uid{};
 	InvalidReason m_invalidReason{ InvalidReason::NONE }; // if m_isValid == false, this contains a more detailed error code
+	SourceStamp m_sourceStamp{};
 	// mounting info
 	std::vector<std::pair<sint32, std::string>> m_mountpoints;
 	class FSTVolume* m_wudVolume{};
@@ -2,6 +2,7 @@
 #include "Common/FileStream.h"
 
 #include "util/helpers/helpers.h"
+#include "util/ThreadPool/ThreadPool.h"
 
 #include <zarchive/zarchivereader.h>
 
@@ -73,6 +74,9 @@ void CafeTitleList::LoadCacheFile()
 		std::string sub_path = titleInfoNode.child_value("sub_path");
 		uint32 group_id = ConvertString<uint32>(titleInfoNode.attribute("group_id").as_string(), 16);
 		uint32 app_type = ConvertString<uint32>(titleInfoNode.attribute("app_type").as_string(), 16);
+		TitleInfo::SourceStamp sourceStamp;
+		sourceStamp.size = titleInfoNode.attribute("source_size").as_ullong();
+		sourceStamp.modTime = titleInfoNode.attribute("source_time").as_llong();
 
 		TitleInfo::CachedInfo cacheEntry;
 		cacheEntry.titleId = titleId;
@@ -85,6 +89,7 @@ void CafeTitleList::LoadCacheFile()
 		cacheEntry.subPath = std::move(sub_path);
 		cacheEntry.group_id = group_id;
 		cacheEntry.app_type = app_type;
+		cacheEntry.sourceStamp = sourceStamp;
 
 		TitleInfo* ti = new TitleInfo(cacheEntry);
 		if (!ti->IsValid())
@@ -120,6 +125,11 @@ void CafeTitleList::StoreCacheFile()
 		titleInfoNode.append_attribute("sdk_version").set_value(fmt::format("{:}", info.sdkVersion).c_str());
 		titleInfoNode.append_attribute("group_id").set_value(fmt::format("{:08x}", info.group_id).c_str());
 		titleInfoNode.append_attribute("app_type").set_value(fmt::format("{:08x}", info.app_type).c_str());
+		if (info.sourceStamp.IsValid())
+		{
+			titleInfoNode.append_attribute("source_size").set_value(fmt::format("{}", info.sourceStamp.size).c_str());
+			titleInfoNode.append_attribute("source_time").set_value(fmt::format("{}", info.sourceStamp.modTime).c_str());
+		}
 		titleInfoNode.append_child("region").append_child(pugi::node_pcdata).set_value(fmt::format("{}", (uint32)info.region).c_str());
 		titleInfoNode.append_child("name").append_child(pugi::node_pcdata).set_value(info.titleName.c_str());
 		titleInfoNode.append_child("format").append_child(pugi::node_pcdata).set_value(fmt::format("{}", (uint32)info.titleDataFormat).c_str());
@@ -213,6 +223,11 @@ void _RemoveTitleFromMultimap(TitleInfo* titleInfo)
 // check if path is a valid title and if it is, permanently add it to the title list
 // in the special case that path points to a WUA file, all contained titles will be added
 void CafeTitleList::AddTitleFromPath(fs::path path)
+{
+	AddTitleFromPath(path, TitleInfo::DetermineSourceStamp(path));
+}
+
+void CafeTitleList::AddTitleFromPath(const fs::path& path, const TitleInfo::SourceStamp& stamp)
 {
 	if (path.has_extension() && boost::iequals(_pathToUtf8(path.extension()), ".wua"))
 	{
@@ -241,6 +256,7 @@ void CafeTitleList::AddTitleFromPath(fs::path path)
 			}
 			// valid subdirectory
 			TitleInfo* titleInfo = new TitleInfo(path, dirEntry.name);
+			titleInfo->SetSourceStamp(stamp);
 			if (titleInfo->IsValid())
 				AddDiscoveredTitle(titleInfo);
 			else
@@ -250,12 +266,25 @@ void CafeTitleList::AddTitleFromPath(fs::path path)
 		return;
 	}
 	TitleInfo* titleInfo = new TitleInfo(path);
+	titleInfo->SetSourceStamp(stamp);
 	if (titleInfo->IsValid())
 		AddDiscoveredTitle(titleInfo);
 	else
 		delete titleInfo;
 }
 
+// compares the candidate against the titles known before the scan started
+// known titles from unchanged sources are kept as they are and removed from the pending list, this includes entries loaded from the cache file
+// returns true if the candidate is new or was modified and needs to be parsed
+static bool _IsScanCandidateChanged(const fs::path& path, const TitleInfo::SourceStamp& stamp)
+{
+	if (!stamp.IsValid())
+		return true;
+	std::unique_lock _lock(sTLMutex);
+	size_t numErased = std::erase_if(sTLListPending, [&](TitleInfo* it) { return it->GetSourceStamp() == stamp && it->GetPath() == path; });
+	return numErased == 0;
+}
+
 bool CafeTitleList::RefreshWorkerThread()
 {
 	SetThreadName("TitleListWorker");
@@ -271,10 +300,10 @@ bool CafeTitleList::RefreshWorkerThread()
 		// at the end of scanning, we can then use this list to identify and remove any titles that are no longer discoverable
 		sTLListPending = sTLList;
 		sTLMutex.unlock();
-		// scan game paths
+		// walk the directories and collect every file or folder which could be a title
+		std::vector<fs::path> candidates;
 		for (auto& it : gamePaths)
-			ScanGamePath(it);
-		// scan MLC
+			ScanGamePath(it, candidates);
 		if (!mlcPath.empty())
 		{
 			std::error_code ec;
@@ -282,11 +311,31 @@ bool CafeTitleList::RefreshWorkerThread()
 			{
 				if (!it.is_directory(ec))
 					continue;
-				ScanMLCPath(it.path());
+				ScanMLCPath(it.path(), candidates);
 			}
-			ScanMLCPath(mlcPath / "sys/title/00050010");
-			ScanMLCPath(mlcPath / "sys/title/00050030");
+			ScanMLCPath(mlcPath / "sys/title/00050010", candidates);
+			ScanMLCPath(mlcPath / "sys/title/00050030", candidates);
 		}
+		// parsing a candidate means opening the image or archive and reading the xml files, this runs on the thread pool
+		// candidates which did not change since the last scan are skipped. Entries loaded from the cache file stay unparsed,
+		// the cache holds everything the title list needs and the full meta info is parsed on demand (see TitleInfo::ParseXmlInfo)
+		std::vector<TitleInfo::SourceStamp> stamps(candidates.size());
+		std::vector<uint8> isChanged(candidates.size());
+		ThreadPool::ParallelFor((uint32)candidates.size(), [&](uint32 i)
+		{
+			stamps[i] = TitleInfo::DetermineSourceStamp(candidates[i]);
+			isChanged[i] = _IsScanCandidateChanged(candidates[i], stamps[i]) ? 1 : 0;
+		});
+		std::vector<uint32> changedIndices;
+		for (uint32 i = 0; i < (uint32)candidates.size(); i++)
+		{
+			if (isChanged[i])
+				changedIndices.emplace_back(i);
+		}
+		ThreadPool::ParallelFor((uint32)changedIndices.size(), [&](uint32 i)
+		{
+			AddTitleFromPath(candidates[changedIndices[i]], stamps[changedIndices[i]]);
+		});
 
 		// remove any titles that are still pending
 		for (auto& itPending : sTLListPending)
@@ -347,7 +396,7 @@ bool _IsKnownFileNameOrExtension(const fs::path& path)
 	// note: To detect extracted titles with RPX we rely on the presence of the content,code,meta directory structure
 }
 
-void CafeTitleList::ScanGamePath(const fs::path& path)
+void CafeTitleList::ScanGamePath(const fs::path& path, std::vector<fs::path>& candidatesOut)
 {
 	// scan the whole directory first to determine if this is a title folder
 	std::vector<fs::path> filesInDirectory;
@@ -380,17 +429,12 @@ void CafeTitleList::ScanGamePath(const fs::path& path)
 			continue;
 		if (!_IsKnownFileNameOrExtension(it))
 			continue;
-		AddTitleFromPath(it);
+		candidatesOut.emplace_back(it);
 	}
 	// is the current directory a title folder?
 	if (hasContentFolder && hasCodeFolder && hasMetaFolder)
 	{
-		// verify if this folder is a valid title
-		TitleInfo* titleInfo = new TitleInfo(path);
-		if (titleInfo->IsValid())
-			AddDiscoveredTitle(titleInfo);
-		else
-			delete titleInfo;
+		candidatesOut.emplace_back(path);
 		// if there are other folders besides content/code/meta then traverse those
 		if (dirsInDirectory.size() > 3)
 		{
@@ -400,7 +444,7 @@ void CafeTitleList::ScanGamePath(const fs::path& path)
 				if (!boost::iequals(dirName, "content") &&
 					!boost::iequals(dirName, "code") &&
 					!boost::iequals(dirName, "meta"))
-					ScanGamePath(it);
+					ScanGamePath(it, candidatesOut);
 			}
 		}
 	}
@@ -408,11 +452,11 @@ void CafeTitleList::ScanGamePath(const fs::path& path)
 	{
 		// scan subdirectories
 		for (auto& it : dirsInDirectory)
-			ScanGamePath(it);
+			ScanGamePath(it, candidatesOut);
 	}
 }
 
-void CafeTitleList::ScanMLCPath(const fs::path& path)
+void CafeTitleList::ScanMLCPath(const fs::path& path, std::vector<fs::path>& candidatesOut)
 {
 	std::error_code ec;
 	for (auto& it : fs::directory_iterator(path, ec))
@@ -440,11 +484,7 @@ void CafeTitleList::ScanMLCPath(const fs::path& path)
 			fs::is_directory(it.path() / "content", ec) &&
 			fs::is_directory(it.path() / "meta", ec))
 		{
-			TitleInfo* titleInfo = new TitleInfo(it);
-			if (titleInfo->IsValid() && titleInfo->ParseXmlInfo())
-				AddDiscoveredTitle(titleInfo);
-			else
-				delete titleInfo;
+			candidatesOut.emplace_back(it.path());
 		}
 	}
 }
@@ -49,8 +49,9 @@ public:
 
 private:
 	static bool RefreshWorkerThread();
-	static void ScanGamePath(const fs::path& path);
-	static void ScanMLCPath(const fs::path& path);
+	static void ScanGamePath(const fs::path& path, std::vector<fs::path>& candidatesOut);
+	static void ScanMLCPath(const fs::path& path, std::vector<fs::path>& candidatesOut);
+	static void AddTitleFromPath(const fs::path& path, const TitleInfo::SourceStamp& stamp);
 
 	static void AddDiscoveredTitle(TitleInfo* titleInfo);
 	static void AddTitle(TitleInfo* titleInfo);
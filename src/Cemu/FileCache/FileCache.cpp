@@ -6,6 +6,13 @@
 #include "zlib.h"
 #include "Common/FileStream.h"
 
+#if !BOOST_OS_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 struct FileCacheAsyncJob
 {
 	FileCache* fileCache;
@@ -14,6 +21,19 @@ struct FileCacheAsyncJob
 	std::vector<uint8> fileData;
 };
 
+// caches which were closed with unused space, compacted on application exit
+static struct
+{
+	std::mutex mutex;
+	std::vector<fs::path> paths;
+}s_pendingCompaction;
+
+static void _FileCache_RemovePendingCompaction(const fs::path& path)
+{
+	std::unique_lock _l(s_pendingCompaction.mutex);
+	std::erase(s_pendingCompaction.paths, path);
+}
+
 struct _FileCacheAsyncWriter
 {
 	_FileCacheAsyncWriter()
@@ -95,9 +115,11 @@ FileCache* FileCache::Create(const fs::path& path, uint32 extraVersion)
 		cemuLog_log(LogType::Force, "Failed to create cache file \"{}\"", _pathToUtf8(path));
 		return nullptr;
 	}
+	_FileCache_RemovePendingCompaction(path);
 	// init file cache
 	auto* fileCache = new FileCache();
 	fileCache->fileStream = fs;
+	fileCache->m_path = path;
 	fileCache->dataOffset = FILECACHE_HEADER_RESV;
 	fileCache->fileTableEntryCount = 32;
 	fileCache->fileTableOffset = 0;
@@ -111,15 +133,11 @@ FileCache* FileCache::Create(const fs::path& path, uint32 extraVersion)
 	fileCache->fileTableEntries[0].fileOffset = fileCache->fileTableOffset;
 	fileCache->fileTableEntries[0].fileSize = fileCache->fileTableSize;
 	// write header
-
-	fs->writeU32(FILECACHE_MAGIC_V3);
-	fs->writeU32(fileCache->extraVersion);
-	fs->writeU64(fileCache->dataOffset);
-	fs->writeU64(fileCache->fileTableOffset);
-	fs->writeU32(fileCache->fileTableSize);
+	fileCache->_writeHeader();
 	// write file table
 	fs->SetPosition(fileCache->dataOffset+fileCache->fileTableOffset);
 	fs->writeData(fileCache->fileTableEntries, fileCache->fileTableSize);
+	fileCache->_buildIndex();
 	// done
 	return fileCache;
 }
@@ -180,9 +198,12 @@ FileCache* FileCache::_OpenExisting(const fs::path& path, bool compareExtraVersi
 		delete fs;
 		return nullptr;
 	}
+	// the file is in use again, it is queued anew when closed
+	_FileCache_RemovePendingCompaction(path);
 	// init struct
 	auto* fileCache = new FileCache();
 	fileCache->fileStream = fs;
+	fileCache->m_path = path;
 	fileCache->extraVersion = extraVersion;
 	fileCache->dataOffset = headerDataOffset;
 	fileCache->fileTableEntryCount = fileTableEntryCount;
@@ -216,6 +237,8 @@ FileCache* FileCache::_OpenExisting(const fs::path& path, bool compareExtraVersi
 		delete fileCache;
 		return nullptr;
 	}
+	fileCache->_buildIndex();
+	fileCache->_mapFile(path);
 	return fileCache;
 }
 
@@ -236,17 +259,249 @@ FileCache* FileCache::Open(const fs::path& path)
 
 FileCache::~FileCache()
 {
+	// compacting rewrites the whole file, so it is not done here where it would block title switches
+	if (m_compactOnClose && _isFragmented())
+	{
+		std::unique_lock _l(s_pendingCompaction.mutex);
+		if (std::find(s_pendingCompaction.paths.begin(), s_pendingCompaction.paths.end(), m_path) == s_pendingCompaction.paths.end())
+			s_pendingCompaction.paths.emplace_back(m_path);
+	}
+	_unmapFile();
 	free(this->fileTableEntries);
 	delete fileStream;
 }
 
+void FileCache::CompactPendingFiles()
+{
+	std::unique_lock _l(s_pendingCompaction.mutex);
+	std::vector<fs::path> paths = std::move(s_pendingCompaction.paths);
+	s_pendingCompaction.paths.clear();
+	_l.unlock();
+	for (auto& path : paths)
+	{
+		MaintenanceStats stats;
+		if (Compact(path, stats))
+			cemuLog_log(LogType::Force, "Compacted cache file {} ({}KB -> {}KB, {} duplicates)", _pathToUtf8(path.filename()), (stats.sizeBefore + 1023) / 1024, (stats.sizeAfter + 1023) / 1024, stats.duplicateCount);
+	}
+}
+
+void FileCache::_mapFile(const fs::path& path)
+{
+	// data written after this point is still read through the file stream
+#if BOOST_OS_WINDOWS
+	HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return;
+	}
+	HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (!hMapping)
+		return;
+	void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(hMapping);
+		return;
+	}
+	m_mappingHandle = hMapping;
+	m_mappedData = (const uint8*)view;
+	m_mappedSize = (uint64)fileSize.QuadPart;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		return;
+	}
+	void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+		return;
+	m_mappedData = (const uint8*)view;
+	m_mappedSize = (uint64)fileStat.st_size;
+#endif
+}
+
+void FileCache::_unmapFile()
+{
+	if (!m_mappedData)
+		return;
+#if BOOST_OS_WINDOWS
+	UnmapViewOfFile(m_mappedData);
+	CloseHandle((HANDLE)m_mappingHandle);
+	m_mappingHandle = nullptr;
+#else
+	munmap((void*)m_mappedData, (size_t)m_mappedSize);
+#endif
+	m_mappedData = nullptr;
+	m_mappedSize = 0;
+}
+
+const uint8* FileCache::_getMappedData(const FileTableEntry* entry) const
+{
+	uint64 offset = this->dataOffset + entry->fileOffset;
+	if (!m_mappedData || offset + entry->fileSize > m_mappedSize)
+		return nullptr;
+	return m_mappedData + offset;
+}
+
+void FileCache::_buildIndex()
+{
+	m_nameIndex.clear();
+	m_nameIndex.reserve(this->fileTableEntryCount);
+	m_freeEntryIndices.clear();
+	m_freeExtents.clear();
+	m_freeExtentsBySize.clear();
+	m_freeExtentsTotalSize = 0;
+	m_sharedExtentRefs.clear();
+	std::vector<std::pair<uint64, uint64>> usedExtents;
+	usedExtents.reserve(this->fileTableEntryCount);
+	for (sint32 i = this->fileTableEntryCount - 1; i >= 0; i--)
+	{
+		const FileTableEntry& entry = this->fileTableEntries[i];
+		if (entry.name1 == FILECACHE_FILETABLE_FREE_NAME && entry.name2 == FILECACHE_FILETABLE_FREE_NAME)
+		{
+			m_freeEntryIndices.emplace_back(i);
+			continue;
+		}
+		// iterating backwards, so on duplicate names the entry with the lowest index wins like with the previous linear search
+		m_nameIndex.insert_or_assign(FileName(entry.name1, entry.name2), i);
+		usedExtents.emplace_back(entry.fileOffset, entry.fileOffset + entry.fileSize);
+	}
+	std::make_heap(m_freeEntryIndices.begin(), m_freeEntryIndices.end(), std::greater<>());
+	// collect holes between used extents
+	std::sort(usedExtents.begin(), usedExtents.end());
+	uint64 currentEnd = 0;
+	for (size_t i = 0; i < usedExtents.size(); i++)
+	{
+		auto& it = usedExtents[i];
+		if (i > 0 && it.second > it.first && usedExtents[i - 1] == it)
+			m_sharedExtentRefs[{it.first, it.second - it.first}]++; // deduplicated data referenced by multiple files
+		if (it.first > currentEnd)
+			_addFreeExtent(currentEnd, it.first - currentEnd);
+		currentEnd = std::max(currentEnd, it.second);
+	}
+	m_dataEnd = currentEnd;
+}
+
+sint32 FileCache::_findEntry(uint64 name1, uint64 name2) const
+{
+	auto it = m_nameIndex.find(FileName(name1, name2));
+	if (it == m_nameIndex.end())
+		return -1;
+	return it->second;
+}
+
+void FileCache::_addFreeExtent(uint64 offset, uint64 size)
+{
+	m_freeExtents.emplace(offset, size);
+	m_freeExtentsBySize.emplace(size, offset);
+	m_freeExtentsTotalSize += size;
+}
+
+std::map<uint64, uint64>::iterator FileCache::_removeFreeExtent(std::map<uint64, uint64>::iterator it)
+{
+	m_freeExtentsBySize.erase({ it->second, it->first });
+	m_freeExtentsTotalSize -= it->second;
+	return m_freeExtents.erase(it);
+}
+
+// smallest hole that fits, otherwise append
+uint64 FileCache::_allocateExtent(uint64 size)
+{
+	if (size == 0)
+		return m_dataEnd;
+	auto bySizeIt = m_freeExtentsBySize.lower_bound({ size, 0 });
+	if (bySizeIt != m_freeExtentsBySize.end())
+	{
+		uint64 offset = bySizeIt->second;
+		uint64 remainingSize = bySizeIt->first - size;
+		_removeFreeExtent(m_freeExtents.find(offset));
+		if (remainingSize > 0)
+			_addFreeExtent(offset + size, remainingSize);
+		return offset;
+	}
+	uint64 offset = m_dataEnd;
+	m_dataEnd += size;
+	return offset;
+}
+
+void FileCache::_freeExtent(uint64 offset, uint64 size)
+{
+	if (size == 0)
+		return;
+	// merge with neighbouring holes
+	auto next = m_freeExtents.lower_bound(offset);
+	if (next != m_freeExtents.end() && next->first == offset + size)
+	{
+		size += next->second;
+		next = _removeFreeExtent(next);
+	}
+	if (next != m_freeExtents.begin())
+	{
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			_removeFreeExtent(prev);
+		}
+	}
+	if (offset + size == m_dataEnd)
+	{
+		m_dataEnd = offset;
+		return;
+	}
+	_addFreeExtent(offset, size);
+}
+
+void FileCache::_releaseExtent(uint64 offset, uint64 size)
+{
+	// empty files don't own any data, their offset can match the start of an unrelated extent
+	if (size == 0)
+		return;
+	auto it = m_sharedExtentRefs.find({offset, size});
+	if (it != m_sharedExtentRefs.end())
+	{
+		if (--it->second == 0)
+			m_sharedExtentRefs.erase(it);
+		return;
+	}
+	_freeExtent(offset, size);
+}
+
+void FileCache::_writeHeader()
+{
+	fileStream->SetPosition(0);
+	fileStream->writeU32(FILECACHE_MAGIC_V3);
+	fileStream->writeU32(this->extraVersion);
+	fileStream->writeU64(this->dataOffset);
+	fileStream->writeU64(this->fileTableOffset);
+	fileStream->writeU32(this->fileTableSize);
+}
+
+void FileCache::_writeFileTableEntry(sint32 entryIndex)
+{
+	fileStream->SetPosition(this->dataOffset + this->fileTableOffset + (uint64)(sizeof(FileTableEntry)*entryIndex));
+	fileStream->writeData(this->fileTableEntries + entryIndex, sizeof(FileTableEntry));
+}
+
+// caller needs to hold the exclusive lock
 void FileCache::fileCache_updateFiletable(sint32 extraEntriesToAllocate)
 {
-	// recreate file table with bigger size (optional)
-	this->fileTableEntries[0].name1 = FILECACHE_FILETABLE_FREE_NAME;
-	this->fileTableEntries[0].name2 = FILECACHE_FILETABLE_FREE_NAME;
+	// recreate file table with bigger size
+	// the old table stays intact until the header points to the new one
 	sint32 newFileTableEntryCount = this->fileTableEntryCount + extraEntriesToAllocate;
-	this->fileTableEntries = (FileTableEntry*)realloc(this->fileTableEntries, sizeof(FileTableEntry)*newFileTableEntryCount);
+	uint32 newFileTableSize = sizeof(FileTableEntry)*newFileTableEntryCount;
+	this->fileTableEntries = (FileTableEntry*)realloc(this->fileTableEntries, newFileTableSize);
 	for (sint32 f = this->fileTableEntryCount; f < newFileTableEntryCount; f++)
 	{
 		this->fileTableEntries[f].name1 = FILECACHE_FILETABLE_FREE_NAME;
@@ -258,23 +513,29 @@ void FileCache::fileCache_updateFiletable(sint32 extraEntriesToAllocate)
 		this->fileTableEntries[f].extraReserved2 = 0;
 		this->fileTableEntries[f].extraReserved3 = 0;
 	}
+	for (sint32 f = this->fileTableEntryCount; f < newFileTableEntryCount; f++)
+	{
+		m_freeEntryIndices.emplace_back(f);
+		std::push_heap(m_freeEntryIndices.begin(), m_freeEntryIndices.end(), std::greater<>());
+	}
 	this->fileTableEntryCount = newFileTableEntryCount;
-	this->_addFileInternal(FILECACHE_FILETABLE_NAME1, FILECACHE_FILETABLE_NAME2, (uint8*)this->fileTableEntries, sizeof(FileTableEntry)*newFileTableEntryCount, true);
-	// update file table info in struct
 	if (this->fileTableEntries[0].name1 != FILECACHE_FILETABLE_NAME1 || this->fileTableEntries[0].name2 != FILECACHE_FILETABLE_NAME2)
 	{
 		cemuLog_log(LogType::Force, "Corruption in cache file detected");
 		assert_dbg();
 	}
-	this->fileTableOffset = this->fileTableEntries[0].fileOffset;
-	this->fileTableSize = this->fileTableEntries[0].fileSize;
-	// update header
-	fileStream->SetPosition(0);
-	fileStream->writeU32(FILECACHE_MAGIC_V3);
-	fileStream->writeU32(this->extraVersion);
-	fileStream->writeU64(this->dataOffset);
-	fileStream->writeU64(this->fileTableOffset);
-	fileStream->writeU32(this->fileTableSize);
+	uint64 oldFileTableOffset = this->fileTableEntries[0].fileOffset;
+	uint32 oldFileTableSize = this->fileTableEntries[0].fileSize;
+	uint64 newFileTableOffset = _allocateExtent(newFileTableSize);
+	this->fileTableEntries[0].fileOffset = newFileTableOffset;
+	this->fileTableEntries[0].fileSize = newFileTableSize;
+	fileStream->SetPosition(this->dataOffset + newFileTableOffset);
+	fileStream->writeData(this->fileTableEntries, newFileTableSize);
+	// update file table info in struct and header
+	this->fileTableOffset = newFileTableOffset;
+	this->fileTableSize = newFileTableSize;
+	_writeHeader();
+	_freeExtent(oldFileTableOffset, oldFileTableSize);
 }
 
 uint8* _fileCache_compressFileData(const uint8* fileData, uint32 fileSize, sint32& compressedSize)
@@ -362,115 +623,49 @@ void FileCache::_addFileInternal(uint64 name1, uint64 name2, const uint8* fileDa
 		}
 	}
 	std::unique_lock lock(this->mutex);
-	// find free entry in file table
-	sint32 entryIndex = -1;
-	// scan for already existing entry
-	for (sint32 i = 0; i < this->fileTableEntryCount; i++)
-	{
-		if (this->fileTableEntries[i].name1 == name1 && this->fileTableEntries[i].name2 == name2)
-		{
-			entryIndex = i;
-			break;
-		}
-	}
-	if (entryIndex == -1)
-	{
-		while (true)
-		{
-			// if no entry exists, search for empty one
-			for (sint32 i = 0; i < this->fileTableEntryCount; i++)
-			{
-				if (this->fileTableEntries[i].name1 == FILECACHE_FILETABLE_FREE_NAME && this->fileTableEntries[i].name2 == FILECACHE_FILETABLE_FREE_NAME)
-				{
-					entryIndex = i;
-					break;
-				}
-			}
-			if (entryIndex == -1)
-			{
-				if (name1 == FILECACHE_FILETABLE_NAME1 && name2 == FILECACHE_FILETABLE_NAME2)
-				{
-					cemuLog_log(LogType::Force, "Error in cache file");
-					cemu_assert_debug(false);
-				}
-				// no free entry, recreate file table with larger size
-				fileCache_updateFiletable(64);
-				// try again
-				continue;
-			}
-			else
-				break;
-		}
-	}
-	// find free space
-	sint64 currentStartOffset = 0;
-	while (true)
+	// reuse existing entry or take a free one
+	sint32 entryIndex = _findEntry(name1, name2);
+	bool isNewEntry = entryIndex < 0;
+	if (isNewEntry)
 	{
-		bool hasCollision = false;
-		sint64 currentEndOffset = currentStartOffset + rawSize;
-		FileTableEntry* entry = this->fileTableEntries;
-		FileTableEntry* entryLast = this->fileTableEntries + this->fileTableEntryCount;
-		while (entry < entryLast)
-		{
-			if (entry->name1 == FILECACHE_FILETABLE_FREE_NAME && entry->name2 == FILECACHE_FILETABLE_FREE_NAME)
-			{
-				entry++;
-				continue;
-			}
-			if (currentEndOffset >= (sint64)entry->fileOffset && currentStartOffset < (sint64)(entry->fileOffset + entry->fileSize))
-			{
-				currentStartOffset = entry->fileOffset + entry->fileSize;
-				hasCollision = true;
-				break;
-			}
-			entry++;
-		}
-		// optimized logic to speed up scanning for free offsets
-		// assumes that most of the time entries are stored in direct succession (holds true more often than not)
-		if (hasCollision && (entry + 1) < entryLast)
-		{
-			entry++;
-			while (entry < entryLast)
-			{
-				if (entry->name1 == FILECACHE_FILETABLE_FREE_NAME && entry->name2 == FILECACHE_FILETABLE_FREE_NAME)
-				{
-					entry++;
-					continue;
-				}
-				if (entry->fileOffset == currentStartOffset)
-				{
-					currentStartOffset = entry->fileOffset + entry->fileSize;
-					entry++;
-					continue;
-				}
-				break;
-			}
-		}
-		// retry in case of collision
-		if (hasCollision == false)
-			break;
+		if (m_freeEntryIndices.empty())
+			fileCache_updateFiletable(64); // no free entry, recreate file table with larger size
+		std::pop_heap(m_freeEntryIndices.begin(), m_freeEntryIndices.end(), std::greater<>());
+		entryIndex = m_freeEntryIndices.back();
+		m_freeEntryIndices.pop_back();
 	}
+	// the previous data of a replaced file is only released after the entry points to the new data
+	uint64 prevFileOffset = this->fileTableEntries[entryIndex].fileOffset;
+	uint32 prevFileSize = this->fileTableEntries[entryIndex].fileSize;
+	uint64 fileOffset = _allocateExtent(rawSize);
 	// update file table entry
 	this->fileTableEntries[entryIndex].name1 = name1;
 	this->fileTableEntries[entryIndex].name2 = name2;
-	this->fileTableEntries[entryIndex].fileOffset = currentStartOffset;
+	this->fileTableEntries[entryIndex].fileOffset = fileOffset;
 	this->fileTableEntries[entryIndex].fileSize = rawSize;
 	this->fileTableEntries[entryIndex].flags = isCompressed ? FileTableEntry::FLAGS::FLAG_COMPRESSED : FileTableEntry::FLAGS::FLAG_NONE;
 	this->fileTableEntries[entryIndex].extraReserved1 = 0;
 	this->fileTableEntries[entryIndex].extraReserved2 = 0;
 	this->fileTableEntries[entryIndex].extraReserved3 = 0;
 	// write file data
-	fileStream->SetPosition(this->dataOffset + currentStartOffset);
+	fileStream->SetPosition(this->dataOffset + fileOffset);
 	fileStream->writeData(rawData, rawSize);
 #ifdef __APPLE__
     fileStream->Flush();
 #endif
 	// write file table entry
-	fileStream->SetPosition(this->dataOffset + this->fileTableOffset + (uint64)(sizeof(FileTableEntry)*entryIndex));
-	fileStream->writeData(this->fileTableEntries + entryIndex, sizeof(FileTableEntry));
+	_writeFileTableEntry(entryIndex);
 #ifdef __APPLE__
     fileStream->Flush();
+#elif !BOOST_OS_WINDOWS
+	// reused space inside the mapped range is read via the mapping, make sure the data is not stuck in the stream buffer
+	if (this->dataOffset + fileOffset < m_mappedSize)
+		fileStream->Flush();
 #endif
+	if (isNewEntry)
+		m_nameIndex.emplace(FileName(name1, name2), entryIndex);
+	else
+		_releaseExtent(prevFileOffset, prevFileSize);
 	if (isCompressed)
 		free(rawData);
 }
@@ -485,25 +680,24 @@ bool FileCache::DeleteFile(const FileName&& name)
 	if( name.name1 == FILECACHE_FILETABLE_NAME1 && name.name2 == FILECACHE_FILETABLE_NAME2 )
 		return false; // prevent filetable from being deleted
 	std::unique_lock lock(this->mutex);
-	FileTableEntry* entry = this->fileTableEntries;
-	FileTableEntry* entryLast = this->fileTableEntries+this->fileTableEntryCount;
-	while( entry < entryLast )
-	{
-		if( entry->name1 == name.name1 && entry->name2 == name.name2 )
-		{
-			entry->name1 = FILECACHE_FILETABLE_FREE_NAME;
-			entry->name2 = FILECACHE_FILETABLE_FREE_NAME;
-			entry->fileOffset = 0;
-			entry->fileSize = 0;
-			// store updated entry to file cache
-			size_t entryIndex = entry - this->fileTableEntries;
-			fileStream->SetPosition(this->dataOffset+this->fileTableOffset+(uint64)(sizeof(FileTableEntry)*entryIndex));
-			fileStream->writeData(this->fileTableEntries+entryIndex, sizeof(FileTableEntry));
-			return true;
-		}
-		entry++;
-	}
-	return false;
+	auto it = m_nameIndex.find(name);
+	if (it == m_nameIndex.end())
+		return false;
+	sint32 entryIndex = it->second;
+	m_nameIndex.erase(it);
+	FileTableEntry* entry = this->fileTableEntries + entryIndex;
+	uint64 prevFileOffset = entry->fileOffset;
+	uint32 prevFileSize = entry->fileSize;
+	entry->name1 = FILECACHE_FILETABLE_FREE_NAME;
+	entry->name2 = FILECACHE_FILETABLE_FREE_NAME;
+	entry->fileOffset = 0;
+	entry->fileSize = 0;
+	// store updated entry to file cache
+	_writeFileTableEntry(entryIndex);
+	_releaseExtent(prevFileOffset, prevFileSize);
+	m_freeEntryIndices.emplace_back(entryIndex);
+	std::push_heap(m_freeEntryIndices.begin(), m_freeEntryIndices.end(), std::greater<>());
+	return true;
 }
 
 void FileCache::AddFileAsync(const FileName& name, const uint8* fileData, sint32 fileSize)
@@ -511,48 +705,87 @@ void FileCache::AddFileAsync(const FileName& name, const uint8* fileData, sint32
 	FileCacheAsyncWriter.AddJob(this, name, fileData, fileSize);
 }
 
-bool FileCache::_getFileDataInternal(const FileTableEntry* entry, std::vector<uint8>& dataOut)
+// caller needs to hold at least the shared lock
+bool FileCache::_getFileViewInternal(const FileTableEntry* entry, std::span<const uint8>& viewOut, std::vector<uint8>& storage)
 {
-	std::vector<uint8> rawData(entry->fileSize);
-
-	fileStream->SetPosition(this->dataOffset + entry->fileOffset);
-	fileStream->readData(rawData.data(), entry->fileSize);
-
+	const uint8* mappedData = _getMappedData(entry);
 	if ((entry->flags&FileTableEntry::FLAG_COMPRESSED) == 0)
 	{
-		// uncompressed
-		std::swap(rawData, dataOut);
+		if (mappedData)
+		{
+			viewOut = std::span<const uint8>(mappedData, entry->fileSize);
+			return true;
+		}
+		storage.resize(entry->fileSize);
+		std::unique_lock streamLock(this->streamMutex);
+		fileStream->SetPosition(this->dataOffset + entry->fileOffset);
+		fileStream->readData(storage.data(), entry->fileSize);
+		streamLock.unlock();
+		viewOut = storage;
 		return true;
 	}
 	// decompress
-	sint32 uncompressedSize = 0;
-	if (!_uncompressFileData(rawData.data(), rawData.size(), dataOut))
+	bool r;
+	if (mappedData)
 	{
-		dataOut.clear();
+		r = _uncompressFileData(mappedData, entry->fileSize, storage);
+	}
+	else
+	{
+		std::vector<uint8> rawData(entry->fileSize);
+		std::unique_lock streamLock(this->streamMutex);
+		fileStream->SetPosition(this->dataOffset + entry->fileOffset);
+		fileStream->readData(rawData.data(), entry->fileSize);
+		streamLock.unlock();
+		r = _uncompressFileData(rawData.data(), rawData.size(), storage);
+	}
+	if (!r)
+	{
+		storage.clear();
+		viewOut = {};
 		return false;
 	}
+	viewOut = storage;
+	return true;
+}
+
+bool FileCache::_getFileDataInternal(const FileTableEntry* entry, std::vector<uint8>& dataOut)
+{
+	std::span<const uint8> view;
+	if (!_getFileViewInternal(entry, view, dataOut))
+		return false;
+	if (view.data() != dataOut.data())
+		dataOut.assign(view.begin(), view.end());
 	return true;
 }
 
 bool FileCache::GetFile(const FileName&& name, std::vector<uint8>& dataOut)
 {
-	std::unique_lock lock(this->mutex);
-	FileTableEntry* entry = this->fileTableEntries;
-	FileTableEntry* entryLast = this->fileTableEntries+this->fileTableEntryCount;
-	while( entry < entryLast )
+	std::shared_lock lock(this->mutex);
+	sint32 entryIndex = _findEntry(name.name1, name.name2);
+	if (entryIndex < 0)
 	{
-		if( entry->name1 == name.name1 && entry->name2 == name.name2 )
-		{
-			return _getFileDataInternal(entry, dataOut);
-		}
-		entry++;
+		dataOut.clear();
+		return false;
 	}
-	dataOut.clear();
-	return false;
+	return _getFileDataInternal(this->fileTableEntries + entryIndex, dataOut);
+}
+
+bool FileCache::GetFileView(const FileName&& name, std::span<const uint8>& viewOut, std::vector<uint8>& storage)
+{
+	std::shared_lock lock(this->mutex);
+	sint32 entryIndex = _findEntry(name.name1, name.name2);
+	if (entryIndex < 0)
+	{
+		viewOut = {};
+		return false;
+	}
+	return _getFileViewInternal(this->fileTableEntries + entryIndex, viewOut, storage);
 }
 
 bool FileCache::GetFileByIndex(sint32 index, uint64* name1, uint64* name2, std::vector<uint8>& dataOut)
 {
+	std::shared_lock lock(this->mutex);
 	if (index < 0 || index >= this->fileTableEntryCount)
 		return false;
 	FileTableEntry* entry = this->fileTableEntries + index;
@@ -566,7 +799,6 @@ bool FileCache::GetFileByIndex(sint32 index, uint64* name1, uint64* name2, std::
 	if (entry->name1 == FILECACHE_FILETABLE_NAME1 && entry->name2 == FILECACHE_FILETABLE_NAME2)
 		return false;
 
-	std::unique_lock lock(this->mutex);
 	if(name1)
 		*name1 = entry->name1;
 	if(name2)
@@ -574,48 +806,296 @@ bool FileCache::GetFileByIndex(sint32 index, uint64* name1, uint64* name2, std::
 	return _getFileDataInternal(entry, dataOut);
 }
 
+bool FileCache::GetFileViewByIndex(sint32 index, uint64* name1, uint64* name2, std::span<const uint8>& viewOut, std::vector<uint8>& storage)
+{
+	std::shared_lock lock(this->mutex);
+	if (index < 0 || index >= this->fileTableEntryCount)
+		return false;
+	FileTableEntry* entry = this->fileTableEntries + index;
+	if (entry->name1 == FILECACHE_FILETABLE_FREE_NAME && entry->name2 == FILECACHE_FILETABLE_FREE_NAME)
+		return false;
+	if (entry->name1 == FILECACHE_FILETABLE_NAME1 && entry->name2 == FILECACHE_FILETABLE_NAME2)
+		return false;
+
+	if(name1)
+		*name1 = entry->name1;
+	if(name2)
+		*name2 = entry->name2;
+	return _getFileViewInternal(entry, viewOut, storage);
+}
+
 bool FileCache::HasFile(const FileName&& name)
 {
-	std::unique_lock lock(this->mutex);
-	FileTableEntry* entry = this->fileTableEntries;
-	FileTableEntry* entryLast = this->fileTableEntries + this->fileTableEntryCount;
-	while (entry < entryLast)
-	{
-		if (entry->name1 == name.name1 && entry->name2 == name.name2)
-			return true;
-		entry++;
-	}
-	return false;
+	std::shared_lock lock(this->mutex);
+	return _findEntry(name.name1, name.name2) >= 0;
 }
 
 sint32 FileCache::GetMaximumFileIndex()
 {
+	std::shared_lock lock(this->mutex);
 	return this->fileTableEntryCount;
 }
 
 sint32 FileCache::GetFileCount()
 {
-	std::unique_lock lock(this->mutex);
-	sint32 fileCount = 0;
-	FileTableEntry* entry = this->fileTableEntries;
-	FileTableEntry* entryLast = this->fileTableEntries+this->fileTableEntryCount;
-	while( entry < entryLast )
+	std::shared_lock lock(this->mutex);
+	sint32 fileCount = (sint32)m_nameIndex.size();
+	if (m_nameIndex.find(FileName(FILECACHE_FILETABLE_NAME1, FILECACHE_FILETABLE_NAME2)) != m_nameIndex.end())
+		fileCount--;
+	return fileCount;
+}
+
+uint64 FileCache::GetUnusedSpace()
+{
+	std::shared_lock lock(this->mutex);
+	return m_freeExtentsTotalSize;
+}
+
+bool FileCache::_isFragmented() const
+{
+	uint64 unusedSpace = m_freeExtentsTotalSize;
+	return unusedSpace >= 1024 * 1024 && unusedSpace * 4 >= m_dataEnd; // at least 1MB and 25% unused
+}
+
+// caller needs to hold at least the shared lock
+bool FileCache::_getRawFileViewInternal(const FileTableEntry* entry, std::span<const uint8>& viewOut, std::vector<uint8>& storage)
+{
+	const uint8* mappedData = _getMappedData(entry);
+	if (mappedData)
+	{
+		viewOut = std::span<const uint8>(mappedData, entry->fileSize);
+		return true;
+	}
+	storage.resize(entry->fileSize);
+	std::unique_lock streamLock(this->streamMutex);
+	fileStream->SetPosition(this->dataOffset + entry->fileOffset);
+	bool r = fileStream->readData(storage.data(), entry->fileSize) == entry->fileSize;
+	streamLock.unlock();
+	viewOut = storage;
+	return r;
+}
+
+struct FileCacheRewriteEntry
+{
+	const void* tableEntry; // FileCache::FileTableEntry
+	FileCache* fileCache;
+	std::span<const uint8> rawData;
+	std::vector<uint8> rawStorage;
+	size_t dataHash{};
+	bool isValid{};
+	sint32 sharedWith{-1}; // index of a previous entry with identical data
+};
+
+// writes the files of destination and the files of source which are not in destination to a new cache file
+// the file is written next to destinationPath and then replaces it. Both caches must not be modified while this runs
+bool FileCache::_rewrite(const fs::path& destinationPath, FileCache* destination, FileCache* source, MaintenanceStats& stats)
+{
+	cemu_assert_debug(destination || source);
+	std::vector<FileCacheRewriteEntry> entries;
+	auto collectEntries = [&](FileCache* fileCache, FileCache* excludeCache) {
+		for (sint32 i = 0; i < fileCache->fileTableEntryCount; i++)
+		{
+			const FileTableEntry* entry = fileCache->fileTableEntries + i;
+			if (entry->name1 == FILECACHE_FILETABLE_FREE_NAME && entry->name2 == FILECACHE_FILETABLE_FREE_NAME)
+				continue;
+			if (entry->name1 == FILECACHE_FILETABLE_NAME1 && entry->name2 == FILECACHE_FILETABLE_NAME2)
+				continue;
+			if (fileCache->_findEntry(entry->name1, entry->name2) != i)
+				continue; // duplicate name, only the indexed entry is reachable
+			if (excludeCache && excludeCache->_findEntry(entry->name1, entry->name2) >= 0)
+				continue;
+			if (excludeCache)
+				stats.mergedCount++;
+			auto& rewriteEntry = entries.emplace_back();
+			rewriteEntry.tableEntry = entry;
+			rewriteEntry.fileCache = fileCache;
+		}
+	};
+	if (destination)
+		collectEntries(destination, nullptr);
+	if (source)
+		collectEntries(source, destination);
+	// read and verify in parallel
+	std::atomic_size_t nextEntryIndex{ 0 };
+	std::atomic_uint64_t bytesRead{ 0 };
+	auto verifyWorker = [&]() {
+		std::vector<uint8> uncompressedData;
+		while (true)
+		{
+			size_t index = nextEntryIndex.fetch_add(1);
+			if (index >= entries.size())
+				break;
+			auto& rewriteEntry = entries[index];
+			const FileTableEntry* entry = (const FileTableEntry*)rewriteEntry.tableEntry;
+			if (!rewriteEntry.fileCache->_getRawFileViewInternal(entry, rewriteEntry.rawData, rewriteEntry.rawStorage))
+				continue;
+			bytesRead += rewriteEntry.rawData.size();
+			if ((entry->flags & FileTableEntry::FLAG_COMPRESSED) != 0 && !_uncompressFileData(rewriteEntry.rawData.data(), rewriteEntry.rawData.size(), uncompressedData))
+				continue;
+			rewriteEntry.dataHash = std::hash<std::string_view>()(std::string_view((const char*)rewriteEntry.rawData.data(), rewriteEntry.rawData.size()));
+			rewriteEntry.isValid = true;
+		}
+	};
+	uint32 threadCount = std::clamp<uint32>(GetPhysicalCoreCount(), 1, 8);
+	std::vector<std::thread> verifyThreads;
+	for (uint32 i = 1; i < threadCount; i++)
+		verifyThreads.emplace_back(verifyWorker);
+	verifyWorker();
+	for (auto& thread : verifyThreads)
+		thread.join();
+	stats.bytesRead += bytesRead;
+	// deduplicate identical payloads
+	std::unordered_multimap<size_t, sint32> entriesByHash;
+	sint32 validEntryCount = 0;
+	for (sint32 i = 0; i < (sint32)entries.size(); i++)
 	{
-		if( entry->name1 == FILECACHE_FILETABLE_FREE_NAME && entry->name2 == FILECACHE_FILETABLE_FREE_NAME )
+		auto& rewriteEntry = entries[i];
+		if (!rewriteEntry.isValid)
 		{
-			entry++;
+			stats.corruptedCount++;
 			continue;
 		}
-		if( entry->name1 == FILECACHE_FILETABLE_NAME1 && entry->name2 == FILECACHE_FILETABLE_NAME2 )
+		validEntryCount++;
+		if (rewriteEntry.rawData.empty())
+			continue;
+		uint8 flags = ((const FileTableEntry*)rewriteEntry.tableEntry)->flags;
+		auto range = entriesByHash.equal_range(rewriteEntry.dataHash);
+		for (auto it = range.first; it != range.second; ++it)
 		{
-			entry++;
+			auto& otherEntry = entries[it->second];
+			if (((const FileTableEntry*)otherEntry.tableEntry)->flags != flags || otherEntry.rawData.size() != rewriteEntry.rawData.size())
+				continue;
+			if (memcmp(otherEntry.rawData.data(), rewriteEntry.rawData.data(), rewriteEntry.rawData.size()) != 0)
+				continue;
+			rewriteEntry.sharedWith = it->second;
+			stats.duplicateCount++;
+			break;
+		}
+		if (rewriteEntry.sharedWith < 0)
+			entriesByHash.emplace(rewriteEntry.dataHash, i);
+	}
+	// write new cache file
+	fs::path tmpPath = destinationPath;
+	tmpPath += ".tmp";
+	FileStream* fs = FileStream::createFile2(tmpPath);
+	if (!fs)
+	{
+		cemuLog_log(LogType::Force, "Failed to create cache file \"{}\"", _pathToUtf8(tmpPath));
+		return false;
+	}
+	FileCache* output = new FileCache();
+	output->fileStream = fs;
+	output->dataOffset = FILECACHE_HEADER_RESV;
+	output->extraVersion = destination ? destination->extraVersion : source->extraVersion;
+	output->fileTableEntryCount = 1 + validEntryCount;
+	output->fileTableOffset = 0;
+	output->fileTableSize = sizeof(FileTableEntry) * output->fileTableEntryCount;
+	output->fileTableEntries = (FileTableEntry*)malloc(output->fileTableSize);
+	memset(output->fileTableEntries, 0, output->fileTableSize);
+	output->fileTableEntries[0].name1 = FILECACHE_FILETABLE_NAME1;
+	output->fileTableEntries[0].name2 = FILECACHE_FILETABLE_NAME2;
+	output->fileTableEntries[0].fileOffset = output->fileTableOffset;
+	output->fileTableEntries[0].fileSize = output->fileTableSize;
+	std::vector<sint32> outputIndices(entries.size(), -1);
+	uint64 writeOffset = output->fileTableSize;
+	sint32 outputIndex = 1;
+	bool writeError = false;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		auto& rewriteEntry = entries[i];
+		if (!rewriteEntry.isValid)
 			continue;
+		const FileTableEntry* entry = (const FileTableEntry*)rewriteEntry.tableEntry;
+		FileTableEntry& outputEntry = output->fileTableEntries[outputIndex];
+		outputEntry = *entry;
+		if (rewriteEntry.sharedWith >= 0)
+		{
+			outputEntry.fileOffset = output->fileTableEntries[outputIndices[rewriteEntry.sharedWith]].fileOffset;
 		}
-		fileCount++;
-		entry++;
+		else
+		{
+			outputEntry.fileOffset = writeOffset;
+			fs->SetPosition(output->dataOffset + writeOffset);
+			if (fs->writeData(rewriteEntry.rawData.data(), (sint32)rewriteEntry.rawData.size()) != (sint32)rewriteEntry.rawData.size())
+				writeError = true;
+			writeOffset += rewriteEntry.rawData.size();
+		}
+		outputIndices[i] = outputIndex;
+		outputIndex++;
 	}
+	output->_writeHeader();
+	fs->SetPosition(output->dataOffset + output->fileTableOffset);
+	if (fs->writeData(output->fileTableEntries, output->fileTableSize) != (sint32)output->fileTableSize)
+		writeError = true;
+	delete output;
+	if (writeError)
+	{
+		cemuLog_log(LogType::Force, "Failed to write cache file \"{}\"", _pathToUtf8(tmpPath));
+		std::error_code ec;
+		fs::remove(tmpPath, ec);
+		return false;
+	}
+	stats.fileCount = validEntryCount;
+	return true;
+}
 
-	return fileCount;
+bool FileCache::Compact(const fs::path& path, MaintenanceStats& stats)
+{
+	return Merge(path, fs::path(), stats);
+}
+
+bool FileCache::Merge(const fs::path& destinationPath, const fs::path& sourcePath, MaintenanceStats& stats)
+{
+	std::error_code ec;
+	FileCache* destination = nullptr;
+	FileCache* source = nullptr;
+	if (fs::exists(destinationPath, ec))
+	{
+		destination = _OpenExisting(destinationPath, false);
+		if (!destination)
+		{
+			cemuLog_log(LogType::Force, "Failed to open cache file \"{}\"", _pathToUtf8(destinationPath));
+			return false;
+		}
+		stats.sizeBefore += fs::file_size(destinationPath, ec);
+	}
+	if (!sourcePath.empty())
+	{
+		source = _OpenExisting(sourcePath, false);
+		if (!source)
+		{
+			cemuLog_log(LogType::Force, "Failed to open cache file \"{}\"", _pathToUtf8(sourcePath));
+			delete destination;
+			return false;
+		}
+		if (destination && destination->extraVersion != source->extraVersion)
+		{
+			cemuLog_log(LogType::Force, "Cannot merge \"{}\" into \"{}\", the cache versions differ", _pathToUtf8(sourcePath), _pathToUtf8(destinationPath));
+			delete destination;
+			delete source;
+			return false;
+		}
+		stats.sizeBefore += fs::file_size(sourcePath, ec);
+	}
+	if (!destination && !source)
+		return false;
+	bool r = _rewrite(destinationPath, destination, source, stats);
+	// close the caches before the destination is replaced
+	delete destination;
+	delete source;
+	if (!r)
+		return false;
+	fs::path tmpPath = destinationPath;
+	tmpPath += ".tmp";
+	fs::rename(tmpPath, destinationPath, ec);
+	if (ec)
+	{
+		cemuLog_log(LogType::Force, "Failed to replace cache file \"{}\": {}", _pathToUtf8(destinationPath), ec.message());
+		fs::remove(tmpPath, ec);
+		return false;
+	}
+	stats.sizeAfter = fs::file_size(destinationPath, ec);
+	return true;
 }
 
 void fileCache_test()
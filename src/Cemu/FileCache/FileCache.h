@@ -1,6 +1,8 @@
 #pragma once
 
 #include <mutex>
+#include <shared_mutex>
+#include <span>
 
 class FileCache
 {
@@ -29,6 +31,8 @@ public:
 
 		FileName(const std::string& filePath) : FileName(std::basic_string_view(filePath.data(), filePath.size())) {};
 
+		bool operator==(const FileName& other) const { return name1 == other.name1 && name2 == other.name2; }
+
 		uint64 name1;
 		uint64 name2;
 	};
@@ -46,12 +50,39 @@ public:
 	bool DeleteFile(const FileName&& name);
 	bool GetFile(const FileName&& name, std::vector<uint8>& dataOut);
 	bool GetFileByIndex(sint32 index, uint64* name1, uint64* name2, std::vector<uint8>& dataOut);
+	// zero-copy variants. Uncompressed files which are inside the memory mapped part of the cache are returned as a view into the mapping
+	// otherwise the data is read into storage and the view points there. Views stay valid until the file is replaced or deleted
+	bool GetFileView(const FileName&& name, std::span<const uint8>& viewOut, std::vector<uint8>& storage);
+	bool GetFileViewByIndex(sint32 index, uint64* name1, uint64* name2, std::span<const uint8>& viewOut, std::vector<uint8>& storage);
 	bool HasFile(const FileName&& name);
 
 	sint32 GetFileCount();
 
 	sint32 GetMaximumFileIndex();
 
+	// maintenance
+	struct MaintenanceStats
+	{
+		uint32 fileCount{}; // files in the rewritten cache
+		uint32 mergedCount{}; // files added from the merge source
+		uint32 duplicateCount{}; // files which share their data with another file
+		uint32 corruptedCount{}; // files which failed verification and were dropped
+		uint64 bytesRead{};
+		uint64 sizeBefore{};
+		uint64 sizeAfter{};
+	};
+
+	// rewrite a cache file without holes. Files are verified and identical payloads are stored only once
+	static bool Compact(const fs::path& path, MaintenanceStats& stats);
+	// add all files from the source cache which do not exist in the destination cache, the result is compacted
+	// if the destination does not exist it is created from the source
+	static bool Merge(const fs::path& destinationPath, const fs::path& sourcePath, MaintenanceStats& stats);
+	// queue the file for compaction if a significant part of it is unused when the cache is closed
+	void EnableCompactionOnClose(bool enable) { m_compactOnClose = enable; }
+	// compacts the files queued by closed caches, called on application exit
+	static void CompactPendingFiles();
+	uint64 GetUnusedSpace();
+
 private:
 	struct FileTableEntry
 	{
@@ -72,6 +103,14 @@ private:
 
 	static_assert(sizeof(FileTableEntry) == 0x20);
 
+	struct FileNameHash
+	{
+		size_t operator()(const FileName& name) const
+		{
+			return (size_t)(name.name1 ^ (name.name2 * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
 	FileCache() {};
 
 	static FileCache* _OpenExisting(const fs::path& path, bool compareExtraVersion, uint32 extraVersion = 0);
@@ -79,8 +118,28 @@ private:
 	void fileCache_updateFiletable(sint32 extraEntriesToAllocate);
 	void _addFileInternal(uint64 name1, uint64 name2, const uint8* fileData, sint32 fileSize, bool noCompression);
 	bool _getFileDataInternal(const FileTableEntry* entry, std::vector<uint8>& dataOut);
+	bool _getFileViewInternal(const FileTableEntry* entry, std::span<const uint8>& viewOut, std::vector<uint8>& storage);
+	const uint8* _getMappedData(const FileTableEntry* entry) const;
+	void _writeHeader();
+	void _writeFileTableEntry(sint32 entryIndex);
+	// name index and free space tracking, rebuilt from the file table on open
+	void _buildIndex();
+	sint32 _findEntry(uint64 name1, uint64 name2) const;
+	uint64 _allocateExtent(uint64 size);
+	void _freeExtent(uint64 offset, uint64 size);
+	void _addFreeExtent(uint64 offset, uint64 size);
+	std::map<uint64, uint64>::iterator _removeFreeExtent(std::map<uint64, uint64>::iterator it); // returns the iterator following the removed hole
+	void _releaseExtent(uint64 offset, uint64 size); // like _freeExtent but respects extents shared by multiple files
+	bool _getRawFileViewInternal(const FileTableEntry* entry, std::span<const uint8>& viewOut, std::vector<uint8>& storage);
+	bool _isFragmented() const;
+	static bool _rewrite(const fs::path& destinationPath, FileCache* destination, FileCache* source, MaintenanceStats& stats);
+	// read-only mapping of the cache file as it was when opened
+	void _mapFile(const fs::path& path);
+	void _unmapFile();
 
 	class FileStream* fileStream{};
+	fs::path m_path;
+	bool m_compactOnClose{false};
 	uint64 dataOffset{};
 	uint32 extraVersion{};
 	// file table
@@ -91,6 +150,21 @@ private:
 	uint32 fileTableSize{};
 	// options
 	bool enableCompression{true};
-
-	std::recursive_mutex mutex;
+	// lookup
+	std::unordered_map<FileName, sint32, FileNameHash> m_nameIndex;
+	std::vector<sint32> m_freeEntryIndices; // unused file table entries, min-heap (std::greater) so the lowest index is reused first
+	std::map<uint64, uint64> m_freeExtents; // offset -> size of holes in the data area, used to merge neighbouring holes
+	std::set<std::pair<uint64, uint64>> m_freeExtentsBySize; // (size, offset) of the same holes, used to find the smallest one that fits
+	uint64 m_freeExtentsTotalSize{};
+	uint64 m_dataEnd{}; // end of the last used extent
+	std::map<std::pair<uint64, uint64>, uint32> m_sharedExtentRefs; // (offset, size) -> number of additional files referencing the extent (deduplicated data)
+	// memory mapping
+	const uint8* m_mappedData{};
+	uint64 m_mappedSize{};
+	void* m_mappingHandle{};
+
+	// readers hold a shared lock, modifications of the file table need exclusive access
+	// reads outside of the mapped range share the file stream and are additionally serialized by streamMutex
+	std::shared_mutex mutex;
+	std::mutex streamMutex;
 };
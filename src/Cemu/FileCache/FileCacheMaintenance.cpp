@@ -0,0 +1,117 @@
+#include "FileCacheMaintenance.h"
+#include "FileCache.h"
+#include "util/helpers/helpers.h"
+
+namespace FileCacheMaintenance
+{
+	struct Job
+	{
+		fs::path targetPath;
+		fs::path sourcePath; // empty if only compacting
+		FileCache::MaintenanceStats stats;
+		bool success{};
+	};
+
+	void ProcessJob(Job& job)
+	{
+		if (job.sourcePath.empty())
+			job.success = FileCache::Compact(job.targetPath, job.stats);
+		else
+			job.success = FileCache::Merge(job.targetPath, job.sourcePath, job.stats);
+	}
+
+	bool Run(const fs::path& targetPath, const fs::path& mergeSourcePath)
+	{
+		std::error_code ec;
+		std::vector<Job> jobs;
+		if (fs::is_directory(targetPath, ec))
+		{
+			// all .bin files in the directory, merge sources are matched by file name
+			std::set<fs::path> fileNames;
+			for (const auto& it : fs::directory_iterator(targetPath, ec))
+			{
+				if (it.is_regular_file() && it.path().extension() == ".bin")
+					fileNames.emplace(it.path().filename());
+			}
+			if (!mergeSourcePath.empty())
+			{
+				if (!fs::is_directory(mergeSourcePath, ec))
+				{
+					cemuLog_log(LogType::Force, "Merge source \"{}\" must be a directory when the target is a directory", _pathToUtf8(mergeSourcePath));
+					return false;
+				}
+				for (const auto& it : fs::directory_iterator(mergeSourcePath, ec))
+				{
+					if (it.is_regular_file() && it.path().extension() == ".bin")
+						fileNames.emplace(it.path().filename());
+				}
+			}
+			for (auto& fileName : fileNames)
+			{
+				auto& job = jobs.emplace_back();
+				job.targetPath = targetPath / fileName;
+				if (!mergeSourcePath.empty() && fs::exists(mergeSourcePath / fileName, ec))
+					job.sourcePath = mergeSourcePath / fileName;
+			}
+		}
+		else
+		{
+			auto& job = jobs.emplace_back();
+			job.targetPath = targetPath;
+			if (!mergeSourcePath.empty())
+				job.sourcePath = fs::is_directory(mergeSourcePath, ec) ? mergeSourcePath / targetPath.filename() : mergeSourcePath;
+		}
+		if (jobs.empty())
+		{
+			cemuLog_log(LogType::Force, "No cache files found in \"{}\"", _pathToUtf8(targetPath));
+			return false;
+		}
+		// each file is verified by multiple threads already, so only a few files are processed at once
+		auto beginTime = std::chrono::steady_clock::now();
+		std::atomic_size_t nextJobIndex{ 0 };
+		auto worker = [&]() {
+			while (true)
+			{
+				size_t index = nextJobIndex.fetch_add(1);
+				if (index >= jobs.size())
+					break;
+				ProcessJob(jobs[index]);
+			}
+		};
+		uint32 threadCount = std::min<uint32>((uint32)jobs.size(), 4);
+		std::vector<std::thread> threads;
+		for (uint32 i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+		double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - beginTime).count();
+		// print results
+		FileCache::MaintenanceStats total{};
+		uint32 failedCount = 0;
+		for (auto& job : jobs)
+		{
+			if (!job.success)
+			{
+				cemuLog_log(LogType::Force, "{}: failed", _pathToUtf8(job.targetPath.filename()));
+				failedCount++;
+				continue;
+			}
+			cemuLog_log(LogType::Force, "{}: {} files ({} merged, {} duplicates, {} corrupted) {}KB -> {}KB", _pathToUtf8(job.targetPath.filename()),
+				job.stats.fileCount, job.stats.mergedCount, job.stats.duplicateCount, job.stats.corruptedCount,
+				(job.stats.sizeBefore + 1023) / 1024, (job.stats.sizeAfter + 1023) / 1024);
+			total.fileCount += job.stats.fileCount;
+			total.mergedCount += job.stats.mergedCount;
+			total.duplicateCount += job.stats.duplicateCount;
+			total.corruptedCount += job.stats.corruptedCount;
+			total.bytesRead += job.stats.bytesRead;
+			total.sizeBefore += job.stats.sizeBefore;
+			total.sizeAfter += job.stats.sizeAfter;
+		}
+		cemuLog_log(LogType::Force, "Processed {} cache files in {:.2f}s ({:.1f}MB/s): {} files ({} merged, {} duplicates, {} corrupted) {}KB -> {}KB",
+			jobs.size() - failedCount, elapsedSeconds, (double)total.bytesRead / (1024.0 * 1024.0) / std::max(elapsedSeconds, 0.001),
+			total.fileCount, total.mergedCount, total.duplicateCount, total.corruptedCount,
+			(total.sizeBefore + 1023) / 1024, (total.sizeAfter + 1023) / 1024);
+		return failedCount == 0;
+	}
+};
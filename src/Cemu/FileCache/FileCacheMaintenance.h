@@ -0,0 +1,8 @@
+#pragma once
+
+namespace FileCacheMaintenance
+{
+	// compacts and deduplicates a cache file or all cache files in a directory
+	// if mergeSourcePath is set, the files of the same name found in it (or the file itself) are merged into the target first
+	bool Run(const fs::path& targetPath, const fs::path& mergeSourcePath);
+};
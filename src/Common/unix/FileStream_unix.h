@@ -1,6 +1,9 @@
 #pragma once
 #include "Common/precompiled.h"
 
+// resolves the path case-insensitively if it doesn't exist as is
+fs::path findPathCI(const fs::path& path);
+
 class FileStream
 {
  public:
@@ -105,6 +105,8 @@ bool ActiveSettings::WaitForGX2DrawDoneEnabled()
 
 GraphicAPI ActiveSettings::GetGraphicsAPI()
 {
+	if (LaunchSettings::NullRendererEnabled())
+		return kNull;
 	GraphicAPI api = g_current_game_profile->GetGraphicsAPI().value_or(GetConfig().graphic_api);
 	// check if vulkan even available
 	if (api == kVulkan && !g_vulkan_available)
@@ -180,6 +182,11 @@ bool ActiveSettings::DumpLibcurlRequestsEnabled()
 	return s_dump_libcurl_requests;
 }
 
+bool ActiveSettings::DumpBootTracesEnabled()
+{
+	return s_dump_boot_traces;
+}
+
 void ActiveSettings::EnableDumpShaders(bool state)
 {
 	s_dump_shaders = state;
@@ -200,6 +207,11 @@ void ActiveSettings::EnableDumpLibcurlRequests(bool state)
 	s_dump_libcurl_requests = state;
 }
 
+void ActiveSettings::EnableDumpBootTraces(bool state)
+{
+	s_dump_boot_traces = state;
+}
+
 bool ActiveSettings::VPADDelayEnabled()
 {
 	const uint64 titleId = CafeSystem::GetForegroundTitleId();
@@ -114,10 +114,12 @@ public:
 	[[nodiscard]] static bool DumpTexturesEnabled();
 	[[nodiscard]] static bool DumpRecompilerFunctionsEnabled();
 	[[nodiscard]] static bool DumpLibcurlRequestsEnabled();
+	[[nodiscard]] static bool DumpBootTracesEnabled();
 	static void EnableDumpShaders(bool state);
 	static void EnableDumpTextures(bool state);
 	static void EnableDumpRecompilerFunctions(bool state);
 	static void EnableDumpLibcurlRequests(bool state);
+	static void EnableDumpBootTraces(bool state);
 
 	// hacks
 	[[nodiscard]] static bool VPADDelayEnabled();
@@ -132,6 +134,7 @@ private:
 	inline static bool s_dump_textures = false;
 	inline static bool s_dump_recompiler_functions = false;
 	inline static bool s_dump_libcurl_requests = false;
+	inline static std::atomic_bool s_dump_boot_traces = false;
 
 	// timer speed
 	inline static uint8 s_timer_shift = 3; // right shift factor, 0 -> 8x, 3 -> 1x, 4 -> 0.5x
@@ -72,6 +72,7 @@ enum GraphicAPI
 	kOpenGL = 0,
 	kVulkan,
 	kMetal,
+	kNull, // no graphics output, only selectable via --null-renderer
 };
 
 enum AudioChannels
@@ -411,6 +412,7 @@ struct CemuConfig
 	ConfigValue<bool> disable_screensaver{DISABLE_SCREENSAVER_DEFAULT};
 #undef DISABLE_SCREENSAVER_DEFAULT
 	ConfigValue<bool> play_boot_sound{false};
+	ConfigValue<uint32> fst_block_cache_size{64}; // in MiB, cache for decrypted blocks of disc images and encrypted titles
 
 	std::vector<std::string> game_paths;
 	std::mutex game_cache_entries_mutex;
@@ -12,6 +12,13 @@
 #include "util/crypto/aes128.h"
 
 #include "Cafe/Filesystem/FST/FST.h"
+#include "Cafe/Filesystem/fsc.h"
+#include "Cafe/HW/Latte/Core/Latte.h"
+#include "Cafe/HW/Latte/Core/LatteBufferCache.h"
+#include "Cafe/HW/Latte/Transcompiler/LatteTC.h"
+#include "Cemu/FileCache/FileCacheMaintenance.h"
+#include "Cafe/HW/Espresso/PPCState.h"
+#include "Cafe/HW/MMU/MMU.h"
 #include "util/helpers/StringHelpers.h"
 
 void requireConsole();
@@ -73,14 +80,22 @@ bool LaunchSettings::HandleCommandline(const std::vector<std::wstring>& args)
 
 		("force-interpreter", po::value<bool>()->implicit_value(true), "Force interpreter CPU emulation, disables recompiler. Useful for debugging purposes where you want to get accurate memory accesses and stack traces.")
 		("force-multicore-interpreter", po::value<bool>()->implicit_value(true), "Force multi-core interpreter CPU emulation, disables recompiler. Only useful for getting stack traces, but slightly faster than the single-core interpreter mode.")
-		("enable-gdbstub", po::value<bool>()->implicit_value(true), "Enable GDB stub to debug executables inside Cemu using an external debugger");
+		("enable-gdbstub", po::value<bool>()->implicit_value(true), "Enable GDB stub to debug executables inside Cemu using an external debugger")
+		("null-renderer", po::value<bool>()->implicit_value(true), "Run games without graphics output. The GPU is still emulated but nothing is drawn, useful for profiling on machines without a GPU");
 
 	po::options_description hidden{ "Hidden options" };
 	hidden.add_options()
 		("nsight", po::value<bool>()->implicit_value(true), "NSight debugging options")
 		("legacy", po::value<bool>()->implicit_value(true), "Intel legacy graphic mode")
 		("ppcrec-lower-addr", po::value<std::string>(), "For debugging: Lower address allowed for PPC recompilation")
-		("ppcrec-upper-addr", po::value<std::string>(), "For debugging: Upper address allowed for PPC recompilation");
+		("ppcrec-upper-addr", po::value<std::string>(), "For debugging: Upper address allowed for PPC recompilation")
+		("replay-gpu-capture", po::wvalue<std::wstring>(), "For profiling: Replay a GPU command stream capture on the null renderer and print timings")
+		("replay-loops", po::value<uint32>()->default_value(1), "For profiling: Number of times the GPU capture is replayed")
+		("benchmark-shader-emitters", po::value<uint32>()->implicit_value(1000), "For profiling: Compare GLSL and direct SPIR-V shader generation on synthetic vertex shaders")
+		("benchmark-fsc-lookup", po::value<uint32>()->implicit_value(1000000), "For profiling: Measure virtual filesystem path resolution on a synthetic mount tree")
+		("simulate-buffer-heap", po::value<uint32>()->implicit_value(10000), "For profiling: Simulate buffer cache heap usage over the given number of frames with and without defragmentation")
+		("compact-cache", po::wvalue<std::wstring>(), "Compact and deduplicate a shader/pipeline cache file or all cache files in a directory")
+		("merge-cache", po::wvalue<std::wstring>(), "Used with --compact-cache: Merge the cache file(s) of the same name from this path into the compacted cache");
 
 	po::options_description extractor{ "Extractor tool" };
 	extractor.add_options()
@@ -180,6 +195,9 @@ bool LaunchSettings::HandleCommandline(const std::vector<std::wstring>& args)
 		if (vm.count("nsight"))
 			s_nsight_mode = vm["nsight"].as<bool>();
 
+		if (vm.count("null-renderer"))
+			s_null_renderer = vm["null-renderer"].as<bool>();
+
 		if(vm.count("force-interpreter"))
 			s_force_interpreter = vm["force-interpreter"].as<bool>();
 
@@ -218,6 +236,39 @@ bool LaunchSettings::HandleCommandline(const std::vector<std::wstring>& args)
 			return false;
 		}
 
+		if (vm.count("replay-gpu-capture"))
+		{
+			GPUCaptureReplayTool(fs::path(vm["replay-gpu-capture"].as<std::wstring>()), vm["replay-loops"].as<uint32>());
+			return false;
+		}
+
+		if (vm.count("benchmark-shader-emitters"))
+		{
+			ShaderEmitterBenchmarkTool(vm["benchmark-shader-emitters"].as<uint32>());
+			return false;
+		}
+
+		if (vm.count("benchmark-fsc-lookup"))
+		{
+			FSCLookupBenchmarkTool(vm["benchmark-fsc-lookup"].as<uint32>());
+			return false;
+		}
+
+		if (vm.count("simulate-buffer-heap"))
+		{
+			BufferHeapSimulationTool(vm["simulate-buffer-heap"].as<uint32>());
+			return false;
+		}
+
+		if (vm.count("compact-cache"))
+		{
+			fs::path mergeSourcePath;
+			if (vm.count("merge-cache"))
+				mergeSourcePath = fs::path(vm["merge-cache"].as<std::wstring>());
+			CacheMaintenanceTool(fs::path(vm["compact-cache"].as<std::wstring>()), mergeSourcePath);
+			return false;
+		}
+
 		return true;
 	}
 	catch (const std::exception& ex)
@@ -292,3 +343,43 @@ bool LaunchSettings::ExtractorTool(std::wstring_view wud_path, std::string_view
 	
 	return true;
 }
+
+bool LaunchSettings::GPUCaptureReplayTool(const fs::path& capturePath, uint32 numLoops)
+{
+	requireConsole();
+	s_verbose = true; // results are logged to stdout
+	PPCTimer_init();
+	PPCTimer_waitForInit();
+	memory_init();
+	memory_mapForGPUReplay();
+	return Latte_RunHeadlessReplay(capturePath, std::max<uint32>(numLoops, 1));
+}
+
+bool LaunchSettings::ShaderEmitterBenchmarkTool(uint32 shaderCount)
+{
+	requireConsole();
+	s_verbose = true; // results are logged to stdout
+	return LatteTC_RunEmitterBenchmark(std::max<uint32>(shaderCount, 1));
+}
+
+bool LaunchSettings::FSCLookupBenchmarkTool(uint32 numLookups)
+{
+	requireConsole();
+	s_verbose = true; // results are logged to stdout
+	return fsc_RunLookupBenchmark(std::max<uint32>(numLookups, 1));
+}
+
+bool LaunchSettings::BufferHeapSimulationTool(uint32 numFrames)
+{
+	requireConsole();
+	s_verbose = true; // results are logged to stdout
+	LatteBufferCache_RunHeapSimulation(std::max<uint32>(numFrames, 1));
+	return true;
+}
+
+bool LaunchSettings::CacheMaintenanceTool(const fs::path& targetPath, const fs::path& mergeSourcePath)
+{
+	requireConsole();
+	s_verbose = true; // results are logged to stdout
+	return FileCacheMaintenance::Run(targetPath, mergeSourcePath);
+}
@@ -26,6 +26,7 @@ public:
 
 	static bool GDBStubEnabled() { return s_enable_gdbstub; }
 	static bool NSightModeEnabled() { return s_nsight_mode; }
+	static bool NullRendererEnabled() { return s_null_renderer; }
 
 	static bool ForceInterpreter() { return s_force_interpreter; };
 	static bool ForceMultiCoreInterpreter() { return s_force_multicore_interpreter; }
@@ -47,6 +48,7 @@ private:
 	
 	inline static bool s_enable_gdbstub = false;
 	inline static bool s_nsight_mode = false;
+	inline static bool s_null_renderer = false;
 
 	inline static bool s_force_interpreter = false;
 	inline static bool s_force_multicore_interpreter = false;
@@ -58,6 +60,11 @@ private:
 	inline static uint32 ppcRec_limitUpperAddr{};
 
 	static bool ExtractorTool(std::wstring_view wud_path, std::string_view output_path, std::wstring_view log_path);
+	static bool GPUCaptureReplayTool(const fs::path& capturePath, uint32 numLoops);
+	static bool ShaderEmitterBenchmarkTool(uint32 shaderCount);
+	static bool FSCLookupBenchmarkTool(uint32 numLookups);
+	static bool BufferHeapSimulationTool(uint32 numFrames);
+	static bool CacheMaintenanceTool(const fs::path& targetPath, const fs::path& mergeSourcePath);
 };
 
 
@@ -31,6 +31,7 @@
 
 #include "Cafe/TitleList/TitleList.h"
 #include "Cafe/TitleList/SaveList.h"
+#include "Cemu/FileCache/FileCache.h"
 
 wxIMPLEMENT_APP_NO_MAIN(CemuApp);
 
@@ -393,6 +394,7 @@ int CemuApp::OnExit()
 {
 	wxApp::OnExit();
 	wxTheClipboard->Flush();
+	FileCache::CompactPendingFiles();
 #if BOOST_OS_WINDOWS
 	ExitProcess(0);
 #else
@@ -6,6 +6,7 @@
 #include "wxgui/helpers/wxHelpers.h"
 #include "wxgui/wxHelper.h"
 #include "Cafe/Filesystem/WUD/wud.h"
+#include "util/ThreadPool/ThreadPool.h"
 
 #include <zip.h>
 #include <curl/curl.h>
@@ -691,30 +692,42 @@ void ChecksumTool::DoWork()
 			throw std::runtime_error("can't open game image");
 
 		const auto wud_size = wud_getWUDSize(wud);
-		std::vector<uint8> buffer(1024 * 1024 * 8);
+		// double buffered, the next chunk is read while the previous one is hashed
+		std::array<std::vector<uint8>, 2> buffers;
+		buffers[0].resize(1024 * 1024 * 8);
+		buffers[1].resize(1024 * 1024 * 8);
 
 		EVP_MD_CTX *sha256 = EVP_MD_CTX_new();
 		EVP_DigestInit(sha256, EVP_sha256());
 
-		uint32 read = 0;
+		auto readChunk = [wud, wud_size](std::vector<uint8>& buffer, size_t offset) -> uint32
+		{
+			if (offset >= wud_size)
+				return 0;
+			return wud_readData(wud, buffer.data(), std::min(buffer.size(), (size_t)wud_size - offset), offset);
+		};
+
+		uint32 read = readChunk(buffers[0], 0);
 		size_t offset = 0;
-		auto size = wud_size;
-		do
+		uint32 bufferIndex = 0;
+		while (read != 0)
 		{
 			if (!m_running.load(std::memory_order_relaxed))
 			{
+				EVP_MD_CTX_free(sha256);
 				wud_close(wud);
 				return;
 			}
-
-			read = wud_readData(wud, buffer.data(), std::min(buffer.size(), (size_t)wud_size - offset), offset);
 			offset += read;
-			size -= read;
+			std::future<uint32> nextRead = std::async(std::launch::async, readChunk, std::ref(buffers[bufferIndex ^ 1]), offset);
+
+			EVP_DigestUpdate(sha256, buffers[bufferIndex].data(), read);
 
-			EVP_DigestUpdate(sha256, buffer.data(), read);
+			read = nextRead.get();
+			bufferIndex ^= 1;
 
 			wxQueueEvent(this, new wxSetGaugeValue((int)((offset * 90) / wud_size), m_progress, m_status, formatWxString(_("Reading game image: {0}/{1} kB"), offset / 1024, wud_size / 1024)));
-		} while (read != 0 && size > 0);
+		}
 		wud_close(wud);
 
 		wxQueueEvent(this, new wxSetGaugeValue(90, m_progress, m_status, formatWxString(_("Generating checksum of game image: {}"), path)));
@@ -746,36 +759,67 @@ void ChecksumTool::DoWork()
 		std::set<std::string> files;
 		_fscGetAllFiles(files, temporaryMountPath, "");
 
-		const size_t file_count = files.size();
-		size_t counter = 0;
-		for (const auto& filename : files)
-		{				
-			auto fileData = fsc_extractFile((temporaryMountPath + "/" + filename).c_str());
-			if (!fileData)
+		// files are hashed in parallel. Each file is streamed in chunks instead of being extracted as a whole
+		// fsc_extractFile() would hold the global fsc lock for the entire read which serializes all workers
+		const std::vector<std::string> fileList(files.begin(), files.end());
+		const size_t file_count = fileList.size();
+		std::vector<std::optional<std::array<uint8, SHA256_DIGEST_LENGTH>>> fileHashes(file_count);
+		std::atomic_size_t counter = 0;
+		ThreadPool::ParallelFor((uint32)file_count, [&](uint32 fileIndex)
+		{
+			if (!m_running.load(std::memory_order_relaxed))
+				return;
+			const std::string& filename = fileList[fileIndex];
+			sint32 fscStatus = FSC_STATUS_UNDEFINED;
+			std::unique_ptr<FSCVirtualFile> fscFile(fsc_open((temporaryMountPath + "/" + filename).c_str(), FSC_ACCESS_FLAG::OPEN_FILE | FSC_ACCESS_FLAG::READ_PERMISSION, &fscStatus));
+			if (!fscFile)
 			{
 				cemuLog_log(LogType::Force, "Failed to open {}", filename);
-				continue;
+				return;
+			}
+			uint32 remainingBytes = fsc_getFileSize(fscFile.get());
+			std::vector<uint8> buffer(std::min<uint32>(remainingBytes, 1024 * 1024 * 8));
+			EVP_MD_CTX* sha256 = EVP_MD_CTX_new();
+			EVP_DigestInit(sha256, EVP_sha256());
+			while (remainingBytes > 0)
+			{
+				uint32 read = fsc_readFile(fscFile.get(), buffer.data(), std::min<uint32>(remainingBytes, (uint32)buffer.size()));
+				if (read == 0)
+					break;
+				EVP_DigestUpdate(sha256, buffer.data(), read);
+				remainingBytes -= read;
+			}
+			std::array<uint8, SHA256_DIGEST_LENGTH> fileHash;
+			EVP_DigestFinal_ex(sha256, fileHash.data(), NULL);
+			EVP_MD_CTX_free(sha256);
+			if (remainingBytes != 0)
+			{
+				cemuLog_log(LogType::Force, "Failed to read {}", filename);
+				return;
 			}
+			fileHashes[fileIndex] = fileHash;
 
-			SHA256(fileData->data(), fileData->size(), checksum.data());
+			size_t numDone = ++counter;
+			wxQueueEvent(this, new wxSetGaugeValue((int)((numDone * 100) / file_count), m_progress, m_status, formatWxString(_("Hashing game file: {}/{}"), numDone, file_count)));
+		});
+		if (!m_running.load(std::memory_order_relaxed))
+		{
+			m_info.Unmount(temporaryMountPath.c_str());
+			return;
+		}
 
+		for (size_t i = 0; i < file_count; i++)
+		{
+			if (!fileHashes[i])
+				continue;
 			std::stringstream str;
-			for (const auto& b : checksum)
+			for (const auto& b : *fileHashes[i])
 			{
 				str << fmt::format("{:02X}", b);
 			}
 
 			// store relative path and hash
-			m_json_entry.file_hashes[filename] = str.str();
-
-			++counter;
-			wxQueueEvent(this, new wxSetGaugeValue((int)((counter * 100) / file_count), m_progress, m_status, formatWxString(_("Hashing game file: {}/{}"), counter, file_count)));
-
-			if (!m_running.load(std::memory_order_relaxed))
-			{
-				m_info.Unmount(temporaryMountPath.c_str());
-				return;
-			}
+			m_json_entry.file_hashes[fileList[i]] = str.str();
 		}
 		m_info.Unmount(temporaryMountPath.c_str());
 
@@ -13,6 +13,7 @@
 #include "AudioDebuggerWindow.h"
 #include "wxgui/canvas/OpenGLCanvas.h"
 #include "wxgui/canvas/VulkanCanvas.h"
+#include "wxgui/canvas/NullCanvas.h"
 #if ENABLE_METAL
 #include "wxgui/canvas/MetalCanvas.h"
 #endif
@@ -38,6 +39,8 @@
 #include "wxgui/TasInputWindow.h"
 
 #include "Cafe/CafeSystem.h"
+#include "Cafe/HW/Latte/Core/LatteCapture.h"
+#include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
 
 #include "util/helpers/SystemException.h"
 #include "wxgui/DownloadGraphicPacksWindow.h"
@@ -169,6 +172,10 @@ enum
 	MAINFRAME_MENU_ID_DEBUG_DUMP_RAM,
 	MAINFRAME_MENU_ID_DEBUG_DUMP_FST,
 	MAINFRAME_MENU_ID_DEBUG_DUMP_CURL_REQUESTS,
+	MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_CAPTURE,
+	MAINFRAME_MENU_ID_DEBUG_GPU_PROFILER,
+	MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_PROFILER_TRACE,
+	MAINFRAME_MENU_ID_DEBUG_DUMP_BOOT_TRACES,
 	// help
 	MAINFRAME_MENU_ID_HELP_ABOUT = 21700,
 	MAINFRAME_MENU_ID_HELP_UPDATE,
@@ -237,6 +244,7 @@ EVT_MENU(MAINFRAME_MENU_ID_DEBUG_ADVANCED_PPC_INFO, MainWindow::OnPPCInfoToggle)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_TEXTURES, MainWindow::OnDebugDumpGeneric)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_SHADERS, MainWindow::OnDebugDumpGeneric)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_RECOMPILER_FUNCTIONS, MainWindow::OnDebugDumpGeneric)
+EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_BOOT_TRACES, MainWindow::OnDebugDumpGeneric)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_CURL_REQUESTS, MainWindow::OnDebugSetting)
 // debug -> Other options
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_RENDER_UPSIDE_DOWN, MainWindow::OnDebugSetting)
@@ -245,6 +253,9 @@ EVT_MENU(MAINFRAME_MENU_ID_DEBUG_VK_ACCURATE_BARRIERS, MainWindow::OnDebugSettin
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_GPU_CAPTURE, MainWindow::OnDebugSetting)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_RAM, MainWindow::OnDebugSetting)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_FST, MainWindow::OnDebugSetting)
+EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_CAPTURE, MainWindow::OnDebugSetting)
+EVT_MENU(MAINFRAME_MENU_ID_DEBUG_GPU_PROFILER, MainWindow::OnDebugSetting)
+EVT_MENU(MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_PROFILER_TRACE, MainWindow::OnDebugSetting)
 // debug -> View ...
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_VIEW_LOGGING_WINDOW, MainWindow::OnLoggingWindow)
 EVT_MENU(MAINFRAME_MENU_ID_DEBUG_TOGGLE_GDB_STUB, MainWindow::OnGDBStubToggle)
@@ -1246,6 +1257,12 @@ void MainWindow::OnDebugSetting(wxCommandEvent& event)
 		ActiveSettings::EnableAudioOnlyAux(event.IsChecked());
 	else if (event.GetId() == MAINFRAME_MENU_ID_DEBUG_DUMP_RAM)
 		memory_createDump();
+	else if (event.GetId() == MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_CAPTURE)
+		LatteCapture_Request(ActiveSettings::GetUserDataPath("dump/gpu_captures/{:016x}_{}.bin", CafeSystem::GetForegroundTitleId(), (uint32)time(nullptr)), 10);
+	else if (event.GetId() == MAINFRAME_MENU_ID_DEBUG_GPU_PROFILER)
+		LatteProfiler_SetEnabled(event.IsChecked());
+	else if (event.GetId() == MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_PROFILER_TRACE)
+		LatteProfiler_RequestTrace(ActiveSettings::GetUserDataPath("dump/gpu_traces/{:016x}_{}.json", CafeSystem::GetForegroundTitleId(), (uint32)time(nullptr)), 60);
 	else if (event.GetId() == MAINFRAME_MENU_ID_DEBUG_DUMP_FST)
 	{
 		/*	int msgBoxAnswer = wxMessageBox(_("All files from the currently running game will be dumped to /dump/<gamefolder>. This process can take a few minutes."),
@@ -1338,6 +1355,10 @@ void MainWindow::OnDebugDumpGeneric(wxCommandEvent& event)
 		dumpSubpath = "dump/recompiler";
 		setDumpState = ActiveSettings::EnableDumpRecompilerFunctions;
 		break;
+	case MAINFRAME_MENU_ID_DEBUG_DUMP_BOOT_TRACES:
+		dumpSubpath = "dump/boot_traces";
+		setDumpState = ActiveSettings::EnableDumpBootTraces;
+		break;
 	default:
 		UNREACHABLE;
 	}
@@ -1849,6 +1870,8 @@ void MainWindow::CreateCanvas()
 		m_render_canvas = new VulkanCanvas(m_game_panel, wxSize(1280, 720), true);
 	else if (ActiveSettings::GetGraphicsAPI() == kOpenGL)
 		m_render_canvas = GLCanvas_Create(m_game_panel, wxSize(1280, 720), true);
+	else if (ActiveSettings::GetGraphicsAPI() == kNull)
+		m_render_canvas = new NullCanvas(m_game_panel, wxSize(1280, 720), true);
 #if ENABLE_METAL
 	else
 	    m_render_canvas = new MetalCanvas(m_game_panel, wxSize(1280, 720), true);
@@ -2590,6 +2613,7 @@ void MainWindow::RecreateMenu()
 	debugDumpMenu->AppendCheckItem(MAINFRAME_MENU_ID_DEBUG_DUMP_SHADERS, _("&Shaders"))->Check(ActiveSettings::DumpShadersEnabled());
 	debugDumpMenu->AppendCheckItem(MAINFRAME_MENU_ID_DEBUG_DUMP_RECOMPILER_FUNCTIONS, _("&Recompiled functions"))->Check(ActiveSettings::DumpRecompilerFunctionsEnabled());
 	debugDumpMenu->AppendCheckItem(MAINFRAME_MENU_ID_DEBUG_DUMP_CURL_REQUESTS, _("&nlibcurl HTTP/HTTPS requests"));
+	debugDumpMenu->AppendCheckItem(MAINFRAME_MENU_ID_DEBUG_DUMP_BOOT_TRACES, _("&Boot traces (until first frame)"))->Check(ActiveSettings::DumpBootTracesEnabled());
 	// debug submenu
 	wxMenu* debugMenu = new wxMenu();
 	m_debugMenu = debugMenu;
@@ -2627,6 +2651,9 @@ void MainWindow::RecreateMenu()
 	debugMenu->Append(MAINFRAME_MENU_ID_DEBUG_VIEW_AUDIO_DEBUGGER, _("&View audio debugger"));
 	debugMenu->Append(MAINFRAME_MENU_ID_DEBUG_VIEW_TEXTURE_RELATIONS, _("&View texture cache info"));
 	debugMenu->Append(MAINFRAME_MENU_ID_DEBUG_DUMP_RAM, _("&Dump current RAM"));
+	debugMenu->Append(MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_CAPTURE, _("&Capture GPU command stream (10 frames)"));
+	debugMenu->AppendCheckItem(MAINFRAME_MENU_ID_DEBUG_GPU_PROFILER, _("&GPU thread profiler overlay"))->Check(LatteProfiler_IsEnabled());
+	debugMenu->Append(MAINFRAME_MENU_ID_DEBUG_DUMP_GPU_PROFILER_TRACE, _("&Capture GPU thread trace (60 frames)"));
 	// debugMenu->Append(MAINFRAME_MENU_ID_DEBUG_DUMP_FST, _("&Dump WUD filesystem"))->Enable(false);
 
 	m_menuBar->Append(debugMenu, _("&Debug"));
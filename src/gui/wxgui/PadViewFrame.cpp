@@ -8,6 +8,7 @@
 #include "Cafe/OS/libs/swkbd/swkbd.h"
 #include "wxgui/canvas/OpenGLCanvas.h"
 #include "wxgui/canvas/VulkanCanvas.h"
+#include "wxgui/canvas/NullCanvas.h"
 #if ENABLE_METAL
 #include "wxgui/canvas/MetalCanvas.h"
 #endif
@@ -79,6 +80,8 @@ void PadViewFrame::InitializeRenderCanvas()
 			m_render_canvas = new VulkanCanvas(this, wxSize(854, 480), false);
 		else if (ActiveSettings::GetGraphicsAPI() == kOpenGL)
 			m_render_canvas = GLCanvas_Create(this, wxSize(854, 480), false);
+		else if (ActiveSettings::GetGraphicsAPI() == kNull)
+			m_render_canvas = new NullCanvas(this, wxSize(854, 480), false);
 #if ENABLE_METAL
 		else
 		    m_render_canvas = new MetalCanvas(this, wxSize(854, 480), false);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "wxgui/canvas/IRenderCanvas.h"
+
+#include <wx/window.h>
+
+// plain window without any graphics output, used with the null renderer
+class NullCanvas : public IRenderCanvas, public wxWindow
+{
+public:
+	NullCanvas(wxWindow* parent, const wxSize& size, bool is_main_window);
+};
@@ -308,6 +308,13 @@ void wxTitleManagerList::OnConvertToCompressedFormat(uint64 titleId, uint64 righ
 		}
 	}
 
+	// entries loaded from the title cache have not been parsed yet
+	for (TitleInfo* titleInfo : { &titleInfo_base, &titleInfo_update, &titleInfo_aoc })
+	{
+		if (titleInfo->IsValid() && titleInfo->IsCached())
+			titleInfo->ParseXmlInfo();
+	}
+
 	wxString msg = _("The following content will be converted to a compressed Wii U archive file (.wua):");
 	msg.append("\n \n");
 	
@@ -1037,22 +1044,20 @@ void wxTitleManagerList::HandleTitleListCallback(CafeTitleListCallbackEvent* evt
 
 	if (evt->eventType == CafeTitleListCallbackEvent::TYPE::TITLE_DISCOVERED)
 	{
-		if (titleInfo.IsCached())
-			return; // the title list only displays non-cached entries
+		// entries from unchanged sources are not parsed again during a scan, so only use info which is also available for cached entries
 		wxTitleManagerList::TitleEntry entry(entryType, entryFormat, titleInfo.GetPath());
 
-		ParsedMetaXml* metaInfo = titleInfo.GetMetaInfo();
 		if(titleInfo.IsSystemDataTitle())
 			return; // dont show system data titles for now
 		entry.location_uid = titleInfo.GetUID();
 		entry.title_id = titleInfo.GetAppTitleId();
-		std::string name = metaInfo->GetLongName(GetConfig().console_language.GetValue());
+		std::string name = titleInfo.GetMetaTitleName();
 		const auto nl = name.find(L'\n');
 		if (nl != std::string::npos)
 			name.replace(nl, 1, " - ");
 		entry.name = wxString::FromUTF8(name);
 		entry.version = titleInfo.GetAppTitleVersion();
-		entry.region = metaInfo->GetRegion();
+		entry.region = titleInfo.GetMetaRegion();
 
 		auto* cmdEvt = new wxCommandEvent(wxEVT_TITLE_FOUND);
 		cmdEvt->SetClientObject(new wxCustomData(entry));
@@ -106,6 +106,9 @@ void WindowSystem::UpdateWindowTitles(bool isIdle, bool isLoading, double fps)
 			renderer = "[Metal]";
 			break;
 #endif
+		case RendererAPI::Null:
+			renderer = "[Null]";
+			break;
 		default:;
 		}
 	}
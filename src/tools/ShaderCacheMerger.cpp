@@ -3,7 +3,7 @@
 #include <regex>
 #include <cinttypes>
 
-void MergeShaderCacheFile(std::string fileName)
+void MergeCacheFile(std::string fileName, const char* contentName)
 {
 	// parse titleId from fileName
 	uint64 titleId = 0;
@@ -14,86 +14,27 @@ void MergeShaderCacheFile(std::string fileName)
 	const std::string mergeSourcePath = "shaderCache/transferable/merge/" + fileName;
 	if (!fs::exists(mainPath) || !fs::exists(mergeSourcePath))
 		return;
-	// open both caches
-	FileCache* mainCache = FileCache::Open(boost::nowide::widen(mainPath));
-	FileCache* sourceCache = FileCache::Open(boost::nowide::widen(mergeSourcePath));
-	if (!mainCache && !sourceCache)
+	// merge into a new compacted and deduplicated file which then replaces the main cache file
+	printf("Merging %s %" PRIx64 "...", contentName, titleId);
+	FileCache::MaintenanceStats stats;
+	if (!FileCache::Merge(boost::nowide::widen(mainPath), boost::nowide::widen(mergeSourcePath), stats))
 	{
-		printf("Failed to open cache files for %s\n", fileName.c_str());
-		if (mainCache)
-			delete mainCache;
-		if (sourceCache)
-			delete sourceCache;
+		printf(" -> Failed to merge cache files for %s\n", fileName.c_str());
 		return;
 	}
-	// begin merging
-	printf("Merging shaders %" PRIx64 "...", titleId);
-	uint32 numMergedEntries = 0; // number of files added to the main cache file
-	for (sint32 i = 0; i < sourceCache->GetFileCount(); i++)
-	{
-		uint64 name1, name2;
-		std::vector<uint8> fileData;
-		if (!sourceCache->GetFileByIndex(i, &name1, &name2, fileData))
-			continue;
-		std::vector<uint8> existingfileData;
-		if (mainCache->HasFile({ name1, name2 }))
-			continue;
-		mainCache->AddFile({ name1, name2 }, fileData.data(), (sint32)fileData.size());
-		numMergedEntries++;
-	}
-	printf(" -> Added %d new shaders for a total of %d\n", numMergedEntries, mainCache->GetFileCount());
-
-	delete mainCache;
-	delete sourceCache;
+	printf(" -> Added %d new %s for a total of %d\n", stats.mergedCount, contentName, stats.fileCount);
 
 	fs::remove(mergeSourcePath);
 }
 
-void MergePipelineCacheFile(std::string fileName)
+void MergeShaderCacheFile(std::string fileName)
 {
-	// parse titleId from fileName
-	uint64 titleId = 0;
-	if (sscanf(fileName.c_str(), "%" SCNx64, &titleId) != 1)
-		return;
-
-	const std::string mainPath = "shaderCache/transferable/" + fileName;
-	const std::string mergeSourcePath = "shaderCache/transferable/merge/" + fileName;
-	if (!fs::exists(mainPath) || !fs::exists(mergeSourcePath))
-		return;
-	// open both caches
-	const uint32 cacheFileVersion = 1;
-	FileCache* mainCache = FileCache::Open(boost::nowide::widen(mainPath));
-	FileCache* sourceCache = FileCache::Open(boost::nowide::widen(mergeSourcePath));
-	if (!mainCache && !sourceCache)
-	{
-		printf("Failed to open cache files for %s\n", fileName.c_str());
-		if (mainCache)
-			delete mainCache;
-		if (sourceCache)
-			delete sourceCache;
-		return;
-	}
-	// begin merging
-	printf("Merging pipelines %" PRIx64 "...", titleId);
-	uint32 numMergedEntries = 0; // number of files added to the main cache file
-	for (sint32 i = 0; i < sourceCache->GetFileCount(); i++)
-	{
-		uint64 name1, name2;
-		std::vector<uint8> fileData;
-		if (!sourceCache->GetFileByIndex(i, &name1, &name2, fileData))
-			continue;
-		std::vector<uint8> existingfileData;
-		if (mainCache->HasFile({ name1, name2 }))
-			continue;
-		mainCache->AddFile({ name1, name2 }, fileData.data(), (sint32)fileData.size());
-		numMergedEntries++;
-	}
-	printf(" -> Added %d new pipelines for a total of %d\n", numMergedEntries, mainCache->GetFileCount());
-
-	delete mainCache;
-	delete sourceCache;
+	MergeCacheFile(fileName, "shaders");
+}
 
-	fs::remove(mergeSourcePath);
+void MergePipelineCacheFile(std::string fileName)
+{
+	MergeCacheFile(fileName, "pipelines");
 }
 
 void MergeShaderAndPipelineCacheFiles()
@@ -315,8 +315,14 @@ public:
 	virtual void free(void* addr) = 0;
 };
 
+// segregated fit heap. Free ranges are tracked in two-level size classes (power of two, then 4 linear steps) similar to TLSF
+// so finding a fitting free range only needs to scan a single list in the common case
 class VHeap : public VGenericHeap
 {
+	static constexpr uint32 SL_BITS = 2;
+	static constexpr uint32 SL_COUNT = 1 << SL_BITS;
+	static constexpr uint32 BUCKET_COUNT = 32 * SL_COUNT;
+
 	struct allocRange_t
 	{
 		allocRange_t* nextFree{};
@@ -390,6 +396,35 @@ public:
 		_free((uint32)offset);
 	}
 
+	// allocate from a free range no larger than maxFreeRangeSize, fails if there is no such free range
+	// used to relocate allocations into holes without splitting up the largest free range
+	bool allocOffsetFromSmallerRange(uint32 size, uint32 alignment, uint32 maxFreeRangeSize, uint32& offsetOut)
+	{
+		return _alloc(size, alignment, offsetOut, maxFreeRangeSize);
+	}
+
+	// returns the largest free range and the offsets of the allocations right before and after it (0xFFFFFFFF if none)
+	// moving these allocations elsewhere grows the largest free range
+	bool getLargestFreeRange(uint32& offsetOut, uint32& sizeOut, uint32& prevAllocationOffset, uint32& nextAllocationOffset)
+	{
+		if (m_flUseMask == 0)
+			return false;
+		uint32 fl = 31 - std::countl_zero(m_flUseMask);
+		uint32 sl = 31 - std::countl_zero((uint32)m_slUseMask[fl]);
+		allocRange_t* largestRange = nullptr;
+		for (allocRange_t* range = bucketFreeRange[fl * SL_COUNT + sl]; range; range = range->nextFree)
+		{
+			if (!largestRange || range->size > largestRange->size)
+				largestRange = range;
+		}
+		offsetOut = largestRange->offset;
+		sizeOut = largestRange->size;
+		// free ranges are always merged, so the neighbours are allocations
+		prevAllocationOffset = largestRange->prevOrdered ? largestRange->prevOrdered->offset : 0xFFFFFFFF;
+		nextAllocationOffset = largestRange->nextOrdered ? largestRange->nextOrdered->offset : 0xFFFFFFFF;
+		return true;
+	}
+
 	uint32 getAllocationSizeFromAddr(void* addr)
 	{
 		uint32 addrOffset = (uint32)((uint8*)addr - m_heapBase);
@@ -411,6 +446,20 @@ public:
 		allocNum = (uint32)map_allocatedRange.size();
 	}
 
+	// the heap is fragmented if the largest free range is much smaller than the total free space
+	void getFragmentationStats(uint32& largestFreeRange, uint32& freeRangeCount)
+	{
+		largestFreeRange = 0;
+		freeRangeCount = m_statsFreeRangeCount;
+		if (m_flUseMask == 0)
+			return;
+		// all ranges in the highest non-empty size class are larger than those in other classes
+		uint32 fl = 31 - std::countl_zero(m_flUseMask);
+		uint32 sl = 31 - std::countl_zero((uint32)m_slUseMask[fl]);
+		for (allocRange_t* range = bucketFreeRange[fl * SL_COUNT + sl]; range; range = range->nextFree)
+			largestFreeRange = std::max(largestFreeRange, range->size);
+	}
+
 private:
 	unsigned ulog2(uint32 v)
 	{
@@ -429,17 +478,42 @@ private:
 		return MUL_DE_BRUIJN_BIT[(v * 0x07C4ACDDu) >> 27];
 	}
 
+	uint32 getBucketIndex(uint32 size)
+	{
+		uint32 fl = ulog2(size);
+		uint32 sl = fl >= SL_BITS ? ((size >> (fl - SL_BITS)) & (SL_COUNT - 1)) : 0;
+		return fl * SL_COUNT + sl;
+	}
+
+	// returns the index of the first non-empty bucket starting at bucketIndex or BUCKET_COUNT if there is none
+	uint32 findNonEmptyBucket(uint32 bucketIndex)
+	{
+		if (bucketIndex >= BUCKET_COUNT)
+			return BUCKET_COUNT;
+		uint32 fl = bucketIndex / SL_COUNT;
+		uint32 slMask = m_slUseMask[fl] & (0xFFu << (bucketIndex % SL_COUNT));
+		if (slMask)
+			return fl * SL_COUNT + std::countr_zero(slMask);
+		uint32 flMask = (fl < 31) ? (m_flUseMask & (0xFFFFFFFFu << (fl + 1))) : 0;
+		if (!flMask)
+			return BUCKET_COUNT;
+		fl = std::countr_zero(flMask);
+		return fl * SL_COUNT + std::countr_zero((uint32)m_slUseMask[fl]);
+	}
+
 	void trackFreeRange(allocRange_t* range)
 	{
-		// get index of msb
 		if (range->size == 0)
 			assert_dbg(); // not allowed
-		uint32 bucketIndex = ulog2(range->size);
+		uint32 bucketIndex = getBucketIndex(range->size);
 		range->nextFree = bucketFreeRange[bucketIndex];
 		if (bucketFreeRange[bucketIndex])
 			bucketFreeRange[bucketIndex]->prevFree = range;
 		range->prevFree = nullptr;
 		bucketFreeRange[bucketIndex] = range;
+		m_slUseMask[bucketIndex / SL_COUNT] |= (1u << (bucketIndex % SL_COUNT));
+		m_flUseMask |= (1u << (bucketIndex / SL_COUNT));
+		m_statsFreeRangeCount++;
 	}
 
 	void forgetFreeRange(allocRange_t* range, uint32 bucketIndex)
@@ -459,7 +533,14 @@ private:
 			bucketFreeRange[bucketIndex] = nextRange;
 			if (nextRange)
 				nextRange->prevFree = nullptr;
+			else
+			{
+				m_slUseMask[bucketIndex / SL_COUNT] &= ~(1u << (bucketIndex % SL_COUNT));
+				if (m_slUseMask[bucketIndex / SL_COUNT] == 0)
+					m_flUseMask &= ~(1u << (bucketIndex / SL_COUNT));
+			}
 		}
+		m_statsFreeRangeCount--;
 	}
 
 	void _allocFrom(allocRange_t* range, uint32 bucketIndex, uint32 allocOffset, uint32 allocSize)
@@ -495,7 +576,7 @@ private:
 		m_statsMemAllocated += allocSize;
 	}
 
-	bool _alloc(uint32 size, uint32 alignment, uint32& allocOffsetOut)
+	bool _alloc(uint32 size, uint32 alignment, uint32& allocOffsetOut, uint32 maxFreeRangeSize = 0xFFFFFFFF)
 	{
 		if(size == 0)
 		{
@@ -504,13 +585,14 @@ private:
 		}
 		// find smallest bucket to scan
 		uint32 alignmentM1 = alignment - 1;
-		uint32 bucketIndex = ulog2(size);
-		while (bucketIndex < 32)
+		uint32 bucketIndex = findNonEmptyBucket(getBucketIndex(size));
+		uint32 lastBucketIndex = maxFreeRangeSize != 0xFFFFFFFF ? getBucketIndex(maxFreeRangeSize) : (BUCKET_COUNT - 1);
+		while (bucketIndex <= lastBucketIndex)
 		{
 			allocRange_t* range = bucketFreeRange[bucketIndex];
 			while (range)
 			{
-				if (range->size >= size)
+				if (range->size >= size && range->size <= maxFreeRangeSize)
 				{
 					// verify if aligned allocation fits
 					uint32 alignedOffset = (range->offset + alignmentM1) & ~alignmentM1;
@@ -525,7 +607,7 @@ private:
 				}
 				range = range->nextFree;
 			}
-			bucketIndex++; // try higher bucket
+			bucketIndex = findNonEmptyBucket(bucketIndex + 1); // try higher bucket
 		}
 		return false;
 	}
@@ -548,12 +630,12 @@ private:
 		{
 			if (nextRange && nextRange->isFree)
 			{
-				forgetFreeRange(nextRange, ulog2(nextRange->size));
+				forgetFreeRange(nextRange, getBucketIndex(nextRange->size));
 				uint32 newSize = (nextRange->offset + nextRange->size) - prevRange->offset;
 				prevRange->nextOrdered = nextRange->nextOrdered;
 				if (nextRange->nextOrdered)
 					nextRange->nextOrdered->prevOrdered = prevRange;
-				forgetFreeRange(prevRange, ulog2(prevRange->size));
+				forgetFreeRange(prevRange, getBucketIndex(prevRange->size));
 				prevRange->size = newSize;
 				trackFreeRange(prevRange);
 				delete range;
@@ -565,7 +647,7 @@ private:
 				prevRange->nextOrdered = nextRange;
 				if (nextRange)
 					nextRange->prevOrdered = prevRange;
-				forgetFreeRange(prevRange, ulog2(prevRange->size));
+				forgetFreeRange(prevRange, getBucketIndex(prevRange->size));
 				prevRange->size = newSize;
 				trackFreeRange(prevRange);
 				delete range;
@@ -575,7 +657,7 @@ private:
 		{
 			uint32 newOffset = range->offset;
 			uint32 newSize = (nextRange->offset + nextRange->size) - newOffset;
-			forgetFreeRange(nextRange, ulog2(nextRange->size));
+			forgetFreeRange(nextRange, getBucketIndex(nextRange->size));
 			nextRange->offset = newOffset;
 			nextRange->size = newSize;
 			if (range->prevOrdered)
@@ -592,11 +674,14 @@ private:
 	}
 
 private:
-	allocRange_t* bucketFreeRange[32]{};
+	allocRange_t* bucketFreeRange[BUCKET_COUNT]{};
+	uint32 m_flUseMask{ 0 }; // bitmask of power of two size classes with at least one free range
+	uint8 m_slUseMask[32]{}; // per power of two size class, bitmask of non-empty linear sub-classes
 	std::unordered_map<uint32, allocRange_t*> map_allocatedRange;
 	uint8* m_heapBase;
 	const uint32 m_heapSize;
 	uint32 m_statsMemAllocated{ 0 };
+	uint32 m_statsFreeRangeCount{ 0 };
 };
 
 template<uint32 TChunkSize>
@@ -0,0 +1,104 @@
+#include "util/ThreadPool/ThreadPool.h"
+#include "util/helpers/helpers.h"
+
+struct ParallelForJob
+{
+	ParallelForJob(uint32 count, const std::function<void(uint32)>& func) : count(count), func(func) {}
+
+	// returns true if an index was claimed and processed
+	bool ProcessNext()
+	{
+		uint32 index = nextIndex.fetch_add(1);
+		if (index >= count)
+			return false;
+		func(index);
+		if (numDone.fetch_add(1) + 1 == count)
+		{
+			std::unique_lock _l(doneMutex);
+			doneCV.notify_all();
+		}
+		return true;
+	}
+
+	bool HasUnclaimedWork() const
+	{
+		return nextIndex.load() < count;
+	}
+
+	const uint32 count;
+	const std::function<void(uint32)>& func;
+	std::atomic_uint32_t nextIndex{0};
+	std::atomic_uint32_t numDone{0};
+	std::mutex doneMutex;
+	std::condition_variable doneCV;
+};
+
+struct ThreadPoolState
+{
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::deque<std::shared_ptr<ParallelForJob>> jobs;
+	uint32 numWorkers{0};
+};
+
+// the workers are detached and keep waiting on the condition variable until the process ends
+// so the state is intentionally never destroyed, otherwise static destruction would block on exit
+static std::once_flag s_threadPoolInitFlag;
+static ThreadPoolState* s_threadPool;
+
+static void _ThreadPool_WorkerThread()
+{
+	SetThreadName("ThreadPoolWorker");
+	std::unique_lock _l(s_threadPool->mutex);
+	while (true)
+	{
+		s_threadPool->workAvailable.wait(_l, []() { return !s_threadPool->jobs.empty(); });
+		std::shared_ptr<ParallelForJob> job = s_threadPool->jobs.front();
+		if (!job->HasUnclaimedWork())
+		{
+			s_threadPool->jobs.pop_front();
+			continue;
+		}
+		_l.unlock();
+		while (job->ProcessNext()) {}
+		job.reset();
+		_l.lock();
+	}
+}
+
+static void _ThreadPool_Init()
+{
+	s_threadPool = new ThreadPoolState();
+	// the calling thread always participates, so one thread less than the number of cores is enough
+	s_threadPool->numWorkers = std::clamp<uint32>(std::thread::hardware_concurrency(), 2, 16) - 1;
+	for (uint32 i = 0; i < s_threadPool->numWorkers; i++)
+		std::thread(_ThreadPool_WorkerThread).detach();
+}
+
+uint32 ThreadPool::GetWorkerCount()
+{
+	std::call_once(s_threadPoolInitFlag, _ThreadPool_Init);
+	return s_threadPool->numWorkers + 1;
+}
+
+void ThreadPool::ParallelFor(uint32 count, const std::function<void(uint32)>& func)
+{
+	if (count == 0)
+		return;
+	if (count == 1)
+	{
+		func(0);
+		return;
+	}
+	std::call_once(s_threadPoolInitFlag, _ThreadPool_Init);
+	auto job = std::make_shared<ParallelForJob>(count, func);
+	{
+		std::unique_lock _l(s_threadPool->mutex);
+		s_threadPool->jobs.emplace_back(job);
+	}
+	s_threadPool->workAvailable.notify_all();
+	while (job->ProcessNext()) {}
+	// wait for indices claimed by workers
+	std::unique_lock _l(job->doneMutex);
+	job->doneCV.wait(_l, [&job]() { return job->numDone.load() == job->count; });
+}
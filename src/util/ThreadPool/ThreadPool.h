@@ -1,4 +1,6 @@
+#pragma once
 #include <thread>
+#include <functional>
 
 class ThreadPool
 {
@@ -11,5 +13,8 @@ public:
 		t.detach();
 	}
 
-
-};
\ No newline at end of file
+	// runs func(i) for every i in [0, count) on a shared pool of worker threads and returns once all calls are done
+	// the calling thread works on the range as well, so this is safe to use from within another ParallelFor
+	static void ParallelFor(uint32 count, const std::function<void(uint32)>& func);
+	static uint32 GetWorkerCount();
+};
@@ -0,0 +1,798 @@
+#include "util/Zir/Core/IR.h"
+#include "util/Zir/Core/ZirUtility.h"
+#include "util/Zir/Core/ZpIRPasses.h"
+#include "util/Zir/EmitterSPIRV/ZpIREmitSPIRV.h"
+
+// subset of the SPIR-V enums used by the emitter (see the SPIR-V specification, unified1)
+namespace SPV
+{
+	constexpr uint32 MAGIC = 0x07230203;
+	constexpr uint32 VERSION_1_3 = 0x00010300;
+
+	enum OP : uint16
+	{
+		OpName = 5,
+		OpMemberName = 6,
+		OpExtInstImport = 11,
+		OpMemoryModel = 14,
+		OpEntryPoint = 15,
+		OpExecutionMode = 16,
+		OpCapability = 17,
+		OpTypeVoid = 19,
+		OpTypeBool = 20,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeArray = 28,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpTypeFunction = 33,
+		OpConstant = 43,
+		OpFunction = 54,
+		OpFunctionEnd = 56,
+		OpVariable = 59,
+		OpLoad = 61,
+		OpStore = 62,
+		OpAccessChain = 65,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+		OpCompositeConstruct = 80,
+		OpCompositeExtract = 81,
+		OpCopyObject = 83,
+		OpConvertFToU = 109,
+		OpConvertFToS = 110,
+		OpConvertSToF = 111,
+		OpConvertUToF = 112,
+		OpBitcast = 124,
+		OpIAdd = 128,
+		OpFAdd = 129,
+		OpISub = 130,
+		OpFSub = 131,
+		OpIMul = 132,
+		OpFMul = 133,
+		OpUDiv = 134,
+		OpSDiv = 135,
+		OpFDiv = 136,
+		OpShiftRightLogical = 194,
+		OpShiftLeftLogical = 196,
+		OpBitwiseOr = 197,
+		OpBitwiseAnd = 199,
+		OpLabel = 248,
+		OpReturn = 253,
+	};
+
+	constexpr uint32 CapabilityShader = 1;
+	constexpr uint32 AddressingModelLogical = 0;
+	constexpr uint32 MemoryModelGLSL450 = 1;
+	constexpr uint32 ExecutionModelVertex = 0;
+	constexpr uint32 FunctionControlNone = 0;
+
+	constexpr uint32 StorageClassInput = 1;
+	constexpr uint32 StorageClassUniform = 2;
+	constexpr uint32 StorageClassOutput = 3;
+
+	constexpr uint32 DecorationBlock = 2;
+	constexpr uint32 DecorationArrayStride = 6;
+	constexpr uint32 DecorationBuiltIn = 11;
+	constexpr uint32 DecorationLocation = 30;
+	constexpr uint32 DecorationBinding = 33;
+	constexpr uint32 DecorationDescriptorSet = 34;
+	constexpr uint32 DecorationOffset = 35;
+
+	constexpr uint32 BuiltInPosition = 0;
+};
+
+namespace ZirEmitter
+{
+	void SPIRV::Emit(ZpIR::ZpIRFunction* irFunction, const Options& options, std::vector<uint32>& output)
+	{
+		m_irFunction = irFunction;
+		m_options = options;
+
+		cemu_assert_debug(m_irFunction->m_entryBlocks.size() == 1);
+		cemu_assert_debug(m_irFunction->m_basicBlocks.size() == 1); // other sizes are todo
+		ZpIR::ZpIRBasicBlock& basicBlock = *m_irFunction->m_entryBlocks[0];
+
+		m_typeVoid = AllocId();
+		EmitOp(SECTION::GLOBALS, SPV::OpTypeVoid, { m_typeVoid });
+		m_typeFunctionVoid = AllocId();
+		EmitOp(SECTION::GLOBALS, SPV::OpTypeFunction, { m_typeFunctionVoid, m_typeVoid });
+
+		// declare inputs and outputs
+		CollectInterface(basicBlock);
+
+		// main function
+		uint32 mainFunctionId = AllocId();
+		EmitOp(SECTION::FUNCTION, SPV::OpFunction, { m_typeVoid, mainFunctionId, SPV::FunctionControlNone, m_typeFunctionVoid });
+		EmitOp(SECTION::FUNCTION, SPV::OpLabel, { AllocId() });
+		GenerateBasicBlockCode(basicBlock);
+		EmitOp(SECTION::FUNCTION, SPV::OpReturn, {});
+		EmitOp(SECTION::FUNCTION, SPV::OpFunctionEnd, {});
+
+		// header, needs to be generated last since the entry point lists all interface variables
+		std::vector<uint32> interfaceIds;
+		for (auto& itr : m_inputAttributeVarIds)
+			interfaceIds.emplace_back(itr.second);
+		if (m_positionVarId)
+			interfaceIds.emplace_back(m_positionVarId);
+		for (auto& itr : m_outputAttributeVarIds)
+			interfaceIds.emplace_back(itr.second);
+		EmitOp(SECTION::HEADER, SPV::OpCapability, { SPV::CapabilityShader });
+		EmitOp(SECTION::HEADER, SPV::OpMemoryModel, { SPV::AddressingModelLogical, SPV::MemoryModelGLSL450 });
+		EmitOpWithString(SECTION::HEADER, SPV::OpEntryPoint, { SPV::ExecutionModelVertex, mainFunctionId }, "main", interfaceIds);
+
+		// assemble module
+		output.clear();
+		output.reserve(5 + m_sectionHeader.size() + m_sectionAnnotations.size() + m_sectionGlobals.size() + m_sectionFunction.size());
+		output.emplace_back(SPV::MAGIC);
+		output.emplace_back(SPV::VERSION_1_3);
+		output.emplace_back(0); // generator
+		output.emplace_back(m_nextId); // bound
+		output.emplace_back(0); // schema
+		output.insert(output.end(), m_sectionHeader.begin(), m_sectionHeader.end());
+		output.insert(output.end(), m_sectionAnnotations.begin(), m_sectionAnnotations.end());
+		output.insert(output.end(), m_sectionGlobals.begin(), m_sectionGlobals.end());
+		output.insert(output.end(), m_sectionFunction.begin(), m_sectionFunction.end());
+	}
+
+	void SPIRV::CollectInterface(ZpIR::ZpIRBasicBlock& basicBlock)
+	{
+		// scan for all imported and exported locations
+		bool exportsPosition = false;
+		std::set<uint16> inputAttributes;
+		std::set<uint16> outputAttributes;
+		for (ZpIR::IR::__InsBase* instruction = basicBlock.m_instructionFirst; instruction; instruction = instruction->next)
+		{
+			if (auto ins = ZpIR::IR::InsIMPORT::getIfForm(instruction))
+			{
+				ZpIR::ShaderSubset::ShaderImportLocation loc(ins->importSymbol);
+				if (loc.IsUniformRegister())
+				{
+					uint16 index;
+					loc.GetUniformRegister(index);
+					m_uniformRegisterCount = std::max<uint32>(m_uniformRegisterCount, index / 4 + 1);
+				}
+				else if (loc.IsVertexAttribute())
+				{
+					uint16 attributeIndex, channelIndex;
+					loc.GetVertexAttribute(attributeIndex, channelIndex);
+					inputAttributes.emplace(attributeIndex);
+				}
+			}
+			else if (auto ins = ZpIR::IR::InsEXPORT::getIfForm(instruction))
+			{
+				ZpIR::ShaderSubset::ShaderExportLocation loc(ins->exportSymbol);
+				if (loc.IsPosition())
+					exportsPosition = true;
+				else if (loc.IsOutputAttribute())
+				{
+					uint16 attributeIndex;
+					loc.GetOutputAttribute(attributeIndex);
+					outputAttributes.emplace(attributeIndex);
+				}
+			}
+		}
+		// uniform block
+		if (m_uniformRegisterCount > 0)
+		{
+			uint32 typeArray = AllocId();
+			EmitOp(SECTION::GLOBALS, SPV::OpTypeArray, { typeArray, GetVec4TypeId(ZpIR::DataType::F32), GetConstantId(ZpIR::DataType::U32, m_uniformRegisterCount) });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { typeArray, SPV::DecorationArrayStride, 16 });
+			uint32 typeBlock = AllocId();
+			EmitOp(SECTION::GLOBALS, SPV::OpTypeStruct, { typeBlock, typeArray });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { typeBlock, SPV::DecorationBlock });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpMemberDecorate, { typeBlock, 0, SPV::DecorationOffset, 0 });
+			m_uniformVarId = AllocId();
+			EmitOp(SECTION::GLOBALS, SPV::OpVariable, { GetPointerTypeId(SPV::StorageClassUniform, typeBlock), m_uniformVarId, SPV::StorageClassUniform });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { m_uniformVarId, SPV::DecorationDescriptorSet, m_options.uniformSetIndex });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { m_uniformVarId, SPV::DecorationBinding, m_options.uniformBindingPoint });
+		}
+		// vertex attributes
+		for (uint16 attributeIndex : inputAttributes)
+		{
+			uint32 varId = AllocId();
+			EmitOp(SECTION::GLOBALS, SPV::OpVariable, { GetPointerTypeId(SPV::StorageClassInput, GetVec4TypeId(ZpIR::DataType::U32)), varId, SPV::StorageClassInput });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { varId, SPV::DecorationLocation, attributeIndex });
+			m_inputAttributeVarIds.emplace(attributeIndex, varId);
+		}
+		// outputs
+		if (exportsPosition)
+		{
+			m_positionVarId = AllocId();
+			EmitOp(SECTION::GLOBALS, SPV::OpVariable, { GetPointerTypeId(SPV::StorageClassOutput, GetVec4TypeId(ZpIR::DataType::F32)), m_positionVarId, SPV::StorageClassOutput });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { m_positionVarId, SPV::DecorationBuiltIn, SPV::BuiltInPosition });
+		}
+		for (uint16 attributeIndex : outputAttributes)
+		{
+			uint32 varId = AllocId();
+			EmitOp(SECTION::GLOBALS, SPV::OpVariable, { GetPointerTypeId(SPV::StorageClassOutput, GetVec4TypeId(ZpIR::DataType::F32)), varId, SPV::StorageClassOutput });
+			EmitOp(SECTION::ANNOTATIONS, SPV::OpDecorate, { varId, SPV::DecorationLocation, attributeIndex });
+			m_outputAttributeVarIds.emplace(attributeIndex, varId);
+		}
+	}
+
+	void SPIRV::GenerateBasicBlockCode(ZpIR::ZpIRBasicBlock& basicBlock)
+	{
+		m_blockContext.currentBasicBlock = &basicBlock;
+		m_blockContext.regIds.clear();
+		m_blockContext.regIds.resize(basicBlock.m_regs.size());
+
+		ZpIR::IR::__InsBase* instruction = basicBlock.m_instructionFirst;
+		while (instruction)
+		{
+			if (auto ins = ZpIR::IR::InsRR::getIfForm(instruction))
+				HandleInstruction(ins);
+			else if (auto ins = ZpIR::IR::InsRRR::getIfForm(instruction))
+				HandleInstruction(ins);
+			else if (auto ins = ZpIR::IR::InsIMPORT::getIfForm(instruction))
+				HandleInstruction(ins);
+			else if (auto ins = ZpIR::IR::InsEXPORT::getIfForm(instruction))
+				HandleInstruction(ins);
+			else
+			{
+				assert_dbg();
+			}
+			instruction = instruction->next;
+		}
+	}
+
+	void SPIRV::HandleInstruction(ZpIR::IR::InsRR* ins)
+	{
+		auto srcType = m_blockContext.currentBasicBlock->getRegType(ins->rB);
+		auto dstType = m_blockContext.currentBasicBlock->getRegType(ins->rA);
+		switch (ins->opcode)
+		{
+		case ZpIR::IR::OpCode::MOV:
+		{
+			// SSA values are immutable, the destination register simply aliases the source
+			SetResultId(ins->rA, GetOperandIdAsType(ins->rB, dstType));
+			break;
+		}
+		case ZpIR::IR::OpCode::BITCAST:
+		{
+			uint32 resultId = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitcast, { GetTypeId(dstType), resultId, GetOperandId(ins->rB) });
+			SetResultId(ins->rA, resultId);
+			break;
+		}
+		case ZpIR::IR::OpCode::SWAP_ENDIAN:
+		{
+			cemu_assert_debug(srcType == dstType);
+			if (srcType != ZpIR::DataType::U32)
+			{
+				assert_dbg();
+				break;
+			}
+			// (v>>24)|((v>>8)&0xFF00)|((v<<8)&0xFF0000)|((v<<24))
+			uint32 typeU32 = GetTypeId(ZpIR::DataType::U32);
+			uint32 v = GetOperandId(ins->rB);
+			uint32 c8 = GetConstantId(ZpIR::DataType::U32, 8);
+			uint32 c24 = GetConstantId(ZpIR::DataType::U32, 24);
+			uint32 t0 = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpShiftRightLogical, { typeU32, t0, v, c24 });
+			uint32 t1a = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpShiftRightLogical, { typeU32, t1a, v, c8 });
+			uint32 t1 = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitwiseAnd, { typeU32, t1, t1a, GetConstantId(ZpIR::DataType::U32, 0xFF00) });
+			uint32 t2a = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpShiftLeftLogical, { typeU32, t2a, v, c8 });
+			uint32 t2 = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitwiseAnd, { typeU32, t2, t2a, GetConstantId(ZpIR::DataType::U32, 0xFF0000) });
+			uint32 t3 = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpShiftLeftLogical, { typeU32, t3, v, c24 });
+			uint32 t01 = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitwiseOr, { typeU32, t01, t0, t1 });
+			uint32 t23 = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitwiseOr, { typeU32, t23, t2, t3 });
+			uint32 resultId = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitwiseOr, { typeU32, resultId, t01, t23 });
+			SetResultId(ins->rA, resultId);
+			break;
+		}
+		case ZpIR::IR::OpCode::CONVERT_FLOAT_TO_INT:
+		{
+			cemu_assert_debug(srcType == ZpIR::DataType::F32);
+			cemu_assert_debug(dstType == ZpIR::DataType::S32 || dstType == ZpIR::DataType::U32);
+			uint32 resultId = AllocId();
+			EmitOp(SECTION::FUNCTION, dstType == ZpIR::DataType::U32 ? SPV::OpConvertFToU : SPV::OpConvertFToS, { GetTypeId(dstType), resultId, GetOperandId(ins->rB) });
+			SetResultId(ins->rA, resultId);
+			break;
+		}
+		case ZpIR::IR::OpCode::CONVERT_INT_TO_FLOAT:
+		{
+			cemu_assert_debug(srcType == ZpIR::DataType::S32 || srcType == ZpIR::DataType::U32);
+			cemu_assert_debug(dstType == ZpIR::DataType::F32);
+			uint32 resultId = AllocId();
+			EmitOp(SECTION::FUNCTION, srcType == ZpIR::DataType::U32 ? SPV::OpConvertUToF : SPV::OpConvertSToF, { GetTypeId(dstType), resultId, GetOperandId(ins->rB) });
+			SetResultId(ins->rA, resultId);
+			break;
+		}
+		default:
+			assert_dbg();
+		}
+	}
+
+	void SPIRV::HandleInstruction(ZpIR::IR::InsRRR* ins)
+	{
+		auto type = m_blockContext.currentBasicBlock->getRegType(ins->rA);
+		const bool isFloat = type == ZpIR::DataType::F32;
+		uint16 opcode;
+		switch (ins->opcode)
+		{
+		case ZpIR::IR::OpCode::ADD:
+			opcode = isFloat ? SPV::OpFAdd : SPV::OpIAdd;
+			break;
+		case ZpIR::IR::OpCode::SUB:
+			opcode = isFloat ? SPV::OpFSub : SPV::OpISub;
+			break;
+		case ZpIR::IR::OpCode::MUL:
+			opcode = isFloat ? SPV::OpFMul : SPV::OpIMul;
+			break;
+		case ZpIR::IR::OpCode::DIV:
+			opcode = isFloat ? SPV::OpFDiv : (type == ZpIR::DataType::S32 ? SPV::OpSDiv : SPV::OpUDiv);
+			break;
+		default:
+			assert_dbg();
+			return;
+		}
+		uint32 resultId = AllocId();
+		EmitOp(SECTION::FUNCTION, opcode, { GetTypeId(type), resultId, GetOperandIdAsType(ins->rB, type), GetOperandIdAsType(ins->rC, type) });
+		SetResultId(ins->rA, resultId);
+	}
+
+	void SPIRV::HandleInstruction(ZpIR::IR::InsIMPORT* ins)
+	{
+		ZpIR::ShaderSubset::ShaderImportLocation loc(ins->importSymbol);
+		cemu_assert_debug(ins->count == 1);
+		cemu_assert_debug(ZpIR::isRegVar(ins->regArray[0]));
+		auto dstType = m_blockContext.currentBasicBlock->getRegType(ins->regArray[0]);
+		uint32 loadedId = AllocId();
+		ZpIR::DataType loadedType;
+		if (loc.IsUniformRegister())
+		{
+			uint16 index;
+			loc.GetUniformRegister(index);
+			loadedType = ZpIR::DataType::F32;
+			uint32 ptrId = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpAccessChain, { GetPointerTypeId(SPV::StorageClassUniform, GetTypeId(loadedType)), ptrId, m_uniformVarId,
+				GetConstantId(ZpIR::DataType::U32, 0), GetConstantId(ZpIR::DataType::U32, index / 4), GetConstantId(ZpIR::DataType::U32, index & 3) });
+			EmitOp(SECTION::FUNCTION, SPV::OpLoad, { GetTypeId(loadedType), loadedId, ptrId });
+		}
+		else if (loc.IsVertexAttribute())
+		{
+			uint16 attributeIndex;
+			uint16 channelIndex;
+			loc.GetVertexAttribute(attributeIndex, channelIndex);
+			cemu_assert_debug(channelIndex < 4);
+			loadedType = ZpIR::DataType::U32;
+			uint32 ptrId = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpAccessChain, { GetPointerTypeId(SPV::StorageClassInput, GetTypeId(loadedType)), ptrId, m_inputAttributeVarIds[attributeIndex], GetConstantId(ZpIR::DataType::U32, channelIndex) });
+			EmitOp(SECTION::FUNCTION, SPV::OpLoad, { GetTypeId(loadedType), loadedId, ptrId });
+		}
+		else
+		{
+			cemu_assert_debug(false);
+			return;
+		}
+		if (dstType != loadedType)
+		{
+			uint32 castId = AllocId();
+			EmitOp(SECTION::FUNCTION, SPV::OpBitcast, { GetTypeId(dstType), castId, loadedId });
+			loadedId = castId;
+		}
+		SetResultId(ins->regArray[0], loadedId);
+	}
+
+	void SPIRV::HandleInstruction(ZpIR::IR::InsEXPORT* ins)
+	{
+		ZpIR::ShaderSubset::ShaderExportLocation loc(ins->exportSymbol);
+		cemu_assert_debug(ins->count == 4);
+		uint32 elementIds[4];
+		for (uint32 i = 0; i < 4; i++)
+			elementIds[i] = i < ins->count ? GetOperandIdAsType(ins->regArray[i], ZpIR::DataType::F32) : GetConstantId(ZpIR::DataType::F32, 0);
+		uint32 targetVarId;
+		if (loc.IsPosition())
+		{
+			targetVarId = m_positionVarId;
+			if (m_options.remapPositionZ)
+			{
+				// z = (z + w) / 2.0
+				uint32 typeF32 = GetTypeId(ZpIR::DataType::F32);
+				uint32 sumId = AllocId();
+				EmitOp(SECTION::FUNCTION, SPV::OpFAdd, { typeF32, sumId, elementIds[2], elementIds[3] });
+				uint32 halfOne = 0x3F000000; // 0.5f
+				uint32 zId = AllocId();
+				EmitOp(SECTION::FUNCTION, SPV::OpFMul, { typeF32, zId, sumId, GetConstantId(ZpIR::DataType::F32, halfOne) });
+				elementIds[2] = zId;
+			}
+		}
+		else if (loc.IsOutputAttribute())
+		{
+			uint16 attributeIndex;
+			loc.GetOutputAttribute(attributeIndex);
+			targetVarId = m_outputAttributeVarIds[attributeIndex];
+		}
+		else
+		{
+			assert_dbg();
+			return;
+		}
+		uint32 vecId = AllocId();
+		EmitOp(SECTION::FUNCTION, SPV::OpCompositeConstruct, { GetVec4TypeId(ZpIR::DataType::F32), vecId, elementIds[0], elementIds[1], elementIds[2], elementIds[3] });
+		EmitOp(SECTION::FUNCTION, SPV::OpStore, { targetVarId, vecId });
+	}
+
+	uint32 SPIRV::GetTypeId(ZpIR::DataType type)
+	{
+		auto it = m_typeIds.find((uint32)type);
+		if (it != m_typeIds.end())
+			return it->second;
+		uint32 id = AllocId();
+		if (type == ZpIR::DataType::F32)
+			EmitOp(SECTION::GLOBALS, SPV::OpTypeFloat, { id, 32 });
+		else if (type == ZpIR::DataType::U32)
+			EmitOp(SECTION::GLOBALS, SPV::OpTypeInt, { id, 32, 0 });
+		else if (type == ZpIR::DataType::S32)
+			EmitOp(SECTION::GLOBALS, SPV::OpTypeInt, { id, 32, 1 });
+		else if (type == ZpIR::DataType::BOOL)
+			EmitOp(SECTION::GLOBALS, SPV::OpTypeBool, { id });
+		else
+			cemu_assert_unimplemented();
+		m_typeIds.emplace((uint32)type, id);
+		return id;
+	}
+
+	uint32 SPIRV::GetVec4TypeId(ZpIR::DataType elementType)
+	{
+		auto it = m_vec4TypeIds.find((uint32)elementType);
+		if (it != m_vec4TypeIds.end())
+			return it->second;
+		uint32 elementTypeId = GetTypeId(elementType);
+		uint32 id = AllocId();
+		EmitOp(SECTION::GLOBALS, SPV::OpTypeVector, { id, elementTypeId, 4 });
+		m_vec4TypeIds.emplace((uint32)elementType, id);
+		return id;
+	}
+
+	uint32 SPIRV::GetPointerTypeId(uint32 storageClass, uint32 typeId)
+	{
+		uint64 key = ((uint64)storageClass << 32) | typeId;
+		auto it = m_pointerTypeIds.find(key);
+		if (it != m_pointerTypeIds.end())
+			return it->second;
+		uint32 id = AllocId();
+		EmitOp(SECTION::GLOBALS, SPV::OpTypePointer, { id, storageClass, typeId });
+		m_pointerTypeIds.emplace(key, id);
+		return id;
+	}
+
+	uint32 SPIRV::GetConstantId(ZpIR::DataType type, uint32 rawValue)
+	{
+		uint64 key = ((uint64)type << 32) | rawValue;
+		auto it = m_constantIds.find(key);
+		if (it != m_constantIds.end())
+			return it->second;
+		uint32 typeId = GetTypeId(type);
+		uint32 id = AllocId();
+		EmitOp(SECTION::GLOBALS, SPV::OpConstant, { typeId, id, rawValue });
+		m_constantIds.emplace(key, id);
+		return id;
+	}
+
+	uint32 SPIRV::GetOperandId(ZpIR::IRReg irReg)
+	{
+		if (ZpIR::isConstVar(irReg))
+		{
+			ZpIR::IRRegConstDef* constDef = m_blockContext.currentBasicBlock->getConstant(irReg);
+			cemu_assert_debug(constDef->type == ZpIR::DataType::U32 || constDef->type == ZpIR::DataType::S32 || constDef->type == ZpIR::DataType::F32);
+			return GetConstantId(constDef->type, constDef->value_u32);
+		}
+		uint32 id = m_blockContext.regIds[ZpIR::getRegIndex(irReg)];
+		cemu_assert_debug(id != 0); // read before write
+		return id;
+	}
+
+	// constants are converted by value, which matches the implicit conversion of literals in the GLSL emitter
+	uint32 SPIRV::GetOperandIdAsType(ZpIR::IRReg irReg, ZpIR::DataType type)
+	{
+		ZpIR::DataType regType = m_blockContext.currentBasicBlock->getRegType(irReg);
+		if (regType == type)
+			return GetOperandId(irReg);
+		if (ZpIR::isConstVar(irReg))
+		{
+			ZpIR::IRRegConstDef* constDef = m_blockContext.currentBasicBlock->getConstant(irReg);
+			uint32 rawValue;
+			if (type == ZpIR::DataType::F32)
+			{
+				f32 v = constDef->type == ZpIR::DataType::S32 ? (f32)constDef->value_s32 : (f32)constDef->value_u32;
+				rawValue = std::bit_cast<uint32>(v);
+			}
+			else if (constDef->type == ZpIR::DataType::F32)
+				rawValue = type == ZpIR::DataType::S32 ? (uint32)(sint32)constDef->value_f32 : (uint32)constDef->value_f32;
+			else
+				rawValue = constDef->value_u32; // S32 <-> U32
+			return GetConstantId(type, rawValue);
+		}
+		cemu_assert_debug(false); // register type mismatch, IR should contain an explicit BITCAST
+		uint32 castId = AllocId();
+		EmitOp(SECTION::FUNCTION, SPV::OpBitcast, { GetTypeId(type), castId, GetOperandId(irReg) });
+		return castId;
+	}
+
+	void SPIRV::SetResultId(ZpIR::IRReg irReg, uint32 id)
+	{
+		cemu_assert_debug(ZpIR::isRegVar(irReg));
+		m_blockContext.regIds[ZpIR::getRegIndex(irReg)] = id;
+	}
+
+	std::vector<uint32>& SPIRV::GetSection(SECTION section)
+	{
+		switch (section)
+		{
+		case SECTION::HEADER:
+			return m_sectionHeader;
+		case SECTION::ANNOTATIONS:
+			return m_sectionAnnotations;
+		case SECTION::GLOBALS:
+			return m_sectionGlobals;
+		default:
+			return m_sectionFunction;
+		}
+	}
+
+	void SPIRV::EmitOp(SECTION section, uint16 opcode, std::initializer_list<uint32> operands)
+	{
+		auto& words = GetSection(section);
+		uint32 wordCount = 1 + (uint32)operands.size();
+		words.emplace_back((wordCount << 16) | opcode);
+		words.insert(words.end(), operands.begin(), operands.end());
+	}
+
+	void SPIRV::EmitOpWithString(SECTION section, uint16 opcode, std::initializer_list<uint32> operandsBefore, std::string_view str, std::span<const uint32> operandsAfter)
+	{
+		auto& words = GetSection(section);
+		uint32 stringWordCount = (uint32)(str.size() / 4 + 1); // includes null terminator
+		uint32 wordCount = 1 + (uint32)operandsBefore.size() + stringWordCount + (uint32)operandsAfter.size();
+		words.emplace_back((wordCount << 16) | opcode);
+		words.insert(words.end(), operandsBefore.begin(), operandsBefore.end());
+		size_t stringOffset = words.size();
+		words.resize(words.size() + stringWordCount, 0);
+		memcpy(words.data() + stringOffset, str.data(), str.size()); // SPIR-V words are little-endian
+		words.insert(words.end(), operandsAfter.begin(), operandsAfter.end());
+	}
+
+	bool SPIRV::Validate(std::span<const uint32> spirv, std::string* errorOut)
+	{
+		auto fail = [&](std::string_view msg, size_t wordOffset) -> bool
+		{
+			if (errorOut)
+				*errorOut = fmt::format("{} (word {})", msg, wordOffset);
+			return false;
+		};
+		if (spirv.size() < 5)
+			return fail("module too small", 0);
+		if (spirv[0] != SPV::MAGIC)
+			return fail("invalid magic", 0);
+		if (spirv[1] > SPV::VERSION_1_3)
+			return fail("unsupported version", 1);
+		const uint32 bound = spirv[3];
+		if (bound == 0 || spirv[4] != 0)
+			return fail("invalid bound or schema", 3);
+
+		// logical layout, each instruction belongs to a section and sections must appear in order
+		enum LAYOUT : uint8
+		{
+			L_CAPABILITY, L_MEMORYMODEL, L_ENTRYPOINT, L_DEBUG, L_ANNOTATION, L_GLOBAL, L_FUNCTION
+		};
+		// how operands are interpreted, only the instructions generated by the emitter are supported
+		enum OPERANDS : uint8
+		{
+			O_NONE, // no ids
+			O_RESULT, // result id, remaining operands are literals
+			O_RESULT_IDS, // result id, remaining operands are ids
+			O_TYPE_RESULT_IDS, // result type, result id, remaining operands are ids
+			O_TYPE_RESULT_LITERALS, // result type, result id, remaining operands are literals
+			O_IDS, // all operands are ids
+			O_ID_LITERALS, // first operand is an id, remaining are literals
+		};
+		struct OpInfo { uint8 layout; uint8 operands; };
+		auto getOpInfo = [](uint16 opcode, OpInfo& info) -> bool
+		{
+			switch (opcode)
+			{
+			case SPV::OpCapability: info = { L_CAPABILITY, O_NONE }; return true;
+			case SPV::OpMemoryModel: info = { L_MEMORYMODEL, O_NONE }; return true;
+			case SPV::OpEntryPoint: info = { L_ENTRYPOINT, O_NONE }; return true; // handled separately
+			case SPV::OpExecutionMode: info = { L_ENTRYPOINT, O_ID_LITERALS }; return true;
+			case SPV::OpName: case SPV::OpMemberName: info = { L_DEBUG, O_ID_LITERALS }; return true;
+			case SPV::OpDecorate: case SPV::OpMemberDecorate: info = { L_ANNOTATION, O_ID_LITERALS }; return true;
+			case SPV::OpTypeVoid: case SPV::OpTypeBool: case SPV::OpTypeInt: case SPV::OpTypeFloat: info = { L_GLOBAL, O_RESULT }; return true;
+			case SPV::OpTypeArray: case SPV::OpTypeStruct: case SPV::OpTypeFunction: info = { L_GLOBAL, O_RESULT_IDS }; return true;
+			case SPV::OpTypeVector: info = { L_GLOBAL, O_RESULT }; return true; // component type checked separately
+			case SPV::OpTypePointer: info = { L_GLOBAL, O_RESULT }; return true; // pointee type checked separately
+			case SPV::OpConstant: info = { L_GLOBAL, O_TYPE_RESULT_LITERALS }; return true;
+			case SPV::OpVariable: info = { L_GLOBAL, O_TYPE_RESULT_LITERALS }; return true;
+			case SPV::OpFunction: case SPV::OpFunctionEnd: case SPV::OpLabel: case SPV::OpReturn:
+			case SPV::OpStore:
+				info = { L_FUNCTION, O_IDS }; return true;
+			case SPV::OpLoad: case SPV::OpAccessChain: case SPV::OpCompositeConstruct: case SPV::OpCopyObject:
+			case SPV::OpConvertFToU: case SPV::OpConvertFToS: case SPV::OpConvertSToF: case SPV::OpConvertUToF: case SPV::OpBitcast:
+			case SPV::OpIAdd: case SPV::OpFAdd: case SPV::OpISub: case SPV::OpFSub: case SPV::OpIMul: case SPV::OpFMul:
+			case SPV::OpUDiv: case SPV::OpSDiv: case SPV::OpFDiv:
+			case SPV::OpShiftRightLogical: case SPV::OpShiftLeftLogical: case SPV::OpBitwiseOr: case SPV::OpBitwiseAnd:
+				info = { L_FUNCTION, O_TYPE_RESULT_IDS }; return true;
+			case SPV::OpCompositeExtract:
+				info = { L_FUNCTION, O_TYPE_RESULT_LITERALS }; return true;
+			default:
+				return false;
+			}
+		};
+
+		std::vector<uint8> defined(bound, 0);
+		std::vector<std::pair<uint32, size_t>> forwardReferences; // references which may point to ids defined later
+		uint8 currentLayout = L_CAPABILITY;
+		bool inFunction = false;
+		bool inBlock = false;
+		bool hasEntryPoint = false;
+		auto define = [&](uint32 id, size_t offset) -> bool
+		{
+			if (id == 0 || id >= bound)
+				return fail("result id out of bounds", offset);
+			if (defined[id])
+				return fail(fmt::format("id {} defined more than once", id), offset);
+			defined[id] = 1;
+			return true;
+		};
+		auto use = [&](uint32 id, size_t offset, bool allowForward) -> bool
+		{
+			if (id == 0 || id >= bound)
+				return fail("referenced id out of bounds", offset);
+			if (!defined[id])
+			{
+				if (!allowForward)
+					return fail(fmt::format("id {} used before definition", id), offset);
+				forwardReferences.emplace_back(id, offset);
+			}
+			return true;
+		};
+
+		size_t offset = 5;
+		while (offset < spirv.size())
+		{
+			uint32 wordCount = spirv[offset] >> 16;
+			uint16 opcode = (uint16)(spirv[offset] & 0xFFFF);
+			if (wordCount == 0 || offset + wordCount > spirv.size())
+				return fail("invalid instruction word count", offset);
+			OpInfo info;
+			if (!getOpInfo(opcode, info))
+				return fail(fmt::format("unsupported opcode {}", opcode), offset);
+			// layout order
+			uint8 layout = info.layout;
+			if (opcode == SPV::OpVariable && inFunction)
+				layout = L_FUNCTION;
+			if (layout < currentLayout)
+				return fail(fmt::format("opcode {} out of order", opcode), offset);
+			currentLayout = layout;
+			std::span<const uint32> operands = spirv.subspan(offset + 1, wordCount - 1);
+			const bool allowForward = layout < L_GLOBAL;
+			// function structure
+			if (opcode == SPV::OpFunction)
+			{
+				if (inFunction || operands.size() != 4)
+					return fail("invalid OpFunction", offset);
+				if (!use(operands[0], offset, false) || !define(operands[1], offset) || !use(operands[3], offset, false))
+					return false;
+				inFunction = true;
+				offset += wordCount;
+				continue;
+			}
+			if (opcode == SPV::OpFunctionEnd)
+			{
+				if (!inFunction || inBlock)
+					return fail("unexpected OpFunctionEnd", offset);
+				inFunction = false;
+				offset += wordCount;
+				continue;
+			}
+			if (opcode == SPV::OpLabel)
+			{
+				if (!inFunction || inBlock || operands.size() != 1 || !define(operands[0], offset))
+					return fail("unexpected OpLabel", offset);
+				inBlock = true;
+				offset += wordCount;
+				continue;
+			}
+			if (layout == L_FUNCTION && !inBlock)
+				return fail("instruction outside of a block", offset);
+			if (opcode == SPV::OpReturn)
+			{
+				inBlock = false;
+				offset += wordCount;
+				continue;
+			}
+			if (opcode == SPV::OpEntryPoint)
+			{
+				// execution model, function id, name string, interface ids
+				if (operands.size() < 3)
+					return fail("invalid OpEntryPoint", offset);
+				if (!use(operands[1], offset, true))
+					return false;
+				size_t i = 2;
+				while (i < operands.size() && (operands[i] >> 24) != 0)
+					i++;
+				if (i >= operands.size())
+					return fail("unterminated string", offset);
+				for (i++; i < operands.size(); i++)
+				{
+					if (!use(operands[i], offset, true))
+						return false;
+				}
+				hasEntryPoint = true;
+				offset += wordCount;
+				continue;
+			}
+			switch (info.operands)
+			{
+			case O_NONE:
+				break;
+			case O_RESULT:
+				if (operands.empty() || !define(operands[0], offset))
+					return fail("missing result id", offset);
+				if (opcode == SPV::OpTypeVector && (operands.size() != 3 || !use(operands[1], offset, false)))
+					return false;
+				if (opcode == SPV::OpTypePointer && (operands.size() != 3 || !use(operands[2], offset, false)))
+					return false;
+				break;
+			case O_RESULT_IDS:
+				if (operands.empty() || !define(operands[0], offset))
+					return fail("missing result id", offset);
+				for (size_t i = 1; i < operands.size(); i++)
+				{
+					if (!use(operands[i], offset, allowForward))
+						return false;
+				}
+				break;
+			case O_TYPE_RESULT_IDS:
+			case O_TYPE_RESULT_LITERALS:
+				if (operands.size() < 2)
+					return fail("missing result type or id", offset);
+				if (!use(operands[0], offset, false) || !define(operands[1], offset))
+					return false;
+				if (info.operands == O_TYPE_RESULT_IDS || opcode == SPV::OpCompositeExtract)
+				{
+					size_t idCount = opcode == SPV::OpCompositeExtract ? std::min<size_t>(operands.size(), 3) : operands.size();
+					for (size_t i = 2; i < idCount; i++)
+					{
+						if (!use(operands[i], offset, allowForward))
+							return false;
+					}
+				}
+				break;
+			case O_IDS:
+				for (size_t i = 0; i < operands.size(); i++)
+				{
+					if (opcode == SPV::OpStore && i >= 2)
+						break; // memory access literals
+					if (!use(operands[i], offset, allowForward))
+						return false;
+				}
+				break;
+			case O_ID_LITERALS:
+				if (operands.empty() || !use(operands[0], offset, true))
+					return fail("missing target id", offset);
+				break;
+			}
+			offset += wordCount;
+		}
+		if (inFunction)
+			return fail("missing OpFunctionEnd", offset);
+		if (!hasEntryPoint)
+			return fail("missing OpEntryPoint", offset);
+		for (auto& itr : forwardReferences)
+		{
+			if (!defined[itr.first])
+				return fail(fmt::format("id {} is never defined", itr.first), itr.second);
+		}
+		return true;
+	}
+};
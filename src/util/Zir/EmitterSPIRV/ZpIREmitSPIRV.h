@@ -0,0 +1,96 @@
+#pragma once
+#include "util/Zir/Core/IR.h"
+#include "util/Zir/Core/ZpIRPasses.h"
+
+namespace ZirEmitter
+{
+	// generates a SPIR-V module directly from ZpIR, without going through GLSL and glslang
+	// IR registers are SSA values so no register allocation pass is needed
+	// the shader interface matches the GLSL emitter:
+	// - uniform registers are read from a uniform block holding a vec4 array (uf_remapped)
+	// - vertex attributes are uvec4 inputs with location = attribute index
+	// - output attributes are vec4 outputs with location = attribute index
+	class SPIRV
+	{
+	public:
+		struct Options
+		{
+			uint32 uniformSetIndex{ 0 };
+			uint32 uniformBindingPoint{ 0 };
+			bool remapPositionZ{ false }; // convert clip space z from [-w,w] to [0,w], same as the SET_POSITION macro for Vulkan
+		};
+
+		SPIRV() {};
+
+		// emit a complete vertex shader module
+		void Emit(ZpIR::ZpIRFunction* irFunction, const Options& options, std::vector<uint32>& output);
+
+		// verifies the module layout, instruction sizes and that every referenced id is defined exactly once
+		// this covers the subset of SPIR-V generated by this emitter and is not a replacement for spirv-val
+		static bool Validate(std::span<const uint32> spirv, std::string* errorOut = nullptr);
+
+	private:
+		enum class SECTION
+		{
+			HEADER, // capabilities, memory model, entry point
+			ANNOTATIONS,
+			GLOBALS, // types, constants and global variables
+			FUNCTION,
+		};
+
+		void CollectInterface(ZpIR::ZpIRBasicBlock& basicBlock);
+		void GenerateBasicBlockCode(ZpIR::ZpIRBasicBlock& basicBlock);
+
+		void HandleInstruction(ZpIR::IR::InsRR* ins);
+		void HandleInstruction(ZpIR::IR::InsRRR* ins);
+		void HandleInstruction(ZpIR::IR::InsIMPORT* ins);
+		void HandleInstruction(ZpIR::IR::InsEXPORT* ins);
+
+		// id allocation and lookup
+		uint32 AllocId() { return m_nextId++; }
+		uint32 GetTypeId(ZpIR::DataType type);
+		uint32 GetVec4TypeId(ZpIR::DataType elementType);
+		uint32 GetPointerTypeId(uint32 storageClass, uint32 typeId);
+		uint32 GetConstantId(ZpIR::DataType type, uint32 rawValue);
+		uint32 GetOperandId(ZpIR::IRReg irReg);
+		uint32 GetOperandIdAsType(ZpIR::IRReg irReg, ZpIR::DataType type);
+		void SetResultId(ZpIR::IRReg irReg, uint32 id);
+
+		// word stream helpers
+		void EmitOp(SECTION section, uint16 opcode, std::initializer_list<uint32> operands);
+		void EmitOpWithString(SECTION section, uint16 opcode, std::initializer_list<uint32> operandsBefore, std::string_view str, std::span<const uint32> operandsAfter);
+		std::vector<uint32>& GetSection(SECTION section);
+
+	private:
+		ZpIR::ZpIRFunction* m_irFunction{};
+		Options m_options;
+		uint32 m_nextId{ 1 };
+
+		std::vector<uint32> m_sectionHeader;
+		std::vector<uint32> m_sectionAnnotations;
+		std::vector<uint32> m_sectionGlobals;
+		std::vector<uint32> m_sectionFunction;
+
+		// cached ids
+		uint32 m_typeVoid{};
+		uint32 m_typeFunctionVoid{};
+		std::unordered_map<uint32, uint32> m_typeIds; // DataType -> id
+		std::unordered_map<uint32, uint32> m_vec4TypeIds; // element DataType -> id
+		std::unordered_map<uint64, uint32> m_pointerTypeIds; // storageClass << 32 | typeId -> id
+		std::unordered_map<uint64, uint32> m_constantIds; // DataType << 32 | value -> id
+
+		// shader interface
+		uint32 m_uniformVarId{};
+		uint32 m_uniformRegisterCount{};
+		uint32 m_positionVarId{};
+		std::map<uint16, uint32> m_inputAttributeVarIds; // attribute index -> variable id
+		std::map<uint16, uint32> m_outputAttributeVarIds;
+
+		struct
+		{
+			ZpIR::ZpIRBasicBlock* currentBasicBlock{ nullptr };
+			std::vector<uint32> regIds; // SSA id for each IR register
+		}m_blockContext;
+	};
+
+}
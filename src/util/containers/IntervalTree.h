@@ -0,0 +1,238 @@
+#pragma once
+
+// Augmented interval tree (AVL tree ordered by range start, each node stores the maximum range end of its subtree)
+// Ranges with the same start are kept in insertion order
+// Insertion and removal are O(log n), lookups are O(log n + k) and every overlapping range is reported exactly once, in ascending order of range start
+template<typename TAddr, typename TData>
+class IntervalTree
+{
+	struct rangeNode_t
+	{
+		TAddr rangeStart;
+		TAddr rangeEnd;
+		TAddr maxEnd; // max rangeEnd of the subtree rooted at this node
+		uint64 seq; // insertion order, makes the key unique
+		TData data;
+		rangeNode_t* left{};
+		rangeNode_t* right{};
+		sint32 height{1};
+		rangeNode_t(TAddr rangeStart, TAddr rangeEnd, uint64 seq, TData data) : rangeStart(rangeStart), rangeEnd(rangeEnd), maxEnd(rangeEnd), seq(seq), data(data) {};
+	};
+
+public:
+	IntervalTree() = default;
+	~IntervalTree()
+	{
+		clear();
+	}
+
+	IntervalTree(const IntervalTree&) = delete;
+	IntervalTree& operator=(const IntervalTree&) = delete;
+
+	// range is defined as inclusive rangeStart and exclusive rangeEnd
+	void addRange(TAddr rangeStart, TAddr rangeEnd, TData data)
+	{
+		cemu_assert_debug(rangeStart < rangeEnd);
+		m_root = insertNode(m_root, new rangeNode_t(rangeStart, rangeEnd, m_seqCounter++, data));
+		m_count++;
+	}
+
+	// returns false if no matching range was registered
+	bool removeRange(TAddr rangeStart, TData data)
+	{
+		rangeNode_t* match = nullptr;
+		visitByStart(m_root, rangeStart, [&](rangeNode_t* node) {
+			if (!match && node->data == data)
+				match = node;
+		});
+		if (!match)
+			return false;
+		m_root = eraseNode(m_root, match->rangeStart, match->seq);
+		m_count--;
+		return true;
+	}
+
+	// calls cb(data) for every range which overlaps [rangeStart, rangeEnd)
+	template<typename TRangeCallback>
+	void lookupRanges(TAddr rangeStart, TAddr rangeEnd, TRangeCallback cb)
+	{
+		cemu_assert_debug(rangeStart < rangeEnd);
+		lookupRangesInclusive(rangeStart, rangeEnd - 1, cb);
+	}
+
+	// calls cb(data) for every range which overlaps [rangeStart, rangeLast]. Allows queries which reach the end of the address space
+	template<typename TRangeCallback>
+	void lookupRangesInclusive(TAddr rangeStart, TAddr rangeLast, TRangeCallback cb)
+	{
+		cemu_assert_debug(rangeStart <= rangeLast);
+		lookupNode(m_root, rangeStart, rangeLast, cb);
+	}
+
+	// calls cb(data) for every range which starts exactly at rangeStart
+	template<typename TRangeCallback>
+	void lookupRangesByStart(TAddr rangeStart, TRangeCallback cb)
+	{
+		visitByStart(m_root, rangeStart, [&](rangeNode_t* node) { cb(node->data); });
+	}
+
+	size_t size() const
+	{
+		return m_count;
+	}
+
+	void clear()
+	{
+		deleteSubtree(m_root);
+		m_root = nullptr;
+		m_count = 0;
+	}
+
+private:
+	static sint32 getHeight(rangeNode_t* node)
+	{
+		return node ? node->height : 0;
+	}
+
+	static void updateNode(rangeNode_t* node)
+	{
+		node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
+		TAddr maxEnd = node->rangeEnd;
+		if (node->left)
+			maxEnd = std::max(maxEnd, node->left->maxEnd);
+		if (node->right)
+			maxEnd = std::max(maxEnd, node->right->maxEnd);
+		node->maxEnd = maxEnd;
+	}
+
+	static rangeNode_t* rotateRight(rangeNode_t* node)
+	{
+		rangeNode_t* l = node->left;
+		node->left = l->right;
+		l->right = node;
+		updateNode(node);
+		updateNode(l);
+		return l;
+	}
+
+	static rangeNode_t* rotateLeft(rangeNode_t* node)
+	{
+		rangeNode_t* r = node->right;
+		node->right = r->left;
+		r->left = node;
+		updateNode(node);
+		updateNode(r);
+		return r;
+	}
+
+	static rangeNode_t* rebalance(rangeNode_t* node)
+	{
+		updateNode(node);
+		sint32 balance = getHeight(node->left) - getHeight(node->right);
+		if (balance > 1)
+		{
+			if (getHeight(node->left->left) < getHeight(node->left->right))
+				node->left = rotateLeft(node->left);
+			return rotateRight(node);
+		}
+		if (balance < -1)
+		{
+			if (getHeight(node->right->right) < getHeight(node->right->left))
+				node->right = rotateRight(node->right);
+			return rotateLeft(node);
+		}
+		return node;
+	}
+
+	static bool isKeyLess(TAddr startA, uint64 seqA, TAddr startB, uint64 seqB)
+	{
+		return startA < startB || (startA == startB && seqA < seqB);
+	}
+
+	static rangeNode_t* insertNode(rangeNode_t* node, rangeNode_t* newNode)
+	{
+		if (!node)
+			return newNode;
+		if (isKeyLess(newNode->rangeStart, newNode->seq, node->rangeStart, node->seq))
+			node->left = insertNode(node->left, newNode);
+		else
+			node->right = insertNode(node->right, newNode);
+		return rebalance(node);
+	}
+
+	// detaches the leftmost node of the subtree and stores it in minOut
+	static rangeNode_t* detachMin(rangeNode_t* node, rangeNode_t*& minOut)
+	{
+		if (!node->left)
+		{
+			minOut = node;
+			return node->right;
+		}
+		node->left = detachMin(node->left, minOut);
+		return rebalance(node);
+	}
+
+	static rangeNode_t* eraseNode(rangeNode_t* node, TAddr rangeStart, uint64 seq)
+	{
+		if (!node)
+			return nullptr;
+		if (isKeyLess(rangeStart, seq, node->rangeStart, node->seq))
+			node->left = eraseNode(node->left, rangeStart, seq);
+		else if (isKeyLess(node->rangeStart, node->seq, rangeStart, seq))
+			node->right = eraseNode(node->right, rangeStart, seq);
+		else
+		{
+			rangeNode_t* l = node->left;
+			rangeNode_t* r = node->right;
+			delete node;
+			if (!r)
+				return l;
+			rangeNode_t* successor;
+			r = detachMin(r, successor);
+			successor->left = l;
+			successor->right = r;
+			return rebalance(successor);
+		}
+		return rebalance(node);
+	}
+
+	template<typename TRangeCallback>
+	static void lookupNode(rangeNode_t* node, TAddr rangeStart, TAddr rangeLast, TRangeCallback& cb)
+	{
+		// no range in this subtree ends after rangeStart
+		if (!node || node->maxEnd <= rangeStart)
+			return;
+		lookupNode(node->left, rangeStart, rangeLast, cb);
+		// this node and the right subtree start after the queried range
+		if (node->rangeStart > rangeLast)
+			return;
+		if (rangeStart < node->rangeEnd)
+			cb(node->data);
+		lookupNode(node->right, rangeStart, rangeLast, cb);
+	}
+
+	template<typename TNodeCallback>
+	static void visitByStart(rangeNode_t* node, TAddr rangeStart, TNodeCallback cb)
+	{
+		if (!node)
+			return;
+		if (rangeStart <= node->rangeStart)
+			visitByStart(node->left, rangeStart, cb);
+		if (node->rangeStart == rangeStart)
+			cb(node);
+		if (node->rangeStart <= rangeStart)
+			visitByStart(node->right, rangeStart, cb);
+	}
+
+	static void deleteSubtree(rangeNode_t* node)
+	{
+		if (!node)
+			return;
+		deleteSubtree(node->left);
+		deleteSubtree(node->right);
+		delete node;
+	}
+
+	rangeNode_t* m_root{};
+	size_t m_count{};
+	uint64 m_seqCounter{};
+};
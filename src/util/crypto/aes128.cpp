@@ -457,7 +457,7 @@ void InvCipher(aes128Ctx_t* aesCtx)
 	AddRoundKey(aesCtx, 0);
 }
 
-static void BlockCopy(uint8* output, uint8* input)
+static void BlockCopy(uint8* output, const uint8* input)
 {
 	uint8 i;
 	for (i = 0; i < KEYLEN; ++i)
@@ -533,7 +533,7 @@ void AES128_CBC_encrypt(uint8* output, uint8* input, uint32 length, const uint8*
 	cemu_assert_debug(remainders == 0);
 }
 
-void __soft__AES128_CBC_decrypt(uint8* output, uint8* input, uint32 length, const uint8* key, const uint8* iv)
+void __soft__AES128_CBC_decrypt(uint8* output, const uint8* input, uint32 length, const uint8* key, const uint8* iv)
 {
 	aes128Ctx_t aesCtx;
 	intptr_t i;
@@ -741,23 +741,76 @@ ATTRIBUTE_AESNI void AESNI128_CBC_decryptWithExpandedKey(const unsigned char *in
 	if (length % 16)
 		length = length / 16 + 1;
 	else length /= 16;
+	const __m128i* roundKey = (const __m128i*)key;
 	feedback = _mm_loadu_si128((__m128i*)ivec);
-	for (unsigned long i = 0; i < length; i++)
+	unsigned long i = 0;
+	// unlike encryption, CBC decryption has no dependency between blocks
+	// process 8 blocks at once so the latency of aesdec is hidden by the other blocks in flight
+	// all inputs are loaded before anything is stored, this keeps in-place decryption (in == out) working
+	for (; (i + 8) <= length; i += 8)
+	{
+		__m128i c0 = _mm_loadu_si128(&((__m128i*)in)[i + 0]);
+		__m128i c1 = _mm_loadu_si128(&((__m128i*)in)[i + 1]);
+		__m128i c2 = _mm_loadu_si128(&((__m128i*)in)[i + 2]);
+		__m128i c3 = _mm_loadu_si128(&((__m128i*)in)[i + 3]);
+		__m128i c4 = _mm_loadu_si128(&((__m128i*)in)[i + 4]);
+		__m128i c5 = _mm_loadu_si128(&((__m128i*)in)[i + 5]);
+		__m128i c6 = _mm_loadu_si128(&((__m128i*)in)[i + 6]);
+		__m128i c7 = _mm_loadu_si128(&((__m128i*)in)[i + 7]);
+		__m128i d0 = _mm_xor_si128(c0, roundKey[10]);
+		__m128i d1 = _mm_xor_si128(c1, roundKey[10]);
+		__m128i d2 = _mm_xor_si128(c2, roundKey[10]);
+		__m128i d3 = _mm_xor_si128(c3, roundKey[10]);
+		__m128i d4 = _mm_xor_si128(c4, roundKey[10]);
+		__m128i d5 = _mm_xor_si128(c5, roundKey[10]);
+		__m128i d6 = _mm_xor_si128(c6, roundKey[10]);
+		__m128i d7 = _mm_xor_si128(c7, roundKey[10]);
+		for (j = 9; j > 0; j--)
+		{
+			__m128i rk = roundKey[j];
+			d0 = _mm_aesdec_si128(d0, rk);
+			d1 = _mm_aesdec_si128(d1, rk);
+			d2 = _mm_aesdec_si128(d2, rk);
+			d3 = _mm_aesdec_si128(d3, rk);
+			d4 = _mm_aesdec_si128(d4, rk);
+			d5 = _mm_aesdec_si128(d5, rk);
+			d6 = _mm_aesdec_si128(d6, rk);
+			d7 = _mm_aesdec_si128(d7, rk);
+		}
+		d0 = _mm_aesdeclast_si128(d0, roundKey[0]);
+		d1 = _mm_aesdeclast_si128(d1, roundKey[0]);
+		d2 = _mm_aesdeclast_si128(d2, roundKey[0]);
+		d3 = _mm_aesdeclast_si128(d3, roundKey[0]);
+		d4 = _mm_aesdeclast_si128(d4, roundKey[0]);
+		d5 = _mm_aesdeclast_si128(d5, roundKey[0]);
+		d6 = _mm_aesdeclast_si128(d6, roundKey[0]);
+		d7 = _mm_aesdeclast_si128(d7, roundKey[0]);
+		_mm_storeu_si128(&((__m128i*)out)[i + 0], _mm_xor_si128(d0, feedback));
+		_mm_storeu_si128(&((__m128i*)out)[i + 1], _mm_xor_si128(d1, c0));
+		_mm_storeu_si128(&((__m128i*)out)[i + 2], _mm_xor_si128(d2, c1));
+		_mm_storeu_si128(&((__m128i*)out)[i + 3], _mm_xor_si128(d3, c2));
+		_mm_storeu_si128(&((__m128i*)out)[i + 4], _mm_xor_si128(d4, c3));
+		_mm_storeu_si128(&((__m128i*)out)[i + 5], _mm_xor_si128(d5, c4));
+		_mm_storeu_si128(&((__m128i*)out)[i + 6], _mm_xor_si128(d6, c5));
+		_mm_storeu_si128(&((__m128i*)out)[i + 7], _mm_xor_si128(d7, c6));
+		feedback = c7;
+	}
+	for (; i < length; i++)
 	{
 		lastin = _mm_loadu_si128(&((__m128i*)in)[i]);
-		data = _mm_xor_si128(lastin, ((__m128i*)key)[10]);
+		data = _mm_xor_si128(lastin, roundKey[10]);
 		for (j = 9; j > 0; j--)
 		{
-			data = _mm_aesdec_si128(data, ((__m128i*)key)[j]);
+			data = _mm_aesdec_si128(data, roundKey[j]);
 		}
-		data = _mm_aesdeclast_si128(data, ((__m128i*)key)[0]);
+		data = _mm_aesdeclast_si128(data, roundKey[0]);
 		data = _mm_xor_si128(data, feedback);
 		_mm_storeu_si128(&((__m128i*)out)[i], data);
 		feedback = lastin;
 	}
 }
 
-ATTRIBUTE_AESNI void __aesni__AES128_CBC_decrypt(uint8* output, uint8* input, uint32 length, const uint8* key, const uint8* iv)
+ATTRIBUTE_AESNI void __aesni__AES128_CBC_decrypt(uint8* output, const uint8* input, uint32 length, const uint8* key, const uint8* iv)
 {
 	alignas(16) uint8 expandedKey[11 * 16];
 	AESNI128_KeyExpansionDecrypt(key, expandedKey);
@@ -794,8 +847,69 @@ ATTRIBUTE_AESNI void __aesni__AES128_ECB_encrypt(uint8* input, const uint8* key,
 }
 #endif
 
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#include <arm_neon.h>
+#define AES128_HAS_ARMV8_CE
+
+// ARMv8 crypto extension implementation
+// this is only used when the build targets a CPU with the AES extension (e.g. Apple Silicon), there is no runtime detection
+// AESD does AddRoundKey + InvShiftRows + InvSubBytes, so unlike AES-NI the round key is applied before the inverse mix step
+// which means the inner round keys need InvMixColumns applied (equivalent inverse cipher)
+void __armv8ce__AES128_CBC_decrypt(uint8* output, const uint8* input, uint32 length, const uint8* key, const uint8* iv)
+{
+	aes128Ctx_t aesCtx;
+	KeyExpansion(&aesCtx, key);
+	uint8x16_t roundKey[11];
+	for (sint32 r = 0; r < 11; r++)
+		roundKey[r] = vld1q_u8(aesCtx.RoundKey + r * 16);
+	for (sint32 r = 1; r < 10; r++)
+		roundKey[r] = vaesimcq_u8(roundKey[r]);
+	uint8x16_t feedback = iv ? vld1q_u8(iv) : vdupq_n_u8(0);
+	uint32 numBlocks = (length + 15) / 16;
+	uint32 i = 0;
+	// process 4 blocks at once to keep the AES pipeline busy. Inputs are loaded before storing so in-place decryption works
+	for (; (i + 4) <= numBlocks; i += 4)
+	{
+		uint8x16_t c0 = vld1q_u8(input + (i + 0) * 16);
+		uint8x16_t c1 = vld1q_u8(input + (i + 1) * 16);
+		uint8x16_t c2 = vld1q_u8(input + (i + 2) * 16);
+		uint8x16_t c3 = vld1q_u8(input + (i + 3) * 16);
+		uint8x16_t d0 = vaesimcq_u8(vaesdq_u8(c0, roundKey[10]));
+		uint8x16_t d1 = vaesimcq_u8(vaesdq_u8(c1, roundKey[10]));
+		uint8x16_t d2 = vaesimcq_u8(vaesdq_u8(c2, roundKey[10]));
+		uint8x16_t d3 = vaesimcq_u8(vaesdq_u8(c3, roundKey[10]));
+		for (sint32 r = 9; r > 1; r--)
+		{
+			d0 = vaesimcq_u8(vaesdq_u8(d0, roundKey[r]));
+			d1 = vaesimcq_u8(vaesdq_u8(d1, roundKey[r]));
+			d2 = vaesimcq_u8(vaesdq_u8(d2, roundKey[r]));
+			d3 = vaesimcq_u8(vaesdq_u8(d3, roundKey[r]));
+		}
+		d0 = veorq_u8(vaesdq_u8(d0, roundKey[1]), roundKey[0]);
+		d1 = veorq_u8(vaesdq_u8(d1, roundKey[1]), roundKey[0]);
+		d2 = veorq_u8(vaesdq_u8(d2, roundKey[1]), roundKey[0]);
+		d3 = veorq_u8(vaesdq_u8(d3, roundKey[1]), roundKey[0]);
+		vst1q_u8(output + (i + 0) * 16, veorq_u8(d0, feedback));
+		vst1q_u8(output + (i + 1) * 16, veorq_u8(d1, c0));
+		vst1q_u8(output + (i + 2) * 16, veorq_u8(d2, c1));
+		vst1q_u8(output + (i + 3) * 16, veorq_u8(d3, c2));
+		feedback = c3;
+	}
+	for (; i < numBlocks; i++)
+	{
+		uint8x16_t c = vld1q_u8(input + i * 16);
+		uint8x16_t d = vaesimcq_u8(vaesdq_u8(c, roundKey[10]));
+		for (sint32 r = 9; r > 1; r--)
+			d = vaesimcq_u8(vaesdq_u8(d, roundKey[r]));
+		d = veorq_u8(vaesdq_u8(d, roundKey[1]), roundKey[0]);
+		vst1q_u8(output + i * 16, veorq_u8(d, feedback));
+		feedback = c;
+	}
+}
+#endif
+
 void(*AES128_ECB_encrypt)(uint8* input, const uint8* key, uint8* output);
-void (*AES128_CBC_decrypt)(uint8* output, uint8* input, uint32 length, const uint8* key, const uint8* iv) = nullptr;
+void (*AES128_CBC_decrypt)(uint8* output, const uint8* input, uint32 length, const uint8* key, const uint8* iv) = nullptr;
 
 // AES128-CTR encrypt/decrypt
 void AES128CTR_transform(uint8* data, sint32 length, uint8* key, uint8* nonceIv)
@@ -850,6 +964,9 @@ void AES128_init()
 		AES128_CBC_decrypt = __soft__AES128_CBC_decrypt;
 		AES128_ECB_encrypt = __soft__AES128_ECB_encrypt;
 	}
+    #elif defined(AES128_HAS_ARMV8_CE)
+	AES128_CBC_decrypt = __armv8ce__AES128_CBC_decrypt;
+	AES128_ECB_encrypt = __soft__AES128_ECB_encrypt;
     #else
 	AES128_CBC_decrypt = __soft__AES128_CBC_decrypt;
 	AES128_ECB_encrypt = __soft__AES128_ECB_encrypt;